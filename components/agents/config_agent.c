@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "agents/config_agent.h"
 #include "agents/config_parser.h"
+#include "agents/config_plan_parser.h"
 
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
@@ -20,8 +21,31 @@ static struct config_parser parser;
 struct config_agent_params {
 	const char *local_eid;
 	bool allow_remote_configuration;
+	void *bundle_processor_context;
 };
 
+static void handle_plan(struct bundle_adu data, void *bp_context)
+{
+	struct config_plan plan;
+
+	if (config_plan_parse(&plan, data.payload, data.length) != UD3TN_OK) {
+		LOGF_WARN(
+			"ConfigAgent: Dropped invalid contact plan from \"%s\"",
+			data.source
+		);
+		bundle_adu_free_members(data);
+		return;
+	}
+	bundle_adu_free_members(data);
+
+	bundle_processor_handle_router_commands(
+		bp_context,
+		plan.commands,
+		plan.count
+	);
+	config_plan_free(&plan);
+}
+
 static void callback(struct bundle_adu data, void *param, const void *ctx)
 {
 	(void)ctx;
@@ -43,6 +67,11 @@ static void callback(struct bundle_adu data, void *param, const void *ctx)
 		free(node_id);
 	}
 
+	if (config_plan_is_cbor(data.payload, data.length)) {
+		handle_plan(data, ca_param->bundle_processor_context);
+		return;
+	}
+
 	config_parser_reset(&parser);
 	config_parser_read(
 		&parser,
@@ -72,6 +101,7 @@ int config_agent_setup(
 
 	ca_param->local_eid = local_eid;
 	ca_param->allow_remote_configuration = allow_remote_configuration;
+	ca_param->bundle_processor_context = bundle_processor_context;
 
 	const struct agent agent = {
 		.sink_identifier = (
@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "agents/config_plan_parser.h"
+
+#include "ud3tn/eid.h"
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+
+#include "cbor.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of items of a command: type, node ID, CLA address, EIDs, contacts
+#define PLAN_COMMAND_ITEMS 5
+// Number of items of a contact: start, end, data rate, EIDs
+#define PLAN_CONTACT_ITEMS 4
+
+bool config_plan_is_cbor(const uint8_t *buffer, size_t length)
+{
+	// Major type 4 (array), whereas ASCII commands start with a digit
+	return length != 0 && (buffer[0] & 0xE0) == 0x80;
+}
+
+static enum ud3tn_result enter_array(CborValue *it, CborValue *recursed,
+				     size_t *length)
+{
+	if (!cbor_value_is_array(it) || !cbor_value_is_length_known(it))
+		return UD3TN_FAIL;
+	if (cbor_value_get_array_length(it, length) != CborNoError)
+		return UD3TN_FAIL;
+	if (cbor_value_enter_container(it, recursed) != CborNoError)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_uint(CborValue *it, uint64_t *out)
+{
+	if (!cbor_value_is_unsigned_integer(it))
+		return UD3TN_FAIL;
+	cbor_value_get_uint64(it, out);
+	if (cbor_value_advance_fixed(it) != CborNoError)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_time_ms(CborValue *it, uint64_t *out_ms)
+{
+	uint64_t time_s;
+
+	// The same limit as for the ASCII format applies.
+	if (parse_uint(it, &time_s) != UD3TN_OK || time_s >= UINT64_MAX / 1000)
+		return UD3TN_FAIL;
+	*out_ms = time_s * 1000;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_string(CborValue *it, char **out)
+{
+	char *str;
+	size_t length;
+
+	if (!cbor_value_is_text_string(it))
+		return UD3TN_FAIL;
+	if (cbor_value_dup_text_string(it, &str, &length, it) != CborNoError)
+		return UD3TN_FAIL;
+	// Strings containing a null character are not accepted.
+	if (length == 0 || strlen(str) != length) {
+		free(str);
+		return UD3TN_FAIL;
+	}
+	*out = str;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_eid(CborValue *it, char **out)
+{
+	char *eid, *node_id;
+
+	if (parse_string(it, &eid) != UD3TN_OK)
+		return UD3TN_FAIL;
+	// As for the ASCII format, the node ID is stored if it can be
+	// determined, as the router searches for it.
+	node_id = get_node_id(eid);
+	if (node_id) {
+		free(eid);
+		eid = node_id;
+	}
+	*out = eid;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_eid_list(CborValue *it,
+					struct endpoint_list **list)
+{
+	struct endpoint_list **tail = list;
+	CborValue recursed;
+	size_t length;
+
+	if (enter_array(it, &recursed, &length) != UD3TN_OK)
+		return UD3TN_FAIL;
+	for (size_t i = 0; i < length; i++) {
+		struct endpoint_list *const entry = malloc(
+			sizeof(struct endpoint_list)
+		);
+
+		if (!entry)
+			return UD3TN_FAIL;
+		entry->next = NULL;
+		if (parse_eid(&recursed, &entry->eid) != UD3TN_OK) {
+			free(entry);
+			return UD3TN_FAIL;
+		}
+		*tail = entry;
+		tail = &entry->next;
+	}
+	if (cbor_value_leave_container(it, &recursed) != CborNoError)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_contact(CborValue *it, struct node *node,
+				       struct contact_list **slot)
+{
+	struct contact *contact;
+	CborValue recursed;
+	size_t length;
+	uint64_t bitrate;
+
+	if (enter_array(it, &recursed, &length) != UD3TN_OK ||
+	    length != PLAN_CONTACT_ITEMS)
+		return UD3TN_FAIL;
+
+	*slot = malloc(sizeof(struct contact_list));
+	if (!*slot)
+		return UD3TN_FAIL;
+	(*slot)->next = NULL;
+	(*slot)->data = contact = contact_create(node);
+	if (!contact) {
+		free(*slot);
+		*slot = NULL;
+		return UD3TN_FAIL;
+	}
+
+	if (parse_time_ms(&recursed, &contact->from_ms) != UD3TN_OK ||
+	    parse_time_ms(&recursed, &contact->to_ms) != UD3TN_OK ||
+	    parse_uint(&recursed, &bitrate) != UD3TN_OK ||
+	    bitrate > UINT32_MAX)
+		return UD3TN_FAIL;
+	contact->bitrate_bytes_per_s = (uint32_t)bitrate;
+	if (parse_eid_list(&recursed, &contact->contact_endpoints) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	if (cbor_value_leave_container(it, &recursed) != CborNoError)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+static enum ud3tn_result parse_command(CborValue *it,
+				       struct router_command *command)
+{
+	struct node *const node = command->data;
+	struct contact_list **slot = &node->contacts;
+	CborValue recursed, contacts;
+	size_t length;
+	uint64_t type;
+
+	if (enter_array(it, &recursed, &length) != UD3TN_OK ||
+	    length != PLAN_COMMAND_ITEMS)
+		return UD3TN_FAIL;
+
+	// The command types are numbered as in the ASCII format.
+	if (parse_uint(&recursed, &type) != UD3TN_OK ||
+	    type < 1 || type > 3)
+		return UD3TN_FAIL;
+	command->type = (enum router_command_type)(
+		ROUTER_COMMAND_ADD + (type - 1)
+	);
+
+	if (parse_eid(&recursed, &node->eid) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	if (cbor_value_is_null(&recursed)) {
+		if (cbor_value_advance_fixed(&recursed) != CborNoError)
+			return UD3TN_FAIL;
+	} else if (parse_string(&recursed, &node->cla_addr) != UD3TN_OK) {
+		return UD3TN_FAIL;
+	}
+
+	if (parse_eid_list(&recursed, &node->endpoints) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	if (enter_array(&recursed, &contacts, &length) != UD3TN_OK)
+		return UD3TN_FAIL;
+	for (size_t i = 0; i < length; i++) {
+		if (parse_contact(&contacts, node, slot) != UD3TN_OK)
+			return UD3TN_FAIL;
+		slot = &(*slot)->next;
+	}
+	if (cbor_value_leave_container(&recursed, &contacts) != CborNoError)
+		return UD3TN_FAIL;
+
+	if (cbor_value_leave_container(it, &recursed) != CborNoError)
+		return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+enum ud3tn_result config_plan_parse(struct config_plan *plan,
+				    const uint8_t *buffer, size_t length)
+{
+	CborParser parser;
+	CborValue it, recursed;
+	size_t count;
+
+	plan->commands = NULL;
+	plan->count = 0;
+
+	if (cbor_parser_init(buffer, length, 0, &parser, &it) != CborNoError)
+		return UD3TN_FAIL;
+	if (enter_array(&it, &recursed, &count) != UD3TN_OK)
+		return UD3TN_FAIL;
+	// Every command takes more than one byte, which prevents allocating
+	// memory for bogus array lengths.
+	if (count == 0 || count > length)
+		return UD3TN_FAIL;
+
+	plan->commands = calloc(count, sizeof(struct router_command));
+	if (!plan->commands)
+		return UD3TN_FAIL;
+
+	for (size_t i = 0; i < count; i++) {
+		struct router_command *const command = &plan->commands[i];
+
+		plan->count++;
+		command->type = ROUTER_COMMAND_UNDEFINED;
+		command->data = node_create(NULL);
+		if (!command->data ||
+		    parse_command(&recursed, command) != UD3TN_OK)
+			goto fail;
+	}
+
+	if (cbor_value_leave_container(&it, &recursed) != CborNoError ||
+	    cbor_value_get_next_byte(&it) != buffer + length)
+		goto fail;
+	return UD3TN_OK;
+
+fail:
+	config_plan_free(plan);
+	return UD3TN_FAIL;
+}
+
+void config_plan_free(struct config_plan *plan)
+{
+	for (size_t i = 0; i < plan->count; i++)
+		free_node(plan->commands[i].data);
+	free(plan->commands);
+	plan->commands = NULL;
+	plan->count = 0;
+}
@@ -50,6 +50,15 @@ static void callback(struct bundle_adu data, void *p, const void *bp_context)
 		data.source
 	);
 
+	const size_t length = data.length;
+	uint8_t *const payload = bundle_adu_take_payload(&data);
+
+	if (!payload) {
+		LOG_ERROR("Echo Agent: Cannot take over the request payload.");
+		bundle_adu_free_members(data);
+		return;
+	}
+
 	agent_create_forward_bundle_direct(
 		bp_context,
 		params->local_eid,
@@ -59,13 +68,12 @@ static void callback(struct bundle_adu data, void *p, const void *bp_context)
 		time_ms,
 		seqnum,
 		params->lifetime_ms,
-		data.payload,
-		data.length,
+		payload,
+		length,
 		0
 	);
 
 	// Pointer responsibility was taken by agent_create_forward_bundle
-	data.payload = NULL;
 	bundle_adu_free_members(data);
 }
 
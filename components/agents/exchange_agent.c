@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/router.h"
+
+#if defined(ROUTING_EPIDEMIC) || defined(ROUTING_PROPHET)
+
+#include "agents/exchange_agent.h"
+
+#include "archipel-core/bundle_restore.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_time.h"
+
+#include "ud3tn/agent_util.h"
+#include "ud3tn/bundle_processor.h"
+#include "ud3tn/common.h"
+#include "ud3tn/eid.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct exchange_agent_params {
+	const struct exchange_agent_config *config;
+	bool is_ipn;
+	const char *local_eid;
+	uint8_t bundle_version;
+	QueueIdentifier_t bundle_restore_queue;
+
+	uint64_t last_bundle_timestamp_ms;
+	uint64_t last_bundle_sequence_number;
+};
+
+static struct exchange_agent_params *agent_params;
+
+static const char *get_agent_id(const struct exchange_agent_config *config,
+				bool is_ipn)
+{
+	return is_ipn ? config->agent_id_ipn : config->agent_id_dtn;
+}
+
+static uint64_t allocate_sequence_number(
+	struct exchange_agent_params *const config,
+	const uint64_t time_ms)
+{
+	if (config->last_bundle_timestamp_ms == time_ms)
+		return ++config->last_bundle_sequence_number;
+
+	config->last_bundle_timestamp_ms = time_ms;
+	config->last_bundle_sequence_number = 1;
+
+	return 1;
+}
+
+static void callback(struct bundle_adu data, void *p, const void *bp_context)
+{
+	struct exchange_agent_params *const params = p;
+	const struct exchange_agent_config *const config = params->config;
+	char *const node_eid = get_node_id(data.source);
+
+	(void)bp_context;
+	if (!node_eid) {
+		LOGF_WARN(
+			"Exchange Agent: Dropped %s from invalid EID \"%s\"",
+			config->state_name,
+			data.source
+		);
+		bundle_adu_free_members(data);
+		return;
+	}
+
+	if (config->state_received(node_eid, data.payload,
+				   data.length) != UD3TN_OK) {
+		LOGF_WARN(
+			"Exchange Agent: Could not process %s from \"%s\"",
+			config->state_name,
+			data.source
+		);
+	} else {
+		// Queue the persisted bundles, which are routed to the peer
+		// depending on its state.
+		bundle_restore_for_destination(
+			params->bundle_restore_queue,
+			node_eid
+		);
+	}
+	free(node_eid);
+	bundle_adu_free_members(data);
+}
+
+int exchange_agent_setup(struct bundle_agent_interface *const bai,
+			 QueueIdentifier_t bundle_restore_queue,
+			 const uint8_t bundle_version,
+			 const struct exchange_agent_config *config)
+{
+	struct exchange_agent_params *params = malloc(
+		sizeof(struct exchange_agent_params)
+	);
+
+	if (!params)
+		return -1;
+	params->config = config;
+	params->is_ipn = get_eid_scheme(bai->local_eid) == EID_SCHEME_IPN;
+	params->local_eid = bai->local_eid;
+	params->bundle_version = bundle_version;
+	params->bundle_restore_queue = bundle_restore_queue;
+	params->last_bundle_timestamp_ms = 0;
+	params->last_bundle_sequence_number = 0;
+	agent_params = params;
+
+	const struct agent agent = {
+		.sink_identifier = get_agent_id(config, params->is_ipn),
+		.callback = callback,
+		.param = params,
+	};
+
+	return bundle_processor_perform_agent_action(
+		bai->bundle_signaling_queue,
+		BP_SIGNAL_AGENT_REGISTER,
+		agent,
+		false
+	);
+}
+
+struct bundle *exchange_agent_create_bundle(const char *node_eid)
+{
+	struct exchange_agent_params *const params = agent_params;
+
+	if (!params)
+		return NULL;
+
+	const struct exchange_agent_config *const config = params->config;
+	const bool is_ipn = get_eid_scheme(node_eid) == EID_SCHEME_IPN;
+	const char *const agent_id = get_agent_id(config, is_ipn);
+	// The IPN node ID ends with ".0", which is replaced by the agent ID
+	const size_t node_length = strlen(node_eid) - (is_ipn ? 1 : 0);
+	char *const destination = malloc(node_length + strlen(agent_id) + 1);
+
+	if (!destination)
+		return NULL;
+	memcpy(destination, node_eid, node_length);
+	strcpy(&destination[node_length], agent_id);
+
+	size_t length;
+	uint8_t *const payload = config->create_state(&length);
+	struct bundle *bundle = NULL;
+
+	if (payload) {
+		const uint64_t time_ms = hal_time_get_timestamp_ms();
+
+		// Takes over the payload, the sink ID is only read
+		bundle = agent_create_bundle(
+			params->bundle_version,
+			params->local_eid,
+			(char *)get_agent_id(config, params->is_ipn),
+			destination,
+			time_ms,
+			allocate_sequence_number(params, time_ms),
+			config->lifetime_ms,
+			payload,
+			length,
+			0
+		);
+	}
+	free(destination);
+	return bundle;
+}
+
+bool exchange_agent_is_state_bundle(
+	const struct exchange_agent_config *config,
+	const struct bundle *bundle)
+{
+	const char *const agent_id = get_agent_id_ptr(bundle->destination);
+	const bool is_ipn = (
+		get_eid_scheme(bundle->destination) == EID_SCHEME_IPN
+	);
+
+	return agent_id != NULL &&
+		strcmp(agent_id, get_agent_id(config, is_ipn)) == 0;
+}
+
+#endif // ROUTING_EPIDEMIC || ROUTING_PROPHET
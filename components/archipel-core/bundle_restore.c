@@ -29,6 +29,9 @@ void bundle_restore_task(void* conf){
             case BUNDLE_RESORE_ALL:
                 __attribute__((assume(signal.destination == NULL)));
 
+            struct bundle_store_residency_stats before, after;
+            hal_store_get_residency_stats(config->store, &before);
+
             struct bundle_store_loadall* loader = 
                 hal_store_loadall(config->store);
 
@@ -45,6 +48,18 @@ void bundle_restore_task(void* conf){
 
             hal_store_loadall_free(loader);
             free(signal.destination);
+
+            // Bundles already queued, in transmission or kept for
+            // reassembly are not restored again (see enum bundle_residency)
+            hal_store_get_residency_stats(config->store, &after);
+            LOGF_INFO(
+                "BundleRestore : Restored %lu bundles, skipped %lu already in memory (%lu loads avoided in total, %lu bundles in memory, %lu in transmission)",
+                (unsigned long)(after.loads - before.loads),
+                (unsigned long)(after.skipped_loads - before.skipped_loads),
+                (unsigned long)after.skipped_loads,
+                (unsigned long)after.in_memory,
+                (unsigned long)after.in_tx
+            );
         }
     }
 
@@ -337,16 +337,14 @@ static inline void bundle6_parser_next(struct bundle6_parser *state)
 		state->current_size += state->basedata->next_bytes;
 		if (state->current_size > BUNDLE_MAX_SIZE) {
 			state->basedata->status = PARSER_STATUS_ERROR;
+		} else if (bundle_block_alloc_data(
+				(*state->current_block_entry)->data,
+				state->basedata->next_bytes) != UD3TN_OK) {
+			state->basedata->status = PARSER_STATUS_ERROR;
 		} else {
 			state->basedata->next_buffer =
-				malloc(state->basedata->next_bytes);
-			if (state->basedata->next_buffer == NULL) {
-				state->basedata->status = PARSER_STATUS_ERROR;
-			} else {
-				(*state->current_block_entry)->data->data =
-					state->basedata->next_buffer;
-				state->basedata->flags |= PARSER_FLAG_BULK_READ;
-			}
+				(*state->current_block_entry)->data->data;
+			state->basedata->flags |= PARSER_FLAG_BULK_READ;
 		}
 		break;
 	default:
@@ -31,6 +31,15 @@ enum ud3tn_result bundle6_serialize(
 	struct bundle *bundle,
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj)
+{
+	return bundle6_serialize_split(bundle, write, write, cla_obj);
+}
+
+enum ud3tn_result bundle6_serialize_split(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_data)(void *cla_obj, const void *, const size_t),
+	void *cla_obj)
 {
 	uint8_t buffer[MAX_SDNV_SIZE];
 
@@ -122,7 +131,8 @@ enum ud3tn_result bundle6_serialize(
 			}
 		}
 		serialize_u32(buffer, cur_entry->data->length);
-		write_bytes(cur_entry->data->length, cur_entry->data->data);
+		write_data(cla_obj, cur_entry->data->data,
+			   cur_entry->data->length);
 		cur_entry = cur_entry->next;
 	}
 
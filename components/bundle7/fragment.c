@@ -4,7 +4,6 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_fragmenter.h"
 
-#include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -70,19 +69,18 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 		bundle_free(remainder);
 		return NULL;
 	}
-	remainder->payload_block->length =
-		working_bundle->payload_block->length - first_payload_length;
-	remainder->payload_block->data =
-		malloc(remainder->payload_block->length);
-	if (remainder->payload_block->data == NULL) {
+	// The second fragment references the tail of the payload, no copy
+	if (bundle_block_share_data(
+			remainder->payload_block,
+			working_bundle->payload_block,
+			first_payload_length,
+			working_bundle->payload_block->length -
+			first_payload_length) != UD3TN_OK) {
+		bundle_block_free(remainder->payload_block);
+		remainder->payload_block = NULL;
 		bundle_free(remainder);
 		return NULL;
 	}
-	memcpy(
-		remainder->payload_block->data,
-		working_bundle->payload_block->data + first_payload_length,
-		remainder->payload_block->length
-	);
 
 	// Link last block with payload block
 	struct bundle_block_list *payload_entry = bundle_block_entry_create(
@@ -104,14 +102,11 @@ struct bundle *bundle7_fragment_bundle(struct bundle *working_bundle,
 		working_bundle->total_adu_length =
 			working_bundle->payload_block->length;
 
-	// Shorten first fragment's payload block
-	working_bundle->payload_block->data =
-		realloc(working_bundle->payload_block->data, first_payload_length);
-
-	assert(working_bundle->payload_block->data != NULL);
-
-	// Set correct lengths and offsets
-	working_bundle->payload_block->length = first_payload_length;
+	// Shorten first fragment's payload block and set correct offsets
+	bundle_block_truncate_data(
+		working_bundle->payload_block,
+		first_payload_length
+	);
 	remainder->fragment_offset =
 		working_bundle->fragment_offset + first_payload_length;
 	remainder->total_adu_length = working_bundle->total_adu_length;
@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * One-shot BPv7 parser for bundles that are already contiguous in memory
+ *
+ * In contrast to the incremental parser in parser.c, which has to be able to
+ * suspend at any byte boundary and copies block data into a separate
+ * allocation via "bulk reads", this parser walks the whole bundle with a
+ * single TinyCBOR iterator. CRCs are computed directly over the source bytes
+ * and block data is not copied: every block of the resulting bundle borrows
+ * its data from the source buffer and holds a reference to it.
+ */
+#include "bundle7/eid.h"
+#include "bundle7/parser.h"
+#include "bundle7/timestamp.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/crc.h"
+#include "ud3tn/payload.h"
+
+#include "compilersupport_p.h" // Private TinyCBOR header, used for endianness
+
+#include "cbor.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Number of items of the primary block array without CRC and fragment fields
+#define PRIMARY_BLOCK_BASE_ITEMS 8
+// Number of items of a canonical block array without CRC field
+#define BLOCK_BASE_ITEMS 5
+
+
+static CborError parse_uint(CborValue *it, uint64_t *value)
+{
+	if (!cbor_value_is_unsigned_integer(it))
+		return CborErrorIllegalType;
+
+	cbor_value_get_uint64(it, value);
+	return cbor_value_advance_fixed(it);
+}
+
+
+/**
+ * Reads the CRC field the iterator points to and verifies it against the
+ * bytes starting at `block_start` up to (excluding) the CRC field. As
+ * mandated by RFC 9171, the CRC field itself is processed as if it was
+ * populated with zeros.
+ *
+ * @return CborErrorIllegalType if the field is malformed or the CRC does not
+ *	   match, otherwise CborNoError
+ */
+static CborError parse_and_verify_crc(CborValue *it,
+	enum bundle_crc_type crc_type, const uint8_t *block_start,
+	union crc *result)
+{
+	const uint8_t *const crc_field = cbor_value_get_next_byte(it);
+	struct crc_stream crc;
+	union crc value;
+	size_t len = sizeof(value);
+	CborError err;
+
+	if (!cbor_value_is_byte_string(it))
+		return CborErrorIllegalType;
+
+	err = cbor_value_copy_byte_string(it, value.bytes, &len, it);
+	if (err)
+		return err;
+
+	if (crc_type == BUNDLE_CRC_TYPE_16) {
+		if (len != 2)
+			return CborErrorIllegalType;
+
+		crc_init(&crc, CRC16_X25);
+		crc_feed_bytes(&crc, block_start, crc_field - block_start);
+		crc.feed(&crc, 0x42); // CBOR byte string(2)
+		crc.feed(&crc, 0x00);
+		crc.feed(&crc, 0x00);
+		crc.feed_eof(&crc);
+
+		// Swap from network byte order to native order and clear all
+		// higher bits
+		result->checksum = cbor_ntohs(value.checksum & 0xffff);
+	} else {
+		if (len != 4)
+			return CborErrorIllegalType;
+
+		crc_init(&crc, CRC32);
+		crc_feed_bytes(&crc, block_start, crc_field - block_start);
+		crc.feed(&crc, 0x44); // CBOR byte string(4)
+		crc.feed(&crc, 0x00);
+		crc.feed(&crc, 0x00);
+		crc.feed(&crc, 0x00);
+		crc.feed(&crc, 0x00);
+		crc.feed_eof(&crc);
+
+		// Swap from network byte order to native order
+		result->checksum = cbor_ntohl(value.checksum);
+	}
+
+	if (crc.checksum != result->checksum)
+		return CborErrorIllegalType;
+
+	return CborNoError;
+}
+
+
+static CborError parse_primary_block(struct bundle *bundle, CborValue *it)
+{
+	const uint8_t *const start = cbor_value_get_next_byte(it);
+	CborValue block;
+	CborError err;
+	size_t items;
+	uint64_t value;
+
+	if (!cbor_value_is_array(it) || !cbor_value_is_length_known(it))
+		return CborErrorIllegalType;
+
+	err = cbor_value_get_array_length(it, &items);
+	if (err)
+		return err;
+
+	err = cbor_value_enter_container(it, &block);
+	if (err)
+		return err;
+
+	err = parse_uint(&block, &value);
+	if (err)
+		return err;
+	if (value != 7)
+		return CborErrorIllegalType;
+	bundle->protocol_version = value;
+
+	err = parse_uint(&block, &value);
+	if (err)
+		return err;
+	bundle->proc_flags = (uint32_t)value & BP_V7_FLAGS;
+
+	err = parse_uint(&block, &value);
+	if (err)
+		return err;
+	if (value > BUNDLE_CRC_TYPE_32)
+		return CborErrorIllegalType;
+	bundle->crc_type = value;
+
+	// Check the item count now that all fields determining it are known
+	const size_t expected_items = (
+		PRIMARY_BLOCK_BASE_ITEMS +
+		(bundle->crc_type != BUNDLE_CRC_TYPE_NONE ? 1U : 0U) +
+		(bundle_is_fragmented(bundle) ? 2U : 0U)
+	);
+
+	if (items != expected_items)
+		return CborErrorIllegalType;
+
+	err = bundle7_eid_parse_cbor(&block, &bundle->destination);
+	if (err)
+		return err;
+	err = bundle7_eid_parse_cbor(&block, &bundle->source);
+	if (err)
+		return err;
+	err = bundle7_eid_parse_cbor(&block, &bundle->report_to);
+	if (err)
+		return err;
+
+	err = bundle7_timestamp_parse(&block,
+		&bundle->creation_timestamp_ms,
+		&bundle->sequence_number);
+	if (err)
+		return err;
+
+	err = parse_uint(&block, &value);
+	if (err)
+		return err;
+	bundle->lifetime_ms = value;
+
+	if (bundle_is_fragmented(bundle)) {
+		err = parse_uint(&block, &value);
+		if (err)
+			return err;
+		bundle->fragment_offset = value;
+
+		err = parse_uint(&block, &value);
+		if (err)
+			return err;
+		bundle->total_adu_length = value;
+	}
+
+	if (bundle->crc_type != BUNDLE_CRC_TYPE_NONE) {
+		err = parse_and_verify_crc(&block, bundle->crc_type, start,
+					   &bundle->crc);
+		if (err)
+			return err;
+	}
+
+	if (!cbor_value_at_end(&block))
+		return CborErrorIllegalType;
+
+	bundle->primary_block_length = cbor_value_get_next_byte(&block) - start;
+
+	return cbor_value_leave_container(it, &block);
+}
+
+
+static CborError parse_block(struct bundle_block *block, CborValue *it,
+	struct payload_buffer *source)
+{
+	const uint8_t *const start = cbor_value_get_next_byte(it);
+	CborValue fields;
+	CborError err;
+	size_t items;
+	size_t length;
+	uint64_t value;
+
+	if (!cbor_value_is_array(it) || !cbor_value_is_length_known(it))
+		return CborErrorIllegalType;
+
+	err = cbor_value_get_array_length(it, &items);
+	if (err)
+		return err;
+
+	err = cbor_value_enter_container(it, &fields);
+	if (err)
+		return err;
+
+	// The block type has already been consumed by the caller
+	err = cbor_value_advance_fixed(&fields);
+	if (err)
+		return err;
+
+	err = parse_uint(&fields, &value);
+	if (err)
+		return err;
+	block->number = value;
+
+	err = parse_uint(&fields, &value);
+	if (err)
+		return err;
+	block->flags = (((uint8_t)value) & (
+		BUNDLE_BLOCK_FLAG_MUST_BE_REPLICATED |
+		BUNDLE_BLOCK_FLAG_DISCARD_IF_UNPROC |
+		BUNDLE_BLOCK_FLAG_REPORT_IF_UNPROC |
+		BUNDLE_BLOCK_FLAG_DELETE_BUNDLE_IF_UNPROC
+	));
+
+	err = parse_uint(&fields, &value);
+	if (err)
+		return err;
+	if (value > BUNDLE_CRC_TYPE_32)
+		return CborErrorIllegalType;
+	block->crc_type = value;
+
+	const size_t expected_items = (
+		BLOCK_BASE_ITEMS +
+		(block->crc_type != BUNDLE_CRC_TYPE_NONE ? 1U : 0U)
+	);
+
+	if (items != expected_items)
+		return CborErrorIllegalType;
+
+	// Block-specific data, borrowed from the source buffer
+	if (!cbor_value_is_byte_string(&fields) ||
+	    !cbor_value_is_length_known(&fields))
+		return CborErrorIllegalType;
+
+	err = cbor_value_get_string_length(&fields, &length);
+	if (err)
+		return err;
+
+	err = cbor_value_advance(&fields);
+	if (err)
+		return err;
+
+	block->data = (uint8_t *)cbor_value_get_next_byte(&fields) - length;
+	block->length = length;
+	block->buffer = payload_buffer_get(source);
+
+	if (block->crc_type != BUNDLE_CRC_TYPE_NONE) {
+		err = parse_and_verify_crc(&fields, block->crc_type, start,
+					   &block->crc);
+		if (err)
+			return err;
+	}
+
+	if (!cbor_value_at_end(&fields))
+		return CborErrorIllegalType;
+
+	return cbor_value_leave_container(it, &fields);
+}
+
+
+static CborError parse_bundle(struct bundle *bundle, CborValue *it,
+	struct payload_buffer *source)
+{
+	struct bundle_block_list **next_entry = &bundle->blocks;
+	CborValue blocks;
+	CborError err;
+	uint64_t type;
+
+	if (!cbor_value_is_array(it) || cbor_value_is_length_known(it))
+		return CborErrorIllegalType;
+
+	err = cbor_value_enter_container(it, &blocks);
+	if (err)
+		return err;
+
+	err = parse_primary_block(bundle, &blocks);
+	if (err)
+		return err;
+
+	// The payload block is always the last block
+	while (bundle->payload_block == NULL) {
+		if (cbor_value_at_end(&blocks) || !cbor_value_is_array(&blocks))
+			return CborErrorIllegalType;
+
+		// Peek the block type to create the block
+		CborValue peek;
+
+		err = cbor_value_enter_container(&blocks, &peek);
+		if (err)
+			return err;
+		if (!cbor_value_is_unsigned_integer(&peek))
+			return CborErrorIllegalType;
+		cbor_value_get_uint64(&peek, &type);
+
+		struct bundle_block *const block = bundle_block_create(type);
+
+		if (block == NULL)
+			return CborErrorOutOfMemory;
+
+		*next_entry = bundle_block_entry_create(block);
+		if (*next_entry == NULL) {
+			bundle_block_free(block);
+			return CborErrorOutOfMemory;
+		}
+		next_entry = &(*next_entry)->next;
+
+		err = parse_block(block, &blocks, source);
+		if (err)
+			return err;
+
+		if (block->type == BUNDLE_BLOCK_TYPE_PAYLOAD)
+			bundle->payload_block = block;
+	}
+
+	if (!cbor_value_at_end(&blocks))
+		return CborErrorIllegalType;
+
+	return cbor_value_leave_container(it, &blocks);
+}
+
+
+struct bundle *bundle7_parse_buffer(struct payload_buffer *source,
+	size_t *consumed)
+{
+	CborParser parser;
+	CborValue it;
+	CborError err;
+	struct bundle *bundle = bundle_init();
+
+	if (bundle == NULL)
+		return NULL;
+
+	err = cbor_parser_init(source->data, source->length, 0, &parser, &it);
+	if (!err)
+		err = parse_bundle(bundle, &it, source);
+
+	const size_t size = cbor_value_get_next_byte(&it) - source->data;
+
+	if (err || size > BUNDLE_MAX_SIZE) {
+		bundle_free(bundle);
+		return NULL;
+	}
+
+	if (consumed)
+		*consumed = size;
+	return bundle;
+}
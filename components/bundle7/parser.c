@@ -574,13 +574,12 @@ CborError block_data(struct bundle7_parser *state, CborValue *it)
 	// Activate CRC feeding again
 	state->flags |= BUNDLE_V7_PARSER_CRC_FEED;
 
-	BLOCK(state)->length = length;
-
 	// Block-specific data
 	// -------------------
 	//
-	BLOCK(state)->data = malloc(length);
-	if (BLOCK(state)->data == NULL)
+	// Large block data is backed by a spill file so that the bulk read
+	// writes it straight to disk instead of the heap.
+	if (bundle_block_alloc_data(BLOCK(state), length) != UD3TN_OK)
 		return CborErrorOutOfMemory;
 
 	// Enable "bulk read" mode
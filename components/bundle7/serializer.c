@@ -125,6 +125,15 @@ enum ud3tn_result bundle7_serialize(
 	struct bundle *bundle,
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj)
+{
+	return bundle7_serialize_split(bundle, write, write, cla_obj);
+}
+
+enum ud3tn_result bundle7_serialize_split(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_data)(void *cla_obj, const void *, const size_t),
+	void *cla_obj)
 {
 	// Assert that the bundle has correct version
 	if (bundle->protocol_version != 7)
@@ -244,7 +253,7 @@ enum ud3tn_result bundle7_serialize(
 		feed_crc(&crc, block->crc_type, buffer,
 			 cbor_encoder_get_buffer_size(&encoder, buffer));
 
-		write(cla_obj, block->data, block->length);
+		write_data(cla_obj, block->data, block->length);
 		feed_crc(&crc, block->crc_type,
 			 block->data, block->length);
 
@@ -47,8 +47,6 @@ const struct available_cla_list_entry AVAILABLE_CLAS[] = {
 };
 
 
-static void cla_register(struct cla_config *config);
-
 static enum ud3tn_result initialize_single(
 	char *cur_cla_config,
 	const struct bundle_agent_interface *bundle_agent_interface)
@@ -165,6 +163,7 @@ enum ud3tn_result cla_link_init(struct cla_link *link,
 
 	link->tx_queue_handle = NULL;
 	link->tx_queue_sem = NULL;
+	memset(&link->tx_stats, 0, sizeof(link->tx_stats));
 
 	// Semaphores used for waiting for the tasks to exit
 	// NOTE: They are already locked on creation!
@@ -367,7 +366,7 @@ char *cla_get_cla_addr_from_link(const struct cla_link *const link)
 
 static struct cla_config *global_instances[ARRAY_SIZE(AVAILABLE_CLAS)];
 
-static void cla_register(struct cla_config *config)
+void cla_register(struct cla_config *config)
 {
 	const char *name = config->vtable->cla_name_get();
 
@@ -381,6 +380,14 @@ static void cla_register(struct cla_config *config)
 	abort();
 }
 
+void cla_deregister(const char *cla_name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(AVAILABLE_CLAS); i++) {
+		if (strcmp(AVAILABLE_CLAS[i].name, cla_name) == 0)
+			global_instances[i] = NULL;
+	}
+}
+
 struct cla_config *cla_config_get(const char *cla_addr)
 {
 	if (!cla_addr)
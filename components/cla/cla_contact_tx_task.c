@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "cla/cla.h"
 #include "cla/cla_contact_tx_task.h"
+#include "cla/cla_tx_scheduler.h"
 
 #include "bundle6/parser.h"
 #include "bundle7/parser.h"
@@ -13,16 +14,47 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
+#include "ud3tn/token_bucket.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-#if defined(CLA_TX_RATE_LIMIT) && CLA_TX_RATE_LIMIT != 0
-static const int rate_sleep_time_ms = 1000 / CLA_TX_RATE_LIMIT;
-#else // CLA_TX_RATE_LIMIT
-static const int rate_sleep_time_ms;
+#ifdef CLA_TX_RATE_LIMIT
+#warning "CLA_TX_RATE_LIMIT is not supported anymore, see CLA_TX_SHAPING_BURST_SIZE"
 #endif // CLA_TX_RATE_LIMIT
 
+struct shaped_writer {
+	struct cla_link *link;
+	struct token_bucket *bucket;
+};
+
+// A bundle serialized by the TX task, waiting to be written to the link
+struct tx_buffer {
+	// NULL requests the send task to exit
+	struct cla_tx_item *item;
+	struct bundle_serialized serialized;
+	// Data rate of the contact when the bundle was scheduled
+	uint32_t bitrate;
+	// Time the serialization was started and finished
+	uint64_t start_us;
+	uint64_t ready_us;
+};
+
+// Stage writing the serialized bundles to the link. If the pipeline is
+// enabled, it runs in a task of its own, fed via the queue.
+struct tx_send_stage {
+	struct cla_link *link;
+	struct token_bucket bucket;
+	// Time the last bundle was written completely
+	uint64_t done_us;
+	QueueIdentifier_t queue;
+	// Released by the send task when exiting
+	Semaphore_t exit_sem;
+};
+
 // BPv7 5.4-4 / RFC5050 5.4-5
 static void prepare_bundle_for_forwarding(struct bundle *bundle)
 {
@@ -52,7 +84,8 @@ static void prepare_bundle_for_forwarding(struct bundle *bundle)
 static void bp_inform_tx(QueueIdentifier_t signaling_queue,
 			 struct bundle *const b,
 			 struct cla_link *const link,
-			 const bool success)
+			 const bool success,
+			 const enum bundle_status_report_reason reason)
 {
 	bundle_processor_inform(
 		signaling_queue,
@@ -62,85 +95,388 @@ static void bp_inform_tx(QueueIdentifier_t signaling_queue,
 				? BP_SIGNAL_TRANSMISSION_SUCCESS
 				: BP_SIGNAL_TRANSMISSION_FAILURE
 			),
+			.reason = reason,
 			.bundle = b,
 			.peer_cla_addr = cla_get_cla_addr_from_link(link),
 		}
 	);
 }
 
-static void cla_contact_tx_task(void *param)
+// Passes the data to the CLA in chunks, each as soon as the data rate of the
+// contact permits.
+static void send_shaped_data(void *param, const void *data, const size_t length)
 {
-	struct cla_link *link = param;
-	struct cla_contact_tx_task_command cmd;
+	struct shaped_writer *const writer = param;
+	const uint8_t *cur = data;
+	size_t remaining = length;
+	uint64_t delay_ms;
+
+	while (remaining != 0) {
+		const size_t chunk = MIN(
+			remaining,
+			(size_t)MIN(CLA_TX_SHAPING_CHUNK_SIZE,
+				    CLA_TX_SHAPING_BURST_SIZE)
+		);
+
+		while ((delay_ms = token_bucket_take(
+				writer->bucket,
+				chunk,
+				hal_time_get_timestamp_ms())) != 0)
+			hal_task_delay((int)MIN(delay_ms, (uint64_t)INT32_MAX));
+		writer->link->config->vtable->cla_send_packet_data(
+			writer->link,
+			cur,
+			chunk
+		);
+		cur += chunk;
+		remaining -= chunk;
+	}
+}
 
-	enum ud3tn_result s;
-	void const *cla_send_packet_data =
-		link->config->vtable->cla_send_packet_data;
-	QueueIdentifier_t signaling_queue =
-		link->config->bundle_agent_interface->bundle_signaling_queue;
+static void send_serialized(struct tx_send_stage *const stage,
+			    const struct bundle_serialized *const serialized,
+			    char *const cla_address)
+{
+	struct cla_link *const link = stage->link;
+	const struct cla_vtable *const vtable = link->config->vtable;
+
+	// While shaping, the serialized bundle is passed on in chunks.
+	if (stage->bucket.rate_bytes_per_s != 0) {
+		struct shaped_writer writer = {
+			.link = link,
+			.bucket = &stage->bucket,
+		};
+
+		vtable->cla_begin_packet(link, serialized->length, cla_address);
+		for (size_t i = 0; i < serialized->iov_count; i++)
+			send_shaped_data(
+				&writer,
+				serialized->iov[i].base,
+				serialized->iov[i].length
+			);
+		vtable->cla_end_packet(link);
+		return;
+	}
+
+	// Prefer a scatter-gather send which transmits the headers and the
+	// in-place block data in one operation.
+	if (vtable->cla_send_packet_iov) {
+		vtable->cla_send_packet_iov(link, serialized, cla_address);
+		return;
+	}
+
+	vtable->cla_begin_packet(link, serialized->length, cla_address);
+	for (size_t i = 0; i < serialized->iov_count; i++)
+		vtable->cla_send_packet_data(
+			link,
+			serialized->iov[i].base,
+			serialized->iov[i].length
+		);
+	vtable->cla_end_packet(link);
+}
+
+static void add_stat(uint64_t *counter, uint64_t value)
+{
+	// The counters are updated by both stages and read by other tasks.
+	__atomic_add_fetch(counter, value, __ATOMIC_RELAXED);
+}
+
+static void send_buffer(struct tx_send_stage *const stage,
+			struct tx_buffer *const buf)
+{
+	struct cla_link *const link = stage->link;
+	struct cla_tx_stats *const stats = &link->tx_stats;
+	const uint64_t start_us = hal_time_get_timestamp_us();
+	const uint64_t pending_us = MAX(stage->done_us, buf->start_us);
+
+	if (CLA_TX_SHAPING_BURST_SIZE != 0 &&
+	    buf->bitrate != stage->bucket.rate_bytes_per_s)
+		token_bucket_set_rate(
+			&stage->bucket,
+			buf->bitrate,
+			hal_time_get_timestamp_ms()
+		);
+
+	LOGF_DEBUG(
+		"TX: Sending bundle %p via CLA %s",
+		buf->item->bundle,
+		link->config->vtable->cla_name_get()
+	);
+	send_serialized(stage, &buf->serialized, buf->item->cla_address);
+	stage->done_us = hal_time_get_timestamp_us();
+
+	add_stat(&stats->bundles_sent, 1);
+	add_stat(&stats->bytes_sent, buf->serialized.length);
+	add_stat(&stats->send_time_us, stage->done_us - start_us);
+	// The link was idle while the bundle was pending but not serialized.
+	if (buf->ready_us > pending_us)
+		add_stat(&stats->send_stall_time_us,
+			 buf->ready_us - pending_us);
+
+	bp_inform_tx(
+		link->config->bundle_agent_interface->bundle_signaling_queue,
+		buf->item->bundle,
+		link,
+		true,
+		BUNDLE_SR_REASON_NO_INFO
+	);
+	bundle_serialized_free(&buf->serialized);
+	free(buf->item);
+}
+
+static void cla_contact_tx_send_task(void *param)
+{
+	struct tx_send_stage *const stage = param;
+	struct tx_buffer buf;
 
 	for (;;) {
-		if (hal_queue_receive(link->tx_queue_handle,
-				      &cmd, -1) == UD3TN_FAIL)
+		if (hal_queue_receive(stage->queue, &buf, -1) == UD3TN_FAIL)
 			continue;
-		else if (cmd.type == TX_COMMAND_FINALIZE || !cmd.bundles)
+		if (buf.item == NULL)
 			break;
+		send_buffer(stage, &buf);
+	}
+	hal_semaphore_release(stage->exit_sem);
+}
+
+static void start_send_task(struct tx_send_stage *const stage)
+{
+	stage->queue = NULL;
+	stage->exit_sem = NULL;
+	if (CLA_TX_PIPELINE_DEPTH == 0)
+		return;
+
+	stage->queue = hal_queue_create(
+		CLA_TX_PIPELINE_DEPTH,
+		sizeof(struct tx_buffer)
+	);
+	// NOTE: The semaphore is already locked on creation!
+	stage->exit_sem = hal_semaphore_init_binary();
+	if (stage->queue != NULL && stage->exit_sem != NULL &&
+	    hal_task_create(cla_contact_tx_send_task, stage) == UD3TN_OK)
+		return;
+
+	LOG_WARN("TX: Cannot start send task, serializing and sending in turn");
+	if (stage->queue != NULL)
+		hal_queue_delete(stage->queue);
+	if (stage->exit_sem != NULL)
+		hal_semaphore_delete(stage->exit_sem);
+	stage->queue = NULL;
+	stage->exit_sem = NULL;
+}
+
+static void stop_send_task(struct tx_send_stage *const stage)
+{
+	const struct tx_buffer terminate = { .item = NULL };
+
+	if (stage->queue == NULL)
+		return;
+	// Bundles already serialized are sent before the task exits.
+	hal_queue_push_to_back(stage->queue, &terminate);
+	hal_semaphore_take_blocking(stage->exit_sem);
+	hal_semaphore_delete(stage->exit_sem);
+	hal_queue_delete(stage->queue);
+}
 
-		struct routed_bundle_list *rbl = cmd.bundles;
+// Tells whether the bundle can be received completely before it expires if
+// sent now at the given data rate (0 = unknown).
+static bool arrives_in_time(const struct cla_tx_item *item, uint32_t bitrate)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	uint64_t tx_time_ms = 0;
 
-		while (rbl) {
-			struct bundle *b = rbl->data;
+	if (bitrate != 0)
+		tx_time_ms = (uint64_t)item->size * 1000 / bitrate;
+	return now_ms + tx_time_ms <= item->expiration_ms;
+}
 
-			prepare_bundle_for_forwarding(b);
-			LOGF_DEBUG(
-				"TX: Sending bundle %p via CLA %s",
-				b,
-				link->config->vtable->cla_name_get()
+// Serializes the bundle and passes it on to the send stage, which writes it
+// to the link while the next bundle is serialized if the pipeline is enabled.
+static void send_item(struct tx_send_stage *const stage,
+		      struct cla_tx_item *const item,
+		      const uint32_t bitrate)
+{
+	struct cla_link *const link = stage->link;
+	QueueIdentifier_t signaling_queue =
+		link->config->bundle_agent_interface->bundle_signaling_queue;
+	struct tx_buffer buf = {
+		.item = item,
+		.bitrate = bitrate,
+	};
+	uint64_t push_us;
+
+	if (!arrives_in_time(item, bitrate)) {
+		LOGF_INFO(
+			"TX: Dropping bundle %p, it would expire before being received",
+			item->bundle
+		);
+		bp_inform_tx(
+			signaling_queue,
+			item->bundle,
+			link,
+			false,
+			BUNDLE_SR_REASON_LIFETIME_EXPIRED
+		);
+		free(item);
+		return;
+	}
+
+	buf.start_us = hal_time_get_timestamp_us();
+	prepare_bundle_for_forwarding(item->bundle);
+	if (bundle_serialize_iov(item->bundle, &buf.serialized) != UD3TN_OK) {
+		LOGF_WARN("TX: Cannot serialize bundle %p", item->bundle);
+		bp_inform_tx(
+			signaling_queue,
+			item->bundle,
+			link,
+			false,
+			BUNDLE_SR_REASON_NO_INFO
+		);
+		free(item);
+		return;
+	}
+	buf.ready_us = hal_time_get_timestamp_us();
+	add_stat(&link->tx_stats.serialize_time_us,
+		 buf.ready_us - buf.start_us);
+
+	if (stage->queue == NULL) {
+		send_buffer(stage, &buf);
+		return;
+	}
+	// Blocks while the pipeline is full, i.e., the link is saturated.
+	hal_queue_push_to_back(stage->queue, &buf);
+	push_us = hal_time_get_timestamp_us();
+	add_stat(&link->tx_stats.serialize_stall_time_us,
+		 push_us - buf.ready_us);
+}
+
+static void schedule_bundles(struct cla_link *const link,
+			     struct cla_tx_scheduler *const scheduler,
+			     const struct cla_contact_tx_task_command *cmd)
+{
+	QueueIdentifier_t signaling_queue =
+		link->config->bundle_agent_interface->bundle_signaling_queue;
+	const size_t cla_address_size = strlen(cmd->cla_address) + 1;
+	struct routed_bundle_list *rbl = cmd->bundles;
+
+	while (rbl) {
+		struct cla_tx_item *item = malloc(
+			sizeof(struct cla_tx_item) + cla_address_size
+		);
+
+		if (item != NULL) {
+			item->bundle = rbl->data;
+			item->prio = rbl->prio;
+			item->expiration_ms = rbl->expiration_ms;
+			item->size = bundle_get_serialized_size(rbl->data);
+			memcpy(item->cla_address, cmd->cla_address,
+			       cla_address_size);
+		}
+		if (item == NULL ||
+		    cla_tx_scheduler_push(scheduler, item) != UD3TN_OK) {
+			LOGF_WARN(
+				"TX: Cannot schedule bundle %p, out of memory",
+				rbl->data
 			);
-			link->config->vtable->cla_begin_packet(
+			bp_inform_tx(
+				signaling_queue,
+				rbl->data,
 				link,
-				bundle_get_serialized_size(b),
-				cmd.cla_address
+				false,
+				BUNDLE_SR_REASON_NO_INFO
 			);
-			s = bundle_serialize(
-				b,
-				cla_send_packet_data,
-				(void *)link
-			);
-			link->config->vtable->cla_end_packet(link);
+			free(item);
+		}
 
-			if (s == UD3TN_OK) {
-				bp_inform_tx(
-					signaling_queue,
-					b,
-					link,
-					true
-				);
-			} else {
-				bp_inform_tx(
-					signaling_queue,
-					b,
-					link,
-					false
-				);
-			}
+		struct routed_bundle_list *tmp = rbl;
+
+		rbl = rbl->next;
+		// Free the bundle list from the command step-by-step.
+		free(tmp);
+	}
+}
 
-			struct routed_bundle_list *tmp = rbl;
+static void cla_contact_tx_task(void *param)
+{
+	struct cla_link *link = param;
+	struct cla_contact_tx_task_command cmd;
+	struct cla_tx_scheduler scheduler;
+	struct cla_tx_item *item;
+	struct tx_send_stage stage = {
+		.link = link,
+		.done_us = 0,
+	};
+	uint32_t bitrate = 0;
 
-			rbl = rbl->next;
-			// Free the bundle list from the command step-by-step.
-			free(tmp);
+	QueueIdentifier_t signaling_queue =
+		link->config->bundle_agent_interface->bundle_signaling_queue;
 
-			if (rate_sleep_time_ms)
-				hal_task_delay(rate_sleep_time_ms);
+	cla_tx_scheduler_init(
+		&scheduler,
+		CLA_TX_SCHEDULER_POLICY,
+		CLA_TX_SCHEDULER_DRR_QUANTUM
+	);
+	token_bucket_init(
+		&stage.bucket,
+		CLA_TX_SHAPING_BURST_SIZE,
+		hal_time_get_timestamp_ms()
+	);
+	start_send_task(&stage);
+
+	for (;;) {
+		// All bundles handed over are scheduled before the next one is
+		// sent. The task only blocks if no bundle is pending.
+		if (hal_queue_receive(
+				link->tx_queue_handle,
+				&cmd,
+				cla_tx_scheduler_empty(&scheduler) ? -1 : 0
+			) == UD3TN_OK) {
+			if (cmd.type == TX_COMMAND_FINALIZE || !cmd.bundles)
+				break;
+
+			// Follows changes of the data rate, e.g. by a contact
+			// plan update, with the next batch of bundles.
+			bitrate = cmd.bitrate_bytes_per_s;
+			schedule_bundles(link, &scheduler, &cmd);
+
+			// Free the attached CLA address - a copy is made by
+			// the contact manager because the contact containing
+			// the original copy may be deleted in the meantime.
+			free(cmd.cla_address);
+			continue;
 		}
 
-		// Free the attached CLA address - a copy is made by the
-		// contact manager because the contact containing the original
-		// copy may be deleted in the meantime.
-		free(cmd.cla_address);
+		item = cla_tx_scheduler_pop(&scheduler);
+		if (item == NULL)
+			continue;
+		send_item(&stage, item, bitrate);
 	}
 
+	stop_send_task(&stage);
+	LOGF_INFO(
+		"TX: Sent %lu bundles (%lu bytes) via CLA %s, %lu ms serializing, %lu ms sending, link idle for %lu ms waiting for serialization, pipeline full for %lu ms",
+		(unsigned long)link->tx_stats.bundles_sent,
+		(unsigned long)link->tx_stats.bytes_sent,
+		link->config->vtable->cla_name_get(),
+		(unsigned long)(link->tx_stats.serialize_time_us / 1000),
+		(unsigned long)(link->tx_stats.send_time_us / 1000),
+		(unsigned long)(link->tx_stats.send_stall_time_us / 1000),
+		(unsigned long)(link->tx_stats.serialize_stall_time_us / 1000)
+	);
+
+	// Bundles still pending are reported as not transmitted.
+	while ((item = cla_tx_scheduler_pop(&scheduler)) != NULL) {
+		bp_inform_tx(
+			signaling_queue,
+			item->bundle,
+			link,
+			false,
+			BUNDLE_SR_REASON_NO_INFO
+		);
+		free(item);
+	}
+	cla_tx_scheduler_free(&scheduler);
+
 	// Lock the queue before we start to free it
 	hal_semaphore_take_blocking(link->tx_queue_sem);
 
@@ -156,7 +492,8 @@ static void cla_contact_tx_task(void *param)
 					signaling_queue,
 					b,
 					link,
-					false
+					false,
+					BUNDLE_SR_REASON_NO_INFO
 				);
 
 				struct routed_bundle_list *tmp = rbl;
@@ -188,12 +525,34 @@ enum ud3tn_result cla_launch_contact_tx_task(struct cla_link *link)
 	return res;
 }
 
+void cla_contact_tx_task_get_stats(const struct cla_link *link,
+				   struct cla_tx_stats *stats)
+{
+	const struct cla_tx_stats *const cur = &link->tx_stats;
+
+	stats->bundles_sent = __atomic_load_n(&cur->bundles_sent,
+					      __ATOMIC_RELAXED);
+	stats->bytes_sent = __atomic_load_n(&cur->bytes_sent,
+					    __ATOMIC_RELAXED);
+	stats->serialize_time_us = __atomic_load_n(&cur->serialize_time_us,
+						   __ATOMIC_RELAXED);
+	stats->send_time_us = __atomic_load_n(&cur->send_time_us,
+					      __ATOMIC_RELAXED);
+	stats->send_stall_time_us = __atomic_load_n(&cur->send_stall_time_us,
+						    __ATOMIC_RELAXED);
+	stats->serialize_stall_time_us = __atomic_load_n(
+		&cur->serialize_stall_time_us,
+		__ATOMIC_RELAXED
+	);
+}
+
 void cla_contact_tx_task_request_exit(QueueIdentifier_t queue)
 {
 	struct cla_contact_tx_task_command command = {
 		.type = TX_COMMAND_FINALIZE,
 		.bundles = NULL,
 		.cla_address = NULL,
+		.bitrate_bytes_per_s = 0,
 	};
 
 	ASSERT(queue != NULL);
@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "cla/cla_tx_scheduler.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/min_heap.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// The sequence number occupies the lower bits of the key with the priority
+// policy, which allows for 2^56 entries without wrapping.
+#define PRIORITY_SHIFT 56
+#define SEQUENCE_NUMBER_MASK ((UINT64_C(1) << PRIORITY_SHIFT) - 1)
+
+// Expected number of destinations served via a link at the same time
+#define FLOWS_EXPECTED_COUNT 8
+
+// Pending items of a destination, only used with CLA_TX_SCHEDULER_DRR
+struct cla_tx_flow {
+	struct cla_tx_item *head;
+	struct cla_tx_item *tail;
+	// Serialized size of the bundle at the head
+	size_t head_size;
+	// Bytes the flow may still send in the current round
+	size_t deficit;
+	// Whether the flow has received its quantum for the current round
+	bool served;
+	struct cla_tx_flow *next;
+};
+
+void cla_tx_scheduler_init(struct cla_tx_scheduler *scheduler,
+			   enum cla_tx_scheduler_policy policy,
+			   size_t drr_quantum)
+{
+	scheduler->policy = policy;
+	scheduler->count = 0;
+	min_heap_init(&scheduler->entries, NULL);
+	scheduler->sequence_number = 0;
+	hashmap_init(&scheduler->flows, FLOWS_EXPECTED_COUNT);
+	scheduler->active_head = NULL;
+	scheduler->active_tail = NULL;
+	scheduler->active_count = 0;
+	scheduler->quantum = drr_quantum ? drr_quantum : 1;
+}
+
+void cla_tx_scheduler_free(struct cla_tx_scheduler *scheduler)
+{
+	ASSERT(scheduler->count == 0);
+	min_heap_free(&scheduler->entries);
+	hashmap_deinit(&scheduler->flows);
+}
+
+static void activate_flow(struct cla_tx_scheduler *scheduler,
+			  struct cla_tx_flow *flow)
+{
+	flow->next = NULL;
+	if (scheduler->active_tail != NULL)
+		scheduler->active_tail->next = flow;
+	else
+		scheduler->active_head = flow;
+	scheduler->active_tail = flow;
+}
+
+static enum ud3tn_result push_to_flow(struct cla_tx_scheduler *scheduler,
+				      struct cla_tx_item *item)
+{
+	const char *const destination = item->bundle->destination;
+	struct cla_tx_flow *flow = hashmap_get(&scheduler->flows, destination);
+
+	item->next = NULL;
+	if (flow != NULL) {
+		flow->tail->next = item;
+		flow->tail = item;
+		return UD3TN_OK;
+	}
+
+	flow = malloc(sizeof(struct cla_tx_flow));
+	if (flow == NULL)
+		return UD3TN_FAIL;
+	if (hashmap_put(&scheduler->flows, destination, flow) != UD3TN_OK) {
+		free(flow);
+		return UD3TN_FAIL;
+	}
+	flow->head = item;
+	flow->tail = item;
+	flow->head_size = item->size;
+	flow->deficit = 0;
+	flow->served = false;
+	activate_flow(scheduler, flow);
+	scheduler->active_count++;
+	return UD3TN_OK;
+}
+
+enum ud3tn_result cla_tx_scheduler_push(struct cla_tx_scheduler *scheduler,
+					struct cla_tx_item *item)
+{
+	const uint64_t seq = scheduler->sequence_number++;
+	enum ud3tn_result result;
+	uint64_t key;
+
+	switch (scheduler->policy) {
+	case CLA_TX_SCHEDULER_DRR:
+		result = push_to_flow(scheduler, item);
+		goto done;
+	case CLA_TX_SCHEDULER_PRIORITY:
+		key = (
+			(uint64_t)(BUNDLE_RPRIO_MAX - 1 - item->prio) <<
+			PRIORITY_SHIFT
+		) | (seq & SEQUENCE_NUMBER_MASK);
+		break;
+	case CLA_TX_SCHEDULER_EDF:
+		key = item->expiration_ms;
+		break;
+	default:
+		key = seq;
+		break;
+	}
+	item->next = NULL;
+	result = min_heap_push(&scheduler->entries, key, item);
+
+done:
+	if (result == UD3TN_OK)
+		scheduler->count++;
+	return result;
+}
+
+static struct cla_tx_item *take_from_flow(
+	struct cla_tx_scheduler *scheduler, struct cla_tx_flow *flow)
+{
+	struct cla_tx_item *const item = flow->head;
+
+	flow->deficit -= flow->head_size;
+	flow->head = item->next;
+	item->next = NULL;
+	if (flow->head != NULL) {
+		// The flow continues as long as its deficit permits.
+		flow->head_size = flow->head->size;
+		return item;
+	}
+
+	// The destination is forgotten as soon as nothing is pending.
+	scheduler->active_head = flow->next;
+	if (scheduler->active_head == NULL)
+		scheduler->active_tail = NULL;
+	scheduler->active_count--;
+	hashmap_remove(&scheduler->flows, item->bundle->destination);
+	free(flow);
+	return item;
+}
+
+// Grants all flows the quanta of the rounds in which none of them could send,
+// so that large bundles do not take a round per quantum.
+static void skip_idle_rounds(struct cla_tx_scheduler *scheduler)
+{
+	const size_t quantum = scheduler->quantum;
+	struct cla_tx_flow *flow;
+	size_t rounds = SIZE_MAX;
+
+	for (flow = scheduler->active_head; flow != NULL; flow = flow->next) {
+		const size_t missing = flow->head_size - flow->deficit;
+
+		rounds = MIN(rounds, (missing + quantum - 1) / quantum);
+	}
+	if (rounds <= 1)
+		return;
+	for (flow = scheduler->active_head; flow != NULL; flow = flow->next)
+		flow->deficit += (rounds - 1) * quantum;
+}
+
+static struct cla_tx_item *pop_from_flows(
+	struct cla_tx_scheduler *scheduler)
+{
+	struct cla_tx_flow *flow;
+	size_t misses = 0;
+
+	for (;;) {
+		flow = scheduler->active_head;
+		if (!flow->served) {
+			flow->deficit += scheduler->quantum;
+			flow->served = true;
+		}
+		if (flow->deficit >= flow->head_size)
+			return take_from_flow(scheduler, flow);
+
+		// Continue with the next flow, the deficit is kept.
+		flow->served = false;
+		if (flow->next != NULL) {
+			scheduler->active_head = flow->next;
+			activate_flow(scheduler, flow);
+		}
+		if (++misses == scheduler->active_count) {
+			skip_idle_rounds(scheduler);
+			misses = 0;
+		}
+	}
+}
+
+struct cla_tx_item *cla_tx_scheduler_pop(
+	struct cla_tx_scheduler *scheduler)
+{
+	if (scheduler->count == 0)
+		return NULL;
+	scheduler->count--;
+	if (scheduler->policy == CLA_TX_SCHEDULER_DRR)
+		return pop_from_flows(scheduler);
+	return min_heap_pop(&scheduler->entries);
+}
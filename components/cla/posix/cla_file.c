@@ -11,6 +11,7 @@
 
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
+#include "ud3tn/payload.h"
 #include "ud3tn/simplehtab.h"
 #include "cla/cla_contact_tx_task.h"
 #include "ud3tn/result.h"
@@ -301,6 +302,24 @@ static void inject_bundle(struct bundle *bundle, void* p)
 	);
 }
 
+// Parses a BPv7 bundle file in one pass from a mapping of it, without copying
+// the block data. Returns false if the file could not be mapped or does not
+// (yet) contain a complete and valid bundle.
+static bool inject_mapped_bundle(struct bundle_injection_params* params)
+{
+	struct payload_buffer* source = payload_buffer_map_file(params->file_path);
+	if(source == NULL)
+		return false;
+
+	struct bundle* bundle = bundle7_parse_buffer(source, NULL);
+	payload_buffer_put(source);
+	if(bundle == NULL)
+		return false;
+
+	inject_bundle(bundle, params);
+	return true;
+}
+
 static void file_cla_watching_task(
 	void* param ){
 
@@ -346,8 +365,12 @@ static void file_cla_watching_task(
 				sprintf(file_path, "%s/%s", folder, entry->d_name);
 
 				if(entry->d_type == 8){ //  Regular file
-				
-					if(bundle_ver == '6' || bundle_ver == '7'){
+
+					parser_params.file_path = file_path;
+
+					if(bundle_ver == '7' && inject_mapped_bundle(&parser_params)){
+						// Bundle was parsed directly from the mapped file
+					} else if(bundle_ver == '6' || bundle_ver == '7'){
 
 						FILE* file = fopen(file_path, "r");
 						if(file != NULL){
@@ -544,10 +567,7 @@ static enum ud3tn_result filecla_end_scheduled_contact(
 	if(c != NULL){
 
 		// End finalize message to transmission task
-		hal_queue_push_to_back(
-			c->tx_queue.tx_queue_handle, 
-			&((struct cla_contact_tx_task_command) { TX_COMMAND_FINALIZE, NULL, NULL })
-		);
+		cla_contact_tx_task_request_exit(c->tx_queue.tx_queue_handle);
 
 		if(c->should_continue != NULL){
 			// Turn continue trigger off for watching task
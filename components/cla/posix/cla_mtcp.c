@@ -558,6 +558,29 @@ void mtcp_send_packet_data(
 	}
 }
 
+void mtcp_send_packet_iov(struct cla_link *link,
+			  const struct bundle_serialized *serialized,
+			  char *cla_addr)
+{
+	struct cla_tcp_link *const tcp_link = (struct cla_tcp_link *)link;
+
+	const size_t BUFFER_SIZE = 9; // max. for uint64_t
+	uint8_t buffer[BUFFER_SIZE];
+
+	const size_t hdr_len = mtcp_encode_header(
+		buffer,
+		BUFFER_SIZE,
+		serialized->length
+	);
+
+	(void)cla_addr;
+	if (tcp_send_all_iov(tcp_link->connection_socket,
+			     buffer, hdr_len, serialized) == -1) {
+		LOG_WARN("MTCP: Error during sending. Data discarded.");
+		link->config->vtable->cla_disconnect_handler(link);
+	}
+}
+
 const struct cla_vtable mtcp_vtable = {
 	.cla_name_get = mtcp_name_get,
 	.cla_launch = mtcp_launch,
@@ -570,6 +593,7 @@ const struct cla_vtable mtcp_vtable = {
 	.cla_begin_packet = mtcp_begin_packet,
 	.cla_end_packet = mtcp_end_packet,
 	.cla_send_packet_data = mtcp_send_packet_data,
+	.cla_send_packet_iov = mtcp_send_packet_iov,
 
 	.cla_rx_task_reset_parsers = mtcp_reset_parsers,
 	.cla_rx_task_forward_to_specific_parser =
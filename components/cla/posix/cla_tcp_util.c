@@ -11,9 +11,11 @@
 #include <netinet/tcp.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -28,6 +30,10 @@
 #define NI_MAXSERV 32
 #endif // NI_MAXSERV
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif // IOV_MAX
+
 char *cla_tcp_sockaddr_to_cla_addr(struct sockaddr *const sockaddr,
 				   const socklen_t sockaddr_len)
 {
@@ -324,6 +330,69 @@ ssize_t tcp_send_all(const int socket, const void *const buffer,
 	return sent;
 }
 
+ssize_t tcp_send_all_iov(const int socket,
+			 const void *const header, const size_t header_length,
+			 const struct bundle_serialized *const serialized)
+{
+	const size_t count = serialized->iov_count + 1;
+	struct iovec *const iov = malloc(sizeof(struct iovec) * count);
+	size_t first = 0;
+	size_t sent = 0;
+
+	if (!iov) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	iov[0].iov_base = (void *)header;
+	iov[0].iov_len = header ? header_length : 0;
+	for (size_t i = 1; i < count; i++) {
+		iov[i].iov_base = (void *)serialized->iov[i - 1].base;
+		iov[i].iov_len = serialized->iov[i - 1].length;
+	}
+
+	while (first < count) {
+		// Skip entries that have been sent completely.
+		if (iov[first].iov_len == 0) {
+			first++;
+			continue;
+		}
+
+		struct msghdr msg = {
+			.msg_iov = &iov[first],
+			.msg_iovlen = MIN(count - first, (size_t)IOV_MAX),
+		};
+		ssize_t r = sendmsg(socket, &msg, 0);
+
+		if (r < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+					errno == EINTR)
+				continue;
+			free(iov);
+			return r;
+		}
+		if (r == 0) {
+			free(iov);
+			return r;
+		}
+
+		sent += r;
+		// Advance over what was sent, possibly within an entry.
+		while (r > 0) {
+			const size_t n = MIN((size_t)r, iov[first].iov_len);
+
+			iov[first].iov_base = (uint8_t *)iov[first].iov_base + n;
+			iov[first].iov_len -= n;
+			r -= n;
+			if (iov[first].iov_len == 0)
+				first++;
+		}
+	}
+
+	free(iov);
+	return sent;
+}
+
 ssize_t tcp_recv_all(const int socket, void *const buffer, const size_t length)
 {
 	size_t recvd = 0;
@@ -799,6 +799,35 @@ static void tcpclv3_send_packet_data(
 	}
 }
 
+static void tcpclv3_send_packet_iov(struct cla_link *link,
+				    const struct bundle_serialized *serialized,
+				    char *cla_addr)
+{
+	struct tcpclv3_contact_parameters *const param =
+		(struct tcpclv3_contact_parameters *)link;
+
+	ASSERT(param->state == TCPCLV3_ESTABLISHED);
+
+	uint8_t header_buffer[1 + MAX_SDNV_SIZE];
+
+	// Single DATA_SEGMENT with both start and end flags, as above.
+	header_buffer[0] = (
+		TCPCLV3_TYPE_DATA_SEGMENT |
+		TCPCLV3_FLAG_S |
+		TCPCLV3_FLAG_E
+	);
+
+	int sdnv_len = sdnv_write_u32(&header_buffer[1], serialized->length);
+
+	(void)cla_addr;
+	if (tcp_send_all_iov(param->link.connection_socket,
+			     header_buffer, sdnv_len + 1,
+			     serialized) == -1) {
+		LOG_ERRNO("TCPCLv3", "sendmsg()", errno);
+		link->config->vtable->cla_disconnect_handler(link);
+	}
+}
+
 /*
  * INIT
  */
@@ -815,6 +844,7 @@ const struct cla_vtable tcpclv3_vtable = {
 	.cla_begin_packet = tcpclv3_begin_packet,
 	.cla_end_packet = tcpclv3_end_packet,
 	.cla_send_packet_data = tcpclv3_send_packet_data,
+	.cla_send_packet_iov = tcpclv3_send_packet_iov,
 
 	.cla_rx_task_reset_parsers = tcpclv3_reset_parsers,
 	.cla_rx_task_forward_to_specific_parser =
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * hal_payload.c
+ *
+ * Description: contains the POSIX implementation of the hardware
+ * abstraction layer interface for file-backed payload storage
+ *
+ */
+
+#include "platform/hal_io.h"
+#include "platform/hal_payload.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPILL_FILE_TEMPLATE "/spill-XXXXXX"
+
+static char *spill_directory;
+
+enum ud3tn_result hal_payload_spill_init(const char *directory)
+{
+	if (!directory)
+		directory = P_tmpdir;
+
+	if (mkdir(directory, S_IRWXU | S_IRWXG) && errno != EEXIST) {
+		LOG_ERRNO_ERROR("HAL", "Cannot create spill directory", errno);
+		return UD3TN_FAIL;
+	}
+
+	char *const dir = strdup(directory);
+
+	if (!dir)
+		return UD3TN_FAIL;
+
+	free(spill_directory);
+	spill_directory = dir;
+	return UD3TN_OK;
+}
+
+static int create_spill_file(void)
+{
+	const char *const dir = spill_directory ? spill_directory : P_tmpdir;
+	char *const path = malloc(strlen(dir) + sizeof(SPILL_FILE_TEMPLATE));
+
+	if (!path)
+		return -1;
+	strcpy(path, dir);
+	strcat(path, SPILL_FILE_TEMPLATE);
+
+	const int fd = mkstemp(path);
+
+	// The file is only referenced by its descriptor (and later the
+	// mapping) so it vanishes automatically if we crash or exit.
+	if (fd >= 0)
+		unlink(path);
+	free(path);
+	return fd;
+}
+
+uint8_t *hal_payload_spill_map(size_t length)
+{
+	if (length == 0)
+		return NULL;
+
+	const int fd = create_spill_file();
+
+	if (fd < 0) {
+		LOG_ERRNO("HAL", "Cannot create payload spill file", errno);
+		return NULL;
+	}
+
+	if (ftruncate(fd, (off_t)length) != 0) {
+		LOG_ERRNO("HAL", "Cannot resize payload spill file", errno);
+		close(fd);
+		return NULL;
+	}
+
+	void *const data = mmap(
+		NULL,
+		length,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED,
+		fd,
+		0
+	);
+
+	// The mapping keeps a reference to the file.
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		LOG_ERRNO("HAL", "Cannot map payload spill file", errno);
+		return NULL;
+	}
+
+	// Payloads are written and read front to back (bulk read, serializer,
+	// AAP delivery), allow the kernel to read ahead and drop behind.
+	madvise(data, length, MADV_SEQUENTIAL);
+
+	return data;
+}
+
+uint8_t *hal_payload_map_file(const char *path, size_t *length)
+{
+	const int fd = open(path, O_RDONLY);
+
+	if (fd < 0) {
+		LOG_ERRNO("HAL", "Cannot open file for mapping", errno);
+		return NULL;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+
+	// A private mapping allows callers to patch the data in place (e.g.
+	// the hop count) without modifying the file they were loaded from.
+	void *const data = mmap(
+		NULL,
+		(size_t)st.st_size,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE,
+		fd,
+		0
+	);
+
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		LOG_ERRNO("HAL", "Cannot map file", errno);
+		return NULL;
+	}
+
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	*length = (size_t)st.st_size;
+	return data;
+}
+
+void hal_payload_prefetch(const uint8_t *data, size_t length)
+{
+	const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+	const uintptr_t start = (uintptr_t)data & ~(page_size - 1);
+
+	if (!data || !length)
+		return;
+	// The advice only applies to whole pages.
+	madvise((void *)start, (uintptr_t)data + length - start, MADV_WILLNEED);
+}
+
+void hal_payload_unmap(uint8_t *data, size_t length)
+{
+	if (data && length)
+		munmap(data, length);
+}
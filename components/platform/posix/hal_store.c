@@ -10,10 +10,15 @@
 #include "bundle6/parser.h"
 #include "bundle7/parser.h"
 #include "ud3tn/bundle.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/payload.h"
 #include "ud3tn/result.h"
 #include "platform/hal_store.h"
 #include "platform/hal_io.h"
+#include "platform/hal_semaphore.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <stdio.h>
@@ -26,9 +31,19 @@
 
 #define SEQUENCE_NUMBER_KEY "sequence_number"
 
+// Expected number of bundles held in memory at the same time
+#define RESIDENCY_MAP_EXPECTED_COUNT 64
+
 struct posix_bundle_store {
     struct bundle_store base;
     char* datadir;
+    // Residency of the stored bundles keyed by their path, the value is the
+    // enum bundle_residency. Bundles at rest are not contained.
+    struct hashmap residency;
+    struct bundle_store_residency_stats residency_stats;
+    // Protects the residency map, which is accessed by the bundle
+    // processor, the contact manager and the bundle restore task
+    Semaphore_t residency_semaphore;
 };
 
 struct posix_bundle_store_loadall_item {
@@ -67,6 +82,14 @@ struct bundle_store* hal_store_init(const char* identifier) {
     if(s == NULL){
         return NULL;
     }
+    s->residency_semaphore = hal_semaphore_init_binary();
+    if(s->residency_semaphore == NULL){
+        free(s);
+        return NULL;
+    }
+    hal_semaphore_release(s->residency_semaphore);
+    hashmap_init(&s->residency, RESIDENCY_MAP_EXPECTED_COUNT);
+    memset(&s->residency_stats, 0, sizeof(s->residency_stats));
     s->base.identifier = strdup(identifier);
     s->datadir = data_path;
 
@@ -101,6 +124,7 @@ const char* BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_REASSEMBLY_PENDING = "RET_CONS
 const char* BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_FORWARD_PENDING = "RET_CONSTRAINT_FORWARD_PENDING";
 const char* BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING = "RET_CONSTRAINT_DISPATCH_PENDING";
 const char* BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_FLAG_OWN = "RET_CONSTRAINT_FLAG_OWN";
+const char* BUNDLE_METADATA_SPRAY_COPIES = "SPRAY_COPIES";
 
 enum ud3tn_result _hal_store_write_metadata(struct bundle* bundle, FILE* file) {
     if((bundle->ret_constraints & BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED) == BUNDLE_RET_CONSTRAINT_CUSTODY_ACCEPTED){
@@ -153,41 +177,26 @@ enum ud3tn_result _hal_store_write_metadata(struct bundle* bundle, FILE* file) {
         fwrite("\n", sizeof(char), 1, file);
     }
 
+    if(bundle->spray_copies != 0){
+        fprintf(file, "%s %" PRIu32 "\n", BUNDLE_METADATA_SPRAY_COPIES, bundle->spray_copies);
+    }
+
     return UD3TN_OK;
 }
 
 const size_t STORE_READ_METADATA_BUFFER = 255;
 
 enum ud3tn_result _hal_store_read_metadata(struct bundle* bundle, FILE* file) {
-    char buffer[STORE_READ_METADATA_BUFFER];
-    size_t buffer_offset = 0;
-    size_t buffer_length = 0;
+    char line_content[STORE_READ_METADATA_BUFFER];
+    const size_t spray_copies_length = strlen(BUNDLE_METADATA_SPRAY_COPIES);
 
-    do {
-        size_t bytes_red = fread(
-            &buffer[buffer_offset], 
-            sizeof(char), STORE_READ_METADATA_BUFFER - buffer_offset,
-            file);
-
-        buffer_length += bytes_red;
-        
-        size_t line_length = 0;
-        while(line_length < buffer_length){
-            if(buffer[line_length] == '\n'){
-                break;
-            }
-            line_length++;
-        }
+    while(fgets(line_content, STORE_READ_METADATA_BUFFER, file) != NULL) {
+        line_content[strcspn(line_content, "\n")] = '\0';
 
-        if(line_length == 0 && bytes_red == 0){
-            break;
-        }
+        if(line_content[0] == '\0'){
+            continue;
 
-        char* line_content = malloc(sizeof(char) * (line_length + 1));
-        memcpy(line_content, &buffer, line_length);
-        line_content[line_length] = '\0';
-        
-        if(strcmp(line_content, BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_FORWARD_PENDING) == 0){
+        } else if(strcmp(line_content, BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_FORWARD_PENDING) == 0){
             bundle->ret_constraints |= BUNDLE_RET_CONSTRAINT_FORWARD_PENDING;
 
         } else if(strcmp(line_content, BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING) == 0) {
@@ -201,17 +210,15 @@ enum ud3tn_result _hal_store_read_metadata(struct bundle* bundle, FILE* file) {
 
         } else if(strcmp(line_content, BUNDLE_METADATA_BUNDLE_RET_CONSTRAINT_FLAG_OWN) == 0) {
             bundle->ret_constraints |= BUNDLE_RET_CONSTRAINT_FLAG_OWN;
-            
+
+        } else if(strncmp(line_content, BUNDLE_METADATA_SPRAY_COPIES, spray_copies_length) == 0 &&
+                line_content[spray_copies_length] == ' ') {
+            bundle->spray_copies = (uint32_t)strtoul(&line_content[spray_copies_length + 1], NULL, 10);
+
         } else {
             LOGF_WARN("HALStore: Discarded unknown metadata %s", line_content);
         }
-        
-        free(line_content);
-
-        memcpy(buffer, &buffer[line_length], buffer_length - line_length);
-        buffer_offset = buffer_length - line_length;
-
-    } while(buffer_length > 0);
+    }
 
     return UD3TN_OK;
 }
@@ -254,6 +261,76 @@ char* _hal_store_bundle_path(struct posix_bundle_store* store, struct bundle *bu
     return path;
 }
 
+static size_t* _hal_store_residency_counter(struct posix_bundle_store* store, enum bundle_residency residency) {
+    switch(residency){
+        case BUNDLE_RESIDENCY_IN_MEMORY:
+            return &store->residency_stats.in_memory;
+        case BUNDLE_RESIDENCY_IN_TX:
+            return &store->residency_stats.in_tx;
+        default:
+            return NULL;
+    }
+}
+
+// Has to be called with the residency semaphore taken
+static void _hal_store_set_residency_locked(
+    struct posix_bundle_store* store,
+    const char* path,
+    enum bundle_residency residency){
+
+    const enum bundle_residency previous = (enum bundle_residency)(uintptr_t)
+        hashmap_remove(&store->residency, path);
+    size_t* counter = _hal_store_residency_counter(store, previous);
+
+    if(counter != NULL)
+        (*counter)--;
+    if(residency == BUNDLE_RESIDENCY_AT_REST)
+        return;
+
+    // If memory is exhausted, the bundle is considered at rest and may be
+    // loaded again, as without residency tracking.
+    if(hashmap_put(&store->residency, path, (void*)(uintptr_t)residency) != UD3TN_OK){
+        LOGF_WARN("Bundle Store : Failed to track residency of %s", path);
+        return;
+    }
+    counter = _hal_store_residency_counter(store, residency);
+    if(counter != NULL)
+        (*counter)++;
+}
+
+static void _hal_store_set_path_residency(
+    struct posix_bundle_store* store,
+    const char* path,
+    enum bundle_residency residency){
+
+    hal_semaphore_take_blocking(store->residency_semaphore);
+    _hal_store_set_residency_locked(store, path, residency);
+    hal_semaphore_release(store->residency_semaphore);
+}
+
+void hal_store_set_residency(
+    struct bundle_store* base_store,
+    struct bundle *bundle,
+    enum bundle_residency residency){
+
+    struct posix_bundle_store* store = (struct posix_bundle_store*) base_store;
+    char* path = _hal_store_bundle_path(store, bundle);
+
+    _hal_store_set_path_residency(store, path, residency);
+    free(path);
+}
+
+void hal_store_get_residency_stats(
+    struct bundle_store* base_store,
+    struct bundle_store_residency_stats* stats){
+
+    struct posix_bundle_store* store = (struct posix_bundle_store*) base_store;
+
+    hal_semaphore_take_blocking(store->residency_semaphore);
+    *stats = store->residency_stats;
+    hal_semaphore_release(store->residency_semaphore);
+}
+
 enum ud3tn_result hal_store_bundle_metadata(struct bundle_store* base_store, struct bundle *bundle) {
     struct posix_bundle_store* store = (struct posix_bundle_store*) base_store;
 
@@ -286,15 +363,30 @@ enum ud3tn_result hal_store_bundle(struct bundle_store* base_store, struct bundl
     char* metadata_path = malloc(sizeof(char) * strlen(path) + 1 + 5);
     sprintf(metadata_path, "%s.meta", path);
 
+    char* temporary_path = malloc(sizeof(char) * strlen(path) + 1 + 4);
+    sprintf(temporary_path, "%s.tmp", path);
+
     enum ud3tn_result return_result = UD3TN_FAIL;
 
-    FILE* fd = fopen(path, "w");
+    // The bundle is written to a temporary file which then replaces the
+    // stored one. An existing file is never truncated in place as it may
+    // still be mapped by a bundle loaded from it (e.g. when a restored
+    // bundle is dispatched and thus stored again).
+    FILE* fd = fopen(temporary_path, "w");
     if(fd){
         return_result = bundle_serialize(bundle, write_bundle_to_file, fd);
-        fclose(fd);
+        if(fclose(fd) != 0)
+            return_result = UD3TN_FAIL;
+        if(return_result == UD3TN_OK && rename(temporary_path, path) != 0){
+            LOGF_ERROR("Bundle Store : Failed to replace file %s (error %d)", path, errno);
+            return_result = UD3TN_FAIL;
+        }
+        if(return_result != UD3TN_OK)
+            remove(temporary_path);
     } else {
-        LOGF_ERROR("Bundle Store : Failed to create file %s (error %d)", path, errno);
+        LOGF_ERROR("Bundle Store : Failed to create file %s (error %d)", temporary_path, errno);
     }
+    free(temporary_path);
 
     FILE* metadata_fd = fopen(metadata_path, "w");
     if(metadata_fd){
@@ -304,6 +396,10 @@ enum ud3tn_result hal_store_bundle(struct bundle_store* base_store, struct bundl
         LOGF_ERROR("Bundle Store : Failed to create file %s (error %d)", metadata_path, errno);
     }
 
+    // The caller keeps the bundle, it must not be loaded again
+    if(return_result == UD3TN_OK)
+        _hal_store_set_path_residency(store, path, BUNDLE_RESIDENCY_IN_MEMORY);
+
     free(path);
     free(metadata_path);
     return return_result;
@@ -326,6 +422,7 @@ enum ud3tn_result hal_store_bundle_delete(struct bundle_store* base_store, struc
         LOG_ERRNO("HALStore", "Failed to remove bundle", errno);
     };
     remove(metadata_path);
+    _hal_store_set_path_residency(store, path, BUNDLE_RESIDENCY_AT_REST);
 
     free(path);
     free(metadata_path);
@@ -394,6 +491,80 @@ uint64_t hal_store_get_uint64_value(
     return value;
 }
 
+enum ud3tn_result hal_store_set_blob_value(
+    struct bundle_store* store,
+    const char* key,
+    const void* data,
+    size_t length){
+
+    char* filepath = _hal_store_get_value_path(store, key);
+    char* temporary_path = malloc(sizeof(char) * strlen(filepath) + 1 + 4);
+    sprintf(temporary_path, "%s.tmp", filepath);
+
+    enum ud3tn_result result = UD3TN_FAIL;
+
+    // As for bundles, the value is written to a temporary file which then
+    // replaces the stored one, as it may still be mapped.
+    FILE* file = fopen(temporary_path, "w");
+    if(file == NULL){
+        LOGF_ERROR("Bundle Store : Failed to write value %s in file %s", key, temporary_path);
+    } else {
+        if(fwrite(data, 1, length, file) == length)
+            result = UD3TN_OK;
+        if(fclose(file) != 0)
+            result = UD3TN_FAIL;
+        if(result == UD3TN_OK && rename(temporary_path, filepath) != 0){
+            LOGF_ERROR("Bundle Store : Failed to replace file %s (error %d)", filepath, errno);
+            result = UD3TN_FAIL;
+        }
+        if(result != UD3TN_OK){
+            LOGF_ERROR("Bundle Store : Failed to write value %s in file %s", key, filepath);
+            remove(temporary_path);
+        }
+    }
+
+    free(temporary_path);
+    free(filepath);
+    return result;
+}
+
+enum ud3tn_result hal_store_append_blob_value(
+    struct bundle_store* store,
+    const char* key,
+    const void* data,
+    size_t length){
+
+    char* filepath = _hal_store_get_value_path(store, key);
+
+    enum ud3tn_result result = UD3TN_FAIL;
+
+    FILE* file = fopen(filepath, "a");
+    if(file == NULL){
+        LOGF_ERROR("Bundle Store : Failed to append value %s in file %s", key, filepath);
+    } else {
+        if(fwrite(data, 1, length, file) == length)
+            result = UD3TN_OK;
+        if(fclose(file) != 0)
+            result = UD3TN_FAIL;
+        if(result != UD3TN_OK)
+            LOGF_ERROR("Bundle Store : Failed to append value %s in file %s", key, filepath);
+    }
+
+    free(filepath);
+    return result;
+}
+
+struct payload_buffer* hal_store_map_blob_value(
+    struct bundle_store* store,
+    const char* key){
+
+    char* filepath = _hal_store_get_value_path(store, key);
+    struct payload_buffer* buffer = payload_buffer_map_file(filepath);
+
+    free(filepath);
+    return buffer;
+}
+
 struct bundle_store_loadall* hal_store_loadall(struct bundle_store* base_store){
     struct posix_bundle_store* store = (struct posix_bundle_store*) base_store;
 
@@ -418,6 +589,12 @@ struct bundle_store_loadall* hal_store_loadall(struct bundle_store* base_store){
             continue;
         }
 
+        // Leftover of an interrupted hal_store_bundle
+        ext = dirent->d_name + sizeof(char) * (strlen(dirent->d_name) - 4);
+        if(strcmp(ext, ".tmp") == 0){
+            continue;
+        }
+
         char protocol_version = dirent->d_name[0];
         if(protocol_version != '7' && protocol_version != '6'){
             continue;
@@ -455,21 +632,33 @@ static void _hal_store_get_bundle(
     *((struct bundle**) out) = bundle;
 }
 
-struct bundle* hal_store_loadall_next(struct bundle_store_loadall* loader_base) {
-    struct posix_bundle_store_loadall* loader = (struct posix_bundle_store_loadall*) loader_base;
-    
-    if(loader->next_item == NULL){
+static struct bundle* _hal_store_parse_mapped(const char* filepath)
+{
+    // The file is mapped and parsed in one pass, block data (including the
+    // payload) is borrowed from the mapping instead of being copied.
+    struct payload_buffer* source = payload_buffer_map_file(filepath);
+    if(source == NULL)
         return NULL;
-    }
 
-    struct posix_bundle_store_loadall_item* item = loader->next_item;
-    loader->next_item = item->next;
-    item->next = NULL;
+    struct bundle* bundle = bundle7_parse_buffer(source, NULL);
+    payload_buffer_put(source);
+    return bundle;
+}
 
+// Parses the bundle stored in the file of the item along with its metadata,
+// returns NULL if that failed.
+static struct bundle* _hal_store_load_item(struct posix_bundle_store_loadall_item* item) {
     // Bundle parsing
 
     struct bundle* next_bundle = NULL;
 
+    if(item->protocol_version == '7'){
+        next_bundle = _hal_store_parse_mapped(item->filepath);
+        if(next_bundle != NULL)
+            goto jump_metadata;
+        // Fall back to the streaming parser, e.g. if mapping failed
+    }
+
 	struct bundle7_parser b7_parser;
 	bundle7_parser_init(&b7_parser, &_hal_store_get_bundle, &next_bundle);
 	b7_parser.bundle_quota = BUNDLE_MAX_SIZE;
@@ -563,6 +752,7 @@ struct bundle* hal_store_loadall_next(struct bundle_store_loadall* loader_base)
         goto jump_next;
     }
     
+    jump_metadata:;
     char* metadata_path = malloc(sizeof(char) * strlen(item->filepath) + 5 + 1);
     sprintf(metadata_path, "%s.meta", item->filepath);
 
@@ -577,13 +767,55 @@ struct bundle* hal_store_loadall_next(struct bundle_store_loadall* loader_base)
 
 
     jump_next:
-    if(next_bundle != NULL)
-        LOGF_DEBUG("Store loaded %s", item->filepath);
-    _hal_store_loadall_item_free(item);
-    if(next_bundle == NULL)
-        return hal_store_loadall_next(loader_base);
-
     return next_bundle;
 }
 
+struct bundle* hal_store_loadall_next(struct bundle_store_loadall* loader_base) {
+    struct posix_bundle_store_loadall* loader = (struct posix_bundle_store_loadall*) loader_base;
+    struct posix_bundle_store* store = (struct posix_bundle_store*) loader_base->store;
+
+    // Resident and unparseable bundles are skipped iteratively, as many
+    // bundles may be resident e.g. after a checkpoint.
+    for(;;){
+        if(loader->next_item == NULL){
+            return NULL;
+        }
+
+        struct posix_bundle_store_loadall_item* item = loader->next_item;
+        loader->next_item = item->next;
+        item->next = NULL;
+
+        // The bundle is claimed before parsing it, so that it is neither
+        // loaded twice nor while it is stored again by the bundle processor.
+        hal_semaphore_take_blocking(store->residency_semaphore);
+        const bool resident = hashmap_get(&store->residency, item->filepath) != NULL;
+        if(resident)
+            store->residency_stats.skipped_loads++;
+        else
+            _hal_store_set_residency_locked(store, item->filepath, BUNDLE_RESIDENCY_IN_MEMORY);
+        hal_semaphore_release(store->residency_semaphore);
+
+        if(resident){
+            LOGF_DEBUG("Store skipped %s, already in memory", item->filepath);
+            _hal_store_loadall_item_free(item);
+            continue;
+        }
+
+        struct bundle* next_bundle = _hal_store_load_item(item);
+
+        hal_semaphore_take_blocking(store->residency_semaphore);
+        if(next_bundle != NULL)
+            store->residency_stats.loads++;
+        else
+            _hal_store_set_residency_locked(store, item->filepath, BUNDLE_RESIDENCY_AT_REST);
+        hal_semaphore_release(store->residency_semaphore);
+
+        if(next_bundle != NULL)
+            LOGF_DEBUG("Store loaded %s", item->filepath);
+        _hal_store_loadall_item_free(item);
+        if(next_bundle != NULL)
+            return next_bundle;
+    }
+}
+
 #endif
\ No newline at end of file
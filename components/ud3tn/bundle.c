@@ -2,6 +2,7 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_processor.h"
 #include "ud3tn/common.h"
+#include "ud3tn/payload.h"
 
 // RFC 5050
 #include "bundle6/bundle6.h"
@@ -43,6 +44,8 @@ static inline void bundle_reset_internal(struct bundle *bundle)
 	bundle->primary_block_length = 0;
 	bundle->blocks = NULL;
 	bundle->payload_block = NULL;
+	bundle->spray_copies = 0;
+	bundle->routed_entries = NULL;
 }
 
 struct bundle *bundle_init(void)
@@ -106,6 +109,8 @@ void bundle_copy_headers(struct bundle *to, const struct bundle *from)
 	// No extension blocks are copied
 	to->blocks = NULL;
 	to->payload_block = NULL;
+	// The copy is not queued for any contact
+	to->routed_entries = NULL;
 }
 
 enum ud3tn_result bundle_recalculate_header_length(struct bundle *bundle)
@@ -138,6 +143,7 @@ struct bundle *bundle_dup(const struct bundle *bundle)
 	if (dup == NULL)
 		return NULL;
 	memcpy(dup, bundle, sizeof(struct bundle));
+	dup->routed_entries = NULL;
 
 	// Allocate new EID references
 	if (dup->source)
@@ -257,6 +263,7 @@ struct bundle_block *bundle_block_create(enum bundle_block_type t)
 	block->crc_type = BUNDLE_CRC_TYPE_NONE;
 	block->length = 0;
 	block->data = NULL;
+	block->buffer = NULL;
 	return block;
 }
 
@@ -279,12 +286,88 @@ void bundle_block_free(struct bundle_block *b)
 	if (b != NULL) {
 		if (b->eid_refs != NULL)
 			free(b->eid_refs);
-		if (b->data != NULL)
+		if (b->buffer != NULL)
+			payload_buffer_put(b->buffer);
+		else if (b->data != NULL)
 			free(b->data);
 		free(b);
 	}
 }
 
+enum ud3tn_result bundle_block_alloc_data(struct bundle_block *b,
+					  size_t length)
+{
+	uint8_t *data = NULL;
+	struct payload_buffer *buffer = NULL;
+
+	if (payload_should_spill(length)) {
+		buffer = payload_buffer_create(length);
+		if (buffer == NULL)
+			return UD3TN_FAIL;
+		data = buffer->data;
+	} else {
+		data = malloc(length);
+		if (data == NULL && length != 0)
+			return UD3TN_FAIL;
+	}
+
+	if (b->buffer != NULL)
+		payload_buffer_put(b->buffer);
+	else
+		free(b->data);
+	b->buffer = buffer;
+	b->data = data;
+	b->length = length;
+	return UD3TN_OK;
+}
+
+enum ud3tn_result bundle_block_share_data(struct bundle_block *dst,
+					  struct bundle_block *src,
+					  size_t offset, size_t length)
+{
+	ASSERT(dst != src);
+	ASSERT(offset + length <= src->length);
+
+	if (length == 0)
+		return bundle_block_alloc_data(dst, 0);
+
+	// Turn a plain heap allocation into a buffer on first use so that
+	// both blocks can reference it. The data pointer does not change.
+	if (src->buffer == NULL) {
+		src->buffer = payload_buffer_wrap(src->data, src->length);
+		if (src->buffer == NULL)
+			return UD3TN_FAIL;
+	}
+
+	struct payload_buffer *const buffer = payload_buffer_get(src->buffer);
+
+	if (dst->buffer != NULL)
+		payload_buffer_put(dst->buffer);
+	else
+		free(dst->data);
+	dst->buffer = buffer;
+	dst->data = src->data + offset;
+	dst->length = length;
+	return UD3TN_OK;
+}
+
+void bundle_block_truncate_data(struct bundle_block *b, size_t length)
+{
+	ASSERT(length <= b->length);
+	b->length = length;
+
+	// A file-backed buffer keeps its size, only the visible length
+	// changes. The remainder is released along with the buffer.
+	if (b->buffer != NULL || length == 0)
+		return;
+
+	uint8_t *const data = realloc(b->data, length);
+
+	// Shrinking may fail, in which case the old allocation stays valid.
+	if (data != NULL)
+		b->data = data;
+}
+
 struct bundle_block_list *bundle_block_entry_free(struct bundle_block_list *e)
 {
 	struct bundle_block_list *next;
@@ -321,10 +404,12 @@ struct bundle_block *bundle_block_dup(struct bundle_block *b)
 		cur_ref = cur_ref->next;
 	}
 
-	dup->data = malloc(b->length);
-	if (dup->data == NULL)
+	// Block data is never modified in place, so the duplicate can
+	// reference the data of the original instead of copying it.
+	dup->data = NULL;
+	dup->buffer = NULL;
+	if (bundle_block_share_data(dup, b, 0, b->length) != UD3TN_OK)
 		goto err;
-	memcpy(dup->data, b->data, b->length);
 	return dup;
 
 err:
@@ -385,6 +470,154 @@ enum ud3tn_result bundle_serialize(
 	return UD3TN_OK;
 }
 
+// Initial sizes of the iovec list and header buffer, grown as needed.
+#define BUNDLE_IOV_INITIAL_COUNT 8
+#define BUNDLE_IOV_INITIAL_HEADER_SIZE 256
+
+struct iov_writer {
+	struct bundle_serialized *result;
+	bool failed;
+};
+
+static bool iov_reserve_entry(struct iov_writer *w)
+{
+	struct bundle_serialized *const r = w->result;
+
+	if (r->iov_count < r->iov_capacity)
+		return true;
+
+	const size_t capacity = (
+		r->iov_capacity ? r->iov_capacity * 2 : BUNDLE_IOV_INITIAL_COUNT
+	);
+	struct bundle_iovec *const iov = realloc(
+		r->iov,
+		capacity * sizeof(struct bundle_iovec)
+	);
+
+	if (!iov) {
+		w->failed = true;
+		return false;
+	}
+	r->iov = iov;
+	r->iov_capacity = capacity;
+	return true;
+}
+
+// Header bytes are copied as the serializers reuse their output buffer. The
+// entry base is assigned after serialization as the buffer may be moved.
+static void iov_write_headers(void *p, const void *buffer, const size_t length)
+{
+	struct iov_writer *const w = p;
+	struct bundle_serialized *const r = w->result;
+
+	if (w->failed || length == 0)
+		return;
+
+	if (r->headers_length + length > r->headers_capacity) {
+		size_t capacity = (
+			r->headers_capacity
+			? r->headers_capacity
+			: BUNDLE_IOV_INITIAL_HEADER_SIZE
+		);
+
+		while (capacity < r->headers_length + length)
+			capacity *= 2;
+
+		uint8_t *const headers = realloc(r->headers, capacity);
+
+		if (!headers) {
+			w->failed = true;
+			return;
+		}
+		r->headers = headers;
+		r->headers_capacity = capacity;
+	}
+	memcpy(r->headers + r->headers_length, buffer, length);
+	r->headers_length += length;
+	r->length += length;
+
+	// Coalesce subsequent header writes into a single entry.
+	if (r->iov_count && r->iov[r->iov_count - 1].base == NULL) {
+		r->iov[r->iov_count - 1].length += length;
+		return;
+	}
+	if (!iov_reserve_entry(w))
+		return;
+	r->iov[r->iov_count++] = (struct bundle_iovec){
+		.base = NULL,
+		.length = length,
+	};
+}
+
+static void iov_write_data(void *p, const void *buffer, const size_t length)
+{
+	struct iov_writer *const w = p;
+	struct bundle_serialized *const r = w->result;
+
+	if (w->failed || length == 0)
+		return;
+	if (!iov_reserve_entry(w))
+		return;
+	r->iov[r->iov_count++] = (struct bundle_iovec){
+		.base = buffer,
+		.length = length,
+	};
+	r->length += length;
+}
+
+enum ud3tn_result bundle_serialize_iov(
+	struct bundle *bundle,
+	struct bundle_serialized *result)
+{
+	struct iov_writer w = {
+		.result = result,
+		.failed = false,
+	};
+	enum ud3tn_result res;
+
+	memset(result, 0, sizeof(struct bundle_serialized));
+
+	switch (bundle->protocol_version) {
+	// RFC 5050
+	case 6:
+		res = bundle6_serialize_split(bundle, iov_write_headers,
+					      iov_write_data, &w);
+		break;
+	// BPv7
+	case 7:
+		res = bundle7_serialize_split(bundle, iov_write_headers,
+					      iov_write_data, &w);
+		break;
+	default:
+		res = UD3TN_FAIL;
+		break;
+	}
+
+	if (res != UD3TN_OK || w.failed) {
+		bundle_serialized_free(result);
+		return UD3TN_FAIL;
+	}
+
+	// Header entries are stored in order in the header buffer.
+	size_t offset = 0;
+
+	for (size_t i = 0; i < result->iov_count; i++) {
+		if (result->iov[i].base != NULL)
+			continue;
+		result->iov[i].base = result->headers + offset;
+		offset += result->iov[i].length;
+	}
+
+	return UD3TN_OK;
+}
+
+void bundle_serialized_free(struct bundle_serialized *serialized)
+{
+	free(serialized->iov);
+	free(serialized->headers);
+	memset(serialized, 0, sizeof(struct bundle_serialized));
+}
+
 size_t bundle_get_first_fragment_min_size(struct bundle *bundle)
 {
 	switch (bundle->protocol_version) {
@@ -484,15 +717,12 @@ enum ud3tn_result bundle_age_update(struct bundle *bundle,
 
 	bundle_age += dwell_time_ms;
 
-	uint8_t *buffer = malloc(BUNDLE_AGE_MAX_ENCODED_SIZE);
-
 	// Out of memory
-	if (buffer == NULL)
+	if (bundle_block_alloc_data(block, BUNDLE_AGE_MAX_ENCODED_SIZE) !=
+	    UD3TN_OK)
 		return UD3TN_FAIL;
 
-	free(block->data);
-	block->data = buffer;
-	block->length = bundle_age_serialize(bundle_age, buffer,
+	block->length = bundle_age_serialize(bundle_age, block->data,
 		BUNDLE_AGE_MAX_ENCODED_SIZE);
 
 	return UD3TN_OK;
@@ -563,14 +793,36 @@ struct bundle_adu bundle_to_adu(struct bundle *bundle)
 
 	adu.payload = bundle->payload_block->data;
 	adu.length = bundle->payload_block->length;
+	adu.payload_buffer = bundle->payload_block->buffer;
 	bundle->payload_block->data = NULL;
+	bundle->payload_block->buffer = NULL;
 	bundle->payload_block->length = 0;
 	return adu;
 }
 
+uint8_t *bundle_adu_take_payload(struct bundle_adu *adu)
+{
+	uint8_t *payload = adu->payload;
+
+	if (adu->payload_buffer != NULL) {
+		payload = malloc(adu->length);
+		if (payload == NULL)
+			return NULL;
+		memcpy(payload, adu->payload, adu->length);
+		payload_buffer_put(adu->payload_buffer);
+		adu->payload_buffer = NULL;
+	}
+
+	adu->payload = NULL;
+	return payload;
+}
+
 void bundle_adu_free_members(struct bundle_adu adu)
 {
 	free(adu.source);
 	free(adu.destination);
-	free(adu.payload);
+	if (adu.payload_buffer != NULL)
+		payload_buffer_put(adu.payload_buffer);
+	else
+		free(adu.payload);
 }
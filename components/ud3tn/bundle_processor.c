@@ -5,11 +5,16 @@
 #include "ud3tn/contact_manager.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/known_bundle_journal.h"
+#include "ud3tn/payload.h"
 #include "ud3tn/report_manager.h"
 #include "ud3tn/result.h"
 #include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
+#include "ud3tn/routing_table_snapshot.h"
 
 #include "agents/config_agent.h"
+#include "agents/exchange_agent.h"
 
 #include "bundle7/hopcount.h"
 
@@ -53,6 +58,21 @@ struct bp_context {
 		uint64_t deadline_ms;
 		struct known_bundle_list *next;
 	} *known_bundle_list;
+	size_t known_bundle_count;
+
+	// Fragments kept for reassembly before the last shutdown which have
+	// not been dispatched again since, see recover_known_bundles()
+	struct known_bundle_list *reassembly_pending;
+	// Records in the journal of known bundles
+	size_t journal_record_count;
+	// Records left in the journal by the last compaction
+	size_t journal_live_count;
+
+	// Time at which the changed routing table is persisted, zero if it
+	// has not been changed, see schedule_routing_table_checkpoint()
+	uint64_t checkpoint_due_ms;
+	// Time of the first change not persisted yet
+	uint64_t checkpoint_dirty_since_ms;
 };
 
 /* DECLARATIONS */
@@ -97,8 +117,6 @@ static void bundle_delete(
 static void bundle_discard(struct bundle_store* store, struct bundle *bundle);
 static void bundle_handle_custody_signal(
 	struct bundle_administrative_record *signal);
-static void bundle_dangling(
-	const struct bp_context *const ctx, struct bundle *bundle);
 static bool hop_count_validation(struct bundle *bundle);
 static const char *get_agent_id(
 	const struct bp_context *const ctx, const char *dest_eid);
@@ -108,6 +126,9 @@ static bool bundle_reassembled_is_known(
 	struct bp_context *const ctx, const struct bundle *bundle);
 static void bundle_add_reassembled_as_known(
 	struct bp_context *const ctx, const struct bundle *bundle);
+static bool bundle_take_reassembly_pending(
+	struct bp_context *const ctx, const struct bundle *bundle);
+static void known_bundle_list_trim(struct bp_context *const ctx);
 
 static void send_status_report(
 	const struct bp_context *const ctx,
@@ -139,15 +160,70 @@ static inline void bundle_rem_rc(struct bundle *bundle,
 	}
 }
 
+// The bundle is kept in the store only, to be restored later.
+static inline void bundle_release_to_store(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	hal_store_set_residency(ctx->store, bundle, BUNDLE_RESIDENCY_AT_REST);
+	bundle_free(bundle);
+}
+
+#ifdef ROUTER_PEERS
+// Reports the end of a transmission to the router. Returns true if the
+// bundle was a copy created by the router, which is released then, as the
+// original is kept in the store.
+static bool release_router_copy(
+	const struct bp_context *const ctx,
+	const struct bundle_processor_signal *signal, bool success)
+{
+	if (!router_peers_transmission_ended(signal->bundle,
+					     signal->peer_cla_addr, success))
+		return false;
+	// The copy has been marked as in transmission instead of the original
+	bundle_release_to_store(ctx, signal->bundle);
+	free(signal->peer_cla_addr);
+	return true;
+}
+#endif // ROUTER_PEERS
+
 #ifdef ARCHIPEL_CORE
 static void handle_link_down(
 	const struct bp_context *const ctx, const char* peer_cla_addr
 	);
+static void restore_routing_table(const struct bp_context *const ctx);
+static void schedule_routing_table_checkpoint(struct bp_context *const ctx);
+static int64_t get_checkpoint_timeout_ms(const struct bp_context *const ctx);
+static void checkpoint_routing_table_if_due(struct bp_context *const ctx);
+static void recover_known_bundles(struct bp_context *const ctx);
+static void journal_known_bundle(
+	struct bp_context *const ctx, enum known_bundle_journal_type type,
+	const struct bundle_unique_identifier *id, uint64_t deadline_ms);
 #endif
 
+#if defined(ROUTING_EPIDEMIC) || defined(ROUTING_PROPHET)
+static void send_router_state(
+	const struct bp_context *const ctx, const char *peer_cla_addr);
+#endif // ROUTING_EPIDEMIC || ROUTING_PROPHET
+
 static void wake_up_contact_manager(QueueIdentifier_t cm_queue,
 				    enum contact_manager_signal cm_signal);
+
+/*
+ * Bundles which have to be routed again, e.g. as their contact has ended.
+ * They are collected while the routing table is modified and routed as a
+ * batch afterwards, see bundle_resched_func().
+ */
+struct resched_batch {
+	const struct bp_context *ctx;
+	struct bundle **bundles;
+	enum router_result_status *results;
+	size_t count;
+	size_t capacity;
+};
+
 static void bundle_resched_func(struct bundle *bundle, const void *ctx);
+static void resched_batch_route(struct resched_batch *batch);
+static void resched_batch_finish(struct resched_batch *batch);
 
 /* COMMUNICATION */
 
@@ -214,29 +290,66 @@ int bundle_processor_perform_agent_action(
 void bundle_processor_handle_router_command(
 	void *const bp_context, struct router_command *cmd)
 {
-	const struct bp_context *const ctx = bp_context;
+	struct bp_context *const ctx = bp_context;
+	struct resched_batch batch = { .ctx = ctx };
 
 	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
 
-	// NOTE: May invoke router via bundle_dangling!
 	enum ud3tn_result result = router_process_command(
 		cmd,
 		(struct rescheduling_handle) {
 			.reschedule_func = bundle_resched_func,
-			.reschedule_func_context = ctx,
+			.reschedule_func_context = &batch,
 		}
 	);
+	resched_batch_route(&batch);
 
 	hal_semaphore_release(ctx->cm_param.semaphore);
+	resched_batch_finish(&batch);
 
 	if (result == UD3TN_OK) {
 		wake_up_contact_manager(
 			ctx->cm_param.control_queue,
 			CM_SIGNAL_UPDATE_CONTACT_LIST
 		);
+		#ifdef ARCHIPEL_CORE
+		schedule_routing_table_checkpoint(ctx);
+		#endif
 	}
 }
 
+void bundle_processor_handle_router_commands(
+	void *const bp_context, struct router_command *commands, size_t count)
+{
+	struct bp_context *const ctx = bp_context;
+	struct resched_batch batch = { .ctx = ctx };
+
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+
+	// If memory ran out while applying the plan, the commands applied
+	// successfully still require the contact manager to be notified.
+	router_process_commands(
+		commands,
+		count,
+		(struct rescheduling_handle) {
+			.reschedule_func = bundle_resched_func,
+			.reschedule_func_context = &batch,
+		}
+	);
+	resched_batch_route(&batch);
+
+	hal_semaphore_release(ctx->cm_param.semaphore);
+	resched_batch_finish(&batch);
+
+	wake_up_contact_manager(
+		ctx->cm_param.control_queue,
+		CM_SIGNAL_UPDATE_CONTACT_LIST
+	);
+	#ifdef ARCHIPEL_CORE
+	schedule_routing_table_checkpoint(ctx);
+	#endif
+}
+
 void bundle_processor_task(void * const param)
 {
 	struct bundle_processor_task_parameters *p =
@@ -249,6 +362,12 @@ void bundle_processor_task(void * const param)
 		.status_reporting = p->status_reporting,
 		.reassembly_list = NULL,
 		.known_bundle_list = NULL,
+		.known_bundle_count = 0,
+		.reassembly_pending = NULL,
+		.journal_record_count = 0,
+		.journal_live_count = 0,
+		.checkpoint_due_ms = 0,
+		.checkpoint_dirty_since_ms = 0,
 		#ifdef ARCHIPEL_CORE
 		.store = p->bundle_store,
 		#endif
@@ -287,14 +406,13 @@ void bundle_processor_task(void * const param)
 	#ifdef ARCHIPEL_CORE
 	ctx.cm_param = contact_manager_start(
 		p->signaling_queue,
-		routing_table_get_raw_contact_list_ptr(),
-		p->bundle_restore_queue
+		p->bundle_restore_queue,
+		p->bundle_store
 		);
 	#endif
 	#ifndef ARCHIPEL_CORE
 	ctx.cm_param = contact_manager_start(
-		p->signaling_queue,
-		routing_table_get_raw_contact_list_ptr()
+		p->signaling_queue
 		);
 	#endif
 
@@ -303,6 +421,11 @@ void bundle_processor_task(void * const param)
 		abort();
 	}
 
+	#ifdef ARCHIPEL_CORE
+	restore_routing_table(&ctx);
+	recover_known_bundles(&ctx);
+	#endif
+
 	if (config_agent_setup(p->signaling_queue, ctx.local_eid,
 			       p->allow_remote_configuration, &ctx)) {
 		LOG_ERROR("BundleProcessor: Config agent could not be initialized!");
@@ -316,11 +439,19 @@ void bundle_processor_task(void * const param)
 	);
 
 	for (;;) {
+		#ifdef ARCHIPEL_CORE
+		const int64_t timeout = get_checkpoint_timeout_ms(&ctx);
+		#else
+		const int64_t timeout = -1;
+		#endif
 		if (hal_queue_receive(p->signaling_queue, &signal,
-			-1) == UD3TN_OK
+			timeout) == UD3TN_OK
 		) {
 			handle_signal(&ctx, signal);
 		}
+		#ifdef ARCHIPEL_CORE
+		checkpoint_routing_table_if_due(&ctx);
+		#endif
 	}
 }
 
@@ -336,16 +467,29 @@ static inline void handle_signal(
 		bundle_receive(ctx, signal.bundle);
 		break;
 	case BP_SIGNAL_TRANSMISSION_SUCCESS:
+		#ifdef ROUTER_PEERS
+		if (release_router_copy(ctx, &signal, true))
+			break;
+		#endif // ROUTER_PEERS
 		bundle_forwarding_success(ctx, signal.bundle);
 		// XXX: We do not use the provided CLA address.
 		free(signal.peer_cla_addr);
 		break;
 	case BP_SIGNAL_TRANSMISSION_FAILURE:
-		bundle_forwarding_failed(
-			ctx,
-			signal.bundle,
-			BUNDLE_SR_REASON_TRANSMISSION_CANCELED
-		);
+		#ifdef ROUTER_PEERS
+		if (release_router_copy(ctx, &signal, false))
+			break;
+		#endif // ROUTER_PEERS
+		// The TX task drops bundles which would expire before
+		// being received completely.
+		if (signal.reason == BUNDLE_SR_REASON_LIFETIME_EXPIRED)
+			bundle_expired(ctx, signal.bundle);
+		else
+			bundle_forwarding_failed(
+				ctx,
+				signal.bundle,
+				BUNDLE_SR_REASON_TRANSMISSION_CANCELED
+			);
 		// XXX: We do not use the provided CLA address.
 		free(signal.peer_cla_addr);
 		break;
@@ -389,7 +533,9 @@ static inline void handle_signal(
 		free(aaps);
 		break;
 	case BP_SIGNAL_NEW_LINK_ESTABLISHED:
-		// XXX: We do not use the provided CLA address.
+		#if defined(ROUTING_EPIDEMIC) || defined(ROUTING_PROPHET)
+		send_router_state(ctx, signal.peer_cla_addr);
+		#endif // ROUTING_EPIDEMIC || ROUTING_PROPHET
 		free(signal.peer_cla_addr);
 		// NOTE: When we implement a "bundle backlog", we will attempt
 		// to route the bundles here.
@@ -450,21 +596,326 @@ static void handle_link_down(
 		CM_SIGNAL_UPDATE_CONTACT_LIST
 	);
 }
+
+// Loads the snapshot of the routing table persisted before the last
+// shutdown, so that bundles can be forwarded without waiting for the contact
+// plan to be uploaded again.
+static void restore_routing_table(const struct bp_context *const ctx)
+{
+	struct payload_buffer *const snapshot = hal_store_map_blob_value(
+		ctx->store,
+		ROUTING_TABLE_SNAPSHOT_KEY
+	);
+	const uint64_t start_ms = hal_time_get_timestamp_ms();
+
+	enum ud3tn_result result;
+
+	if (snapshot == NULL)
+		return;
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+	result = routing_table_snapshot_restore(
+		snapshot->data,
+		snapshot->length,
+		start_ms
+	);
+	hal_semaphore_release(ctx->cm_param.semaphore);
+	payload_buffer_put(snapshot);
+
+	if (result != UD3TN_OK) {
+		LOG_WARN("BundleProcessor: Discarding invalid routing table snapshot");
+		return;
+	}
+	LOGF_INFO(
+		"BundleProcessor: Routing table restored in %lu ms",
+		(unsigned long)(hal_time_get_timestamp_ms() - start_ms)
+	);
+	wake_up_contact_manager(
+		ctx->cm_param.control_queue,
+		CM_SIGNAL_UPDATE_CONTACT_LIST
+	);
+}
+
+// Persists the routing table after the contact plan has been changed.
+static void checkpoint_routing_table(const struct bp_context *const ctx)
+{
+	uint8_t *snapshot;
+	size_t length;
+	enum ud3tn_result result;
+
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+	result = routing_table_snapshot_create(&snapshot, &length);
+	hal_semaphore_release(ctx->cm_param.semaphore);
+
+	if (result != UD3TN_OK) {
+		LOG_WARN("BundleProcessor: Failed to create routing table snapshot");
+		return;
+	}
+	if (hal_store_set_blob_value(ctx->store, ROUTING_TABLE_SNAPSHOT_KEY,
+				     snapshot, length) != UD3TN_OK)
+		LOG_WARN("BundleProcessor: Failed to persist routing table snapshot");
+	free(snapshot);
+}
+
+// Marks the routing table as changed, it is persisted once the contact plan
+// has not been changed for ROUTING_TABLE_CHECKPOINT_DELAY_MS.
+static void schedule_routing_table_checkpoint(struct bp_context *const ctx)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+
+	if (ctx->checkpoint_due_ms == 0)
+		ctx->checkpoint_dirty_since_ms = time_ms;
+	ctx->checkpoint_due_ms = MIN(
+		time_ms + ROUTING_TABLE_CHECKPOINT_DELAY_MS,
+		ctx->checkpoint_dirty_since_ms +
+			10 * ROUTING_TABLE_CHECKPOINT_DELAY_MS
+	);
+}
+
+// Returns how long to wait for signals before the routing table has to be
+// persisted, -1 if it has not been changed.
+static int64_t get_checkpoint_timeout_ms(const struct bp_context *const ctx)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+
+	if (ctx->checkpoint_due_ms == 0)
+		return -1;
+	if (ctx->checkpoint_due_ms <= time_ms)
+		return 0;
+	return (int64_t)(ctx->checkpoint_due_ms - time_ms);
+}
+
+static void checkpoint_routing_table_if_due(struct bp_context *const ctx)
+{
+	if (ctx->checkpoint_due_ms == 0 ||
+	    ctx->checkpoint_due_ms > hal_time_get_timestamp_ms())
+		return;
+	ctx->checkpoint_due_ms = 0;
+	checkpoint_routing_table(ctx);
+}
+
+static size_t encode_journal_record(
+	uint8_t *buffer, enum known_bundle_journal_type type,
+	const struct bundle_unique_identifier *id, uint64_t deadline_ms)
+{
+	const struct known_bundle_journal_record record = {
+		.type = type,
+		.id = *id,
+		.deadline_ms = deadline_ms,
+	};
+
+	return known_bundle_journal_encode(&record, buffer);
+}
+
+// Serializes all known bundles and fragments awaiting reassembly which have
+// not expired at the given time. If buffer is NULL, only the required size
+// is determined.
+static size_t encode_known_bundles(
+	const struct bp_context *const ctx, uint64_t time_ms,
+	uint8_t *buffer, size_t *record_count)
+{
+	const struct known_bundle_list *e;
+	const struct reassembly_list *r;
+	const struct reassembly_bundle_list *rb;
+	size_t length = 0;
+
+	*record_count = 0;
+	for (e = ctx->known_bundle_list; e != NULL; e = e->next) {
+		if (e->deadline_ms < time_ms)
+			continue;
+		length += encode_journal_record(
+			buffer ? &buffer[length] : NULL,
+			KNOWN_BUNDLE_JOURNAL_DELIVERED,
+			&e->id,
+			e->deadline_ms
+		);
+		(*record_count)++;
+	}
+	for (e = ctx->reassembly_pending; e != NULL; e = e->next) {
+		if (e->deadline_ms < time_ms)
+			continue;
+		length += encode_journal_record(
+			buffer ? &buffer[length] : NULL,
+			KNOWN_BUNDLE_JOURNAL_FRAGMENT,
+			&e->id,
+			e->deadline_ms
+		);
+		(*record_count)++;
+	}
+	for (r = ctx->reassembly_list; r != NULL; r = r->next) {
+		for (rb = r->bundle_list; rb != NULL; rb = rb->next) {
+			struct bundle_unique_identifier id =
+				bundle_get_unique_identifier(rb->bundle);
+
+			length += encode_journal_record(
+				buffer ? &buffer[length] : NULL,
+				KNOWN_BUNDLE_JOURNAL_FRAGMENT,
+				&id,
+				bundle_get_expiration_time_ms(rb->bundle)
+			);
+			bundle_free_unique_identifier(&id);
+			(*record_count)++;
+		}
+	}
+	return length;
+}
+
+// Rewrites the journal with only the entries which are still needed.
+static void compact_known_bundles(struct bp_context *const ctx)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+	size_t record_count;
+	const size_t length = encode_known_bundles(
+		ctx,
+		time_ms,
+		NULL,
+		&record_count
+	);
+	uint8_t *const buffer = malloc(length ? length : 1);
+
+	if (!buffer) {
+		LOG_WARN("BundleProcessor: Cannot allocate known bundle journal");
+		return;
+	}
+	encode_known_bundles(ctx, time_ms, buffer, &record_count);
+	if (hal_store_set_blob_value(ctx->store, KNOWN_BUNDLE_JOURNAL_KEY,
+				     buffer, length) != UD3TN_OK)
+		LOG_WARN("BundleProcessor: Failed to rewrite known bundle journal");
+	else
+		ctx->journal_record_count = ctx->journal_live_count =
+			record_count;
+	free(buffer);
+}
+
+// Appends the record to the journal, which is rewritten if it has grown
+// to more than twice its size after the last compaction, which includes the
+// fragments pending reassembly.
+static void journal_known_bundle(
+	struct bp_context *const ctx, enum known_bundle_journal_type type,
+	const struct bundle_unique_identifier *id, uint64_t deadline_ms)
+{
+	const size_t length = encode_journal_record(
+		NULL,
+		type,
+		id,
+		deadline_ms
+	);
+	uint8_t *const buffer = malloc(length);
+
+	if (!buffer) {
+		LOG_WARN("BundleProcessor: Cannot allocate known bundle journal record");
+		return;
+	}
+	encode_journal_record(buffer, type, id, deadline_ms);
+	if (hal_store_append_blob_value(ctx->store, KNOWN_BUNDLE_JOURNAL_KEY,
+					buffer, length) != UD3TN_OK)
+		LOG_WARN("BundleProcessor: Failed to journal known bundle");
+	free(buffer);
+
+	ctx->journal_record_count++;
+	if (ctx->journal_record_count > 2 * ctx->journal_live_count +
+					KNOWN_BUNDLE_JOURNAL_MIN_COMPACTION)
+		compact_known_bundles(ctx);
+}
+
+// Inserts the entry into the list ordered by deadline. The search starts
+// after the given entry if possible, which makes inserting the records of a
+// compacted (thus, ordered) journal take constant time.
+static void known_bundle_list_insert(
+	struct known_bundle_list **list, struct known_bundle_list *hint,
+	struct known_bundle_list *entry)
+{
+	struct known_bundle_list **cur_entry = list;
+
+	if (hint != NULL && hint->deadline_ms <= entry->deadline_ms)
+		cur_entry = &hint->next;
+	while (*cur_entry != NULL &&
+	       (*cur_entry)->deadline_ms <= entry->deadline_ms)
+		cur_entry = &(*cur_entry)->next;
+	entry->next = *cur_entry;
+	*cur_entry = entry;
+}
+
+// Loads the bundles delivered and the fragments kept for reassembly before
+// the last shutdown from the journal, so that bundles restored from the
+// store are neither delivered twice nor stranded.
+static void recover_known_bundles(struct bp_context *const ctx)
+{
+	struct payload_buffer *const journal = hal_store_map_blob_value(
+		ctx->store,
+		KNOWN_BUNDLE_JOURNAL_KEY
+	);
+	const uint64_t start_ms = hal_time_get_timestamp_ms();
+	struct known_bundle_list *last_known = NULL, *last_pending = NULL;
+	struct known_bundle_journal_record record;
+	size_t pos = 0, consumed, fragment_count = 0;
+
+	if (journal == NULL)
+		return;
+	while ((consumed = known_bundle_journal_decode(
+			&journal->data[pos],
+			journal->length - pos,
+			&record)) != 0) {
+		pos += consumed;
+
+		struct known_bundle_list *const entry = (
+			record.deadline_ms >= start_ms
+			? malloc(sizeof(struct known_bundle_list))
+			: NULL
+		);
+
+		if (!entry) {
+			bundle_free_unique_identifier(&record.id);
+			continue;
+		}
+		entry->id = record.id;
+		entry->deadline_ms = record.deadline_ms;
+		if (record.type == KNOWN_BUNDLE_JOURNAL_DELIVERED) {
+			known_bundle_list_insert(&ctx->known_bundle_list,
+						 last_known, entry);
+			last_known = entry;
+			ctx->known_bundle_count++;
+		} else {
+			known_bundle_list_insert(&ctx->reassembly_pending,
+						 last_pending, entry);
+			last_pending = entry;
+			fragment_count++;
+		}
+	}
+	// The last record may have been interrupted by the shutdown.
+	if (pos != journal->length)
+		LOG_WARN("BundleProcessor: Discarding incomplete known bundle journal records");
+	payload_buffer_put(journal);
+	known_bundle_list_trim(ctx);
+
+	LOGF_INFO(
+		"BundleProcessor: Recovered %lu known bundles and %lu fragments in %lu ms",
+		(unsigned long)ctx->known_bundle_count,
+		(unsigned long)fragment_count,
+		(unsigned long)(hal_time_get_timestamp_ms() - start_ms)
+	);
+	compact_known_bundles(ctx);
+}
 #endif
 
 static void handle_contact_over(
 	const struct bp_context *const ctx, struct contact *contact)
 {
+	struct resched_batch batch = { .ctx = ctx };
+
 	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
-	// NOTE: May invoke router via bundle_dangling!
+	#ifdef ROUTER_PEERS
+	router_peers_contact_over(contact);
+	#endif // ROUTER_PEERS
 	routing_table_contact_passed(
 		contact,
 		(struct rescheduling_handle) {
 			.reschedule_func = bundle_resched_func,
-			.reschedule_func_context = ctx,
+			.reschedule_func_context = &batch,
 		}
 	);
+	resched_batch_route(&batch);
 	hal_semaphore_release(ctx->cm_param.semaphore);
+	resched_batch_finish(&batch);
 }
 
 /* BUNDLE HANDLING */
@@ -487,6 +938,11 @@ static enum ud3tn_result bundle_dispatch(
 		LOGF_INFO("BundleProcessor: Bundle %p persisted", bundle);
 	};
 
+	#ifdef ROUTING_EPIDEMIC
+	// Announced to peers so that they do not send it again
+	router_epidemic_record_known(bundle);
+	#endif // ROUTING_EPIDEMIC
+
 	enum ud3tn_result deliver_result = UD3TN_FAIL;
 
 	if (bundle_endpoint_is_local(ctx, bundle)) {
@@ -599,7 +1055,7 @@ static void bundle_forwarding_failed(
 			bundle
 		);
 		hal_store_bundle_metadata(ctx->store, bundle);
-		bundle_free(bundle);
+		bundle_release_to_store(ctx, bundle);
 	}
 }
 
@@ -723,7 +1179,7 @@ static void bundle_deliver_local(
 					bundle->source,
 					bundle->destination
 				);
-				bundle_free(bundle);
+				bundle_release_to_store(ctx, bundle);
 				return;
 			}
 		}
@@ -732,8 +1188,12 @@ static void bundle_deliver_local(
 
 	bundle_rem_rc(bundle, BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING, 0, ctx->store);
 
+	// Fragments kept for reassembly before a restart have been recorded
+	// as known already, but still have to be reassembled.
+	const bool resumed = bundle_take_reassembly_pending(ctx, bundle);
+
 	/* Check and record knowledge of bundle */
-	if (bundle_record_add_and_check_known(ctx, bundle)) {
+	if (!resumed && bundle_record_add_and_check_known(ctx, bundle)) {
 		LOGF_DEBUG(
 			"BundleProcessor: Bundle %p was already delivered, dropping.",
 			bundle
@@ -775,13 +1235,27 @@ static void bundle_deliver_local(
 				bundle->destination
 			);
 			hal_store_bundle_metadata(ctx->store, bundle);
-			bundle_free(bundle);
+			bundle_release_to_store(ctx, bundle);
 			return;
 		}
 	}
 
 	if (HAS_FLAG(bundle->proc_flags, BUNDLE_FLAG_IS_FRAGMENT)) {
 		bundle_add_rc(bundle, BUNDLE_RET_CONSTRAINT_REASSEMBLY_PENDING, ctx->store);
+		#ifdef ARCHIPEL_CORE
+		if (!resumed) {
+			struct bundle_unique_identifier id =
+				bundle_get_unique_identifier(bundle);
+
+			journal_known_bundle(
+				ctx,
+				KNOWN_BUNDLE_JOURNAL_FRAGMENT,
+				&id,
+				bundle_get_expiration_time_ms(bundle)
+			);
+			bundle_free_unique_identifier(&id);
+		}
+		#endif
 		bundle_attempt_reassembly(ctx, bundle);
 	} else {
 		struct bundle_adu adu = bundle_to_adu(bundle);
@@ -868,18 +1342,20 @@ static void try_reassemble(
 	// Reassemble by memcpy
 	b = e->bundle_list->bundle;
 	const size_t adu_length = b->total_adu_length;
-	uint8_t *const payload = malloc(adu_length);
+	struct payload_buffer *const buffer = payload_buffer_create(adu_length);
 	bool added_as_known = false;
 
-	if (!payload) {
+	if (!buffer) {
 		LOG_ERROR("BundleProcessor: Cannot allocate reassembly buffer!");
 		return; // currently not enough memory to reassemble
 	}
 
+	uint8_t *const payload = buffer->data;
 	struct bundle_adu adu = bundle_adu_init(b);
 
 	adu.payload = payload;
 	adu.length = adu_length;
+	adu.payload_buffer = buffer;
 
 	pos_in_bundle = 0;
 	for (eb = e->bundle_list; eb; eb = eb->next) {
@@ -942,6 +1418,7 @@ static void bundle_attempt_reassembly(
 			ctx->store
 		);
 		bundle_discard(ctx->store, bundle);
+		return;
 	}
 
 	// Find bundle
@@ -1009,13 +1486,18 @@ static void bundle_deliver_adu(const struct bp_context *const ctx, struct bundle
 			);
 
 			// Remove the record-specific bytes from the ADU so
-			// only the BPDU remains.
+			// only the BPDU remains. A payload held in a buffer
+			// may be shared with other bundles (e.g. fragments),
+			// thus, only move the view in that case.
 			adu.length = adu.length - bytes_to_skip;
-			memmove(
-				adu.payload,
-				adu.payload + bytes_to_skip,
-				adu.length
-			);
+			if (adu.payload_buffer != NULL)
+				adu.payload += bytes_to_skip;
+			else
+				memmove(
+					adu.payload,
+					adu.payload + bytes_to_skip,
+					adu.length
+				);
 			adu.proc_flags = BUNDLE_FLAG_ADMINISTRATIVE_RECORD;
 
 			const char *agent_id = (
@@ -1105,28 +1587,6 @@ static void bundle_handle_custody_signal(
 	(void)signal;
 }
 
-/* RE-SCHEDULING */
-static void bundle_dangling(
-	const struct bp_context *const ctx, struct bundle *bundle)
-{
-	uint8_t resched = (FAILED_FORWARD_POLICY == POLICY_TRY_RE_SCHEDULE);
-
-	if (!resched) {
-		LOGF_INFO(
-			"BundleProcessor: Deleting bundle %p: Forwarding failed and policy indicates to drop it.",
-			bundle
-		);
-		bundle_delete(
-			ctx,
-			bundle,
-			BUNDLE_SR_REASON_TRANSMISSION_CANCELED
-		);
-	/* Send it to the router task again after evaluating policy. */
-	} else {
-		send_bundle(ctx, bundle);
-	}
-}
-
 /* HELPERS */
 
 static void send_status_report(
@@ -1187,6 +1647,8 @@ static inline const char *get_router_status_str(
 	switch (result) {
 	case ROUTER_RESULT_OK:
 		return "Success";
+	case ROUTER_RESULT_COPIED:
+		return "Copies Queued";
 	case ROUTER_RESULT_NO_ROUTE:
 		return "No Route Found";
 	case ROUTER_RESULT_NO_MEMORY:
@@ -1199,22 +1661,19 @@ static inline const char *get_router_status_str(
 	}
 }
 
-static enum ud3tn_result send_bundle(
-	const struct bp_context *const ctx, struct bundle *bundle)
+static enum ud3tn_result handle_route_result(
+	const struct bp_context *const ctx, struct bundle *bundle,
+	enum router_result_status result)
 {
-	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
-
-	enum router_result_status result = router_route_bundle(bundle);
-
-	hal_semaphore_release(ctx->cm_param.semaphore);
-
-	if (result == ROUTER_RESULT_OK) {
-		/* 5.4-4 */
-		/* We do not accept custody -> only inform CM */
-		wake_up_contact_manager(
-			ctx->cm_param.control_queue,
-			CM_SIGNAL_PROCESS_CURRENT_BUNDLES
-		);
+	if (result == ROUTER_RESULT_OK || result == ROUTER_RESULT_COPIED) {
+		#ifdef ROUTING_SPRAY_AND_WAIT
+		// The copy budget left has been updated by the router
+		if (hal_store_bundle_metadata(ctx->store, bundle) != UD3TN_OK)
+			LOGF_ERROR("BundleProcessor: Failed to save bundle %p metadata", bundle);
+		#endif // ROUTING_SPRAY_AND_WAIT
+		// Routed again when restored from the store
+		if (result == ROUTER_RESULT_COPIED)
+			bundle_release_to_store(ctx, bundle);
 		return UD3TN_OK;
 	}
 
@@ -1235,6 +1694,62 @@ static enum ud3tn_result send_bundle(
 	return UD3TN_FAIL;
 }
 
+#if defined(ARCHIPEL_CORE) && CONTACT_PRESTAGE_READ_AHEAD
+// Reads the payload of a bundle queued for a contact which has been
+// pre-staged but not started yet ahead from the store, so that it can be
+// sent right away when the contact starts.
+static void read_ahead_prestaged_payload(const struct bundle *bundle)
+{
+	const struct bundle_block *const payload = bundle->payload_block;
+	const struct routed_bundle_list *entry;
+
+	if (payload == NULL || payload->buffer == NULL)
+		return;
+	for (entry = bundle->routed_entries; entry != NULL;
+	     entry = entry->next_for_bundle) {
+		// Bundles are only queued for contacts
+		const struct contact *const contact = (const struct contact *)(
+			(const char *)entry->queue -
+			offsetof(struct contact, contact_bundles)
+		);
+
+		if (contact->prestaged && !contact->active) {
+			payload_buffer_prefetch(
+				payload->buffer,
+				payload->data,
+				payload->length
+			);
+			return;
+		}
+	}
+}
+#endif // ARCHIPEL_CORE && CONTACT_PRESTAGE_READ_AHEAD
+
+static enum ud3tn_result send_bundle(
+	const struct bp_context *const ctx, struct bundle *bundle)
+{
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+
+	enum router_result_status result = router_route_bundle(bundle);
+
+	#if defined(ARCHIPEL_CORE) && CONTACT_PRESTAGE_READ_AHEAD
+	if (result == ROUTER_RESULT_OK)
+		read_ahead_prestaged_payload(bundle);
+	#endif // ARCHIPEL_CORE && CONTACT_PRESTAGE_READ_AHEAD
+	hal_semaphore_release(ctx->cm_param.semaphore);
+
+	if (handle_route_result(ctx, bundle, result) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	/* 5.4-4 */
+	/* We do not accept custody -> only inform CM */
+	wake_up_contact_manager(
+		ctx->cm_param.control_queue,
+		CM_SIGNAL_PROCESS_CURRENT_BUNDLES
+	);
+	return UD3TN_OK;
+}
+
 /**
  * 4.3.4. Hop Count (BPv7-bis)
  *
@@ -1275,10 +1790,9 @@ static bool hop_count_validation(struct bundle *bundle)
 	hop_count.count++;
 
 	/* CBOR-encoding */
-	uint8_t *buffer = malloc(BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE);
-
 	/* Out of memory - validation passes none the less */
-	if (buffer == NULL) {
+	if (bundle_block_alloc_data(block,
+			BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE) != UD3TN_OK) {
 		LOGF_WARN(
 			"BundleProcessor: Could not increment hop-count of bundle %p.",
 			bundle
@@ -1286,11 +1800,8 @@ static bool hop_count_validation(struct bundle *bundle)
 		return true;
 	}
 
-	free(block->data);
-
-	block->data = buffer;
 	block->length = bundle7_hop_count_serialize(&hop_count,
-		buffer, BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE);
+		block->data, BUNDLE7_HOP_COUNT_MAX_ENCODED_SIZE);
 
 	return true;
 }
@@ -1320,6 +1831,20 @@ static const char *get_agent_id(const struct bp_context *const ctx, const char *
 	return &dest_eid[local_len + 1];
 }
 
+// Forgets the bundles expiring first if more than the configured maximum
+// number of bundles are known.
+static void known_bundle_list_trim(struct bp_context *const ctx)
+{
+	while (ctx->known_bundle_count > KNOWN_BUNDLE_LIST_MAX_LENGTH) {
+		struct known_bundle_list *const e = ctx->known_bundle_list;
+
+		ctx->known_bundle_list = e->next;
+		bundle_free_unique_identifier(&e->id);
+		free(e);
+		ctx->known_bundle_count--;
+	}
+}
+
 // Checks whether we know the bundle. If not, adds it to the list.
 static bool bundle_record_add_and_check_known(
 	struct bp_context *const ctx, const struct bundle *bundle)
@@ -1342,6 +1867,7 @@ static bool bundle_record_add_and_check_known(
 			*cur_entry = e->next;
 			bundle_free_unique_identifier(&e->id);
 			free(e);
+			ctx->known_bundle_count--;
 			continue;
 		} else if (e->deadline_ms > bundle_deadline_ms) {
 			// Won't find, insert here!
@@ -1361,6 +1887,17 @@ static bool bundle_record_add_and_check_known(
 	new_entry->deadline_ms = bundle_deadline_ms;
 	new_entry->next = *cur_entry;
 	*cur_entry = new_entry;
+	ctx->known_bundle_count++;
+
+	#ifdef ARCHIPEL_CORE
+	journal_known_bundle(
+		ctx,
+		KNOWN_BUNDLE_JOURNAL_DELIVERED,
+		&new_entry->id,
+		bundle_deadline_ms
+	);
+	#endif
+	known_bundle_list_trim(ctx);
 
 	return false;
 }
@@ -1418,7 +1955,96 @@ static void bundle_add_reassembled_as_known(
 	new_entry->deadline_ms = bundle_deadline_ms;
 	new_entry->next = *cur_entry;
 	*cur_entry = new_entry;
+	ctx->known_bundle_count++;
+
+	#ifdef ARCHIPEL_CORE
+	journal_known_bundle(
+		ctx,
+		KNOWN_BUNDLE_JOURNAL_DELIVERED,
+		&new_entry->id,
+		bundle_deadline_ms
+	);
+	#endif
+	known_bundle_list_trim(ctx);
+}
+
+// Removes the fragment from the ones kept for reassembly before the last
+// shutdown. Returns false if it is not one of them.
+static bool bundle_take_reassembly_pending(
+	struct bp_context *const ctx, const struct bundle *bundle)
+{
+	struct known_bundle_list **cur_entry = &ctx->reassembly_pending;
+
+	if (!HAS_FLAG(bundle->proc_flags, BUNDLE_FLAG_IS_FRAGMENT))
+		return false;
+	while (*cur_entry != NULL) {
+		struct known_bundle_list *e = *cur_entry;
+
+		if (bundle_is_equal(bundle, &e->id)) {
+			*cur_entry = e->next;
+			bundle_free_unique_identifier(&e->id);
+			free(e);
+			return true;
+		}
+		cur_entry = &(*cur_entry)->next;
+	}
+	return false;
+}
+
+#if defined(ROUTING_EPIDEMIC) || defined(ROUTING_PROPHET)
+// Returns a copy of the EID of the node of the active contact using the given
+// CLA address, or NULL if there is none.
+static char *get_active_node_eid(
+	const struct bp_context *const ctx, const char *peer_cla_addr)
+{
+	struct contact_list *c;
+	char *node_eid = NULL;
+
+	if (peer_cla_addr == NULL)
+		return NULL;
+
+	hal_semaphore_take_blocking(ctx->cm_param.semaphore);
+	for (c = *routing_table_get_raw_contact_list_ptr(); c; c = c->next) {
+		if (c->data->active && c->data->node->cla_addr != NULL &&
+		    strcmp(c->data->node->cla_addr, peer_cla_addr) == 0) {
+			node_eid = strdup(c->data->node->eid);
+			break;
+		}
+	}
+	hal_semaphore_release(ctx->cm_param.semaphore);
+	return node_eid;
+}
+
+// Sends the state of the router, i.e., the summary vector of the known
+// bundles or the delivery predictabilities of this node, to the node reached
+// via the new link, which then knows which bundles to send here.
+static void send_router_state(
+	const struct bp_context *const ctx, const char *peer_cla_addr)
+{
+	char *const node_eid = get_active_node_eid(ctx, peer_cla_addr);
+
+	if (node_eid == NULL)
+		return;
+
+	struct bundle *const b = exchange_agent_create_bundle(node_eid);
+
+	if (b == NULL) {
+		LOGF_WARN(
+			"BundleProcessor: Could not create router state for \"%s\"",
+			node_eid
+		);
+	} else {
+		LOGF_DEBUG(
+			"BundleProcessor: Sending router state to \"%s\"",
+			node_eid
+		);
+		bundle_add_rc(b, BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING,
+			      ctx->store);
+		bundle_forward(ctx, b);
+	}
+	free(node_eid);
 }
+#endif // ROUTING_EPIDEMIC || ROUTING_PROPHET
 
 // Interaction with CM / RT
 
@@ -1436,9 +2062,83 @@ static void wake_up_contact_manager(QueueIdentifier_t cm_queue,
 	}
 }
 
+/* RE-SCHEDULING */
+
 static void bundle_resched_func(struct bundle *bundle, const void *ctx)
 {
-	const struct bp_context *bp_context = ctx;
+	// The batch is owned by the caller of the routing table function
+	struct resched_batch *const batch = (struct resched_batch *)ctx;
+
+	if (batch->count == batch->capacity) {
+		const size_t capacity = batch->capacity ? batch->capacity * 2 : 16;
+		struct bundle **const bundles = realloc(
+			batch->bundles,
+			capacity * sizeof(struct bundle *)
+		);
+		enum router_result_status *const results = (
+			bundles != NULL
+			? realloc(batch->results,
+				  capacity * sizeof(enum router_result_status))
+			: NULL
+		);
+
+		if (bundles != NULL)
+			batch->bundles = bundles;
+		// Status reports cannot be sent while the routing table is
+		// modified, the bundle is left to the store to be restored.
+		if (results == NULL) {
+			LOGF_WARN(
+				"BundleProcessor: Cannot re-schedule bundle %p, keeping it in store only.",
+				bundle
+			);
+			bundle_release_to_store(batch->ctx, bundle);
+			return;
+		}
+		batch->results = results;
+		batch->capacity = capacity;
+	}
+	batch->bundles[batch->count++] = bundle;
+}
+
+/* Has to be called with the semaphore of the contact manager taken. */
+static void resched_batch_route(struct resched_batch *batch)
+{
+	if (FAILED_FORWARD_POLICY != POLICY_TRY_RE_SCHEDULE ||
+	    batch->count == 0)
+		return;
+	router_route_bundles(batch->bundles, batch->count, batch->results);
+}
+
+static void resched_batch_finish(struct resched_batch *batch)
+{
+	const struct bp_context *const ctx = batch->ctx;
+	bool routed = false;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		struct bundle *const bundle = batch->bundles[i];
 
-	bundle_dangling(bp_context, bundle);
+		if (FAILED_FORWARD_POLICY != POLICY_TRY_RE_SCHEDULE) {
+			LOGF_INFO(
+				"BundleProcessor: Deleting bundle %p: Forwarding failed and policy indicates to drop it.",
+				bundle
+			);
+			bundle_delete(
+				ctx,
+				bundle,
+				BUNDLE_SR_REASON_TRANSMISSION_CANCELED
+			);
+		} else if (handle_route_result(ctx, bundle,
+					       batch->results[i]) == UD3TN_OK) {
+			routed = true;
+		}
+	}
+
+	// The contact manager is woken up once for the whole batch
+	if (routed)
+		wake_up_contact_manager(
+			ctx->cm_param.control_queue,
+			CM_SIGNAL_PROCESS_CURRENT_BUNDLES
+		);
+	free(batch->bundles);
+	free(batch->results);
 }
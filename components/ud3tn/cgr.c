@@ -0,0 +1,672 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/cgr.h"
+#include "ud3tn/common.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/node.h"
+#include "ud3tn/routing_table.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_time.h"
+
+#include "util/htab_hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CGR_LOCAL_NODE 0
+#define CGR_NO_NODE UINT32_MAX
+#define CGR_NO_EDGE UINT32_MAX
+
+// Identifies an edge of the graph across rebuilds
+struct cgr_edge_key {
+	const struct contact *contact;
+	uint64_t from_ms;
+	uint64_t to_ms;
+	// Hash of the sender EID, zero for the local node
+	uint32_t sender_hash;
+	// Hash of the EIDs of all nodes the edge delivers to
+	uint32_t receiver_hash;
+};
+
+struct cgr_edge {
+	struct cgr_edge_key key;
+	uint32_t sender;
+	// Range in the reachable array, the first entry is the receiver
+	uint32_t reachable_offset;
+	uint32_t reachable_count;
+};
+
+struct cgr_heap_entry {
+	uint64_t arrival_ms;
+	uint32_t node;
+};
+
+struct cgr_graph {
+	// EID -> node number, the local node is not contained
+	struct hashmap node_index;
+	uint32_t node_count;
+	// Ordered by sender, outgoing edges of node n are in the range
+	// [out_offsets[n], out_offsets[n + 1])
+	struct cgr_edge *edges;
+	uint32_t edge_count;
+	uint32_t *out_offsets;
+	uint32_t *reachable;
+	// Edge keys ordered by contact and sender for lookups
+	struct cgr_edge_key *keys;
+
+	// Working memory of the search
+	uint64_t *arrival_ms;
+	uint32_t *pred_edge;
+	uint8_t *excluded;
+	struct cgr_heap_entry *heap;
+};
+
+struct cgr_route {
+	struct contact *first_hop;
+	uint64_t arrival_ms;
+	// End of the first contact of the route that ends
+	uint64_t valid_until_ms;
+	uint32_t hop_count;
+	struct cgr_edge_key *hops;
+};
+
+struct cgr_cache_entry {
+	char *destination;
+	struct cgr_cache_entry *prev;
+	struct cgr_cache_entry *next;
+	uint8_t route_count;
+	struct cgr_route routes[CGR_MAX_ROUTES];
+};
+
+static struct cgr_graph graph;
+static bool graph_valid;
+static uint32_t graph_generation;
+
+/* Node ID -> struct cgr_cache_entry */
+static struct hashmap route_cache;
+static struct cgr_cache_entry *cache_entries;
+static bool initialized;
+
+/* GRAPH */
+
+static uint32_t eid_hash(const char *eid, uint32_t initval)
+{
+	const uint32_t hash = hashlittle(eid, strlen(eid), initval);
+
+	return hash != 0 ? hash : 1;
+}
+
+static uint32_t endpoint_list_length(const struct endpoint_list *el)
+{
+	uint32_t length = 0;
+
+	for (; el != NULL; el = el->next)
+		length++;
+	return length;
+}
+
+static uint32_t get_node_number(struct cgr_graph *g, const char *eid)
+{
+	void *const value = hashmap_get(&g->node_index, eid);
+
+	if (value != NULL)
+		return (uint32_t)(uintptr_t)value;
+	if (hashmap_put(&g->node_index, eid,
+			(void *)(uintptr_t)g->node_count) != UD3TN_OK)
+		return CGR_NO_NODE;
+	return g->node_count++;
+}
+
+static int compare_edges(const void *a, const void *b)
+{
+	const struct cgr_edge *ea = a, *eb = b;
+
+	if (ea->sender != eb->sender)
+		return ea->sender < eb->sender ? -1 : 1;
+	if (ea->key.from_ms != eb->key.from_ms)
+		return ea->key.from_ms < eb->key.from_ms ? -1 : 1;
+	return 0;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+	const struct cgr_edge_key *ka = a, *kb = b;
+	const uintptr_t ca = (uintptr_t)ka->contact;
+	const uintptr_t cb = (uintptr_t)kb->contact;
+
+	if (ca != cb)
+		return ca < cb ? -1 : 1;
+	if (ka->sender_hash != kb->sender_hash)
+		return ka->sender_hash < kb->sender_hash ? -1 : 1;
+	return 0;
+}
+
+static bool graph_contains(const struct cgr_graph *g,
+			   const struct cgr_edge_key *key)
+{
+	const struct cgr_edge_key *const found = bsearch(
+		key,
+		g->keys,
+		g->edge_count,
+		sizeof(struct cgr_edge_key),
+		compare_keys
+	);
+
+	return (
+		found != NULL &&
+		found->from_ms == key->from_ms &&
+		found->to_ms == key->to_ms &&
+		found->receiver_hash == key->receiver_hash
+	);
+}
+
+static void graph_free(struct cgr_graph *g)
+{
+	hashmap_deinit(&g->node_index);
+	free(g->edges);
+	free(g->out_offsets);
+	free(g->reachable);
+	free(g->keys);
+	free(g->arrival_ms);
+	free(g->pred_edge);
+	free(g->excluded);
+	free(g->heap);
+	memset(g, 0, sizeof(struct cgr_graph));
+}
+
+static uint32_t add_reachable(struct cgr_graph *g, uint32_t pos,
+			      const struct endpoint_list *el, uint32_t *hash)
+{
+	for (; el != NULL; el = el->next) {
+		g->reachable[pos++] = get_node_number(g, el->eid);
+		*hash = eid_hash(el->eid, *hash);
+	}
+	return pos;
+}
+
+static void add_edge(struct cgr_graph *g, struct contact *c,
+		     uint32_t sender, const char *sender_eid,
+		     uint32_t reachable_offset, uint32_t reachable_end,
+		     uint32_t receiver_hash)
+{
+	struct cgr_edge *const e = &g->edges[g->edge_count++];
+
+	e->key.contact = c;
+	e->key.from_ms = c->from_ms;
+	e->key.to_ms = c->to_ms;
+	e->key.sender_hash = sender_eid ? eid_hash(sender_eid, 0) : 0;
+	e->key.receiver_hash = receiver_hash;
+	e->sender = sender;
+	e->reachable_offset = reachable_offset;
+	e->reachable_count = reachable_end - reachable_offset;
+}
+
+static enum ud3tn_result graph_build(struct cgr_graph *g, uint64_t now_ms)
+{
+	const struct node_list *nl;
+	const struct contact_list *cl;
+	uint32_t edge_count = 0, reachable_count = 0, pos = 0;
+
+	memset(g, 0, sizeof(struct cgr_graph));
+	hashmap_init(&g->node_index, NODE_HTAB_SLOT_COUNT);
+	g->node_count = 1; // the local node
+
+	for (nl = routing_table_get_node_list(); nl; nl = nl->next) {
+		const uint32_t node_eps = endpoint_list_length(
+			nl->node->endpoints
+		);
+
+		for (cl = nl->node->contacts; cl; cl = cl->next) {
+			const uint32_t eps = node_eps + endpoint_list_length(
+				cl->data->contact_endpoints
+			);
+
+			if (cl->data->to_ms <= now_ms)
+				continue;
+			if (nl->node->cla_addr != NULL) {
+				edge_count++;
+				reachable_count += 1 + eps;
+			} else {
+				// One edge per sender, all sharing the receiver
+				edge_count += eps;
+				reachable_count += 1;
+			}
+		}
+	}
+
+	g->edges = malloc(sizeof(struct cgr_edge) * (edge_count + 1));
+	g->reachable = malloc(sizeof(uint32_t) * (reachable_count + 1));
+	g->keys = malloc(sizeof(struct cgr_edge_key) * (edge_count + 1));
+	if (!g->edges || !g->reachable || !g->keys)
+		goto fail;
+
+	for (nl = routing_table_get_node_list(); nl; nl = nl->next) {
+		const struct node *const node = nl->node;
+		const uint32_t receiver = get_node_number(g, node->eid);
+		const uint32_t node_hash = eid_hash(node->eid, 0);
+
+		if (receiver == CGR_NO_NODE)
+			goto fail;
+
+		for (cl = node->contacts; cl; cl = cl->next) {
+			struct contact *const c = cl->data;
+			const struct endpoint_list *el;
+			uint32_t hash = node_hash;
+			const uint32_t start = pos;
+
+			if (c->to_ms <= now_ms)
+				continue;
+
+			if (node->cla_addr != NULL) {
+				// Local contact, also delivering to all
+				// reachable EIDs
+				g->reachable[pos++] = receiver;
+				pos = add_reachable(g, pos, node->endpoints,
+						    &hash);
+				pos = add_reachable(g, pos,
+						    c->contact_endpoints,
+						    &hash);
+				add_edge(g, c, CGR_LOCAL_NODE, NULL, start, pos,
+					 hash);
+				continue;
+			}
+
+			// Contact of another node, one edge per sender
+			g->reachable[pos++] = receiver;
+			for (el = node->endpoints; el; el = el->next)
+				add_edge(g, c, get_node_number(g, el->eid),
+					 el->eid, start, pos, hash);
+			for (el = c->contact_endpoints; el; el = el->next)
+				add_edge(g, c, get_node_number(g, el->eid),
+					 el->eid, start, pos, hash);
+		}
+	}
+
+	for (uint32_t i = 0; i < pos; i++) {
+		if (g->reachable[i] == CGR_NO_NODE)
+			goto fail;
+	}
+	for (uint32_t i = 0; i < g->edge_count; i++) {
+		if (g->edges[i].sender == CGR_NO_NODE)
+			goto fail;
+	}
+
+	qsort(g->edges, g->edge_count, sizeof(struct cgr_edge),
+	      compare_edges);
+	for (uint32_t i = 0; i < g->edge_count; i++)
+		g->keys[i] = g->edges[i].key;
+	qsort(g->keys, g->edge_count, sizeof(struct cgr_edge_key),
+	      compare_keys);
+
+	g->out_offsets = calloc(g->node_count + 1, sizeof(uint32_t));
+	g->arrival_ms = malloc(sizeof(uint64_t) * g->node_count);
+	g->pred_edge = malloc(sizeof(uint32_t) * g->node_count);
+	g->excluded = calloc(g->edge_count + 1, sizeof(uint8_t));
+	// Every improvement of a node pushes one entry, plus the start
+	g->heap = malloc(sizeof(struct cgr_heap_entry) * (pos + 1));
+	if (!g->out_offsets || !g->arrival_ms || !g->pred_edge ||
+	    !g->excluded || !g->heap)
+		goto fail;
+
+	for (uint32_t i = 0; i < g->edge_count; i++)
+		g->out_offsets[g->edges[i].sender + 1]++;
+	for (uint32_t n = 0; n < g->node_count; n++)
+		g->out_offsets[n + 1] += g->out_offsets[n];
+
+	return UD3TN_OK;
+
+fail:
+	graph_free(g);
+	return UD3TN_FAIL;
+}
+
+/* SEARCH */
+
+static void heap_push(struct cgr_graph *g, uint32_t *size,
+		      uint64_t arrival_ms, uint32_t node)
+{
+	uint32_t i = (*size)++;
+
+	while (i > 0) {
+		const uint32_t parent = (i - 1) / 2;
+
+		if (g->heap[parent].arrival_ms <= arrival_ms)
+			break;
+		g->heap[i] = g->heap[parent];
+		i = parent;
+	}
+	g->heap[i] = (struct cgr_heap_entry){ arrival_ms, node };
+}
+
+static struct cgr_heap_entry heap_pop(struct cgr_graph *g, uint32_t *size)
+{
+	const struct cgr_heap_entry top = g->heap[0];
+	const struct cgr_heap_entry last = g->heap[--(*size)];
+	uint32_t i = 0;
+
+	for (;;) {
+		uint32_t child = 2 * i + 1;
+
+		if (child >= *size)
+			break;
+		if (child + 1 < *size &&
+		    g->heap[child + 1].arrival_ms < g->heap[child].arrival_ms)
+			child++;
+		if (last.arrival_ms <= g->heap[child].arrival_ms)
+			break;
+		g->heap[i] = g->heap[child];
+		i = child;
+	}
+	g->heap[i] = last;
+	return top;
+}
+
+// Earliest-arrival search, as the arrival time over a contact never
+// decreases with the time of arrival at its sender, every node has to be
+// expanded only once. Returns whether the target has been reached, the
+// route is recorded in pred_edge.
+static bool find_route(struct cgr_graph *g, uint32_t target, uint64_t now_ms)
+{
+	uint32_t heap_size = 0;
+
+	for (uint32_t n = 0; n < g->node_count; n++) {
+		g->arrival_ms[n] = UINT64_MAX;
+		g->pred_edge[n] = CGR_NO_EDGE;
+	}
+	g->arrival_ms[CGR_LOCAL_NODE] = now_ms;
+	heap_push(g, &heap_size, now_ms, CGR_LOCAL_NODE);
+
+	while (heap_size != 0) {
+		const struct cgr_heap_entry cur = heap_pop(g, &heap_size);
+
+		// Outdated entry, the node has been reached earlier
+		if (cur.arrival_ms != g->arrival_ms[cur.node])
+			continue;
+		if (cur.node == target)
+			return true;
+
+		for (uint32_t i = g->out_offsets[cur.node];
+		     i < g->out_offsets[cur.node + 1]; i++) {
+			const struct cgr_edge *const e = &g->edges[i];
+			const uint64_t arrival_ms = MAX(
+				e->key.from_ms,
+				cur.arrival_ms
+			);
+
+			if (g->excluded[i] || e->key.to_ms <= cur.arrival_ms)
+				continue;
+
+			for (uint32_t r = 0; r < e->reachable_count; r++) {
+				const uint32_t n = g->reachable[
+					e->reachable_offset + r
+				];
+
+				if (arrival_ms >= g->arrival_ms[n])
+					continue;
+				g->arrival_ms[n] = arrival_ms;
+				g->pred_edge[n] = i;
+				heap_push(g, &heap_size, arrival_ms, n);
+			}
+		}
+	}
+	return false;
+}
+
+// Records the route found by find_route(), returns the first-hop edge
+static uint32_t record_route(const struct cgr_graph *g, uint32_t target,
+			     struct cgr_route *route)
+{
+	uint32_t hop_count = 0, edge;
+
+	for (edge = g->pred_edge[target]; edge != CGR_NO_EDGE;
+	     edge = g->pred_edge[g->edges[edge].sender])
+		hop_count++;
+
+	route->hops = malloc(sizeof(struct cgr_edge_key) * hop_count);
+	if (route->hops == NULL)
+		return CGR_NO_EDGE;
+	route->hop_count = hop_count;
+	route->arrival_ms = g->arrival_ms[target];
+	route->valid_until_ms = UINT64_MAX;
+
+	uint32_t first_hop = CGR_NO_EDGE;
+
+	for (edge = g->pred_edge[target]; edge != CGR_NO_EDGE;
+	     edge = g->pred_edge[g->edges[edge].sender]) {
+		route->hops[--hop_count] = g->edges[edge].key;
+		route->valid_until_ms = MIN(
+			route->valid_until_ms,
+			g->edges[edge].key.to_ms
+		);
+		first_hop = edge;
+	}
+	route->first_hop = (struct contact *)g->edges[first_hop].key.contact;
+	return first_hop;
+}
+
+/* ROUTE CACHE */
+
+static void cache_remove(struct cgr_cache_entry *entry)
+{
+	hashmap_remove(&route_cache, entry->destination);
+	if (entry->prev != NULL)
+		entry->prev->next = entry->next;
+	else
+		cache_entries = entry->next;
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
+	for (uint8_t i = 0; i < entry->route_count; i++)
+		free(entry->routes[i].hops);
+	free(entry->destination);
+	free(entry);
+}
+
+static void cache_clear(void)
+{
+	while (cache_entries != NULL)
+		cache_remove(cache_entries);
+}
+
+// Drops all routes that could have changed between the two graphs
+static void cache_update(const struct cgr_graph *old_graph,
+			 const struct cgr_graph *new_graph)
+{
+	struct cgr_cache_entry *entry, *next;
+	uint64_t min_new_from_ms = UINT64_MAX;
+
+	if (old_graph == NULL) {
+		cache_clear();
+		return;
+	}
+
+	// A new contact can only improve routes arriving after it starts
+	for (uint32_t i = 0; i < new_graph->edge_count; i++) {
+		if (!graph_contains(old_graph, &new_graph->keys[i]))
+			min_new_from_ms = MIN(
+				min_new_from_ms,
+				new_graph->keys[i].from_ms
+			);
+	}
+
+	for (entry = cache_entries; entry != NULL; entry = next) {
+		bool valid = true;
+
+		next = entry->next;
+		if (min_new_from_ms != UINT64_MAX) {
+			const uint64_t latest_arrival_ms = (
+				entry->route_count == CGR_MAX_ROUTES
+				? entry->routes[CGR_MAX_ROUTES - 1].arrival_ms
+				: UINT64_MAX
+			);
+
+			valid = latest_arrival_ms <= min_new_from_ms;
+		}
+		for (uint8_t r = 0; valid && r < entry->route_count; r++) {
+			const struct cgr_route *const route = &entry->routes[r];
+
+			for (uint32_t h = 0; valid && h < route->hop_count; h++)
+				valid = graph_contains(new_graph,
+						       &route->hops[h]);
+		}
+		if (!valid)
+			cache_remove(entry);
+	}
+}
+
+static struct cgr_cache_entry *compute_routes(
+	const char *destination, uint32_t target, uint64_t now_ms)
+{
+	struct cgr_cache_entry *entry;
+	uint32_t first_hops[CGR_MAX_ROUTES];
+
+	if (hashmap_count(&route_cache) >= CGR_ROUTE_CACHE_SIZE)
+		cache_clear();
+
+	entry = malloc(sizeof(struct cgr_cache_entry));
+	if (entry == NULL)
+		return NULL;
+	entry->destination = strdup(destination);
+	entry->route_count = 0;
+	if (entry->destination == NULL) {
+		free(entry);
+		return NULL;
+	}
+
+	while (entry->route_count < CGR_MAX_ROUTES &&
+	       find_route(&graph, target, now_ms)) {
+		const uint32_t first_hop = record_route(
+			&graph,
+			target,
+			&entry->routes[entry->route_count]
+		);
+
+		if (first_hop == CGR_NO_EDGE)
+			break;
+		// Find an alternative via a different first hop next
+		graph.excluded[first_hop] = 1;
+		first_hops[entry->route_count++] = first_hop;
+	}
+	for (uint8_t i = 0; i < entry->route_count; i++)
+		graph.excluded[first_hops[i]] = 0;
+
+	if (hashmap_put(&route_cache, destination, entry) != UD3TN_OK) {
+		for (uint8_t i = 0; i < entry->route_count; i++)
+			free(entry->routes[i].hops);
+		free(entry->destination);
+		free(entry);
+		return NULL;
+	}
+	entry->prev = NULL;
+	entry->next = cache_entries;
+	if (cache_entries != NULL)
+		cache_entries->prev = entry;
+	cache_entries = entry;
+	return entry;
+}
+
+static bool cache_entry_expired(const struct cgr_cache_entry *entry,
+				uint64_t now_ms)
+{
+	for (uint8_t i = 0; i < entry->route_count; i++) {
+		if (entry->routes[i].valid_until_ms <= now_ms)
+			return true;
+	}
+	return false;
+}
+
+static void update_graph(uint64_t now_ms)
+{
+	const uint32_t generation = routing_table_get_generation();
+	struct cgr_graph new_graph;
+
+	if (graph_valid && generation == graph_generation)
+		return;
+
+	if (graph_build(&new_graph, now_ms) != UD3TN_OK) {
+		LOG_ERROR("CGR: Failed to build contact graph");
+		cache_clear();
+		graph_free(&graph);
+		graph_valid = false;
+		return;
+	}
+	cache_update(graph_valid ? &graph : NULL, &new_graph);
+	graph_free(&graph);
+	graph = new_graph;
+	graph_valid = true;
+	graph_generation = generation;
+	LOGF_DEBUG(
+		"CGR: Contact graph updated (%lu nodes, %lu edges, %lu cached destinations)",
+		(unsigned long)graph.node_count,
+		(unsigned long)graph.edge_count,
+		(unsigned long)hashmap_count(&route_cache)
+	);
+}
+
+struct contact_list *cgr_lookup_first_hops(
+	const char *destination, uint64_t deadline_ms)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	char *const node_id = get_node_id(destination);
+	struct contact_list *result = NULL, **next = &result;
+	struct cgr_cache_entry *entry;
+	const char *key = node_id;
+	void *target;
+
+	if (!initialized) {
+		hashmap_init(&route_cache, CGR_ROUTE_CACHE_SIZE);
+		initialized = true;
+	}
+	update_graph(now_ms);
+	if (!graph_valid)
+		goto finish;
+
+	// Fallback: perform a "dumb" string lookup
+	target = key ? hashmap_get(&graph.node_index, key) : NULL;
+	if (target == NULL) {
+		key = destination;
+		target = hashmap_get(&graph.node_index, key);
+		if (target == NULL)
+			goto finish;
+	}
+
+	entry = hashmap_get(&route_cache, key);
+	if (entry != NULL && cache_entry_expired(entry, now_ms)) {
+		cache_remove(entry);
+		entry = NULL;
+	}
+	if (entry == NULL)
+		entry = compute_routes(key, (uint32_t)(uintptr_t)target,
+				       now_ms);
+	if (entry == NULL)
+		goto finish;
+
+	for (uint8_t i = 0; i < entry->route_count; i++) {
+		if (entry->routes[i].arrival_ms >= deadline_ms)
+			break;
+		*next = malloc(sizeof(struct contact_list));
+		if (*next == NULL)
+			break;
+		(*next)->data = entry->routes[i].first_hop;
+		(*next)->next = NULL;
+		next = &(*next)->next;
+	}
+
+finish:
+	free(node_id);
+	return result;
+}
+
+void cgr_free(void)
+{
+	if (!initialized)
+		return;
+	cache_clear();
+	hashmap_deinit(&route_cache);
+	graph_free(&graph);
+	graph_valid = false;
+	initialized = false;
+}
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/contact_index.h"
+#include "ud3tn/node.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct contact_index_lane {
+	// The list entry this lane node refers to
+	struct contact_list *entry;
+	struct contact_index_lane *next[];
+};
+
+static inline uint64_t key_of(const struct contact_index *index,
+			      const struct contact_list *entry)
+{
+	return index->order_by_from ? entry->data->from_ms : entry->data->to_ms;
+}
+
+// Compares the entry to the given time and sequence number of a contact:
+// contacts with the same time are ordered by their creation.
+static inline int compare(const struct contact_index *index,
+			  const struct contact_list *entry,
+			  uint64_t time_ms, uint64_t sequence_number)
+{
+	const uint64_t key = key_of(index, entry);
+	const uint64_t seq = entry->data->sequence_number;
+
+	if (key != time_ms)
+		return key < time_ms ? -1 : 1;
+	if (seq != sequence_number)
+		return seq < sequence_number ? -1 : 1;
+	return 0;
+}
+
+static inline struct contact_index_lane **lane_slot(
+	struct contact_index *index, struct contact_index_lane *prev,
+	uint8_t level)
+{
+	return prev != NULL ? &prev->next[level] : &index->head[level];
+}
+
+// Every level is used with a probability of 1/4 of the one below.
+static uint8_t random_level(void)
+{
+	static uint32_t state = 0x2545F491;
+	uint32_t bits;
+	uint8_t level = 0;
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	bits = state;
+	while (level < CONTACT_INDEX_MAX_LEVEL && (bits & 3) == 0) {
+		level++;
+		bits >>= 2;
+	}
+	return level;
+}
+
+void contact_index_init(struct contact_index *index,
+			struct contact_list **list, bool order_by_from)
+{
+	ASSERT(list != NULL && *list == NULL);
+	index->list = list;
+	for (uint8_t l = 0; l < CONTACT_INDEX_MAX_LEVEL; l++)
+		index->head[l] = NULL;
+	index->level = 0;
+	index->order_by_from = order_by_from;
+}
+
+void contact_index_free(struct contact_index *index)
+{
+	struct contact_index_lane *lane = index->head[0], *next_lane;
+	struct contact_list *entry = *index->list, *next;
+
+	// Every lane node is linked into the lowest lane
+	while (lane != NULL) {
+		next_lane = lane->next[0];
+		free(lane);
+		lane = next_lane;
+	}
+	while (entry != NULL) {
+		next = entry->next;
+		free(entry);
+		entry = next;
+	}
+	*index->list = NULL;
+	contact_index_init(index, index->list, index->order_by_from);
+}
+
+/*
+ * Determines for every lane the last node before the given time and
+ * sequence number, and returns the slot of the first list entry at or after
+ * them.
+ */
+static struct contact_list **search(
+	const struct contact_index *index, uint64_t time_ms,
+	uint64_t sequence_number, struct contact_index_lane **update)
+{
+	struct contact_index_lane *prev = NULL, *next;
+	struct contact_list **slot;
+
+	for (int l = index->level - 1; l >= 0; l--) {
+		next = prev != NULL ? prev->next[l] : index->head[l];
+		while (next != NULL && compare(index, next->entry, time_ms,
+					       sequence_number) < 0) {
+			prev = next;
+			next = prev->next[l];
+		}
+		if (update != NULL)
+			update[l] = prev;
+	}
+	slot = prev != NULL ? &prev->entry->next : index->list;
+	while (*slot != NULL &&
+	       compare(index, *slot, time_ms, sequence_number) < 0)
+		slot = &(*slot)->next;
+	return slot;
+}
+
+static inline uint64_t time_of(const struct contact_index *index,
+			       const struct contact *contact)
+{
+	return index->order_by_from ? contact->from_ms : contact->to_ms;
+}
+
+bool contact_index_add(struct contact_index *index, struct contact *contact)
+{
+	struct contact_index_lane *update[CONTACT_INDEX_MAX_LEVEL];
+	struct contact_index_lane *lane = NULL;
+	struct contact_list **slot, *entry;
+	const uint8_t level = random_level();
+	uint64_t time_ms, seq;
+
+	ASSERT(contact != NULL);
+	time_ms = time_of(index, contact);
+	seq = contact->sequence_number;
+	slot = search(index, time_ms, seq, update);
+	// Only contacts sharing the sequence number are walked
+	while (*slot != NULL && compare(index, *slot, time_ms, seq) == 0) {
+		if ((*slot)->data == contact)
+			return false;
+		slot = &(*slot)->next;
+	}
+
+	entry = malloc(sizeof(struct contact_list));
+	if (entry == NULL)
+		return false;
+	if (level != 0) {
+		lane = malloc(
+			sizeof(struct contact_index_lane) +
+			level * sizeof(struct contact_index_lane *)
+		);
+		if (lane == NULL) {
+			free(entry);
+			return false;
+		}
+		lane->entry = entry;
+	}
+	entry->data = contact;
+	entry->next = *slot;
+	*slot = entry;
+
+	for (uint8_t l = 0; l < level; l++) {
+		struct contact_index_lane *prev = (
+			l < index->level ? update[l] : NULL
+		);
+		struct contact_index_lane **lslot = lane_slot(index, prev, l);
+
+		while (*lslot != NULL &&
+		       compare(index, (*lslot)->entry, time_ms, seq) == 0)
+			lslot = &(*lslot)->next[l];
+		lane->next[l] = *lslot;
+		*lslot = lane;
+	}
+	if (level > index->level)
+		index->level = level;
+	return true;
+}
+
+static void unlink_lanes(struct contact_index *index,
+			 const struct contact_list *entry, uint64_t time_ms,
+			 struct contact_index_lane **update)
+{
+	const uint64_t seq = entry->data->sequence_number;
+	struct contact_index_lane *lane = NULL;
+
+	for (uint8_t l = 0; l < index->level; l++) {
+		struct contact_index_lane **lslot = lane_slot(
+			index,
+			update != NULL ? update[l] : NULL,
+			l
+		);
+
+		// Without hint, i.e., if the time of the contact has been
+		// changed, all nodes of the lane are checked.
+		while (*lslot != NULL && (*lslot)->entry != entry &&
+		       (update == NULL ||
+			compare(index, (*lslot)->entry, time_ms, seq) == 0))
+			lslot = &(*lslot)->next[l];
+		if (*lslot == NULL || (*lslot)->entry != entry)
+			break;
+		lane = *lslot;
+		*lslot = lane->next[l];
+	}
+	free(lane);
+	while (index->level > 0 && index->head[index->level - 1] == NULL)
+		index->level--;
+}
+
+bool contact_index_remove(struct contact_index *index,
+			  struct contact *contact)
+{
+	struct contact_index_lane *update[CONTACT_INDEX_MAX_LEVEL];
+	struct contact_list **slot, *entry;
+	uint64_t time_ms, seq;
+
+	ASSERT(contact != NULL);
+	time_ms = time_of(index, contact);
+	seq = contact->sequence_number;
+	slot = search(index, time_ms, seq, update);
+	while (*slot != NULL && (*slot)->data != contact &&
+	       compare(index, *slot, time_ms, seq) == 0)
+		slot = &(*slot)->next;
+
+	if (*slot != NULL && (*slot)->data == contact) {
+		entry = *slot;
+		*slot = entry->next;
+		unlink_lanes(index, entry, time_ms, update);
+		free(entry);
+		return true;
+	}
+
+	// The time of the contact may have been changed after indexing it
+	for (slot = index->list; *slot != NULL; slot = &(*slot)->next) {
+		if ((*slot)->data == contact) {
+			entry = *slot;
+			*slot = entry->next;
+			unlink_lanes(index, entry, time_ms, NULL);
+			free(entry);
+			return true;
+		}
+	}
+	return false;
+}
+
+struct contact_list *contact_index_find_first(
+	const struct contact_index *index, uint64_t time_ms)
+{
+	// Sequence numbers start at one
+	return *search(index, time_ms, 0, NULL);
+}
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/common.h"
 #include "ud3tn/contact_manager.h"
+#include "ud3tn/min_heap.h"
 #include "ud3tn/node.h"
 #include "ud3tn/routing_table.h"
 #include "archipel-core/bundle_restore.h"
@@ -20,14 +21,27 @@
 #include <stdbool.h>
 #include <string.h>
 
+// With epidemic and PRoPHET routing, bundles are restored as soon as the
+// state of the peer is known, see exchange_agent.h.
+#if defined(ARCHIPEL_CORE) && !defined(ROUTING_EPIDEMIC) && \
+	!defined(ROUTING_PROPHET)
+#define CONTACT_RESTORE_BUNDLES
+#endif
+
+// Spray-and-Wait only routes via active contacts, bundles restored ahead of
+// the start of a contact could not be queued for it.
+#if defined(CONTACT_RESTORE_BUNDLES) && !defined(ROUTING_SPRAY_AND_WAIT)
+#define CONTACT_PRESTAGE_BUNDLES
+#endif
+
 
 struct contact_manager_task_parameters {
 	Semaphore_t semaphore;
 	QueueIdentifier_t control_queue;
 	QueueIdentifier_t bp_queue;
-	struct contact_list **contact_list_ptr;
 	#ifdef ARCHIPEL_CORE
 	QueueIdentifier_t restore_queue;
+	struct bundle_store *bundle_store;
 	#endif
 };
 
@@ -35,154 +49,207 @@ struct contact_info {
 	struct contact *contact;
 	char *eid;
 	char *cla_addr;
+	// Position in the heap of active contacts
+	size_t index;
+	// Next contact started or ended in the same round
+	struct contact_info *next;
 };
 
 struct contact_manager_context {
-	struct contact_info current_contacts[MAX_CONCURRENT_CONTACTS];
-	int8_t current_contact_count;
+	// Active contacts (struct contact_info), ordered by end time
+	struct min_heap current_contacts;
 	uint64_t next_contact_time_ms;
 	#ifdef ARCHIPEL_CORE
 	QueueIdentifier_t bundle_restore_queue;
+	// Informed of the bundles handed over to a CLA
+	struct bundle_store *bundle_store;
 	#endif
 };
 
-static bool contact_active(
-	const struct contact_manager_context *const ctx,
-	const struct contact *contact)
+static void set_contact_info_index(void *cinfo, size_t index)
+{
+	((struct contact_info *)cinfo)->index = index;
+}
+
+static void free_contact_info(struct contact_info *cinfo)
 {
-	int8_t i;
+	free(cinfo->eid);
+	free(cinfo->cla_addr);
+	free(cinfo);
+}
 
-	for (i = 0; i < ctx->current_contact_count; i++) {
-		if (ctx->current_contacts[i].contact == contact)
-			return true;
+static struct contact_info *get_contact_info(
+	const struct contact_manager_context *const ctx, size_t index)
+{
+	return ctx->current_contacts.entries[index].data;
+}
+
+// Active contacts may have been shortened by replacing the contact plan of
+// their node, see routing_table_replace_node(). Decreasing a key only moves
+// the entry towards the root, i.e., to an index already visited.
+static void update_shortened_contacts(
+	struct contact_manager_context *const ctx)
+{
+	struct min_heap *const heap = &ctx->current_contacts;
+
+	for (size_t i = 0; i < heap->count; i++) {
+		const struct contact_info *const cinfo = heap->entries[i].data;
+
+		if (cinfo->contact->to_ms < heap->entries[i].key)
+			min_heap_update(heap, i, cinfo->contact->to_ms);
 	}
-	return false;
 }
 
-static int8_t remove_expired_contacts(
+static struct contact_info *remove_expired_contacts(
 	struct contact_manager_context *const ctx,
-	const uint64_t current_timestamp_ms, struct contact_info list[])
+	const uint64_t current_timestamp_ms)
 {
 	/* Check for ending contacts */
-	/* We do this first as it frees space in the list */
-	int8_t i, c, removed = 0;
-
-	for (i = ctx->current_contact_count - 1; i >= 0; i--) {
-		if (ctx->current_contacts[i].contact->to_ms <=
-		    current_timestamp_ms) {
-			ASSERT(i <= MAX_CONCURRENT_CONTACTS);
-			/* Unset "active" constraint */
-			ctx->current_contacts[i].contact->active = 0;
-			/* The TX task takes care of re-scheduling */
-			list[removed++] = ctx->current_contacts[i];
-			/* If it's not the last element, we have to move mem */
-			if (i != ctx->current_contact_count - 1) {
-				for (c = i; c < ctx->current_contact_count; c++)
-					ctx->current_contacts[c] =
-						ctx->current_contacts[c + 1];
-			}
-			ctx->current_contact_count--;
+	const struct min_heap_entry *next;
+	struct contact_info *removed = NULL, *cinfo;
+
+	while ((next = min_heap_peek(&ctx->current_contacts)) != NULL &&
+	       next->key <= current_timestamp_ms) {
+		cinfo = next->data;
+		// Contacts extended while active, e.g., by merge_contacts(),
+		// are re-keyed lazily. Active contacts are never freed.
+		if (cinfo->contact->to_ms > current_timestamp_ms) {
+			min_heap_update(&ctx->current_contacts, cinfo->index,
+					cinfo->contact->to_ms);
+			continue;
 		}
+		min_heap_pop(&ctx->current_contacts);
+		/* Unset "active" constraint */
+		cinfo->contact->active = 0;
+		/* The TX task takes care of re-scheduling */
+		cinfo->next = removed;
+		removed = cinfo;
 	}
 	return removed;
 }
 
-static uint8_t check_upcoming(
-	struct contact_manager_context *const ctx,
-	struct contact *c, struct contact_info list[], const uint8_t index)
+static struct contact_info *check_upcoming(
+	struct contact_manager_context *const ctx, struct contact *c)
 {
-	// Contact is already active, do nothing
-	if (contact_active(ctx, c))
-		return 0;
+	struct contact_info *cinfo = malloc(sizeof(struct contact_info));
 
-	// Too many contacts are already active, cannot add another...
-	if (ctx->current_contact_count >= MAX_CONCURRENT_CONTACTS) {
+	if (!cinfo) {
+		LOG_ERROR("ContactManager: Failed to allocate contact info");
+		return NULL;
+	}
+	cinfo->contact = c;
+	cinfo->next = NULL;
+	cinfo->index = MIN_HEAP_NO_INDEX;
+	cinfo->eid = strdup(c->node->eid);
+	if (!cinfo->eid) {
+		LOG_ERROR("ContactManager: Failed to copy EID");
+		free(cinfo);
+		return NULL;
+	}
+	cinfo->cla_addr = strdup(c->node->cla_addr);
+	if (!cinfo->cla_addr) {
+		LOG_ERROR("ContactManager: Failed to copy CLA address");
+		free(cinfo->eid);
+		free(cinfo);
+		return NULL;
+	}
+	if (min_heap_push(&ctx->current_contacts, c->to_ms, cinfo) !=
+	    UD3TN_OK) {
 		LOGF_WARN(
-			"ContactManager: Cannot start contact with \"%s\", too many contacts are already active",
+			"ContactManager: Cannot start contact with \"%s\", out of memory",
 			c->node->eid
 		);
-		return 0;
+		free_contact_info(cinfo);
+		return NULL;
 	}
 
 	/* Set "active" constraint, "blocking" the contact */
 	c->active = 1;
 
-	/* Add contact */
-	ctx->current_contacts[ctx->current_contact_count].contact = c;
-	ctx->current_contacts[ctx->current_contact_count].eid = strdup(
-		c->node->eid
-	);
-	if (!ctx->current_contacts[ctx->current_contact_count].eid) {
-		LOG_ERROR("ContactManager: Failed to copy EID");
-		return 0;
-	}
-	ctx->current_contacts[ctx->current_contact_count].cla_addr = strdup(
-		c->node->cla_addr
-	);
-	if (!ctx->current_contacts[ctx->current_contact_count].cla_addr) {
-		LOG_ERROR("ContactManager: Failed to copy CLA address");
-		free(ctx->current_contacts[ctx->current_contact_count].eid);
-		return 0;
-	}
-	list[index] = ctx->current_contacts[ctx->current_contact_count];
-	ctx->current_contact_count++;
-
-	return 1;
+	return cinfo;
 }
 
-static int8_t process_upcoming_list(
+static struct contact_info *process_upcoming_list(
 	struct contact_manager_context *const ctx,
-	struct contact_list *contact_list, const uint64_t current_timestamp_ms,
-	struct contact_info list[])
+	const uint64_t current_timestamp_ms)
 {
-	int8_t added = 0;
-	struct contact_list *cur_entry;
+	struct contact_info *added = NULL, **tail = &added, *cinfo;
+	const struct min_heap_entry *next_end;
+	struct contact *c;
+
+	while ((c = routing_table_peek_upcoming_contact()) != NULL &&
+	       c->from_ms <= current_timestamp_ms) {
+		routing_table_pop_upcoming_contact();
+		// Contacts which have already passed are not started
+		if (c->to_ms <= current_timestamp_ms)
+			continue;
+		cinfo = check_upcoming(ctx, c);
+		if (cinfo == NULL)
+			continue;
+		*tail = cinfo;
+		tail = &cinfo->next;
+	}
 
 	ctx->next_contact_time_ms = UINT64_MAX;
-	cur_entry = contact_list;
-	while (cur_entry != NULL) {
-		if (cur_entry->data->from_ms <= current_timestamp_ms) {
-			if (cur_entry->data->to_ms > current_timestamp_ms) {
-				added += check_upcoming(
-					ctx,
-					cur_entry->data,
-					list,
-					added
-				);
-				if (cur_entry->data->to_ms <
-				    ctx->next_contact_time_ms)
-					ctx->next_contact_time_ms =
-						cur_entry->data->to_ms;
-			}
-		} else {
-			if (cur_entry->data->from_ms <
-			    ctx->next_contact_time_ms)
-				ctx->next_contact_time_ms = (
-					cur_entry->data->from_ms
-				);
-			/* As our contact_list is sorted ascending by */
-			/* from-time we can stop checking here */
-			break;
-		}
-		cur_entry = cur_entry->next;
-	}
+	if (c != NULL)
+		ctx->next_contact_time_ms = c->from_ms;
+	next_end = min_heap_peek(&ctx->current_contacts);
+	if (next_end != NULL && next_end->key < ctx->next_contact_time_ms)
+		ctx->next_contact_time_ms = next_end->key;
 	return added;
 }
 
-static int hand_over_contact_bundles(
-	struct contact_manager_context *const ctx, Semaphore_t semphr, int8_t i)
+#ifdef CONTACT_PRESTAGE_BUNDLES
+static void prestage_contact(struct contact *c, void *context)
 {
-	struct contact_info cinfo = ctx->current_contacts[i];
+	struct contact_manager_context *const ctx = context;
+
+	if (c->prestaged)
+		return;
+	LOGF_INFO(
+		"ContactManager: Loading bundles for upcoming contact with \"%s\" (%p).",
+		c->node->eid,
+		c
+	);
+	c->prestaged = 1;
+	bundle_restore_for_destination(
+		ctx->bundle_restore_queue,
+		c->node->eid);
+}
 
+// Loads the stored bundles for all contacts starting within the lead time,
+// so that they are routed and queued once the contact starts. Returns the
+// time at which the next contact enters the lead time.
+static uint64_t prestage_upcoming_contacts(
+	struct contact_manager_context *const ctx,
+	const uint64_t current_timestamp_ms)
+{
+	const uint64_t next_start_ms = routing_table_visit_upcoming_contacts(
+		current_timestamp_ms + CONTACT_PRESTAGE_LEAD_TIME_MS,
+		prestage_contact,
+		ctx
+	);
+
+	if (next_start_ms == UINT64_MAX)
+		return UINT64_MAX;
+	return next_start_ms - CONTACT_PRESTAGE_LEAD_TIME_MS;
+}
+#endif // CONTACT_PRESTAGE_BUNDLES
+
+// Returns false if the contact is not part of the routing table anymore.
+static bool hand_over_contact_bundles(
+	const struct contact_manager_context *const ctx,
+	struct contact_info *const cinfo, Semaphore_t semphr, bool *pending)
+{
 	hal_semaphore_take_blocking(semphr);
 
-	// NOTE: cinfo.contact MAY not be valid at this point!
-	struct node_table_entry *n = routing_table_lookup_eid(cinfo.eid);
+	// NOTE: cinfo->contact MAY not be valid at this point!
+	struct node_table_entry *n = routing_table_lookup_eid(cinfo->eid);
 	struct contact_list *cl = (n != NULL) ? n->contacts : NULL;
 	bool found = false;
 
 	while (cl) {
-		if (cl->data == cinfo.contact) {
+		if (cl->data == cinfo->contact) {
 			found = true;
 			break;
 		}
@@ -192,179 +259,182 @@ static int hand_over_contact_bundles(
 	if (!found) {
 		LOGF_WARN(
 			"ContactManager: Could not find contact %p to \"%s\" via \"%s\", discarding record",
-			cinfo.contact,
-			cinfo.eid,
-			cinfo.cla_addr
+			cinfo->contact,
+			cinfo->eid,
+			cinfo->cla_addr
 		);
-		// Remove invalid contact info
-		free(cinfo.eid);
-		free(cinfo.cla_addr);
-		if (i < ctx->current_contact_count - 1) {
-			memmove(
-				&ctx->current_contacts[i],
-				&ctx->current_contacts[i + 1],
-				sizeof(struct contact_info) * (
-					ctx->current_contact_count - 1 - i
-				)
-			);
-		}
-		ctx->current_contact_count--;
 		hal_semaphore_release(semphr);
-		return 0;
+		return false;
 	}
 
 	// Contact found and valid -> continue!
-	if (cinfo.contact->contact_bundles == NULL) {
+	if (routed_bundle_queue_empty(&cinfo->contact->contact_bundles)) {
 		hal_semaphore_release(semphr);
-		return 1;
+		return true;
 	}
 
-	ASSERT(cinfo.cla_addr != NULL);
+	ASSERT(cinfo->cla_addr != NULL);
 	// Try to obtain a handler
-	struct cla_config *cla_config = cla_config_get(cinfo.cla_addr);
+	struct cla_config *cla_config = cla_config_get(cinfo->cla_addr);
 
 	if (!cla_config) {
 		LOGF_WARN(
 			"ContactManager: Could not obtain CLA for address \"%s\"",
-			cinfo.cla_addr
+			cinfo->cla_addr
 		);
 		hal_semaphore_release(semphr);
-		return 1;
+		return true;
 	}
 
 	struct cla_tx_queue tx_queue = cla_config->vtable->cla_get_tx_queue(
 		cla_config,
-		cinfo.eid,
-		cinfo.cla_addr
+		cinfo->eid,
+		cinfo->cla_addr
 	);
 
 	if (!tx_queue.tx_queue_handle) {
 		LOGF_WARN(
 			"ContactManager: Could not obtain queue for TX to \"%s\" via \"%s\"",
-			cinfo.eid,
-			cinfo.cla_addr
+			cinfo->eid,
+			cinfo->cla_addr
 		);
 		// Re-scheduling will be done by routerTask or transmission will
 		// occur after signal of new connection.
 		hal_semaphore_release(semphr);
-		return 1;
+		return true;
 	}
 
 	LOGF_INFO(
 		"ContactManager: Queuing bundles for contact with \"%s\".",
-		cinfo.eid
+		cinfo->eid
 	);
 
 	struct cla_contact_tx_task_command command = {
 		.type = TX_COMMAND_BUNDLES,
 		// Take over the bundles as we can now push them into the queue
-		// that is protected by the CLA semaphore.
-		.bundles = cinfo.contact->contact_bundles,
+		// that is protected by the CLA semaphore. This detaches them
+		// from the contact, so the Router does not interfere. We own
+		// the list now and the TX task will free it.
+		.bundles = routed_bundle_queue_take(
+			&cinfo->contact->contact_bundles,
+			CONTACT_BUNDLE_HANDOVER_BATCH
+		),
+		.bitrate_bytes_per_s = cinfo->contact->bitrate_bytes_per_s,
 	};
 
-	// Ensure the Router does not interfere. We own the list now and the
-	// TX task will free it.
-	cinfo.contact->contact_bundles = NULL;
+	// Remaining bundles are handed over in the next round.
+	if (!routed_bundle_queue_empty(&cinfo->contact->contact_bundles))
+		*pending = true;
 	// Now we can also let the BP do its thing again...
 	hal_semaphore_release(semphr);
-	// NOTE: From now on, cinfo.contact MAY become invalid again!
+	// NOTE: From now on, cinfo->contact MAY become invalid again!
 
-	command.cla_address = strdup(cinfo.cla_addr);
+	#ifdef ARCHIPEL_CORE
+	// The list is owned by us until it is pushed, thus, the bundles are
+	// marked without blocking the BP and before the TX task may report
+	// (and thus release) them.
+	for (struct routed_bundle_list *e = command.bundles; e; e = e->next)
+		hal_store_set_residency(ctx->bundle_store, e->data,
+					BUNDLE_RESIDENCY_IN_TX);
+	#endif // ARCHIPEL_CORE
+	command.cla_address = strdup(cinfo->cla_addr);
 	hal_queue_push_to_back(tx_queue.tx_queue_handle, &command);
 	hal_semaphore_release(tx_queue.tx_queue_sem); // taken by get_tx_queue
 
-	return 1;
+	return true;
 }
 
-static uint8_t check_for_contacts(
-	struct contact_manager_context *const ctx,
-	struct contact_list *contact_list,
-	struct contact_info removed_contacts[])
+static struct contact_info *check_for_contacts(
+	struct contact_manager_context *const ctx)
 {
-	int8_t i;
-	static struct contact_info added_contacts[MAX_CONCURRENT_CONTACTS];
+	struct contact_info *cinfo;
 	const uint64_t current_timestamp_ms = hal_time_get_timestamp_ms();
-	const int8_t removed_count = remove_expired_contacts(
-		ctx,
-		current_timestamp_ms,
-		removed_contacts
-	);
-	const int8_t added_count = process_upcoming_list(
-		ctx,
-		contact_list,
-		current_timestamp_ms,
-		added_contacts
-	);
+	struct contact_info *removed_contacts, *added_contacts;
+
+	update_shortened_contacts(ctx);
+	removed_contacts = remove_expired_contacts(ctx, current_timestamp_ms);
+	added_contacts = process_upcoming_list(ctx, current_timestamp_ms);
+	#ifdef CONTACT_PRESTAGE_BUNDLES
+	if (CONTACT_PRESTAGE_LEAD_TIME_MS != 0) {
+		const uint64_t next_prestage_ms = prestage_upcoming_contacts(
+			ctx,
+			current_timestamp_ms
+		);
+
+		if (next_prestage_ms < ctx->next_contact_time_ms)
+			ctx->next_contact_time_ms = next_prestage_ms;
+	}
+	#endif
 
 	ASSERT(ctx->next_contact_time_ms > current_timestamp_ms);
 
-	for (i = 0; i < added_count; i++) {
+	for (cinfo = added_contacts; cinfo != NULL; cinfo = cinfo->next) {
 		LOGF_INFO(
 			"ContactManager: Scheduled contact with \"%s\" started (%p).",
-			added_contacts[i].eid,
-			added_contacts[i].contact
+			cinfo->eid,
+			cinfo->contact
 		);
 
 		struct cla_config *cla_config = cla_config_get(
-			added_contacts[i].cla_addr
+			cinfo->cla_addr
 		);
 
 		if (!cla_config) {
 			LOGF_WARN(
 				"ContactManager: Could not obtain CLA for address \"%s\"",
-				added_contacts[i].cla_addr
+				cinfo->cla_addr
 			);
 		} else {
 			cla_config->vtable->cla_start_scheduled_contact(
 				cla_config,
-				added_contacts[i].eid,
-				added_contacts[i].cla_addr
+				cinfo->eid,
+				cinfo->cla_addr
 			);
 		}
 
-		#ifdef ARCHIPEL_CORE
-		bundle_restore_for_destination(
-			ctx->bundle_restore_queue,
-			added_contacts[i].eid);
+		#ifdef CONTACT_RESTORE_BUNDLES
+		#ifdef CONTACT_PRESTAGE_BUNDLES
+		// Otherwise, they are already queued for the contact.
+		if (!cinfo->contact->prestaged)
+		#endif // CONTACT_PRESTAGE_BUNDLES
+			bundle_restore_for_destination(
+				ctx->bundle_restore_queue,
+				cinfo->eid);
 		#endif
 	}
-	for (i = 0; i < removed_count; i++) {
+	for (cinfo = removed_contacts; cinfo != NULL; cinfo = cinfo->next) {
 		LOGF_INFO(
 			"ContactManager: Scheduled contact with \"%s\" ended (%p).",
-			removed_contacts[i].eid,
-			removed_contacts[i].contact
+			cinfo->eid,
+			cinfo->contact
 		);
 
 		struct cla_config *cla_config = cla_config_get(
-			removed_contacts[i].cla_addr
+			cinfo->cla_addr
 		);
 
 		if (!cla_config) {
 			LOGF_WARN(
 				"ContactManager: Could not obtain CLA for address \"%s\"",
-				removed_contacts[i].cla_addr
+				cinfo->cla_addr
 			);
 		} else {
 			cla_config->vtable->cla_end_scheduled_contact(
 				cla_config,
-				removed_contacts[i].eid,
-				removed_contacts[i].cla_addr
+				cinfo->eid,
+				cinfo->cla_addr
 			);
 		}
-		free(removed_contacts[i].eid);
-		free(removed_contacts[i].cla_addr);
 	}
-	return removed_count;
+	return removed_contacts;
 }
 
-/* We assume that contact_list will not change. */
 static void manage_contacts(
 	struct contact_manager_context *const ctx,
-	struct contact_list **contact_list, enum contact_manager_signal signal,
+	enum contact_manager_signal signal,
 	Semaphore_t semphr, QueueIdentifier_t bp_queue)
 {
-	struct contact_info removed_list[MAX_CONCURRENT_CONTACTS];
-	int8_t removed, i;
+	struct contact_info *removed, *next;
 
 	ASSERT(semphr != NULL);
 	ASSERT(bp_queue != NULL);
@@ -372,27 +442,48 @@ static void manage_contacts(
 	// NOTE: CM_SIGNAL_UNKNOWN has both flags
 	if (HAS_FLAG(signal, CM_SIGNAL_UPDATE_CONTACT_LIST)) {
 		hal_semaphore_take_blocking(semphr);
-		removed = check_for_contacts(ctx, *contact_list, removed_list);
+		removed = check_for_contacts(ctx);
 		hal_semaphore_release(semphr);
-		for (i = 0; i < removed; i++) {
+		for (; removed != NULL; removed = next) {
+			next = removed->next;
 			/* The contact has to be deleted first... */
 			bundle_processor_inform(
 				bp_queue,
 				(struct bundle_processor_signal) {
 					.type = BP_SIGNAL_CONTACT_OVER,
-					.contact = removed_list[i].contact,
+					.contact = removed->contact,
 				}
 			);
+			free_contact_info(removed);
 		}
 	}
 
 	// NOTE: CM_SIGNAL_UNKNOWN has both flags
 	if (HAS_FLAG(signal, CM_SIGNAL_PROCESS_CURRENT_BUNDLES)) {
-		for (int8_t i = 0; i < ctx->current_contact_count; ) {
-			// NOTE this may either return 1 or 0, the latter if it
-			// deleted an item & modified ctx->current_contact_count
-			i += hand_over_contact_bundles(ctx, semphr, i);
-		}
+		struct contact_info *invalid = NULL, *cinfo;
+		bool pending;
+
+		// Hand over one batch per contact and round, until all
+		// queues are empty. Invalid records are removed after the
+		// round, as removing them reorders the heap.
+		do {
+			pending = false;
+			for (size_t i = 0; i < ctx->current_contacts.count; i++) {
+				cinfo = get_contact_info(ctx, i);
+				if (!hand_over_contact_bundles(ctx, cinfo,
+							       semphr,
+							       &pending)) {
+					cinfo->next = invalid;
+					invalid = cinfo;
+				}
+			}
+			for (; invalid != NULL; invalid = next) {
+				next = invalid->next;
+				min_heap_remove(&ctx->current_contacts,
+						invalid->index);
+				free_contact_info(invalid);
+			}
+		} while (pending);
 	}
 }
 
@@ -404,10 +495,10 @@ static void contact_manager_task(void *cm_parameters)
 	uint64_t cur_time_ms, next_time_ms;
 	int64_t delay_ms;
 	struct contact_manager_context ctx = {
-		.current_contact_count = 0,
 		.next_contact_time_ms = UINT64_MAX,
 		#ifdef ARCHIPEL_CORE
-		.bundle_restore_queue = parameters->restore_queue
+		.bundle_restore_queue = parameters->restore_queue,
+		.bundle_store = parameters->bundle_store,
 		#endif
 	};
 
@@ -415,11 +506,11 @@ static void contact_manager_task(void *cm_parameters)
 		LOG_ERROR("ContactManager: Cannot start, parameters not defined");
 		abort();
 	}
+	min_heap_init(&ctx.current_contacts, set_contact_info_index);
 	for (;;) {
 		if (signal != CM_SIGNAL_NONE) {
 			manage_contacts(
 				&ctx,
-				parameters->contact_list_ptr,
 				signal,
 				parameters->semaphore,
 				parameters->bp_queue
@@ -451,10 +542,10 @@ static void contact_manager_task(void *cm_parameters)
 }
 
 struct contact_manager_params contact_manager_start(
-	QueueIdentifier_t bp_queue,
-	struct contact_list **clistptr
+	QueueIdentifier_t bp_queue
 	#ifdef ARCHIPEL_CORE
 	,QueueIdentifier_t bundle_restore_queue
+	,struct bundle_store *bundle_store
 	#endif
 	)
 {
@@ -484,9 +575,9 @@ struct contact_manager_params contact_manager_start(
 	cmt_params->semaphore = semaphore;
 	cmt_params->control_queue = queue;
 	cmt_params->bp_queue = bp_queue;
-	cmt_params->contact_list_ptr = clistptr;
 	#ifdef ARCHIPEL_CORE
 	cmt_params->restore_queue = bundle_restore_queue;
+	cmt_params->bundle_store = bundle_store;
 	#endif
 	ret.task_creation_result = hal_task_create(
 		contact_manager_task,
@@ -12,9 +12,40 @@
 
 #include "ud3tn/crc.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+
+/*
+ * CRC-32-C instructions are available on x86 with SSE 4.2 and on ARMv8 with
+ * the CRC extension. The kernels are compiled for these targets via function
+ * attributes and only used if the CPU supports them at runtime.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC_HAVE_X86_SSE42
+#include <nmmintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && \
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+	(defined(__ARM_FEATURE_CRC32) || defined(__linux__))
+#define CRC_HAVE_ARM_CRC
+#include <arm_acle.h>
+#ifndef __ARM_FEATURE_CRC32
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif // __ARM_FEATURE_CRC32
+#endif
+
+
+typedef uint32_t (*crc_kernel_t)(uint32_t crc, const uint8_t *data,
+				 size_t len);
+
+// Kernels for bulk computation, selected at runtime (see crc_setup())
+static crc_kernel_t crc16_x25_kernel;
+static crc_kernel_t crc32_kernel;
+
+static void crc_setup(void);
 
 
 /**
@@ -79,19 +110,29 @@ static void crc16_x25_feed_eof(struct crc_stream *crc)
 	crc->checksum ^= 0xffff;
 }
 
-uint16_t crc16_x25(const uint8_t *data, size_t len)
+static uint32_t crc16_x25_bytewise(uint32_t crc, const uint8_t *p,
+				   size_t len)
 {
-	// Initial value as defined in CRC-16 X.25
-	uint16_t crc = 0xffff;
-	const uint8_t *p = data;
-
 	while (len) {
 		crc = (crc >> 8) ^ crc16_x25_table[(crc & 0xff) ^ (*p++)];
 		len--;
 	}
 
-	// Final XOR
-	return crc ^ 0xffff;
+	return crc;
+}
+
+static void crc16_x25_feed_bytes(struct crc_stream *crc, const uint8_t *data,
+				 size_t len)
+{
+	crc->checksum = crc16_x25_kernel(crc->checksum, data, len);
+}
+
+uint16_t crc16_x25(const uint8_t *data, size_t len)
+{
+	crc_setup();
+
+	// Initial value as defined in CRC-16 X.25, final XOR
+	return (uint16_t)(crc16_x25_kernel(0xffff, data, len) ^ 0xffff);
 }
 
 
@@ -149,6 +190,16 @@ static void crc16_ccitt_false_feed(struct crc_stream *crc, uint8_t byte)
 	crc->checksum ^= crc16_ccitt_false_table[index];
 }
 
+static void crc16_ccitt_false_feed_bytes(struct crc_stream *crc,
+					 const uint8_t *data, size_t len)
+{
+	// Not used by BPv7, thus only the byte-wise variant is provided
+	while (len) {
+		crc16_ccitt_false_feed(crc, *data++);
+		len--;
+	}
+}
+
 static void crc16_ccitt_false_feed_eof(struct crc_stream *crc)
 {
 	// NOOP
@@ -279,50 +330,290 @@ static void crc32_feed_eof(struct crc_stream *crc)
 	crc->checksum ^= 0xffffffff;
 }
 
+static uint32_t crc32_bytewise(uint32_t crc, const uint8_t *p, size_t len)
+{
+	while (len) {
+		crc = (crc >> 8) ^ crc32_table[(crc & 0xff) ^ (*p++)];
+		len--;
+	}
+
+	return crc;
+}
+
+static void crc32_feed_bytes(struct crc_stream *crc, const uint8_t *data,
+			     size_t len)
+{
+	crc->checksum = crc32_kernel(crc->checksum, data, len);
+}
+
 uint32_t crc32(const uint8_t *data, size_t len)
 {
-	// Initial value as defined in CRC-32 Ethernet
-	uint32_t crc = 0xffffffff;
-	const uint8_t *p = data;
+	crc_setup();
+
+	// Initial value as defined in CRC-32 Ethernet, final XOR
+	return crc32_kernel(0xffffffff, data, len) ^ 0xffffffff;
+}
+
+
+/**
+ * Slicing-by-8
+ *
+ * Table k contains the CRC of the byte i followed by k zero bytes. This
+ * allows processing eight bytes with eight independent lookups, which is
+ * only limited by the load throughput of the CPU instead of the latency of
+ * the dependency chain of the byte-wise algorithm. As all our CRCs are
+ * reflected and at most 32 bit wide, the same algorithm can be used for
+ * CRC-16 X.25 and CRC-32-C.
+ *
+ * The tables are derived from the byte-wise tables above on first use.
+ */
+static uint32_t crc16_x25_slice_table[8][256];
+static uint32_t crc32_slice_table[8][256];
+
+static void slice_table_init(uint32_t table[8][256], const uint32_t base[256])
+{
+	for (int i = 0; i < 256; i++)
+		table[0][i] = base[i];
+
+	for (int k = 1; k < 8; k++) {
+		for (int i = 0; i < 256; i++) {
+			const uint32_t prev = table[k - 1][i];
+
+			table[k][i] = (prev >> 8) ^ base[prev & 0xff];
+		}
+	}
+}
+
+static inline uint32_t load_le32(const uint8_t *p)
+{
+	return (
+		(uint32_t)p[0] |
+		((uint32_t)p[1] << 8) |
+		((uint32_t)p[2] << 16) |
+		((uint32_t)p[3] << 24)
+	);
+}
+
+static inline uint32_t slice_by_8(const uint32_t table[8][256],
+				  uint32_t crc, const uint8_t *p, size_t len)
+{
+	while (len >= 8) {
+		const uint32_t one = crc ^ load_le32(p);
+		const uint32_t two = load_le32(p + 4);
+
+		crc = (
+			table[7][one & 0xff] ^
+			table[6][(one >> 8) & 0xff] ^
+			table[5][(one >> 16) & 0xff] ^
+			table[4][one >> 24] ^
+			table[3][two & 0xff] ^
+			table[2][(two >> 8) & 0xff] ^
+			table[1][(two >> 16) & 0xff] ^
+			table[0][two >> 24]
+		);
+		p += 8;
+		len -= 8;
+	}
 
 	while (len) {
-		crc = (crc >> 8) ^ crc32_table[(crc & 0xff) ^ (*p++)];
+		crc = (crc >> 8) ^ table[0][(crc & 0xff) ^ (*p++)];
 		len--;
 	}
 
-	// Final XOR
-	return crc ^ 0xffffffff;
+	return crc;
 }
 
+static uint32_t crc16_x25_slice_by_8(uint32_t crc, const uint8_t *p,
+				     size_t len)
+{
+	return slice_by_8(crc16_x25_slice_table, crc, p, len);
+}
 
-void crc_feed_bytes(struct crc_stream *crc, const uint8_t *data, size_t len)
+static uint32_t crc32_slice_by_8(uint32_t crc, const uint8_t *p, size_t len)
 {
-	const uint8_t *p = data;
+	return slice_by_8(crc32_slice_table, crc, p, len);
+}
+
+
+/**
+ * Hardware CRC-32-C
+ *
+ * The instructions operate on the same (reflected) remainder as the
+ * byte-wise algorithm, so they can be mixed freely with it.
+ */
+#if defined(CRC_HAVE_X86_SSE42)
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32_hardware(uint32_t crc, const uint8_t *p, size_t len)
+{
+#if defined(__x86_64__)
+	uint64_t crc64 = crc;
+
+	while (len >= 8) {
+		uint64_t value;
+
+		memcpy(&value, p, sizeof(value));
+		crc64 = _mm_crc32_u64(crc64, value);
+		p += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#endif // __x86_64__
+
+	while (len >= 4) {
+		uint32_t value;
+
+		memcpy(&value, p, sizeof(value));
+		crc = _mm_crc32_u32(crc, value);
+		p += 4;
+		len -= 4;
+	}
+
+	while (len) {
+		crc = _mm_crc32_u8(crc, *p++);
+		len--;
+	}
+
+	return crc;
+}
+
+#elif defined(CRC_HAVE_ARM_CRC)
+
+#if defined(__clang__)
+__attribute__((target("crc")))
+#else
+__attribute__((target("+crc")))
+#endif
+static uint32_t crc32_hardware(uint32_t crc, const uint8_t *p, size_t len)
+{
+	while (len >= 8) {
+		uint64_t value;
+
+		memcpy(&value, p, sizeof(value));
+		crc = __crc32cd(crc, value);
+		p += 8;
+		len -= 8;
+	}
 
 	while (len) {
-		crc->feed(crc, *p++);
+		crc = __crc32cb(crc, *p++);
 		len--;
 	}
+
+	return crc;
+}
+
+#endif
+
+
+bool crc_hardware_available(void)
+{
+#if defined(CRC_HAVE_X86_SSE42)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.2");
+#elif defined(CRC_HAVE_ARM_CRC) && defined(__ARM_FEATURE_CRC32)
+	return true;
+#elif defined(CRC_HAVE_ARM_CRC)
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+	return false;
+#endif
+}
+
+
+// --------
+// Dispatch
+// --------
+
+static enum crc_implementation current_implementation;
+static bool crc_ready;
+
+static bool select_implementation(enum crc_implementation implementation)
+{
+	switch (implementation) {
+	case CRC_IMPLEMENTATION_BYTEWISE:
+		crc16_x25_kernel = crc16_x25_bytewise;
+		crc32_kernel = crc32_bytewise;
+		break;
+	case CRC_IMPLEMENTATION_SLICE_BY_8:
+		crc16_x25_kernel = crc16_x25_slice_by_8;
+		crc32_kernel = crc32_slice_by_8;
+		break;
+	case CRC_IMPLEMENTATION_HARDWARE:
+#if defined(CRC_HAVE_X86_SSE42) || defined(CRC_HAVE_ARM_CRC)
+		if (!crc_hardware_available())
+			return false;
+		crc16_x25_kernel = crc16_x25_slice_by_8;
+		crc32_kernel = crc32_hardware;
+		break;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+
+	current_implementation = implementation;
+	return true;
+}
+
+bool crc_set_implementation(enum crc_implementation implementation)
+{
+	crc_setup();
+	return select_implementation(implementation);
+}
+
+enum crc_implementation crc_get_implementation(void)
+{
+	crc_setup();
+	return current_implementation;
+}
+
+static void crc_setup(void)
+{
+	if (__atomic_load_n(&crc_ready, __ATOMIC_ACQUIRE))
+		return;
+
+	// All steps are idempotent: if multiple tasks get here concurrently
+	// on first use, they write identical values.
+	slice_table_init(crc16_x25_slice_table, crc16_x25_table);
+	slice_table_init(crc32_slice_table, crc32_table);
+
+	if (!select_implementation(CRC_IMPLEMENTATION_HARDWARE))
+		select_implementation(CRC_IMPLEMENTATION_SLICE_BY_8);
+
+	__atomic_store_n(&crc_ready, true, __ATOMIC_RELEASE);
+}
+
+
+void crc_feed_bytes(struct crc_stream *crc, const uint8_t *data, size_t len)
+{
+	crc->feed_bytes(crc, data, len);
 }
 
 
 void crc_init(struct crc_stream *crc, enum crc_version version)
 {
+	crc_setup();
+
 	// Set initial values and callback functions
 	switch (version) {
 	case CRC16_X25:
 		crc->checksum = 0xffff;
 		crc->feed = crc16_x25_feed;
+		crc->feed_bytes = crc16_x25_feed_bytes;
 		crc->feed_eof = crc16_x25_feed_eof;
 		break;
 	case CRC16_CCITT_FALSE:
 		crc->checksum = 0xffff;
 		crc->feed = crc16_ccitt_false_feed;
+		crc->feed_bytes = crc16_ccitt_false_feed_bytes;
 		crc->feed_eof = crc16_ccitt_false_feed_eof;
 		break;
 	default:
 		crc->checksum = 0xffffffff;
 		crc->feed = crc32_feed;
+		crc->feed_bytes = crc32_feed_bytes;
 		crc->feed_eof = crc32_feed_eof;
 		break;
 	}
@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/hashmap.h"
+
+#include "util/htab_hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HASHMAP_MIN_CAPACITY 8
+
+// Number of slots of the previous table migrated per modification. As the
+// table is grown at a load of 7/8, migrating more than one slot per
+// insertion ensures that the migration is complete before the new table
+// needs to grow again.
+#define HASHMAP_MIGRATE_STEPS 4
+
+static inline bool load_exceeded(size_t count, size_t capacity)
+{
+	return count * 8 > capacity * 7;
+}
+
+static uint32_t hash_key(const char *key)
+{
+	const uint32_t hash = hashlittle(key, strlen(key), 0);
+
+	return hash != 0 ? hash : 1;
+}
+
+static inline size_t probe_distance(uint32_t hash, size_t pos,
+				    size_t capacity)
+{
+	return (pos - (hash & (capacity - 1))) & (capacity - 1);
+}
+
+static struct hashmap_slot *table_find(struct hashmap_slot *slots,
+				       size_t capacity, uint32_t hash,
+				       const char *key)
+{
+	if (slots == NULL)
+		return NULL;
+
+	const size_t mask = capacity - 1;
+	size_t pos = hash & mask;
+
+	for (size_t dist = 0; ; dist++, pos = (pos + 1) & mask) {
+		struct hashmap_slot *const slot = &slots[pos];
+
+		// Robin Hood invariant: the key would have displaced any
+		// entry closer to its home slot.
+		if (slot->hash == 0 ||
+		    probe_distance(slot->hash, pos, capacity) < dist)
+			return NULL;
+		if (slot->hash == hash && strcmp(slot->key, key) == 0)
+			return slot;
+	}
+}
+
+static void table_insert(struct hashmap_slot *slots, size_t capacity,
+			 struct hashmap_slot entry)
+{
+	const size_t mask = capacity - 1;
+	size_t pos = entry.hash & mask;
+
+	for (size_t dist = 0; ; dist++, pos = (pos + 1) & mask) {
+		struct hashmap_slot *const slot = &slots[pos];
+
+		if (slot->hash == 0) {
+			*slot = entry;
+			return;
+		}
+
+		const size_t slot_dist = probe_distance(slot->hash, pos,
+							capacity);
+
+		// Take the slot from an entry closer to its home and
+		// continue to find a place for that one.
+		if (slot_dist < dist) {
+			const struct hashmap_slot tmp = *slot;
+
+			*slot = entry;
+			entry = tmp;
+			dist = slot_dist;
+		}
+	}
+}
+
+static void table_delete(struct hashmap_slot *slots, size_t capacity,
+			 size_t pos)
+{
+	const size_t mask = capacity - 1;
+
+	for (;;) {
+		const size_t next = (pos + 1) & mask;
+
+		// Shift back the rest of the cluster until an empty slot or
+		// an entry in its home slot is reached.
+		if (slots[next].hash == 0 ||
+		    probe_distance(slots[next].hash, next, capacity) == 0) {
+			slots[pos].hash = 0;
+			slots[pos].key = NULL;
+			slots[pos].value = NULL;
+			return;
+		}
+		slots[pos] = slots[next];
+		pos = next;
+	}
+}
+
+static void migrate(struct hashmap *map, size_t steps)
+{
+	while (map->old_slots != NULL && steps-- != 0) {
+		struct hashmap_slot *const slot =
+			&map->old_slots[map->migrate_pos];
+
+		// Deleting shifts the following entries of the cluster into
+		// this slot, so move entries until it stays empty. The scan
+		// starts behind an empty slot, thus, entries are never shifted
+		// into slots that have already been processed.
+		while (slot->hash != 0) {
+			table_insert(map->slots, map->capacity, *slot);
+			table_delete(map->old_slots, map->old_capacity,
+				     map->migrate_pos);
+		}
+
+		map->migrate_pos = (map->migrate_pos + 1) &
+			(map->old_capacity - 1);
+		if (--map->migrate_remaining == 0) {
+			free(map->old_slots);
+			map->old_slots = NULL;
+			map->old_capacity = 0;
+		}
+	}
+}
+
+static enum ud3tn_result grow(struct hashmap *map)
+{
+	const size_t capacity = (
+		map->slots != NULL ? map->capacity * 2 : map->capacity
+	);
+	struct hashmap_slot *const slots = calloc(
+		capacity,
+		sizeof(struct hashmap_slot)
+	);
+
+	if (slots == NULL)
+		return UD3TN_FAIL;
+
+	// Should not happen as the migration outpaces the insertions, but
+	// only a single previous table is supported.
+	if (map->old_slots != NULL)
+		migrate(map, map->migrate_remaining);
+
+	if (map->slots != NULL) {
+		size_t start = 0;
+
+		// The table is never full, find an empty slot to start at
+		while (map->slots[start].hash != 0)
+			start++;
+		map->old_slots = map->slots;
+		map->old_capacity = map->capacity;
+		map->migrate_pos = (start + 1) & (map->capacity - 1);
+		map->migrate_remaining = map->capacity;
+	}
+
+	map->slots = slots;
+	map->capacity = capacity;
+	return UD3TN_OK;
+}
+
+void hashmap_init(struct hashmap *map, size_t expected_count)
+{
+	map->slots = NULL;
+	map->capacity = HASHMAP_MIN_CAPACITY;
+	while (load_exceeded(expected_count, map->capacity))
+		map->capacity *= 2;
+	map->count = 0;
+	map->old_slots = NULL;
+	map->old_capacity = 0;
+	map->migrate_pos = 0;
+	map->migrate_remaining = 0;
+}
+
+static void free_keys(struct hashmap_slot *slots, size_t capacity)
+{
+	if (slots == NULL)
+		return;
+	for (size_t i = 0; i < capacity; i++)
+		free(slots[i].key);
+}
+
+void hashmap_deinit(struct hashmap *map)
+{
+	free_keys(map->slots, map->capacity);
+	free_keys(map->old_slots, map->old_capacity);
+	free(map->slots);
+	free(map->old_slots);
+	hashmap_init(map, 0);
+}
+
+enum ud3tn_result hashmap_put(struct hashmap *map, const char *key,
+			      void *value)
+{
+	ASSERT(key != NULL);
+
+	const uint32_t hash = hash_key(key);
+
+	if (table_find(map->slots, map->capacity, hash, key) != NULL ||
+	    table_find(map->old_slots, map->old_capacity, hash, key) != NULL)
+		return UD3TN_FAIL;
+
+	if (map->slots == NULL ||
+	    load_exceeded(map->count + 1, map->capacity)) {
+		if (grow(map) != UD3TN_OK)
+			return UD3TN_FAIL;
+	}
+
+	char *const key_copy = strdup(key);
+
+	if (key_copy == NULL)
+		return UD3TN_FAIL;
+
+	table_insert(map->slots, map->capacity, (struct hashmap_slot) {
+		.hash = hash,
+		.key = key_copy,
+		.value = value,
+	});
+	map->count++;
+	migrate(map, HASHMAP_MIGRATE_STEPS);
+	return UD3TN_OK;
+}
+
+void *hashmap_get(const struct hashmap *map, const char *key)
+{
+	const uint32_t hash = hash_key(key);
+	struct hashmap_slot *slot = table_find(
+		map->slots,
+		map->capacity,
+		hash,
+		key
+	);
+
+	if (slot == NULL)
+		slot = table_find(
+			map->old_slots,
+			map->old_capacity,
+			hash,
+			key
+		);
+	return slot != NULL ? slot->value : NULL;
+}
+
+void *hashmap_remove(struct hashmap *map, const char *key)
+{
+	const uint32_t hash = hash_key(key);
+	struct hashmap_slot *slots = map->slots;
+	size_t capacity = map->capacity;
+	struct hashmap_slot *slot = table_find(slots, capacity, hash, key);
+
+	if (slot == NULL) {
+		slots = map->old_slots;
+		capacity = map->old_capacity;
+		slot = table_find(slots, capacity, hash, key);
+		if (slot == NULL)
+			return NULL;
+	}
+
+	void *const value = slot->value;
+
+	free(slot->key);
+	table_delete(slots, capacity, (size_t)(slot - slots));
+	map->count--;
+	migrate(map, HASHMAP_MIGRATE_STEPS);
+	return value;
+}
@@ -10,16 +10,20 @@
 
 #include "agents/application_agent.h"
 #include "agents/echo_agent.h"
+#include "agents/epidemic_agent.h"
+#include "agents/prophet_agent.h"
 
 #include "cla/cla.h"
 
 #include "platform/hal_io.h"
+#include "platform/hal_payload.h"
 #include "platform/hal_platform.h"
 #include "platform/hal_queue.h"
 #include "platform/hal_task.h"
 #include "platform/hal_store.h"
 #include "archipel-core/bundle_restore.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -55,6 +59,15 @@ void start_tasks(const struct ud3tn_cmdline_options *const opt)
 	#ifdef ROUTING_LEGACY
 	LOG_INFO("Routing algorithm: legacy (ud3tn)");
 	#endif
+	#ifdef ROUTING_CGR
+	LOG_INFO("Routing algorithm: contact graph routing");
+	#endif
+	#ifdef ROUTING_PROPHET
+	LOG_INFO("Routing algorithm: PRoPHET");
+	#endif
+	#ifdef ROUTING_SPRAY_AND_WAIT
+	LOG_INFO("Routing algorithm: binary spray-and-wait");
+	#endif
 
 	LOGF_INFO("INIT: Configured to use EID \"%s\" and BPv%d",
 	     opt->eid, opt->bundle_version);
@@ -88,6 +101,20 @@ void start_tasks(const struct ud3tn_cmdline_options *const opt)
 		exit(EXIT_FAILURE);
 	}
 
+	/* Spill large payloads to the same file system as the store */
+	char *spill_folder = malloc(strlen(opt->store_folder) + 6 + 1);
+
+	if (spill_folder == NULL) {
+		LOG_ERROR("INIT: Allocation of `spill_folder` failed");
+		abort();
+	}
+	sprintf(spill_folder, "%s/spill", opt->store_folder);
+	if (hal_payload_spill_init(spill_folder) != UD3TN_OK) {
+		LOG_ERROR("INIT: Payload spill folder could not be initialized!");
+		exit(EXIT_FAILURE);
+	}
+	free(spill_folder);
+
 	/* Initialize bundle restoration task */
 	struct bundle_restore_config* bundle_restore_task_config = 
 		malloc(sizeof(struct bundle_restore_config));
@@ -162,6 +189,34 @@ void start_tasks(const struct ud3tn_cmdline_options *const opt)
 		abort();
 	}
 
+	#ifdef ROUTING_EPIDEMIC
+	result = exchange_agent_setup(
+		&bundle_agent_interface,
+		bundle_restore_task_config->restore_queue,
+		opt->bundle_version,
+		&epidemic_agent_config
+	);
+
+	if (result) {
+		LOG_ERROR("INIT: Epidemic agent could not be initialized!");
+		abort();
+	}
+	#endif // ROUTING_EPIDEMIC
+
+	#ifdef ROUTING_PROPHET
+	result = exchange_agent_setup(
+		&bundle_agent_interface,
+		bundle_restore_task_config->restore_queue,
+		opt->bundle_version,
+		&prophet_agent_config
+	);
+
+	if (result) {
+		LOG_ERROR("INIT: PRoPHET agent could not be initialized!");
+		abort();
+	}
+	#endif // ROUTING_PROPHET
+
 	if (opt->allow_remote_configuration)
 		LOG_WARN("!! WARNING !! Remote configuration capability ENABLED!");
 
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/crc.h"
+#include "ud3tn/known_bundle_journal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// type, protocol version, source length, creation timestamp, sequence
+// number, fragment offset, payload length, deadline, checksum
+#define RECORD_FIXED_SIZE (1 + 1 + 2 + 8 + 8 + 4 + 4 + 8 + 4)
+
+static uint8_t *write_uint(uint8_t *buffer, uint64_t value, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		buffer[i] = (uint8_t)(value >> (8 * i));
+	return &buffer[n];
+}
+
+static const uint8_t *read_uint(const uint8_t *buffer, uint64_t *value,
+				size_t n)
+{
+	*value = 0;
+	for (size_t i = 0; i < n; i++)
+		*value |= (uint64_t)buffer[i] << (8 * i);
+	return &buffer[n];
+}
+
+size_t known_bundle_journal_encode(
+	const struct known_bundle_journal_record *record, uint8_t *buffer)
+{
+	const struct bundle_unique_identifier *const id = &record->id;
+	const size_t source_length = strlen(id->source);
+	uint8_t *cur = buffer;
+
+	if (!buffer)
+		return RECORD_FIXED_SIZE + source_length;
+
+	cur = write_uint(cur, record->type, 1);
+	cur = write_uint(cur, id->protocol_version, 1);
+	cur = write_uint(cur, source_length, 2);
+	memcpy(cur, id->source, source_length);
+	cur += source_length;
+	cur = write_uint(cur, id->creation_timestamp_ms, 8);
+	cur = write_uint(cur, id->sequence_number, 8);
+	cur = write_uint(cur, id->fragment_offset, 4);
+	cur = write_uint(cur, id->payload_length, 4);
+	cur = write_uint(cur, record->deadline_ms, 8);
+	cur = write_uint(cur, crc32(buffer, cur - buffer), 4);
+	return cur - buffer;
+}
+
+size_t known_bundle_journal_decode(
+	const uint8_t *buffer, size_t length,
+	struct known_bundle_journal_record *record)
+{
+	const uint8_t *cur = buffer;
+	uint64_t type, version, source_length, offset, payload_length, crc;
+	size_t record_length;
+	char *source;
+
+	if (length < RECORD_FIXED_SIZE)
+		return 0;
+	cur = read_uint(cur, &type, 1);
+	cur = read_uint(cur, &version, 1);
+	cur = read_uint(cur, &source_length, 2);
+	record_length = RECORD_FIXED_SIZE + source_length;
+	if (length < record_length)
+		return 0;
+	read_uint(&buffer[record_length - 4], &crc, 4);
+	if (crc32(buffer, record_length - 4) != crc)
+		return 0;
+	if (type != KNOWN_BUNDLE_JOURNAL_DELIVERED &&
+	    type != KNOWN_BUNDLE_JOURNAL_FRAGMENT)
+		return 0;
+
+	source = malloc(source_length + 1);
+	if (!source)
+		return 0;
+	memcpy(source, cur, source_length);
+	source[source_length] = '\0';
+	cur += source_length;
+
+	record->type = (enum known_bundle_journal_type)type;
+	record->id.protocol_version = (uint8_t)version;
+	record->id.source = source;
+	cur = read_uint(cur, &record->id.creation_timestamp_ms, 8);
+	cur = read_uint(cur, &record->id.sequence_number, 8);
+	cur = read_uint(cur, &offset, 4);
+	cur = read_uint(cur, &payload_length, 4);
+	read_uint(cur, &record->deadline_ms, 8);
+	record->id.fragment_offset = (uint32_t)offset;
+	record->id.payload_length = (uint32_t)payload_length;
+	return record_length;
+}
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/min_heap.h"
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MIN_HEAP_INITIAL_CAPACITY 16
+
+void min_heap_init(struct min_heap *heap, min_heap_index_func_t set_index)
+{
+	heap->entries = NULL;
+	heap->count = 0;
+	heap->capacity = 0;
+	heap->set_index = set_index;
+}
+
+void min_heap_free(struct min_heap *heap)
+{
+	free(heap->entries);
+	heap->entries = NULL;
+	heap->count = 0;
+	heap->capacity = 0;
+}
+
+static void place(struct min_heap *heap, size_t index,
+		  struct min_heap_entry entry)
+{
+	heap->entries[index] = entry;
+	if (heap->set_index != NULL)
+		heap->set_index(entry.data, index);
+}
+
+static void sift_up(struct min_heap *heap, size_t index)
+{
+	const struct min_heap_entry entry = heap->entries[index];
+
+	while (index > 0) {
+		const size_t parent = (index - 1) / 2;
+
+		if (heap->entries[parent].key <= entry.key)
+			break;
+		place(heap, index, heap->entries[parent]);
+		index = parent;
+	}
+	place(heap, index, entry);
+}
+
+static void sift_down(struct min_heap *heap, size_t index)
+{
+	const struct min_heap_entry entry = heap->entries[index];
+
+	for (;;) {
+		size_t child = 2 * index + 1;
+
+		if (child >= heap->count)
+			break;
+		if (child + 1 < heap->count &&
+		    heap->entries[child + 1].key < heap->entries[child].key)
+			child++;
+		if (entry.key <= heap->entries[child].key)
+			break;
+		place(heap, index, heap->entries[child]);
+		index = child;
+	}
+	place(heap, index, entry);
+}
+
+enum ud3tn_result min_heap_push(struct min_heap *heap, uint64_t key,
+				void *data)
+{
+	if (heap->count == heap->capacity) {
+		const size_t capacity = (
+			heap->capacity != 0
+			? heap->capacity * 2
+			: MIN_HEAP_INITIAL_CAPACITY
+		);
+		struct min_heap_entry *const entries = realloc(
+			heap->entries,
+			capacity * sizeof(struct min_heap_entry)
+		);
+
+		if (entries == NULL)
+			return UD3TN_FAIL;
+		heap->entries = entries;
+		heap->capacity = capacity;
+	}
+	heap->entries[heap->count++] = (struct min_heap_entry) {
+		.key = key,
+		.data = data,
+	};
+	sift_up(heap, heap->count - 1);
+	return UD3TN_OK;
+}
+
+void *min_heap_remove(struct min_heap *heap, size_t index)
+{
+	void *data;
+
+	ASSERT(index < heap->count);
+	data = heap->entries[index].data;
+	heap->count--;
+	if (index != heap->count) {
+		const uint64_t key = heap->entries[index].key;
+
+		heap->entries[index] = heap->entries[heap->count];
+		if (heap->entries[index].key < key)
+			sift_up(heap, index);
+		else
+			sift_down(heap, index);
+	}
+	if (heap->set_index != NULL)
+		heap->set_index(data, MIN_HEAP_NO_INDEX);
+	return data;
+}
+
+void min_heap_update(struct min_heap *heap, size_t index, uint64_t key)
+{
+	uint64_t old_key;
+
+	ASSERT(index < heap->count);
+	old_key = heap->entries[index].key;
+	heap->entries[index].key = key;
+	if (key < old_key)
+		sift_up(heap, index);
+	else
+		sift_down(heap, index);
+}
+
+// The subtree of an entry exceeding max_key can be skipped as a whole, its
+// key is the smallest one of the subtree.
+static uint64_t visit_subtree(const struct min_heap *heap, size_t index,
+			      uint64_t max_key, min_heap_visit_func_t func,
+			      void *context)
+{
+	uint64_t left, right;
+
+	if (index >= heap->count)
+		return UINT64_MAX;
+	if (heap->entries[index].key > max_key)
+		return heap->entries[index].key;
+	func(heap->entries[index].data, context);
+	left = visit_subtree(heap, 2 * index + 1, max_key, func, context);
+	right = visit_subtree(heap, 2 * index + 2, max_key, func, context);
+	return MIN(left, right);
+}
+
+uint64_t min_heap_visit(const struct min_heap *heap, uint64_t max_key,
+			min_heap_visit_func_t func, void *context)
+{
+	return visit_subtree(heap, 0, max_key, func, context);
+}
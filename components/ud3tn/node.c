@@ -1,4 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
 #include "ud3tn/node.h"
 #include "ud3tn/result.h"
@@ -39,6 +40,9 @@ struct node *node_create(char *eid)
 
 struct contact *contact_create(struct node *node)
 {
+	// Contacts created concurrently may get the same number, which only
+	// affects their order, see contact_index.h.
+	static uint64_t last_sequence_number;
 	struct contact *ret = malloc(sizeof(struct contact));
 
 	if (ret == NULL)
@@ -52,8 +56,11 @@ struct contact *contact_create(struct node *node)
 	ret->remaining_capacity_p1 = 0;
 	ret->remaining_capacity_p2 = 0;
 	ret->contact_endpoints = NULL;
-	ret->contact_bundles = NULL;
+	routed_bundle_queue_init(&ret->contact_bundles);
 	ret->active = 0;
+	ret->prestaged = 0;
+	ret->upcoming_index = MIN_HEAP_NO_INDEX;
+	ret->sequence_number = ++last_sequence_number;
 	return ret;
 }
 
@@ -61,23 +68,18 @@ static void free_contact_internal(
 	struct contact *contact, int free_eid_list)
 {
 	struct endpoint_list *cur_eid;
-	struct routed_bundle_list *next, *cur_bundle;
 
 	if (contact == NULL)
 		return;
 	ASSERT(contact->active == 0);
+	ASSERT(contact->upcoming_index == MIN_HEAP_NO_INDEX);
 	if (free_eid_list) {
 		cur_eid = contact->contact_endpoints;
 		while (cur_eid != NULL)
 			cur_eid = endpoint_list_free(cur_eid);
 	}
 	/* Free associated bundle list (not bundles themselves) */
-	cur_bundle = contact->contact_bundles;
-	while (cur_bundle != NULL) {
-		next = cur_bundle->next;
-		free(cur_bundle);
-		cur_bundle = next;
-	}
+	routed_bundle_queue_clear(&contact->contact_bundles);
 	free(contact);
 }
 
@@ -471,7 +473,7 @@ struct endpoint_list *endpoint_list_strip_and_sort(struct endpoint_list *el)
 
 int node_prepare_and_verify(struct node *node, uint64_t min_end_time_s)
 {
-	struct contact_list *cl, *i;
+	struct contact_list *cl;
 
 	ASSERT(node != NULL);
 	if (!node || node->eid == NULL)
@@ -487,17 +489,35 @@ int node_prepare_and_verify(struct node *node, uint64_t min_end_time_s)
 			return 0;
 		cl->data->contact_endpoints = endpoint_list_strip_and_sort(
 			cl->data->contact_endpoints);
-		i = cl->next;
-		while (i != NULL) {
-			if (contacts_overlap(cl->data, i->data))
-				return 0;
-			i = i->next;
-		}
+		// The contacts are sorted by their start time, thus, a contact
+		// not overlapping with the next one does not overlap with any
+		// of the following ones.
+		if (cl->next != NULL && contacts_overlap(cl->data,
+							 cl->next->data))
+			return 0;
 		cl = cl->next;
 	}
 	return 1;
 }
 
+static void subtract_queued_bundles(struct contact *contact)
+{
+	const struct routed_bundle_list *entry;
+	int32_t size;
+
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		entry = contact->contact_bundles.head[p];
+		for (; entry != NULL; entry = entry->next) {
+			size = (int32_t)bundle_get_serialized_size(entry->data);
+			contact->remaining_capacity_p0 -= size;
+			if (p > BUNDLE_RPRIO_LOW)
+				contact->remaining_capacity_p1 -= size;
+			if (p > BUNDLE_RPRIO_NORMAL)
+				contact->remaining_capacity_p2 -= size;
+		}
+	}
+}
+
 void recalculate_contact_capacity(struct contact *contact)
 {
 	uint64_t duration_s, new_capacity_bytes;
@@ -520,6 +540,16 @@ void recalculate_contact_capacity(struct contact *contact)
 		contact->remaining_capacity_p2 = INT32_MAX;
 		return;
 	}
+	// Bundles queued while the capacity was "infinite" have not been
+	// accounted for, see router_add_bundle_to_contact().
+	if (contact->remaining_capacity_p0 == INT32_MAX) {
+		contact->total_capacity_bytes = (uint32_t)new_capacity_bytes;
+		contact->remaining_capacity_p0 = (int32_t)new_capacity_bytes;
+		contact->remaining_capacity_p1 = (int32_t)new_capacity_bytes;
+		contact->remaining_capacity_p2 = (int32_t)new_capacity_bytes;
+		subtract_queued_bundles(contact);
+		return;
+	}
 	capacity_difference = (
 		new_capacity_bytes -
 		(int32_t)contact->total_capacity_bytes
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/payload.h"
+
+#include "platform/hal_payload.h"
+
+#include <stdlib.h>
+
+static struct payload_buffer *payload_buffer_alloc(
+	enum payload_backing backing, uint8_t *data, size_t length)
+{
+	struct payload_buffer *buffer = malloc(sizeof(struct payload_buffer));
+
+	if (!buffer)
+		return NULL;
+
+	buffer->backing = backing;
+	buffer->data = data;
+	buffer->length = length;
+	buffer->ref_count = 1;
+	return buffer;
+}
+
+struct payload_buffer *payload_buffer_create(size_t length)
+{
+	struct payload_buffer *buffer;
+
+	if (payload_should_spill(length)) {
+		uint8_t *const data = hal_payload_spill_map(length);
+
+		if (!data)
+			return NULL;
+		buffer = payload_buffer_alloc(PAYLOAD_BACKING_FILE, data,
+					      length);
+		if (!buffer)
+			hal_payload_unmap(data, length);
+		return buffer;
+	}
+
+	// Allocate at least one byte to be able to detect failure.
+	uint8_t *const data = malloc(length ? length : 1);
+
+	if (!data)
+		return NULL;
+	buffer = payload_buffer_wrap(data, length);
+	if (!buffer)
+		free(data);
+	return buffer;
+}
+
+struct payload_buffer *payload_buffer_wrap(uint8_t *data, size_t length)
+{
+	return payload_buffer_alloc(PAYLOAD_BACKING_MEMORY, data, length);
+}
+
+struct payload_buffer *payload_buffer_map_file(const char *path)
+{
+	size_t length;
+	uint8_t *const data = hal_payload_map_file(path, &length);
+
+	if (!data)
+		return NULL;
+
+	struct payload_buffer *const buffer = payload_buffer_alloc(
+		PAYLOAD_BACKING_MAPPED_FILE,
+		data,
+		length
+	);
+
+	if (!buffer)
+		hal_payload_unmap(data, length);
+	return buffer;
+}
+
+void payload_buffer_prefetch(const struct payload_buffer *buffer,
+			     const uint8_t *data, size_t length)
+{
+	if (buffer->backing != PAYLOAD_BACKING_MEMORY)
+		hal_payload_prefetch(data, length);
+}
+
+struct payload_buffer *payload_buffer_get(struct payload_buffer *buffer)
+{
+	// Blocks referencing the same buffer may be released by different
+	// tasks (e.g. fragments handed to different CLAs).
+	__atomic_add_fetch(&buffer->ref_count, 1, __ATOMIC_RELAXED);
+	return buffer;
+}
+
+void payload_buffer_put(struct payload_buffer *buffer)
+{
+	if (!buffer)
+		return;
+
+	if (__atomic_sub_fetch(&buffer->ref_count, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+
+	if (buffer->backing == PAYLOAD_BACKING_MEMORY)
+		free(buffer->data);
+	else
+		hal_payload_unmap(buffer->data, buffer->length);
+	free(buffer);
+}
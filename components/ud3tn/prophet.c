@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/prophet.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROPHET_ATOMS_MIN_CAPACITY 16
+
+#define PROPHET_TABLE_VERSION 1
+// Version and the 32-bit number of entries
+#define PROPHET_TABLE_HEADER_SIZE 5
+// 16-bit EID length and 16-bit predictability
+#define PROPHET_ENTRY_OVERHEAD 4
+#define PROPHET_P_SCALE 65535.0f
+
+/* ATOMS */
+
+void prophet_atoms_init(struct prophet_atoms *atoms)
+{
+	hashmap_init(&atoms->map, 0);
+	atoms->eids = NULL;
+	atoms->refs = NULL;
+	atoms->unused = NULL;
+	atoms->unused_count = 0;
+	atoms->count = 0;
+	atoms->capacity = 0;
+}
+
+void prophet_atoms_free(struct prophet_atoms *atoms)
+{
+	for (uint32_t i = 0; i < atoms->count; i++)
+		free(atoms->eids[i]);
+	free(atoms->eids);
+	free(atoms->refs);
+	free(atoms->unused);
+	hashmap_deinit(&atoms->map);
+	prophet_atoms_init(atoms);
+}
+
+static enum ud3tn_result grow_atoms(struct prophet_atoms *atoms)
+{
+	const uint32_t capacity = (
+		atoms->capacity != 0
+		? atoms->capacity * 2
+		: PROPHET_ATOMS_MIN_CAPACITY
+	);
+	char **const eids = realloc(atoms->eids, capacity * sizeof(char *));
+
+	if (eids == NULL)
+		return UD3TN_FAIL;
+	atoms->eids = eids;
+
+	uint32_t *const refs = realloc(
+		atoms->refs,
+		capacity * sizeof(uint32_t)
+	);
+
+	if (refs == NULL)
+		return UD3TN_FAIL;
+	atoms->refs = refs;
+
+	uint32_t *const unused = realloc(
+		atoms->unused,
+		capacity * sizeof(uint32_t)
+	);
+
+	if (unused == NULL)
+		return UD3TN_FAIL;
+	atoms->unused = unused;
+	atoms->capacity = capacity;
+	return UD3TN_OK;
+}
+
+int32_t prophet_atom_get(struct prophet_atoms *atoms, const char *node_eid,
+			 bool create)
+{
+	const uintptr_t value = (uintptr_t)hashmap_get(&atoms->map, node_eid);
+
+	if (value != 0)
+		return (int32_t)(value - 1);
+	if (!create)
+		return -1;
+	if (atoms->unused_count == 0 && atoms->count == atoms->capacity &&
+	    (atoms->count == INT32_MAX || grow_atoms(atoms) != UD3TN_OK))
+		return -1;
+
+	const uint32_t atom = (
+		atoms->unused_count != 0
+		? atoms->unused[atoms->unused_count - 1]
+		: atoms->count
+	);
+	char *const eid = strdup(node_eid);
+
+	if (eid == NULL)
+		return -1;
+	if (hashmap_put(&atoms->map, node_eid,
+			(void *)(uintptr_t)(atom + 1)) != UD3TN_OK) {
+		free(eid);
+		return -1;
+	}
+	atoms->eids[atom] = eid;
+	atoms->refs[atom] = 0;
+	if (atoms->unused_count != 0)
+		atoms->unused_count--;
+	else
+		atoms->count++;
+	return (int32_t)atom;
+}
+
+// Releases the atom if no table has a predictability for it
+static void release_atom(struct prophet_atoms *atoms, uint32_t atom)
+{
+	if (atoms->refs[atom] != 0 || atoms->eids[atom] == NULL)
+		return;
+	hashmap_remove(&atoms->map, atoms->eids[atom]);
+	free(atoms->eids[atom]);
+	atoms->eids[atom] = NULL;
+	atoms->unused[atoms->unused_count++] = atom;
+}
+
+/* TABLE */
+
+void prophet_table_init(struct prophet_table *table,
+			struct prophet_atoms *atoms, uint64_t time_ms)
+{
+	table->p = NULL;
+	table->size = 0;
+	table->aged_ms = time_ms;
+	table->atoms = atoms;
+}
+
+// Sets the predictability, which has to be in range, and keeps track of the
+// atoms referred to by the table.
+static void set_p(struct prophet_table *table, uint32_t atom, float p)
+{
+	struct prophet_atoms *const atoms = table->atoms;
+
+	if (p < PROPHET_P_MIN)
+		p = 0.0f;
+	if (p != 0.0f && table->p[atom] == 0.0f) {
+		atoms->refs[atom]++;
+	} else if (p == 0.0f && table->p[atom] != 0.0f) {
+		atoms->refs[atom]--;
+		release_atom(atoms, atom);
+	}
+	table->p[atom] = p;
+}
+
+void prophet_table_free(struct prophet_table *table)
+{
+	for (uint32_t i = 0; i < table->size; i++)
+		set_p(table, i, 0.0f);
+	free(table->p);
+	table->p = NULL;
+	table->size = 0;
+}
+
+static enum ud3tn_result ensure_size(struct prophet_table *table,
+				     uint32_t size)
+{
+	if (size <= table->size)
+		return UD3TN_OK;
+
+	// Grow by at least half to amortize the reallocation
+	size = MAX(size, table->size + table->size / 2);
+
+	float *const p = realloc(table->p, size * sizeof(float));
+
+	if (p == NULL)
+		return UD3TN_FAIL;
+	for (uint32_t i = table->size; i < size; i++)
+		p[i] = 0.0f;
+	table->p = p;
+	table->size = size;
+	return UD3TN_OK;
+}
+
+void prophet_table_age(struct prophet_table *table, uint64_t time_ms)
+{
+	if (time_ms < table->aged_ms + PROPHET_AGING_UNIT_MS)
+		return;
+
+	const uint64_t units = (time_ms - table->aged_ms) /
+		PROPHET_AGING_UNIT_MS;
+	float factor = 1.0f;
+
+	// gamma^units, stops as soon as everything decays to zero
+	for (uint64_t i = 0; i < units && factor >= PROPHET_P_MIN; i++)
+		factor *= PROPHET_GAMMA;
+
+	for (uint32_t i = 0; i < table->size; i++)
+		set_p(table, i, table->p[i] * factor);
+	table->aged_ms += units * PROPHET_AGING_UNIT_MS;
+}
+
+enum ud3tn_result prophet_table_encounter(struct prophet_table *table,
+					  int32_t atom)
+{
+	if (atom < 0 || ensure_size(table, (uint32_t)atom + 1) != UD3TN_OK)
+		return UD3TN_FAIL;
+	set_p(
+		table,
+		(uint32_t)atom,
+		table->p[atom] + (1.0f - table->p[atom]) * PROPHET_P_ENCOUNTER
+	);
+	return UD3TN_OK;
+}
+
+enum ud3tn_result prophet_table_transitive(
+	struct prophet_table *table, int32_t atom,
+	const struct prophet_table *peer_table)
+{
+	const float p_ab = prophet_table_get(table, atom);
+
+	if (p_ab == 0.0f)
+		return UD3TN_OK;
+	if (ensure_size(table, peer_table->size) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	for (uint32_t c = 0; c < peer_table->size; c++) {
+		const float p_ac = p_ab * peer_table->p[c] * PROPHET_BETA;
+
+		// The predictability for the node itself is not derived
+		if ((int32_t)c != atom && p_ac > table->p[c])
+			set_p(table, c, p_ac);
+	}
+	return UD3TN_OK;
+}
+
+/* SERIALIZATION */
+
+uint8_t *prophet_table_serialize(const struct prophet_table *table,
+				 const struct prophet_atoms *atoms,
+				 size_t *length)
+{
+	size_t size = PROPHET_TABLE_HEADER_SIZE;
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < table->size && i < atoms->count; i++) {
+		if (table->p[i] < PROPHET_P_MIN)
+			continue;
+		size += PROPHET_ENTRY_OVERHEAD + MIN(
+			strlen(atoms->eids[i]),
+			(size_t)UINT16_MAX
+		);
+		count++;
+	}
+
+	uint8_t *const buffer = malloc(size);
+
+	if (buffer == NULL)
+		return NULL;
+	buffer[0] = PROPHET_TABLE_VERSION;
+	buffer[1] = (count >> 24) & 0xFF;
+	buffer[2] = (count >> 16) & 0xFF;
+	buffer[3] = (count >> 8) & 0xFF;
+	buffer[4] = count & 0xFF;
+
+	uint8_t *cur = &buffer[PROPHET_TABLE_HEADER_SIZE];
+
+	for (uint32_t i = 0; i < table->size && i < atoms->count; i++) {
+		if (table->p[i] < PROPHET_P_MIN)
+			continue;
+
+		const size_t eid_length = MIN(
+			strlen(atoms->eids[i]),
+			(size_t)UINT16_MAX
+		);
+		const uint16_t p = (uint16_t)(
+			MIN(table->p[i], 1.0f) * PROPHET_P_SCALE + 0.5f
+		);
+
+		cur[0] = (eid_length >> 8) & 0xFF;
+		cur[1] = eid_length & 0xFF;
+		memcpy(&cur[2], atoms->eids[i], eid_length);
+		cur += 2 + eid_length;
+		cur[0] = (p >> 8) & 0xFF;
+		cur[1] = p & 0xFF;
+		cur += 2;
+	}
+	*length = size;
+	return buffer;
+}
+
+enum ud3tn_result prophet_table_parse(struct prophet_table *table,
+				      struct prophet_atoms *atoms,
+				      const uint8_t *data, size_t length,
+				      uint64_t time_ms)
+{
+	if (length < PROPHET_TABLE_HEADER_SIZE ||
+	    length > PROPHET_TABLE_MAX_SIZE ||
+	    data[0] != PROPHET_TABLE_VERSION)
+		return UD3TN_FAIL;
+
+	const uint32_t count = (
+		(uint32_t)data[1] << 24 |
+		(uint32_t)data[2] << 16 |
+		(uint32_t)data[3] << 8 |
+		(uint32_t)data[4]
+	);
+	size_t pos = PROPHET_TABLE_HEADER_SIZE;
+
+	prophet_table_init(table, atoms, time_ms);
+	for (uint32_t i = 0; i < count; i++) {
+		if (length - pos < PROPHET_ENTRY_OVERHEAD)
+			goto fail;
+
+		const size_t eid_length = (size_t)data[pos] << 8 | data[pos + 1];
+
+		if (length - pos < PROPHET_ENTRY_OVERHEAD + eid_length)
+			goto fail;
+
+		char *const eid = malloc(eid_length + 1);
+
+		if (eid == NULL)
+			goto fail;
+		memcpy(eid, &data[pos + 2], eid_length);
+		eid[eid_length] = '\0';
+		pos += 2 + eid_length;
+
+		const float p = (
+			((uint16_t)data[pos] << 8 | data[pos + 1]) /
+			PROPHET_P_SCALE
+		);
+		int32_t atom = prophet_atom_get(atoms, eid, false);
+
+		// Unknown EIDs of negligible predictability are not kept
+		if (atom < 0 && p >= PROPHET_P_INTERN) {
+			atom = prophet_atom_get(atoms, eid, true);
+			if (atom < 0) {
+				free(eid);
+				goto fail;
+			}
+		}
+		free(eid);
+		pos += 2;
+		if (atom < 0)
+			continue;
+		if (ensure_size(table, (uint32_t)atom + 1) != UD3TN_OK) {
+			release_atom(atoms, (uint32_t)atom);
+			goto fail;
+		}
+		set_p(table, (uint32_t)atom, p);
+		release_atom(atoms, (uint32_t)atom);
+	}
+	if (pos != length)
+		goto fail;
+	return UD3TN_OK;
+
+fail:
+	prophet_table_free(table);
+	return UD3TN_FAIL;
+}
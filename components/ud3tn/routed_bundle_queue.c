@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/routed_bundle_queue.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+
+void routed_bundle_queue_init(struct routed_bundle_queue *queue)
+{
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		queue->head[p] = NULL;
+		queue->tail[p] = NULL;
+	}
+	queue->length = 0;
+}
+
+static struct routed_bundle_list *find_entry(
+	const struct routed_bundle_queue *queue, const struct bundle *bundle)
+{
+	struct routed_bundle_list *entry = bundle->routed_entries;
+
+	while (entry != NULL && entry->queue != queue)
+		entry = entry->next_for_bundle;
+	return entry;
+}
+
+static void detach_from_bundle(struct routed_bundle_list *entry)
+{
+	struct routed_bundle_list **cur = &entry->data->routed_entries;
+
+	while (*cur != entry) {
+		ASSERT(*cur != NULL);
+		cur = &(*cur)->next_for_bundle;
+	}
+	*cur = entry->next_for_bundle;
+	entry->next_for_bundle = NULL;
+	entry->queue = NULL;
+}
+
+static void unlink_entry(struct routed_bundle_queue *queue,
+			 struct routed_bundle_list *entry)
+{
+	if (entry->prev != NULL)
+		entry->prev->next = entry->next;
+	else
+		queue->head[entry->prio] = entry->next;
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
+	else
+		queue->tail[entry->prio] = entry->prev;
+	entry->next = NULL;
+	entry->prev = NULL;
+	queue->length--;
+}
+
+static void link_entry(struct routed_bundle_queue *queue,
+		       struct routed_bundle_list *entry)
+{
+	struct routed_bundle_list *pos = queue->tail[entry->prio];
+
+#if CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+	// Bundles mostly arrive in order of their expiration time, so the
+	// position is typically found directly at the tail.
+	while (pos != NULL && pos->expiration_ms > entry->expiration_ms)
+		pos = pos->prev;
+#endif // CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+
+	entry->prev = pos;
+	if (pos != NULL) {
+		entry->next = pos->next;
+		pos->next = entry;
+	} else {
+		entry->next = queue->head[entry->prio];
+		queue->head[entry->prio] = entry;
+	}
+	if (entry->next != NULL)
+		entry->next->prev = entry;
+	else
+		queue->tail[entry->prio] = entry;
+	queue->length++;
+}
+
+enum ud3tn_result routed_bundle_queue_push(struct routed_bundle_queue *queue,
+					   struct bundle *bundle)
+{
+	ASSERT(find_entry(queue, bundle) == NULL);
+	if (find_entry(queue, bundle) != NULL)
+		return UD3TN_FAIL;
+
+	struct routed_bundle_list *entry = malloc(
+		sizeof(struct routed_bundle_list)
+	);
+
+	if (entry == NULL)
+		return UD3TN_FAIL;
+	entry->data = bundle;
+	entry->queue = queue;
+	entry->prio = bundle_get_routing_priority(bundle);
+	entry->expiration_ms = bundle_get_expiration_time_ms(bundle);
+	link_entry(queue, entry);
+
+	entry->next_for_bundle = bundle->routed_entries;
+	bundle->routed_entries = entry;
+	return UD3TN_OK;
+}
+
+enum ud3tn_result routed_bundle_queue_remove(struct routed_bundle_queue *queue,
+					     struct bundle *bundle)
+{
+	struct routed_bundle_list *entry = find_entry(queue, bundle);
+
+	if (entry == NULL)
+		return UD3TN_FAIL;
+	unlink_entry(queue, entry);
+	detach_from_bundle(entry);
+	free(entry);
+	return UD3TN_OK;
+}
+
+static struct routed_bundle_list *first_entry(
+	const struct routed_bundle_queue *queue)
+{
+	for (int p = BUNDLE_RPRIO_MAX - 1; p >= 0; p--) {
+		if (queue->head[p] != NULL)
+			return queue->head[p];
+	}
+	return NULL;
+}
+
+struct bundle *routed_bundle_queue_first(
+	const struct routed_bundle_queue *queue)
+{
+	struct routed_bundle_list *entry = first_entry(queue);
+
+	return entry != NULL ? entry->data : NULL;
+}
+
+struct bundle *routed_bundle_queue_pop(struct routed_bundle_queue *queue)
+{
+	struct routed_bundle_list *entry = first_entry(queue);
+
+	if (entry == NULL)
+		return NULL;
+
+	struct bundle *bundle = entry->data;
+
+	unlink_entry(queue, entry);
+	detach_from_bundle(entry);
+	free(entry);
+	return bundle;
+}
+
+struct routed_bundle_list *routed_bundle_queue_take(
+	struct routed_bundle_queue *queue, size_t max_count)
+{
+	struct routed_bundle_list *result = NULL, **next = &result;
+	size_t count = 0;
+
+	for (int p = BUNDLE_RPRIO_MAX - 1; p >= 0; p--) {
+		struct routed_bundle_list *entry = queue->head[p];
+
+		if (entry == NULL)
+			continue;
+
+		// Chain the partition to the result, the entries are
+		// already linked via next.
+		*next = entry;
+		while (entry != NULL && (max_count == 0 || count < max_count)) {
+			detach_from_bundle(entry);
+			entry->prev = NULL;
+			next = &entry->next;
+			entry = entry->next;
+			count++;
+		}
+
+		// Split the partition if the batch is full
+		queue->head[p] = entry;
+		*next = NULL;
+		if (entry != NULL) {
+			entry->prev = NULL;
+			break;
+		}
+		queue->tail[p] = NULL;
+	}
+
+	queue->length -= count;
+	return result;
+}
+
+void routed_bundle_queue_clear(struct routed_bundle_queue *queue)
+{
+	struct routed_bundle_list *entry = routed_bundle_queue_take(queue, 0);
+
+	while (entry != NULL) {
+		struct routed_bundle_list *next = entry->next;
+
+		free(entry);
+		entry = next;
+	}
+}
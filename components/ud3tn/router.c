@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle.h"
+#include "ud3tn/cgr.h"
 #include "ud3tn/common.h"
 #include "ud3tn/eid.h"
+#include "ud3tn/hashmap.h"
 #include "ud3tn/node.h"
 #include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
@@ -11,6 +13,7 @@
 #include "platform/hal_io.h"
 #include "platform/hal_time.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -43,13 +46,19 @@ struct contact_list *router_lookup_destination(char *const dest)
 	if (!dest_node_eid || !e)
 		e = routing_table_lookup_eid(dest);
 
-	struct contact_list *result = NULL;
+	struct contact_list *result = NULL, **tail = &result;
 
+	// The contacts of the entry are already ordered by their end time
 	if (e != NULL) {
 		struct contact_list *cur = e->contacts;
 
 		while (cur != NULL) {
-			add_contact_to_ordered_list(&result, cur->data, 0);
+			*tail = malloc(sizeof(struct contact_list));
+			if (*tail == NULL)
+				break;
+			(*tail)->data = cur->data;
+			(*tail)->next = NULL;
+			tail = &(*tail)->next;
 			cur = cur->next;
 		}
 	}
@@ -59,6 +68,131 @@ struct contact_list *router_lookup_destination(char *const dest)
 	return result;
 }
 
+/* ROUTE CACHE */
+
+// The contacts of an entry form a vector that is linked as contact_list, so
+// it can be passed to the route calculation functions as is.
+struct route_cache_entry {
+	char *destination;
+	struct route_cache_entry *prev;
+	struct route_cache_entry *next;
+	// Routing table generation the contacts have been looked up for
+	uint32_t generation;
+	size_t contact_count;
+	struct contact_list contacts[];
+};
+
+/* Destination EID -> struct route_cache_entry */
+static struct hashmap route_cache;
+static struct route_cache_entry *route_cache_entries;
+static bool route_cache_initialized;
+
+static void route_cache_remove(struct route_cache_entry *entry)
+{
+	hashmap_remove(&route_cache, entry->destination);
+	if (entry->prev != NULL)
+		entry->prev->next = entry->next;
+	else
+		route_cache_entries = entry->next;
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
+	free(entry->destination);
+	free(entry);
+}
+
+static void route_cache_clear(void)
+{
+	while (route_cache_entries != NULL)
+		route_cache_remove(route_cache_entries);
+}
+
+static struct route_cache_entry *route_cache_add(
+	const char *dest, const struct contact_list *contacts)
+{
+	struct route_cache_entry *entry;
+	size_t count = 0;
+
+	for (const struct contact_list *c = contacts; c != NULL; c = c->next)
+		count++;
+	if (hashmap_count(&route_cache) >= ROUTER_ROUTE_CACHE_SIZE)
+		route_cache_clear();
+
+	entry = malloc(sizeof(struct route_cache_entry) +
+		       count * sizeof(struct contact_list));
+	if (entry == NULL)
+		return NULL;
+	entry->destination = strdup(dest);
+	if (entry->destination == NULL) {
+		free(entry);
+		return NULL;
+	}
+	if (hashmap_put(&route_cache, dest, entry) != UD3TN_OK) {
+		free(entry->destination);
+		free(entry);
+		return NULL;
+	}
+	entry->generation = routing_table_get_generation();
+	entry->contact_count = count;
+	// The list of the routing table is already ordered by end time
+	for (size_t i = 0; i < count; i++) {
+		entry->contacts[i].data = contacts->data;
+		entry->contacts[i].next = (
+			i + 1 < count ? &entry->contacts[i + 1] : NULL
+		);
+		contacts = contacts->next;
+	}
+	entry->prev = NULL;
+	entry->next = route_cache_entries;
+	if (route_cache_entries != NULL)
+		route_cache_entries->prev = entry;
+	route_cache_entries = entry;
+	return entry;
+}
+
+struct contact_list *router_lookup_destination_cached(const char *dest)
+{
+	struct route_cache_entry *entry;
+
+	if (!route_cache_initialized) {
+		hashmap_init(&route_cache, ROUTER_ROUTE_CACHE_SIZE);
+		route_cache_initialized = true;
+	}
+
+	entry = hashmap_get(&route_cache, dest);
+	// Contacts may have been freed if the routing table was modified
+	if (entry != NULL &&
+	    entry->generation != routing_table_get_generation()) {
+		route_cache_remove(entry);
+		entry = NULL;
+	}
+	if (entry == NULL) {
+		char *dest_node_eid = get_node_id(dest);
+		const struct node_table_entry *e = NULL;
+
+		if (dest_node_eid)
+			e = routing_table_lookup_eid(dest_node_eid);
+		// Fallback: perform a "dumb" string lookup
+		if (!dest_node_eid || !e)
+			e = routing_table_lookup_eid(dest);
+		free(dest_node_eid);
+
+		entry = route_cache_add(dest, e != NULL ? e->contacts : NULL);
+		if (entry == NULL)
+			return NULL;
+	}
+
+	return entry->contact_count != 0 ? entry->contacts : NULL;
+}
+
+void router_route_cache_free(void)
+{
+	if (!route_cache_initialized)
+		return;
+	route_cache_clear();
+	hashmap_deinit(&route_cache);
+	route_cache_initialized = false;
+}
+
 static inline struct max_fragment_size_result {
 	uint32_t max_fragment_size;
 	uint32_t payload_capacity;
@@ -278,8 +412,17 @@ struct router_result router_get_first_route(struct bundle *bundle)
 		bundle
 	);
 	struct router_result res;
+#ifdef ROUTING_CGR
+	// First hops of all routes arriving in time, best route first
+	struct contact_list *contacts = cgr_lookup_first_hops(
+		bundle->destination,
+		expiration_time_ms
+	);
+#else // ROUTING_CGR
+	// Owned by the route cache, must not be freed
 	struct contact_list *contacts =
-		router_lookup_destination(bundle->destination);
+		router_lookup_destination_cached(bundle->destination);
+#endif // ROUTING_CGR
 
 	res.fragments = 0;
 	res.preemption_improved = 0;
@@ -352,12 +495,14 @@ struct router_result router_get_first_route(struct bundle *bundle)
 		);
 
 finish:
+#ifdef ROUTING_CGR
 	while (contacts) {
 		struct contact_list *const tmp = contacts->next;
 
 		free(contacts);
 		contacts = tmp;
 	}
+#endif // ROUTING_CGR
 	return res;
 }
 
@@ -383,7 +528,7 @@ struct router_result router_try_reuse(
 		fr = &route.fragment_results[0];
 		fr->payload_size = remaining_pay;
 		if (fr->contact->to_ms <= time_ms ||
-		    fr->contact->to_ms > expiration_time_ms ||
+		    fr->contact->from_ms >= expiration_time_ms ||
 		    ROUTER_CONTACT_CAPACITY(fr->contact, 0) < (int32_t)size)
 			route.fragments = 0;
 		return route;
@@ -400,7 +545,7 @@ struct router_result router_try_reuse(
 		fr = &route.fragment_results[f];
 		min_cap = UINT32_MAX;
 		if (fr->contact->to_ms <= time_ms ||
-		    fr->contact->to_ms > expiration_time_ms ||
+		    fr->contact->from_ms >= expiration_time_ms ||
 		    (ROUTER_CONTACT_CAPACITY(fr->contact, 0) <
 		     (int32_t)(size + RC.fragment_min_payload))) {
 			route.fragments = 0;
@@ -425,30 +570,14 @@ struct router_result router_try_reuse(
 enum ud3tn_result router_add_bundle_to_contact(
 	struct contact *contact, struct bundle *b)
 {
-	struct routed_bundle_list *new_entry, **cur_entry;
-
 	ASSERT(contact != NULL);
 	ASSERT(b != NULL);
 	if (!contact || !b)
 		return UD3TN_FAIL;
 	ASSERT(contact->remaining_capacity_p0 > 0);
 
-	new_entry = malloc(sizeof(struct routed_bundle_list));
-	if (new_entry == NULL)
+	if (routed_bundle_queue_push(&contact->contact_bundles, b) != UD3TN_OK)
 		return UD3TN_FAIL;
-	new_entry->data = b;
-	new_entry->next = NULL;
-	cur_entry = &contact->contact_bundles;
-	/* Go to end of list (=> FIFO) */
-	while (*cur_entry != NULL) {
-		ASSERT((*cur_entry)->data != b);
-		if ((*cur_entry)->data == b) {
-			free(new_entry);
-			return UD3TN_FAIL;
-		}
-		cur_entry = &(*cur_entry)->next;
-	}
-	*cur_entry = new_entry;
 	// This contact is of infinite capacity, just return "OK".
 	if (contact->remaining_capacity_p0 == INT32_MAX)
 		return UD3TN_OK;
@@ -469,37 +598,38 @@ enum ud3tn_result router_add_bundle_to_contact(
 enum ud3tn_result router_remove_bundle_from_contact(
 	struct contact *contact, struct bundle *bundle)
 {
-	struct routed_bundle_list **cur_entry, *tmp;
-
 	ASSERT(contact != NULL);
 	if (!contact)
 		return UD3TN_FAIL;
-	cur_entry = &contact->contact_bundles;
-	/* Find bundle */
-	while (*cur_entry != NULL) {
-		ASSERT((*cur_entry)->data != NULL);
-		if ((*cur_entry)->data == bundle) {
-			tmp = *cur_entry;
-			*cur_entry = (*cur_entry)->next;
-			free(tmp);
-			// This contact is of infinite capacity, do nothing.
-			if (contact->remaining_capacity_p0 == INT32_MAX)
-				continue;
+	if (routed_bundle_queue_remove(&contact->contact_bundles,
+				       bundle) != UD3TN_OK)
+		return UD3TN_FAIL;
+	// This contact is of infinite capacity, do nothing.
+	if (contact->remaining_capacity_p0 == INT32_MAX)
+		return UD3TN_OK;
 
-			const size_t bundle_size =
-				bundle_get_serialized_size(bundle);
-			const enum bundle_routing_priority prio =
-				bundle_get_routing_priority(bundle);
+	const size_t bundle_size = bundle_get_serialized_size(bundle);
+	const enum bundle_routing_priority prio =
+		bundle_get_routing_priority(bundle);
 
-			contact->remaining_capacity_p0 += bundle_size;
-			if (prio > BUNDLE_RPRIO_LOW) {
-				contact->remaining_capacity_p1 += bundle_size;
-				if (prio != BUNDLE_RPRIO_NORMAL)
-					contact->remaining_capacity_p2 += bundle_size;
-			}
-			return UD3TN_OK;
-		}
-		cur_entry = &(*cur_entry)->next;
+	contact->remaining_capacity_p0 += bundle_size;
+	if (prio > BUNDLE_RPRIO_LOW) {
+		contact->remaining_capacity_p1 += bundle_size;
+		if (prio != BUNDLE_RPRIO_NORMAL)
+			contact->remaining_capacity_p2 += bundle_size;
 	}
-	return UD3TN_FAIL;
+	return UD3TN_OK;
+}
+
+// Epidemic, PRoPHET and Spray-and-Wait decide per bundle and peer, the
+// legacy and CG routers implement batches in router_task_legacy.c.
+#if !defined(ROUTING_LEGACY) && !defined(ROUTING_CGR)
+
+void router_route_bundles(struct bundle **bundles, size_t count,
+			  enum router_result_status *results)
+{
+	for (size_t i = 0; i < count; i++)
+		results[i] = router_route_bundle(bundles[i]);
 }
+
+#endif // !ROUTING_LEGACY && !ROUTING_CGR
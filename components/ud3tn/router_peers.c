@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/summary_vector.h"
+
+#include "platform/hal_time.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ROUTER_PEERS
+
+static const struct router_peer_ops *peer_ops;
+/* Node EID -> struct router_peer */
+static struct hashmap peers;
+// All peers, to check them for expiration
+static struct router_peer *peer_list;
+
+void router_peers_init(const struct router_peer_ops *ops)
+{
+	if (peer_ops != NULL)
+		return;
+	hashmap_init(&peers, 0);
+	peer_ops = ops;
+}
+
+static void free_peer(struct router_peer *peer)
+{
+	if (peer->state != NULL && peer_ops->free_state)
+		peer_ops->free_state(peer->state);
+	digest_set_free(&peer->sent);
+	free(peer->node_eid);
+	free(peer);
+}
+
+struct router_peer *router_peers_get(const char *node_eid, bool create)
+{
+	struct router_peer *peer;
+
+	if (peer_ops == NULL)
+		return NULL;
+	peer = hashmap_get(&peers, node_eid);
+	if (peer != NULL && create)
+		peer->last_contact_ms = hal_time_get_timestamp_ms();
+	if (peer != NULL || !create)
+		return peer;
+
+	peer = malloc(sizeof(struct router_peer));
+	if (peer == NULL)
+		return NULL;
+	peer->node_eid = strdup(node_eid);
+	digest_set_init(&peer->sent);
+	peer->state = peer_ops->create_state ? peer_ops->create_state() : NULL;
+	peer->last_contact_ms = hal_time_get_timestamp_ms();
+	if (peer->node_eid == NULL ||
+	    (peer_ops->create_state && peer->state == NULL) ||
+	    hashmap_put(&peers, node_eid, peer) != UD3TN_OK) {
+		free_peer(peer);
+		return NULL;
+	}
+	peer->next = peer_list;
+	peer_list = peer;
+	return peer;
+}
+
+static bool in_contact(const char *node_eid)
+{
+	const struct node *const node = routing_table_lookup_node(node_eid);
+
+	if (node == NULL)
+		return false;
+	for (const struct contact_list *cl = node->contacts; cl; cl = cl->next) {
+		if (cl->data->active)
+			return true;
+	}
+	return false;
+}
+
+// Drops the peers without pending bundles not in contact for a long time
+static void expire_peers(uint64_t time_ms)
+{
+	struct router_peer **cur = &peer_list;
+
+	while (*cur != NULL) {
+		struct router_peer *const peer = *cur;
+
+		digest_set_expire(&peer->sent, time_ms);
+		if (peer->sent.count != 0 ||
+		    peer->last_contact_ms + ROUTER_PEER_TIMEOUT_MS > time_ms ||
+		    in_contact(peer->node_eid)) {
+			cur = &peer->next;
+			continue;
+		}
+		*cur = peer->next;
+		hashmap_remove(&peers, peer->node_eid);
+		free_peer(peer);
+	}
+}
+
+static struct node *get_node_by_cla_addr(const char *cla_addr)
+{
+	struct node_list *node_list = routing_table_get_node_list();
+
+	for (; node_list != NULL; node_list = node_list->next) {
+		if (node_list->node->cla_addr != NULL &&
+		    strcmp(node_list->node->cla_addr, cla_addr) == 0)
+			return node_list->node;
+	}
+	return NULL;
+}
+
+static void bundle_unsent(struct router_peer *peer, struct bundle *bundle)
+{
+	if (peer_ops->unsent)
+		peer_ops->unsent(peer, bundle);
+	else
+		digest_set_remove(&peer->sent, summary_vector_digest(bundle));
+}
+
+static bool owns_bundle(const struct bundle *bundle)
+{
+	return peer_ops->owns != NULL && peer_ops->owns(bundle);
+}
+
+bool router_peers_transmission_ended(struct bundle *bundle,
+				     const char *peer_cla_addr, bool success)
+{
+	if (peer_ops == NULL)
+		return false;
+	if (success || peer_cla_addr == NULL)
+		return owns_bundle(bundle);
+
+	const struct node *const node = get_node_by_cla_addr(peer_cla_addr);
+	struct router_peer *const peer = (
+		node != NULL ? router_peers_get(node->eid, false) : NULL
+	);
+
+	// The bundle has to be sent again during the next contact
+	if (peer != NULL)
+		bundle_unsent(peer, bundle);
+	return owns_bundle(bundle);
+}
+
+bool router_peers_bundle_unqueued(const struct contact *contact,
+				  struct bundle *bundle)
+{
+	struct router_peer *peer;
+
+	if (peer_ops == NULL)
+		return false;
+	peer = (
+		contact->node != NULL
+		? router_peers_get(contact->node->eid, false)
+		: NULL
+	);
+	if (peer != NULL)
+		bundle_unsent(peer, bundle);
+	return owns_bundle(bundle);
+}
+
+void router_peers_contact_over(const struct contact *contact)
+{
+	const uint64_t time_ms = hal_time_get_timestamp_ms();
+	struct contact_list *cl = *routing_table_get_raw_contact_list_ptr();
+	struct router_peer *peer;
+
+	// The contact may have been deleted already
+	while (cl != NULL && cl->data != contact)
+		cl = cl->next;
+	peer = (
+		cl != NULL && contact->node != NULL
+		? router_peers_get(contact->node->eid, false)
+		: NULL
+	);
+
+	if (peer != NULL) {
+		// Bundles still queued have not been sent
+		for (int prio = 0; prio < BUNDLE_RPRIO_MAX; prio++) {
+			const struct routed_bundle_list *e =
+				contact->contact_bundles.head[prio];
+
+			for (; e != NULL; e = e->next)
+				bundle_unsent(peer, e->data);
+		}
+		peer->last_contact_ms = time_ms;
+	}
+	if (peer_ops != NULL)
+		expire_peers(time_ms);
+}
+
+enum router_result_status router_peers_route_direct(struct bundle *bundle)
+{
+	char *const node_eid = get_node_id(bundle->destination);
+	struct node *const node = (
+		node_eid != NULL ? routing_table_lookup_node(node_eid) : NULL
+	);
+
+	free(node_eid);
+	if (node == NULL)
+		return ROUTER_RESULT_NO_ROUTE;
+
+	for (struct contact_list *cl = node->contacts; cl; cl = cl->next) {
+		if (!cl->data->active)
+			continue;
+		if (router_add_bundle_to_contact(cl->data, bundle) == UD3TN_OK)
+			return ROUTER_RESULT_OK;
+	}
+	return ROUTER_RESULT_NO_ROUTE;
+}
+
+#endif // ROUTER_PEERS
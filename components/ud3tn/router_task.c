@@ -3,6 +3,7 @@
 #include "ud3tn/bundle.h"
 #include "ud3tn/bundle_fragmenter.h"
 #include "ud3tn/common.h"
+#include "ud3tn/hashmap.h"
 #include "ud3tn/node.h"
 #include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
@@ -75,4 +76,123 @@ enum ud3tn_result router_process_command(
 	free(command);
 
 	return success ? UD3TN_OK : UD3TN_FAIL;
-}
\ No newline at end of file
+}
+
+// Returns whether the node of the command is known after applying the
+// preceding commands of the plan, the last of which referring to the node
+// is passed (NULL if there is none).
+static bool node_known(const struct router_command *command,
+		       const struct router_command *last)
+{
+	if (last == NULL)
+		return routing_table_lookup_node(command->data->eid) != NULL;
+	// Only deleting without endpoints and contacts removes the node
+	return (
+		last->type != ROUTER_COMMAND_DELETE ||
+		last->data->endpoints != NULL ||
+		last->data->contacts != NULL
+	);
+}
+
+// Returns whether the command does not fail depending on the routing table.
+static bool command_applicable(const struct router_command *command,
+			       bool known)
+{
+	switch (command->type) {
+	case ROUTER_COMMAND_ADD:
+#ifdef ROUTING_CGR
+		return true;
+#else // ROUTING_CGR
+		// New nodes without CLA address are only accepted by CGR
+		return known || command->data->cla_addr != NULL;
+#endif // ROUTING_CGR
+	case ROUTER_COMMAND_UPDATE:
+	case ROUTER_COMMAND_DELETE:
+		return known;
+	default:
+		return false;
+	}
+}
+
+static bool verify_commands(struct router_command *commands, size_t count)
+{
+	const uint64_t cur_time_s = hal_time_get_timestamp_s();
+	// Node EID -> last command of the plan referring to the node
+	struct hashmap last_commands;
+	bool valid = true;
+
+	hashmap_init(&last_commands, count);
+	for (size_t i = 0; valid && i < count; i++) {
+		struct router_command *const command = &commands[i];
+
+		if (!node_prepare_and_verify(command->data, cur_time_s)) {
+			LOGF_WARN(
+				"Router: Command %lu (T = %c) of plan is invalid, rejecting plan!",
+				(unsigned long)i,
+				command->type
+			);
+			valid = false;
+			break;
+		}
+
+		const struct router_command *const last = hashmap_remove(
+			&last_commands,
+			command->data->eid
+		);
+
+		if (!command_applicable(command, node_known(command, last))) {
+			LOGF_WARN(
+				"Router: Command %lu (T = %c) of plan cannot be applied to node \"%s\", rejecting plan!",
+				(unsigned long)i,
+				command->type,
+				command->data->eid
+			);
+			valid = false;
+		} else if (hashmap_put(&last_commands, command->data->eid,
+				       command) != UD3TN_OK) {
+			LOG_WARN("Router: Cannot verify plan, rejecting it!");
+			valid = false;
+		}
+	}
+	hashmap_deinit(&last_commands);
+	return valid;
+}
+
+enum ud3tn_result router_process_commands(
+	struct router_command *commands, size_t count,
+	struct rescheduling_handle rescheduler)
+{
+	size_t failed = 0;
+
+	// All commands are verified before applying the first one, so that a
+	// plan which would fail does not leave the routing table half updated.
+	if (!verify_commands(commands, count)) {
+		for (size_t i = 0; i < count; i++) {
+			free_node(commands[i].data);
+			commands[i].data = NULL;
+		}
+		return UD3TN_FAIL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (!process_router_command(&commands[i], rescheduler))
+			failed++;
+		// The node has been taken over or freed by the routing table.
+		commands[i].data = NULL;
+	}
+	if (failed != 0) {
+		// Only possible if memory could not be allocated
+		LOGF_WARN(
+			"Router: Processing %lu of %lu commands of plan failed!",
+			(unsigned long)failed,
+			(unsigned long)count
+		);
+	} else {
+		LOGF_DEBUG(
+			"Router: Plan of %lu commands processed.",
+			(unsigned long)count
+		);
+	}
+
+	return failed == 0 ? UD3TN_OK : UD3TN_FAIL;
+}
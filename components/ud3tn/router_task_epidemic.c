@@ -1,10 +1,19 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/bundle_fragmenter.h"
+#include "ud3tn/common.h"
+#include "ud3tn/eid.h"
 #include "ud3tn/node.h"
 #include "ud3tn/result.h"
 #include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
 #include "ud3tn/routing_table.h"
+#include "ud3tn/summary_vector.h"
+
+#include "agents/epidemic_agent.h"
+
+#include "cla/cla.h"
 
 #include "platform/hal_io.h"
 #include "platform/hal_time.h"
@@ -13,11 +22,298 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef ROUTING_EPIDEMIC
 
+// PEER STATE
+
+// A bundle which has been sent to a peer partially, as fragments
+struct epidemic_transfer {
+	uint64_t digest;
+	uint64_t expiration_ms;
+	struct fragment_ranges sent;
+	struct epidemic_transfer *next;
+};
+
+struct epidemic_peer {
+	// Last summary vector received from the peer
+	struct summary_vector summary;
+	// Bundles of which only some fragments have been queued for the peer
+	struct epidemic_transfer *transfers;
+	// Bundles counted as suppressed for the peer, see count_suppressed()
+	struct digest_set suppressed;
+};
+
+/* Bundles known to this node, sent to peers as summary vector */
+static struct digest_set known;
+static struct router_epidemic_stats stats;
+static bool initialized;
+
+static struct epidemic_transfer *get_transfer(struct epidemic_peer *peer,
+					      uint64_t digest)
+{
+	struct epidemic_transfer *t = peer->transfers;
+
+	while (t != NULL && t->digest != digest)
+		t = t->next;
+	return t;
+}
+
+static struct epidemic_transfer *create_transfer(struct epidemic_peer *peer,
+						 uint64_t digest,
+						 uint64_t expiration_ms)
+{
+	struct epidemic_transfer *t = malloc(sizeof(struct epidemic_transfer));
+
+	if (t == NULL)
+		return NULL;
+	t->digest = digest;
+	t->expiration_ms = expiration_ms;
+	fragment_ranges_init(&t->sent);
+	t->next = peer->transfers;
+	peer->transfers = t;
+	return t;
+}
+
+static void remove_transfers(struct epidemic_peer *peer, uint64_t time_ms,
+			     bool only_empty)
+{
+	struct epidemic_transfer **t = &peer->transfers;
+
+	while (*t != NULL) {
+		struct epidemic_transfer *const cur = *t;
+
+		if (cur->expiration_ms < time_ms ||
+		    (only_empty && cur->sent.count == 0)) {
+			*t = cur->next;
+			fragment_ranges_free(&cur->sent);
+			free(cur);
+		} else {
+			t = &cur->next;
+		}
+	}
+}
+
+static void *create_peer(void)
+{
+	struct epidemic_peer *const peer = malloc(
+		sizeof(struct epidemic_peer)
+	);
+
+	if (peer == NULL)
+		return NULL;
+	peer->summary = (struct summary_vector){ NULL, 0, 0 };
+	peer->transfers = NULL;
+	digest_set_init(&peer->suppressed);
+	return peer;
+}
+
+static void free_peer(void *state)
+{
+	struct epidemic_peer *const peer = state;
+
+	while (peer->transfers != NULL) {
+		struct epidemic_transfer *const t = peer->transfers;
+
+		peer->transfers = t->next;
+		fragment_ranges_free(&t->sent);
+		free(t);
+	}
+	summary_vector_free(&peer->summary);
+	digest_set_free(&peer->suppressed);
+	free(peer);
+}
+
+// Allows to send the bundle or fragment to the peer again
+static void forget_sent(struct router_peer *peer, struct bundle *b)
+{
+	const struct epidemic_peer *const state = peer->state;
+	const uint64_t digest = summary_vector_digest(b);
+
+	if (digest_set_remove(&peer->sent, digest) || !bundle_is_fragmented(b))
+		return;
+	for (struct epidemic_transfer *t = state->transfers; t; t = t->next) {
+		if (fragment_ranges_remove(&t->sent, digest))
+			return;
+	}
+}
+
+static const struct router_peer_ops peer_ops = {
+	.create_state = create_peer,
+	.free_state = free_peer,
+	.unsent = forget_sent,
+};
+
+static void init_state(void)
+{
+	if (initialized)
+		return;
+	digest_set_init(&known);
+	router_peers_init(&peer_ops);
+	initialized = true;
+}
+
+static struct router_peer *get_peer(const char *node_eid, bool create)
+{
+	init_state();
+	return router_peers_get(node_eid, create);
+}
+
+static bool is_summary_bundle(const struct bundle *b)
+{
+	return exchange_agent_is_state_bundle(&epidemic_agent_config, b);
+}
+
 // BUNDLE HANDLING
 
+// Returns the size of the largest bundle that can still be sent via the
+// contact, limited by its remaining capacity and the MBS of the CLA.
+static size_t get_max_bundle_size(struct contact *contact)
+{
+	const int32_t capacity = ROUTER_CONTACT_CAPACITY(contact, 0);
+	struct cla_config *const cla_config = cla_config_get(
+		contact->node->cla_addr
+	);
+	size_t mbs = router_get_config().global_mbs;
+
+	if (capacity <= 0)
+		return 0;
+	if (cla_config != NULL)
+		mbs = MIN(mbs, cla_config->vtable->cla_mbs_get(cla_config));
+	return MIN((size_t)capacity, mbs);
+}
+
+// Creates a fragment containing the given range of the payload of the bundle.
+// The payload data is shared with the bundle, not copied.
+static struct bundle *create_fragment(struct bundle *b, uint64_t offset,
+				      uint64_t length)
+{
+	struct bundle *fragment = bundlefragmenter_initialize_first_fragment(b);
+	struct bundle *rest;
+
+	if (fragment == NULL)
+		return NULL;
+
+	if (offset != 0) {
+		rest = bundlefragmenter_fragment_bundle(
+			fragment,
+			bundle_get_first_fragment_min_size(fragment) + offset
+		);
+		if (rest == NULL || rest == fragment) {
+			bundle_free(fragment);
+			return NULL;
+		}
+		bundle_free(fragment);
+		fragment = rest;
+	}
+
+	rest = bundlefragmenter_fragment_bundle(
+		fragment,
+		bundle_get_first_fragment_min_size(fragment) + length
+	);
+	if (rest == NULL) {
+		bundle_free(fragment);
+		return NULL;
+	}
+	if (rest != fragment)
+		bundle_free(rest);
+
+	// Only the bundle is kept in storage until all peers received it
+	fragment->ret_constraints &= ~BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING;
+	return fragment;
+}
+
+// Queues fragments for the payload ranges not sent to the peer yet, as far as
+// the contact allows. Returns the number of fragments queued.
+static int route_fragments(struct router_peer *peer,
+			   struct contact *contact, struct bundle *b,
+			   uint64_t digest)
+{
+	const uint64_t payload_length = b->payload_block->length;
+	// Upper bound for the size of every fragment except its payload
+	const size_t header_size = bundle_get_first_fragment_min_size(b);
+	const uint64_t min_payload = router_get_config().fragment_min_payload;
+	struct epidemic_peer *const state = peer->state;
+	struct epidemic_transfer *transfer = get_transfer(state, digest);
+	uint64_t position = 0, gap_offset, gap_length;
+	int queued = 0;
+
+	if (transfer == NULL)
+		transfer = create_transfer(
+			state,
+			digest,
+			bundle_get_expiration_time_ms(b)
+		);
+	if (transfer == NULL)
+		return 0;
+
+	while (fragment_ranges_next_gap(&transfer->sent, position,
+					payload_length, &gap_offset,
+					&gap_length)) {
+		const size_t max_size = get_max_bundle_size(contact);
+
+		if (max_size <= header_size ||
+		    max_size - header_size < MIN(min_payload, gap_length))
+			break;
+
+		const uint64_t length = MIN(gap_length, max_size - header_size);
+		struct bundle *const fragment = create_fragment(
+			b,
+			gap_offset,
+			length
+		);
+
+		if (fragment == NULL)
+			break;
+		if (bundle_get_serialized_size(fragment) > max_size ||
+		    router_add_bundle_to_contact(contact, fragment) != UD3TN_OK) {
+			bundle_free(fragment);
+			break;
+		}
+		if (fragment_ranges_add(&transfer->sent,
+					summary_vector_digest(fragment),
+					gap_offset, length) != UD3TN_OK)
+			LOGF_WARN(
+				"Router: Could not record fragment %p, it may be sent again",
+				fragment
+			);
+		stats.fragments_queued++;
+		queued++;
+		position = gap_offset + length;
+	}
+
+	if (transfer->sent.count == 0)
+		remove_transfers(state, 0, true);
+	return queued;
+}
+
+// Whether the peer has the bundle already or it has been queued for the peer
+static bool known_by_peer(const struct router_peer *peer, uint64_t digest)
+{
+	const struct epidemic_peer *const state = peer->state;
+
+	return summary_vector_contains(&state->summary, digest) ||
+		digest_set_contains(&peer->sent, digest);
+}
+
+// Counts the bundle as not sent as the peer knows it already. Each bundle is
+// counted once per peer, e.g. not again when it is routed anew, and not at
+// all if it has been queued for the peer.
+static void count_suppressed(struct router_peer *peer, const struct bundle *b,
+			     uint64_t digest, size_t size)
+{
+	struct epidemic_peer *const state = peer->state;
+
+	if (digest_set_contains(&peer->sent, digest) ||
+	    digest_set_contains(&state->suppressed, digest))
+		return;
+	digest_set_add(&state->suppressed, digest,
+		       bundle_get_expiration_time_ms(b));
+	stats.bundles_suppressed++;
+	stats.bytes_saved += size;
+}
+
 enum router_result_status router_route_bundle(struct bundle *b)
 {
 	const uint64_t timestamp_ms = hal_time_get_timestamp_ms();
@@ -25,25 +321,55 @@ enum router_result_status router_route_bundle(struct bundle *b)
 		return ROUTER_RESULT_EXPIRED;
 	}
 
+	// Summary vectors are only sent to the node they are addressed to
+	if (is_summary_bundle(b))
+		return router_peers_route_direct(b);
+
 	struct node_list* node_list = routing_table_get_node_list();
 
 	enum router_result_status status = ROUTER_RESULT_NO_ROUTE;
 	size_t bundle_serialied_size = bundle_get_serialized_size(b);
+	const uint64_t digest = summary_vector_digest(b);
 
 	while (node_list != NULL) {
 		struct node* node = node_list->node;
+		struct router_peer *peer = NULL;
 
 		struct contact_list* contact_list = node->contacts;
 		while(contact_list != NULL){
 			if(contact_list->data->active){
-				if(ROUTER_CONTACT_CAPACITY(contact_list->data, 0) < (int32_t)(bundle_serialied_size)){
-					LOGF_INFO("Cannot send bundle %p to %s since contact capacity is less than bundle size", b, node->eid);
-					//TODO Fragment bundle here
+				if (peer == NULL)
+					peer = get_peer(node->eid, true);
+				if (peer != NULL && known_by_peer(peer, digest)) {
+					LOGF_DEBUG("Router: Bundle %p already known by %s, not sending it", b, node->eid);
+					count_suppressed(peer, b, digest,
+							 bundle_serialied_size);
+					break;
+				}
+				const bool partially_sent = (
+					peer != NULL &&
+					get_transfer(peer->state, digest)
+				);
+
+				if(partially_sent || get_max_bundle_size(contact_list->data) < bundle_serialied_size){
+					if (peer == NULL || bundle_must_not_fragment(b)) {
+						LOGF_INFO("Cannot send bundle %p to %s since contact capacity or MBS is less than bundle size", b, node->eid);
+					} else if (route_fragments(peer, contact_list->data, b, digest) > 0) {
+						status = ROUTER_RESULT_OK;
+					} else {
+						LOGF_DEBUG("Router: No fragment of bundle %p queued for %s", b, node->eid);
+					}
 				} else {
 					if(router_add_bundle_to_contact(contact_list->data, b) == UD3TN_FAIL) {
 						LOGF_ERROR("Failed to emit bundle %p to %s", b, node->eid);
 					} else {
 						status = ROUTER_RESULT_OK;
+						if (peer != NULL)
+							digest_set_add(
+								&peer->sent,
+								digest,
+								bundle_get_expiration_time_ms(b)
+							);
 					}
 				}
 			}
@@ -57,4 +383,76 @@ enum router_result_status router_route_bundle(struct bundle *b)
 	return status;
 }
 
-#endif
\ No newline at end of file
+// ANTI-ENTROPY
+
+void router_epidemic_record_known(const struct bundle *b)
+{
+	if (is_summary_bundle(b))
+		return;
+	init_state();
+	digest_set_add(&known, summary_vector_digest(b),
+		       bundle_get_expiration_time_ms(b));
+}
+
+uint8_t *router_epidemic_create_summary(size_t *length)
+{
+	struct summary_vector sv;
+	uint8_t *buffer;
+
+	init_state();
+	digest_set_expire(&known, hal_time_get_timestamp_ms());
+	if (summary_vector_create(&sv, &known) != UD3TN_OK)
+		return NULL;
+
+	*length = summary_vector_get_serialized_size(&sv);
+	buffer = malloc(*length);
+	if (buffer != NULL)
+		summary_vector_serialize(&sv, buffer);
+	summary_vector_free(&sv);
+	return buffer;
+}
+
+enum ud3tn_result router_epidemic_summary_received(
+	const char *node_eid, const uint8_t *data, size_t length)
+{
+	struct router_peer *const peer = get_peer(node_eid, true);
+	struct epidemic_peer *state;
+	struct summary_vector sv;
+
+	if (peer == NULL ||
+	    summary_vector_parse(&sv, data, length) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	state = peer->state;
+	summary_vector_free(&state->summary);
+	state->summary = sv;
+	digest_set_expire(&peer->sent, hal_time_get_timestamp_ms());
+	digest_set_expire(&state->suppressed, hal_time_get_timestamp_ms());
+	remove_transfers(state, hal_time_get_timestamp_ms(), false);
+	stats.summaries_received++;
+
+	LOGF_INFO(
+		"Router: Summary vector of \"%s\" received (%lu bytes), %llu bundles (%llu bytes) not sent to peers knowing them so far",
+		node_eid,
+		(unsigned long)length,
+		(unsigned long long)stats.bundles_suppressed,
+		(unsigned long long)stats.bytes_saved
+	);
+	return UD3TN_OK;
+}
+
+const struct exchange_agent_config epidemic_agent_config = {
+	.state_name = "summary vector",
+	.agent_id_dtn = AGENT_ID_EPIDEMIC_DTN,
+	.agent_id_ipn = AGENT_ID_EPIDEMIC_IPN,
+	.lifetime_ms = EPIDEMIC_SUMMARY_LIFETIME_MS,
+	.create_state = router_epidemic_create_summary,
+	.state_received = router_epidemic_summary_received,
+};
+
+struct router_epidemic_stats router_epidemic_get_stats(void)
+{
+	return stats;
+}
+
+#endif
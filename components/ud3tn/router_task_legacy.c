@@ -14,7 +14,8 @@
 #include <stdlib.h>
 #include <string.h>
 
-#ifdef ROUTING_LEGACY
+// CGR only differs in the candidate contacts, see router_get_first_route()
+#if defined(ROUTING_LEGACY) || defined(ROUTING_CGR)
 
 // BUNDLE HANDLING
 
@@ -44,10 +45,49 @@ static inline enum router_result_status br_to_rrs(int8_t bh_result)
 	}
 }
 
+/*
+ * Route determined for the previous bundle of a batch, which is reused for
+ * the next bundle to the same destination while its contacts have capacity.
+ */
+struct route_reuse {
+	struct router_result route;
+	enum bundle_routing_priority priority;
+	uint64_t expiration_time_ms;
+};
+
 static struct bundle_processing_result apply_fragmentation(
 	struct bundle *bundle, struct router_result route);
 
-static struct bundle_processing_result process_bundle(struct bundle *bundle)
+static struct router_result get_route(struct bundle *bundle,
+				      struct route_reuse *reuse)
+{
+	const enum bundle_routing_priority priority =
+		ROUTER_BUNDLE_PRIORITY(bundle);
+	const uint64_t expiration_time_ms = bundle_get_expiration_time_ms(
+		bundle
+	);
+	struct router_result route = { .fragments = 0 };
+
+	if (reuse == NULL)
+		return router_get_first_route(bundle);
+
+	// Only routes of bundles which have not been fragmented are reused.
+	// A route arriving in time for a bundle of the same priority arrives
+	// in time for any bundle expiring later as well.
+	if (reuse->route.fragments == 1 && reuse->priority == priority &&
+	    reuse->expiration_time_ms <= expiration_time_ms)
+		route = router_try_reuse(reuse->route, bundle);
+	if (route.fragments == 0)
+		route = router_get_first_route(bundle);
+
+	reuse->route = route;
+	reuse->priority = priority;
+	reuse->expiration_time_ms = expiration_time_ms;
+	return route;
+}
+
+static struct bundle_processing_result process_bundle(
+	struct bundle *bundle, struct route_reuse *reuse)
 {
 	struct router_result route;
 	struct bundle_processing_result result = {
@@ -63,7 +103,7 @@ static struct bundle_processing_result process_bundle(struct bundle *bundle)
 		return result;
 	}
 
-	route = router_get_first_route(bundle);
+	route = get_route(bundle, reuse);
 	if (route.fragments == 1) {
 		result.fragments[0] = bundle;
 		if (router_add_bundle_to_contact(
@@ -154,14 +194,15 @@ static struct bundle_processing_result apply_fragmentation(
 	return result;
 }
 
-enum router_result_status router_route_bundle(struct bundle *b)
+static enum router_result_status route_bundle(struct bundle *b,
+					      struct route_reuse *reuse)
 {
 	struct bundle_processing_result proc_result = {
 		.status_or_fragments = BUNDLE_RESULT_INVALID
 	};
 
 	if (b != NULL)
-		proc_result = process_bundle(b);
+		proc_result = process_bundle(b, reuse);
 
 	LOGF_DEBUG(
 		"Router: Bundle %p [ %s ] [ frag = %d ]",
@@ -174,4 +215,78 @@ enum router_result_status router_route_bundle(struct bundle *b)
 	return ROUTER_RESULT_OK;
 }
 
+enum router_result_status router_route_bundle(struct bundle *b)
+{
+	return route_bundle(b, NULL);
+}
+
+// BATCHES
+
+struct batch_entry {
+	struct bundle *bundle;
+	uint64_t expiration_time_ms;
+	size_t index;
+	// The bundle is the first one of the batch to its destination
+	bool first_of_destination;
+};
+
+// Orders by destination, the bundles expiring first are routed first
+static int compare_batch_entries(const void *a, const void *b)
+{
+	const struct batch_entry *const ea = a;
+	const struct batch_entry *const eb = b;
+	const int cmp = strcmp(ea->bundle->destination,
+			       eb->bundle->destination);
+
+	if (cmp != 0)
+		return cmp;
+	if (ea->expiration_time_ms != eb->expiration_time_ms)
+		return ea->expiration_time_ms < eb->expiration_time_ms ? -1 : 1;
+	return ea->index < eb->index ? -1 : (ea->index > eb->index);
+}
+
+void router_route_bundles(struct bundle **bundles, size_t count,
+			  enum router_result_status *results)
+{
+	struct batch_entry *const entries = malloc(
+		count * sizeof(struct batch_entry)
+	);
+	struct route_reuse reuse = { .route = { .fragments = 0 } };
+	size_t i;
+
+	if (entries == NULL) {
+		for (i = 0; i < count; i++)
+			results[i] = route_bundle(bundles[i], NULL);
+		return;
+	}
+
+	for (i = 0; i < count; i++)
+		entries[i] = (struct batch_entry) {
+			.bundle = bundles[i],
+			.expiration_time_ms = bundle_get_expiration_time_ms(
+				bundles[i]
+			),
+			.index = i,
+		};
+	qsort(entries, count, sizeof(struct batch_entry),
+	      compare_batch_entries);
+	// Determined beforehand as fragmented bundles are freed when routed
+	for (i = 0; i < count; i++)
+		entries[i].first_of_destination = (
+			i == 0 ||
+			strcmp(entries[i - 1].bundle->destination,
+			       entries[i].bundle->destination) != 0
+		);
+
+	for (i = 0; i < count; i++) {
+		if (entries[i].first_of_destination)
+			reuse.route.fragments = 0;
+		results[entries[i].index] = route_bundle(
+			entries[i].bundle,
+			&reuse
+		);
+	}
+	free(entries);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/node.h"
+#include "ud3tn/prophet.h"
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/summary_vector.h"
+
+#include "agents/prophet_agent.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_time.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ROUTING_PROPHET
+
+// PEER STATE
+
+static struct prophet_atoms atoms;
+// Delivery predictabilities of this node
+static struct prophet_table own_table;
+static struct router_prophet_stats stats;
+static bool initialized;
+
+// The state of a peer are the delivery predictabilities received from it on
+// the last encounter.
+static void *create_peer(void)
+{
+	struct prophet_table *const table = malloc(
+		sizeof(struct prophet_table)
+	);
+
+	if (table != NULL)
+		prophet_table_init(table, &atoms, hal_time_get_timestamp_ms());
+	return table;
+}
+
+static void free_peer(void *state)
+{
+	prophet_table_free(state);
+	free(state);
+}
+
+static const struct router_peer_ops peer_ops = {
+	.create_state = create_peer,
+	.free_state = free_peer,
+};
+
+static void init_state(void)
+{
+	if (initialized)
+		return;
+	prophet_atoms_init(&atoms);
+	prophet_table_init(&own_table, &atoms, hal_time_get_timestamp_ms());
+	router_peers_init(&peer_ops);
+	initialized = true;
+}
+
+static struct router_peer *get_peer(const char *node_eid, bool create)
+{
+	init_state();
+	return router_peers_get(node_eid, create);
+}
+
+// BUNDLE HANDLING
+
+static bool queue_for_contact(struct contact *contact, struct bundle *b,
+			      size_t size)
+{
+	if (ROUTER_CONTACT_CAPACITY(contact, 0) < (int32_t)size) {
+		LOGF_INFO(
+			"Router: Cannot send bundle %p to %s since contact capacity is less than bundle size",
+			b,
+			contact->node->eid
+		);
+		return false;
+	}
+	return router_add_bundle_to_contact(contact, b) == UD3TN_OK;
+}
+
+enum router_result_status router_route_bundle(struct bundle *b)
+{
+	const uint64_t timestamp_ms = hal_time_get_timestamp_ms();
+
+	if (bundle_get_expiration_time_ms(b) < timestamp_ms)
+		return ROUTER_RESULT_EXPIRED;
+
+	// Predictability tables are only sent to the node they are addressed to
+	if (exchange_agent_is_state_bundle(&prophet_agent_config, b))
+		return router_peers_route_direct(b);
+
+	init_state();
+	prophet_table_age(&own_table, timestamp_ms);
+
+	char *const dest_node_eid = get_node_id(b->destination);
+	const int32_t dest_atom = (
+		dest_node_eid != NULL
+		? prophet_atom_get(&atoms, dest_node_eid, false)
+		: -1
+	);
+	const float own_p = prophet_table_get(&own_table, dest_atom);
+	const size_t size = bundle_get_serialized_size(b);
+	const uint64_t digest = summary_vector_digest(b);
+	enum router_result_status status = ROUTER_RESULT_NO_ROUTE;
+
+	for (struct node_list *nl = routing_table_get_node_list();
+	     nl != NULL; nl = nl->next) {
+		struct node *const node = nl->node;
+		const bool is_destination = (
+			dest_node_eid != NULL &&
+			strcmp(node->eid, dest_node_eid) == 0
+		);
+		struct router_peer *peer = NULL;
+
+		for (struct contact_list *cl = node->contacts; cl;
+		     cl = cl->next) {
+			if (!cl->data->active)
+				continue;
+			if (peer == NULL)
+				peer = get_peer(node->eid, true);
+			if (peer != NULL &&
+			    digest_set_contains(&peer->sent, digest))
+				break;
+
+			// The table of a peer is unknown until it has been
+			// received, i.e., all its predictabilities are zero.
+			if (!is_destination && (peer == NULL ||
+			    prophet_table_get(peer->state, dest_atom) <=
+			    own_p)) {
+				LOGF_DEBUG(
+					"Router: Not sending bundle %p to %s, it is no better carrier",
+					b,
+					node->eid
+				);
+				stats.bundles_withheld++;
+				break;
+			}
+
+			if (queue_for_contact(cl->data, b, size)) {
+				status = ROUTER_RESULT_OK;
+				stats.bundles_forwarded++;
+				if (peer != NULL)
+					digest_set_add(
+						&peer->sent,
+						digest,
+						bundle_get_expiration_time_ms(b)
+					);
+				break;
+			}
+		}
+	}
+	free(dest_node_eid);
+
+	// The bundle is kept for better carriers encountered later
+	b->ret_constraints |= BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING;
+
+	return status;
+}
+
+// PREDICTABILITY EXCHANGE
+
+uint8_t *router_prophet_create_table(size_t *length)
+{
+	init_state();
+	prophet_table_age(&own_table, hal_time_get_timestamp_ms());
+	return prophet_table_serialize(&own_table, &atoms, length);
+}
+
+enum ud3tn_result router_prophet_table_received(
+	const char *node_eid, const uint8_t *data, size_t length)
+{
+	const uint64_t timestamp_ms = hal_time_get_timestamp_ms();
+	struct router_peer *const peer = get_peer(node_eid, true);
+	struct prophet_table *peer_table;
+	struct prophet_table table;
+	int32_t atom;
+
+	if (peer == NULL ||
+	    prophet_table_parse(&table, &atoms, data, length,
+				timestamp_ms) != UD3TN_OK)
+		return UD3TN_FAIL;
+
+	peer_table = peer->state;
+	prophet_table_free(peer_table);
+	*peer_table = table;
+	digest_set_expire(&peer->sent, timestamp_ms);
+
+	prophet_table_age(&own_table, timestamp_ms);
+	// Assigned after the tables have been updated, which may release
+	// atoms, and referred to by the own table on the encounter.
+	atom = prophet_atom_get(&atoms, node_eid, true);
+	if (atom < 0 ||
+	    prophet_table_encounter(&own_table, atom) != UD3TN_OK ||
+	    prophet_table_transitive(&own_table, atom,
+				     peer_table) != UD3TN_OK)
+		return UD3TN_FAIL;
+	stats.tables_received++;
+
+	LOGF_INFO(
+		"Router: Delivery predictabilities of \"%s\" received (%lu bytes), P = %.3f",
+		node_eid,
+		(unsigned long)length,
+		(double)prophet_table_get(&own_table, atom)
+	);
+	return UD3TN_OK;
+}
+
+const struct exchange_agent_config prophet_agent_config = {
+	.state_name = "predictability table",
+	.agent_id_dtn = AGENT_ID_PROPHET_DTN,
+	.agent_id_ipn = AGENT_ID_PROPHET_IPN,
+	.lifetime_ms = PROPHET_TABLE_LIFETIME_MS,
+	.create_state = router_prophet_create_table,
+	.state_received = router_prophet_table_received,
+};
+
+struct router_prophet_stats router_prophet_get_stats(void)
+{
+	return stats;
+}
+
+#endif // ROUTING_PROPHET
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/eid.h"
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/spray_and_wait.h"
+#include "ud3tn/summary_vector.h"
+
+#include "platform/hal_io.h"
+#include "platform/hal_time.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ROUTING_SPRAY_AND_WAIT
+
+// PEER STATE
+
+static struct router_spray_and_wait_stats stats;
+static bool initialized;
+// Copies taken back from relays by bundle digest, added to the budget of the
+// bundle when it is routed again
+static struct digest_set returned;
+
+// Takes back the copies handed over to a peer not having received them,
+// which have been recorded along with the digest.
+static void forget_sent(struct router_peer *peer, struct bundle *b)
+{
+	const uint64_t digest = summary_vector_digest(b);
+	uint32_t copies = 0, earlier = 0;
+
+	if (!digest_set_take(&peer->sent, digest, &copies) || copies == 0)
+		return;
+	digest_set_expire(&returned, hal_time_get_timestamp_ms());
+	digest_set_take(&returned, digest, &earlier);
+	// If memory is exhausted, the copies are lost, which is safe.
+	digest_set_put(&returned, digest, bundle_get_expiration_time_ms(b),
+		       earlier + copies);
+	stats.copies_handed_over -= copies;
+}
+
+// Relays get copies of the bundle without a budget of their own
+static bool is_relay_copy(const struct bundle *b)
+{
+	return b->spray_copies == 0;
+}
+
+// Only the bundles queued for a peer are recorded
+static const struct router_peer_ops peer_ops = {
+	.unsent = forget_sent,
+	.owns = is_relay_copy,
+};
+
+static struct router_peer *get_peer(const char *node_eid, bool create)
+{
+	if (!initialized) {
+		digest_set_init(&returned);
+		router_peers_init(&peer_ops);
+		initialized = true;
+	}
+	return router_peers_get(node_eid, create);
+}
+
+// BUNDLE HANDLING
+
+static bool queue_for_contact(struct contact *contact, struct bundle *b)
+{
+	const size_t size = bundle_get_serialized_size(b);
+
+	if (ROUTER_CONTACT_CAPACITY(contact, 0) < (int32_t)size) {
+		LOGF_INFO(
+			"Router: Cannot send bundle %p to %s since contact capacity is less than bundle size",
+			b,
+			contact->node->eid
+		);
+		return false;
+	}
+	return router_add_bundle_to_contact(contact, b) == UD3TN_OK;
+}
+
+// Queues the bundle for the first active contact of the node
+static bool queue_for_node(struct node *node, struct bundle *b)
+{
+	for (struct contact_list *cl = node->contacts; cl; cl = cl->next) {
+		if (cl->data->active && queue_for_contact(cl->data, b))
+			return true;
+	}
+	return false;
+}
+
+static bool has_active_contact(const struct node *node)
+{
+	for (const struct contact_list *cl = node->contacts; cl; cl = cl->next) {
+		if (cl->data->active)
+			return true;
+	}
+	return false;
+}
+
+// Every relay gets a copy of the bundle carrying the number of copies handed
+// over to it in the extension block, which is recorded for the peer to take
+// them back if the copy is not sent.
+static enum router_result_status hand_over(
+	struct node *relay, struct router_peer *peer, const struct bundle *b,
+	uint64_t digest, uint32_t handed)
+{
+	struct bundle *const copy = bundle_dup(b);
+	enum router_result_status status = ROUTER_RESULT_NO_MEMORY;
+
+	if (copy == NULL)
+		return ROUTER_RESULT_NO_MEMORY;
+	copy->spray_copies = 0;
+	if (spray_and_wait_set_handed_copies(copy, handed) != UD3TN_OK ||
+	    digest_set_put(&peer->sent, digest,
+			   bundle_get_expiration_time_ms(b),
+			   handed) != UD3TN_OK)
+		goto fail;
+	if (queue_for_node(relay, copy))
+		return ROUTER_RESULT_COPIED;
+	digest_set_remove(&peer->sent, digest);
+	status = ROUTER_RESULT_NO_ROUTE;
+fail:
+	bundle_free(copy);
+	return status;
+}
+
+enum router_result_status router_route_bundle(struct bundle *b)
+{
+	const uint64_t timestamp_ms = hal_time_get_timestamp_ms();
+
+	if (bundle_get_expiration_time_ms(b) < timestamp_ms)
+		return ROUTER_RESULT_EXPIRED;
+
+	char *const dest_node_eid = get_node_id(b->destination);
+	const uint64_t digest = summary_vector_digest(b);
+	const uint64_t expiration_ms = bundle_get_expiration_time_ms(b);
+	enum router_result_status status = ROUTER_RESULT_NO_ROUTE;
+	struct node *relay = NULL;
+	struct router_peer *relay_peer = NULL;
+
+	b->spray_copies = spray_and_wait_get_copies(b);
+
+	for (struct node_list *nl = routing_table_get_node_list();
+	     nl != NULL; nl = nl->next) {
+		struct node *const node = nl->node;
+		struct router_peer *peer;
+
+		if (!has_active_contact(node))
+			continue;
+		peer = get_peer(node->eid, true);
+		if (peer != NULL && digest_set_contains(&peer->sent, digest))
+			continue;
+
+		if (dest_node_eid != NULL &&
+		    strcmp(node->eid, dest_node_eid) == 0) {
+			// Direct delivery, the bundle is not sprayed meanwhile
+			if (queue_for_node(node, b)) {
+				status = ROUTER_RESULT_OK;
+				if (peer != NULL)
+					digest_set_add(&peer->sent, digest,
+						       expiration_ms);
+				relay = NULL;
+				break;
+			}
+			continue;
+		}
+		if (relay == NULL) {
+			relay = node;
+			relay_peer = peer;
+		}
+	}
+	free(dest_node_eid);
+
+	uint32_t copies_back;
+
+	if (digest_set_take(&returned, digest, &copies_back))
+		b->spray_copies += copies_back;
+
+	if (relay != NULL && b->spray_copies > 1) {
+		const uint32_t handed = spray_and_wait_split(b->spray_copies);
+
+		status = (
+			relay_peer != NULL
+			? hand_over(relay, relay_peer, b, digest, handed)
+			: ROUTER_RESULT_NO_MEMORY
+		);
+		if (status == ROUTER_RESULT_COPIED) {
+			b->spray_copies -= handed;
+			stats.copies_handed_over += handed;
+		}
+	} else if (relay != NULL) {
+		LOGF_DEBUG(
+			"Router: Not sending bundle %p to %s, waiting for its destination",
+			b,
+			relay->eid
+		);
+		stats.bundles_withheld++;
+	}
+
+	// The bundle is kept for further relays and its destination
+	b->ret_constraints |= BUNDLE_RET_CONSTRAINT_DISPATCH_PENDING;
+
+	return status;
+}
+
+struct router_spray_and_wait_stats router_spray_and_wait_get_stats(void)
+{
+	return stats;
+}
+
+#endif // ROUTING_SPRAY_AND_WAIT
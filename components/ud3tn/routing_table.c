@@ -1,10 +1,15 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle.h"
 #include "ud3tn/common.h"
+#include "ud3tn/contact_index.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/min_heap.h"
 #include "ud3tn/node.h"
 #include "ud3tn/router.h"
+#include "ud3tn/router_peers.h"
 #include "ud3tn/routing_table.h"
-#include "ud3tn/simplehtab.h"
+
+#include "util/llsort.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -12,20 +17,36 @@
 
 static struct node_list *node_list;
 static struct contact_list *contact_list;
+/* Index over contact_list, ordered by start time */
+static struct contact_index contact_index;
 
-static struct htab_entrylist *htab_elem[NODE_HTAB_SLOT_COUNT];
-static struct htab eid_table;
+/* Node EID -> entry of node_list */
+static struct hashmap node_index;
+/* Reachable EID -> struct node_table_entry */
+static struct hashmap eid_table;
 static uint8_t eid_table_initialized;
+/* Incremented on every modification of the contact plan */
+static uint32_t generation;
+/* Contacts of contact_list not started yet, ordered by start time */
+static struct min_heap upcoming;
 
 /* INIT */
 
+static void set_upcoming_index(void *contact, size_t index)
+{
+	((struct contact *)contact)->upcoming_index = index;
+}
+
 enum ud3tn_result routing_table_init(void)
 {
 	if (eid_table_initialized != 0)
 		return UD3TN_OK;
 	node_list = NULL;
 	contact_list = NULL;
-	htab_init(&eid_table, NODE_HTAB_SLOT_COUNT, htab_elem);
+	contact_index_init(&contact_index, &contact_list, true);
+	hashmap_init(&node_index, NODE_HTAB_SLOT_COUNT);
+	hashmap_init(&eid_table, NODE_HTAB_SLOT_COUNT);
+	min_heap_init(&upcoming, set_upcoming_index);
 	eid_table_initialized = 1;
 	return UD3TN_OK;
 }
@@ -42,33 +63,33 @@ void routing_table_free(void)
 		free(node_list);
 		node_list = next;
 	}
+	hashmap_deinit(&node_index);
+	// The entries are released along with their last contact
+	ASSERT(hashmap_count(&eid_table) == 0);
+	hashmap_deinit(&eid_table);
+	contact_index_free(&contact_index);
+	min_heap_free(&upcoming);
+	eid_table_initialized = 0;
 }
 
 /* LOOKUP */
 
-static struct node_list **get_node_entry_ptr_by_eid(const char *eid)
+static struct node_list *get_node_entry_by_eid(const char *eid)
 {
-	struct node_list **cur = &node_list;
-
 	if (eid == NULL)
 		return NULL;
-	/* Linear search for now */
-	while ((*cur) != NULL) {
-		if (strcmp((*cur)->node->eid, eid) == 0)
-			return cur;
-		cur = &((*cur)->next);
-	}
-	return NULL;
+	return hashmap_get(&node_index, eid);
 }
 
-static struct node_list *get_node_entry_by_eid(const char *eid)
+static void unlink_node_entry(struct node_list *entry)
 {
-	struct node_list **entry_ptr = get_node_entry_ptr_by_eid(eid);
-
-	if (entry_ptr == NULL)
-		return NULL;
+	hashmap_remove(&node_index, entry->node->eid);
+	if (entry->prev != NULL)
+		entry->prev->next = entry->next;
 	else
-		return *entry_ptr;
+		node_list = entry->next;
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
 }
 
 struct node *routing_table_lookup_node(const char *eid)
@@ -83,7 +104,7 @@ struct node *routing_table_lookup_node(const char *eid)
 
 struct node_table_entry *routing_table_lookup_eid(const char *eid)
 {
-	return (struct node_table_entry *)htab_get(&eid_table, eid);
+	return (struct node_table_entry *)hashmap_get(&eid_table, eid);
 }
 
 
@@ -108,18 +129,30 @@ uint8_t routing_table_lookup_hot_node(
 static void add_node_to_tables(struct node *node);
 static void remove_node_from_tables(struct node *node, bool drop_contacts,
 				  struct rescheduling_handle rescheduler);
+static void add_contact_to_tables(struct node *node, struct contact *c);
+static void remove_contact_from_tables(struct node *node, struct contact *c);
 
 static void reschedule_bundles(
 	struct contact *contact, struct rescheduling_handle rescheduler);
+static void reschedule_unfit_bundles(
+	struct contact *contact, struct rescheduling_handle rescheduler);
 
 static bool add_new_node(struct node *new_node)
 {
 	struct node_list *new_elem;
 
-	if (new_node->eid == NULL || new_node->cla_addr == NULL) {
+	if (new_node->eid == NULL) {
 		free_node(new_node);
 		return false;
 	}
+#ifndef ROUTING_CGR
+	// Nodes without CLA address describe contacts between other nodes,
+	// which are only considered by CGR.
+	if (new_node->cla_addr == NULL) {
+		free_node(new_node);
+		return false;
+	}
+#endif // ROUTING_CGR
 
 	new_elem = malloc(sizeof(struct node_list));
 	if (new_elem == NULL) {
@@ -127,7 +160,15 @@ static bool add_new_node(struct node *new_node)
 		return false;
 	}
 	new_elem->node = new_node;
+	if (hashmap_put(&node_index, new_node->eid, new_elem) != UD3TN_OK) {
+		free(new_elem);
+		free_node(new_node);
+		return false;
+	}
+	new_elem->prev = NULL;
 	new_elem->next = node_list;
+	if (node_list != NULL)
+		node_list->prev = new_elem;
 	node_list = new_elem;
 
 	add_node_to_tables(new_node);
@@ -142,13 +183,15 @@ bool routing_table_add_node(
 	struct contact_list *cap_modified = NULL, *cur_contact, *next;
 
 	entry = get_node_entry_by_eid(new_node->eid);
+	generation++;
 
 	if (entry == NULL)
 		return add_new_node(new_node);
 
 	cur_node = entry->node;
-	/* Should not be needed here because we only ADD */
-	/* remove_node_from_htab(cur_node); */
+	/* Contacts may be merged, changing their start and end times, */
+	/* thus, they are indexed again after the update. */
+	remove_node_from_tables(cur_node, false, rescheduler);
 	if (new_node->cla_addr != NULL &&
 		new_node->cla_addr[0] != '\0') {
 		// New non-empty CLA address provided
@@ -169,19 +212,10 @@ bool routing_table_add_node(
 		cur_contact->data->node = cur_node;
 		cur_contact = cur_contact->next;
 	}
-	/* Process contacts with modified capacity */
+	/* Process contacts with modified capacity, their new capacity */
+	/* has already been calculated by merging them. */
 	while (cap_modified != NULL) {
-		/* Check for all nodes with modified bandwidth if now */
-		/* the remaining capacity for p0 is negative: */
-		/* We assume that the new contact capacity */
-		/* has already been calculated */
-		/* TODO: This can be improved! */
-		if (cap_modified->data->remaining_capacity_p0 < 0) {
-			reschedule_bundles(
-				cap_modified->data,
-				rescheduler
-			);
-		}
+		reschedule_unfit_bundles(cap_modified->data, rescheduler);
 		next = cap_modified->next;
 		free(cap_modified);
 		cap_modified = next;
@@ -192,35 +226,175 @@ bool routing_table_add_node(
 	return true;
 }
 
+static bool endpoint_list_contains(const struct endpoint_list *list,
+				   const char *eid)
+{
+	for (; list != NULL; list = list->next) {
+		if (strcmp(list->eid, eid) == 0)
+			return true;
+	}
+	return false;
+}
+
+// Returns whether an EID of the old list is not contained in the new one.
+static bool endpoints_removed(const struct endpoint_list *old_list,
+			      const struct endpoint_list *new_list)
+{
+	for (; old_list != NULL; old_list = old_list->next) {
+		if (!endpoint_list_contains(new_list, old_list->eid))
+			return true;
+	}
+	return false;
+}
+
+// Updates an existing contact to the values of the overlapping contact of
+// the new plan, which is released afterwards.
+static void update_contact(struct contact *contact, struct contact *update,
+			   bool node_endpoints_removed,
+			   struct rescheduling_handle rescheduler)
+{
+	struct endpoint_list *cur_eid;
+	const bool contact_endpoints_removed = endpoints_removed(
+		contact->contact_endpoints,
+		update->contact_endpoints
+	);
+
+	// An active contact has started at its current start time.
+	if (!contact->active)
+		contact->from_ms = update->from_ms;
+	contact->to_ms = update->to_ms;
+	contact->bitrate_bytes_per_s = update->bitrate_bytes_per_s;
+	recalculate_contact_capacity(contact);
+
+	cur_eid = contact->contact_endpoints;
+	while (cur_eid != NULL)
+		cur_eid = endpoint_list_free(cur_eid);
+	contact->contact_endpoints = update->contact_endpoints;
+	update->contact_endpoints = NULL;
+	free_contact(update);
+
+	// Bundles queued for a removed EID might not be deliverable via the
+	// contact anymore, thus, they have to be routed again.
+	if (node_endpoints_removed || contact_endpoints_removed)
+		reschedule_bundles(contact, rescheduler);
+	else
+		reschedule_unfit_bundles(contact, rescheduler);
+}
+
+// Drops a contact which is not part of the new plan of its node.
+static void drop_contact(struct contact *contact,
+			 struct rescheduling_handle rescheduler)
+{
+	reschedule_bundles(contact, rescheduler);
+	// If the contact is active, un-associate it to prevent freeing it
+	// right now, see remove_node_from_tables().
+	if (contact->active)
+		contact->node = NULL;
+	else
+		free_contact(contact);
+}
+
+// Applies the new plan of the node contact by contact: overlapping contacts
+// are updated in place and keep their bundles as long as these still fit,
+// contacts not present anymore are dropped and new ones are added.
+static void update_node_contacts(struct node *cur_node, struct node *new_node,
+				 struct rescheduling_handle rescheduler)
+{
+	struct contact_list *old_list = cur_node->contacts;
+	struct contact_list *new_list = new_node->contacts;
+	struct contact_list *result = NULL, **tail = &result, *next;
+	const bool node_endpoints_removed = endpoints_removed(
+		cur_node->endpoints,
+		new_node->endpoints
+	);
+
+	ASSERT(contact_list_sorted(old_list, 1));
+	ASSERT(contact_list_sorted(new_list, 1));
+	// Both lists are sorted by start time and free of overlaps.
+	while (old_list != NULL || new_list != NULL) {
+		struct contact *const old_c = old_list ? old_list->data : NULL;
+		struct contact *const new_c = new_list ? new_list->data : NULL;
+
+		if (old_c && new_c && old_c->from_ms < new_c->to_ms &&
+		    old_c->to_ms > new_c->from_ms) {
+			update_contact(old_c, new_c, node_endpoints_removed,
+				       rescheduler);
+			// Keep the list entry of the existing contact
+			*tail = old_list;
+			tail = &old_list->next;
+			old_list = old_list->next;
+			next = new_list->next;
+			free(new_list);
+			new_list = next;
+		} else if (old_c &&
+			   (!new_c || old_c->to_ms <= new_c->from_ms)) {
+			drop_contact(old_c, rescheduler);
+			next = old_list->next;
+			free(old_list);
+			old_list = next;
+		} else {
+			new_c->node = cur_node;
+			*tail = new_list;
+			tail = &new_list->next;
+			new_list = new_list->next;
+		}
+	}
+	*tail = NULL;
+	// Start times of active contacts are retained.
+	LLSORT(struct contact_list, data->from_ms, result);
+	cur_node->contacts = result;
+	new_node->contacts = NULL;
+}
+
 bool routing_table_replace_node(
 	struct node *node, struct rescheduling_handle rescheduler)
 {
 	struct node_list *entry;
+	struct node *cur_node;
+	struct endpoint_list *cur_eid;
 
 	entry = get_node_entry_by_eid(node->eid);
 
 	if (entry == NULL)
 		return false;
 
-	remove_node_from_tables(entry->node, true,
-				rescheduler);
-	free_node(entry->node);
-	entry->node = node;
-	add_node_to_tables(node);
+	generation++;
+	cur_node = entry->node;
+	// Contacts via another CLA address are not the same, thus, the node is
+	// replaced as a whole.
+	if (cur_node->cla_addr == NULL || node->cla_addr == NULL ||
+	    strcmp(cur_node->cla_addr, node->cla_addr) != 0) {
+		remove_node_from_tables(cur_node, true, rescheduler);
+		free_node(cur_node);
+		entry->node = node;
+		add_node_to_tables(node);
+		return true;
+	}
+
+	remove_node_from_tables(cur_node, false, rescheduler);
+	update_node_contacts(cur_node, node, rescheduler);
+	cur_eid = cur_node->endpoints;
+	while (cur_eid != NULL)
+		cur_eid = endpoint_list_free(cur_eid);
+	cur_node->endpoints = node->endpoints;
+	node->endpoints = NULL;
+	cur_node->flags = node->flags;
+	free_node(node);
+	add_node_to_tables(cur_node);
 	return true;
 }
 
 bool routing_table_delete_node_by_eid(
 	char *eid, struct rescheduling_handle rescheduler)
 {
-	struct node_list **entry_ptr, *old_node_entry;
+	struct node_list *old_node_entry;
 
 	ASSERT(eid != NULL);
-	entry_ptr = get_node_entry_ptr_by_eid(eid);
-	if (entry_ptr != NULL) {
+	old_node_entry = get_node_entry_by_eid(eid);
+	if (old_node_entry != NULL) {
 		/* Delete whole node */
-		old_node_entry = *entry_ptr;
-		*entry_ptr = old_node_entry->next;
+		generation++;
+		unlink_node_entry(old_node_entry);
 		remove_node_from_tables(old_node_entry->node, true,
 					rescheduler);
 		free_node(old_node_entry->node);
@@ -233,17 +407,17 @@ bool routing_table_delete_node_by_eid(
 bool routing_table_delete_node(
 	struct node *new_node, struct rescheduling_handle rescheduler)
 {
-	struct node_list **entry_ptr, *old_node_entry;
+	struct node_list *old_node_entry;
 	struct node *cur_node;
 	struct contact_list *modified = NULL, *deleted = NULL, *next, *tmp;
 
-	entry_ptr = get_node_entry_ptr_by_eid(new_node->eid);
-	if (entry_ptr != NULL) {
-		cur_node = (*entry_ptr)->node;
+	old_node_entry = get_node_entry_by_eid(new_node->eid);
+	if (old_node_entry != NULL) {
+		generation++;
+		cur_node = old_node_entry->node;
 		if (new_node->endpoints == NULL && new_node->contacts == NULL) {
 			/* Delete whole node */
-			old_node_entry = *entry_ptr;
-			*entry_ptr = old_node_entry->next;
+			unlink_node_entry(old_node_entry);
 			remove_node_from_tables(old_node_entry->node, true,
 						rescheduler);
 			free_node(old_node_entry->node);
@@ -290,30 +464,64 @@ bool routing_table_delete_node(
 static bool add_contact_to_node_in_htab(char *eid, struct contact *c);
 static bool remove_contact_from_node_in_htab(char *eid, struct contact *c);
 
+// Adds the contact to the upcoming contacts or, as its start time may have
+// changed by merging it with another contact, updates its position.
+static void add_upcoming_contact(struct contact *c)
+{
+	if (c->active)
+		return;
+	if (c->upcoming_index != MIN_HEAP_NO_INDEX)
+		min_heap_update(&upcoming, c->upcoming_index, c->from_ms);
+	else
+		min_heap_push(&upcoming, c->from_ms, c);
+}
+
+static void remove_upcoming_contact(struct contact *c)
+{
+	if (c->upcoming_index != MIN_HEAP_NO_INDEX)
+		min_heap_remove(&upcoming, c->upcoming_index);
+}
+
+static void add_contact_to_tables(struct node *node, struct contact *c)
+{
+	struct endpoint_list *cur_eid;
+
+	recalculate_contact_capacity(c);
+	// Contacts between other nodes cannot be used directly
+	if (node->cla_addr == NULL)
+		return;
+	add_contact_to_node_in_htab(node->eid, c);
+	for (cur_eid = node->endpoints; cur_eid; cur_eid = cur_eid->next)
+		add_contact_to_node_in_htab(cur_eid->eid, c);
+	cur_eid = c->contact_endpoints;
+	for (; cur_eid; cur_eid = cur_eid->next)
+		add_contact_to_node_in_htab(cur_eid->eid, c);
+	contact_index_add(&contact_index, c);
+	add_upcoming_contact(c);
+}
+
+static void remove_contact_from_tables(struct node *node, struct contact *c)
+{
+	struct endpoint_list *cur_eid;
+
+	remove_contact_from_node_in_htab(node->eid, c);
+	for (cur_eid = node->endpoints; cur_eid; cur_eid = cur_eid->next)
+		remove_contact_from_node_in_htab(cur_eid->eid, c);
+	cur_eid = c->contact_endpoints;
+	for (; cur_eid; cur_eid = cur_eid->next)
+		remove_contact_from_node_in_htab(cur_eid->eid, c);
+	contact_index_remove(&contact_index, c);
+	remove_upcoming_contact(c);
+}
+
 static void add_node_to_tables(struct node *node)
 {
 	struct contact_list *cur_contact;
-	struct endpoint_list *cur_persistent_node, *cur_contact_node;
 
 	ASSERT(node != NULL);
 	cur_contact = node->contacts;
 	while (cur_contact != NULL) {
-		add_contact_to_node_in_htab(node->eid, cur_contact->data);
-		cur_persistent_node = node->endpoints;
-		while (cur_persistent_node != NULL) {
-			add_contact_to_node_in_htab(
-				cur_persistent_node->eid, cur_contact->data);
-			cur_persistent_node = cur_persistent_node->next;
-		}
-		cur_contact_node = cur_contact->data->contact_endpoints;
-		while (cur_contact_node != NULL) {
-			add_contact_to_node_in_htab(
-				cur_contact_node->eid, cur_contact->data);
-			cur_contact_node = cur_contact_node->next;
-		}
-		add_contact_to_ordered_list(
-			&contact_list, cur_contact->data, 1);
-		recalculate_contact_capacity(cur_contact->data);
+		add_contact_to_tables(node, cur_contact->data);
 		cur_contact = cur_contact->next;
 	}
 }
@@ -322,7 +530,6 @@ static void remove_node_from_tables(struct node *node, bool drop_contacts,
 				    struct rescheduling_handle rescheduler)
 {
 	struct contact_list **cur_slot;
-	struct endpoint_list *cur_persistent_node, *cur_contact_node;
 
 	ASSERT(node != NULL);
 	if (!node)
@@ -332,20 +539,7 @@ static void remove_node_from_tables(struct node *node, bool drop_contacts,
 	while (*cur_slot != NULL) {
 		struct contact_list *const cur_contact = *cur_slot;
 
-		remove_contact_from_node_in_htab(node->eid, cur_contact->data);
-		cur_persistent_node = node->endpoints;
-		while (cur_persistent_node != NULL) {
-			remove_contact_from_node_in_htab(
-				cur_persistent_node->eid, cur_contact->data);
-			cur_persistent_node = cur_persistent_node->next;
-		}
-		cur_contact_node = cur_contact->data->contact_endpoints;
-		while (cur_contact_node != NULL) {
-			remove_contact_from_node_in_htab(
-				cur_contact_node->eid, cur_contact->data);
-			cur_contact_node = cur_contact_node->next;
-		}
-		remove_contact_from_list(&contact_list, cur_contact->data);
+		remove_contact_from_tables(node, cur_contact->data);
 		if (drop_contacts) {
 			reschedule_bundles(cur_contact->data,
 					   rescheduler);
@@ -373,16 +567,20 @@ static bool add_contact_to_node_in_htab(char *eid, struct contact *c)
 	if (!eid || !c)
 		return false;
 
-	entry = (struct node_table_entry *)htab_get(&eid_table, eid);
+	entry = (struct node_table_entry *)hashmap_get(&eid_table, eid);
 	if (entry == NULL) {
 		entry = malloc(sizeof(struct node_table_entry));
 		if (entry == NULL)
 			return false;
 		entry->ref_count = 0;
 		entry->contacts = NULL;
-		htab_add(&eid_table, eid, entry);
+		contact_index_init(&entry->index, &entry->contacts, false);
+		if (hashmap_put(&eid_table, eid, entry) != UD3TN_OK) {
+			free(entry);
+			return false;
+		}
 	}
-	if (add_contact_to_ordered_list(&(entry->contacts), c, 0)) {
+	if (contact_index_add(&entry->index, c)) {
 		entry->ref_count++;
 		return true;
 	}
@@ -398,13 +596,13 @@ static bool remove_contact_from_node_in_htab(char *eid, struct contact *c)
 	if (!eid || !c)
 		return false;
 
-	entry = (struct node_table_entry *)htab_get(&eid_table, eid);
+	entry = (struct node_table_entry *)hashmap_get(&eid_table, eid);
 	if (entry == NULL)
 		return false;
-	if (remove_contact_from_list(&(entry->contacts), c)) {
+	if (contact_index_remove(&entry->index, c)) {
 		entry->ref_count--;
 		if (entry->ref_count <= 0) {
-			htab_remove(&eid_table, eid);
+			hashmap_remove(&eid_table, eid);
 			free(entry);
 		}
 		return true;
@@ -423,6 +621,52 @@ struct node_list *routing_table_get_node_list(void)
 	return node_list;
 }
 
+uint32_t routing_table_get_generation(void)
+{
+	return generation;
+}
+
+struct contact *routing_table_peek_upcoming_contact(void)
+{
+	const struct min_heap_entry *const next = min_heap_peek(&upcoming);
+
+	return next != NULL ? next->data : NULL;
+}
+
+struct contact *routing_table_pop_upcoming_contact(void)
+{
+	return min_heap_pop(&upcoming);
+}
+
+struct upcoming_visit {
+	void (*func)(struct contact *, void *);
+	void *context;
+};
+
+static void visit_upcoming_contact(void *contact, void *context)
+{
+	const struct upcoming_visit *const visit = context;
+
+	visit->func(contact, visit->context);
+}
+
+uint64_t routing_table_visit_upcoming_contacts(
+	uint64_t until_ms, void (*func)(struct contact *, void *),
+	void *context)
+{
+	struct upcoming_visit visit = {
+		.func = func,
+		.context = context,
+	};
+
+	return min_heap_visit(
+		&upcoming,
+		until_ms,
+		visit_upcoming_contact,
+		&visit
+	);
+}
+
 void routing_table_delete_contact(struct contact *contact)
 {
 	struct endpoint_list *cur_eid;
@@ -430,10 +674,11 @@ void routing_table_delete_contact(struct contact *contact)
 	ASSERT(contact != NULL);
 	if (!contact)
 		return;
-	ASSERT(contact->contact_bundles == NULL);
-	if (contact->contact_bundles != NULL)
+	ASSERT(routed_bundle_queue_empty(&contact->contact_bundles));
+	if (!routed_bundle_queue_empty(&contact->contact_bundles))
 		return;
 
+	generation++;
 	if (contact->node != NULL) {
 		remove_contact_from_node_in_htab(
 			contact->node->eid, contact);
@@ -457,16 +702,35 @@ void routing_table_delete_contact(struct contact *contact)
 	}
 	contact->contact_endpoints = NULL;
 	/* Remove from global list */
-	remove_contact_from_list(&contact_list, contact);
+	contact_index_remove(&contact_index, contact);
+	remove_upcoming_contact(contact);
 	/* Free contact itself */
 	free_contact(contact);
 }
 
+// Re-schedules a bundle removed from the queue of the contact
+static void reschedule_unqueued_bundle(
+	struct contact *contact, struct bundle *b,
+	struct rescheduling_handle rescheduler)
+{
+	#ifdef ROUTER_PEERS
+	// Copies created by the router for the peer are not routed again
+	if (router_peers_bundle_unqueued(contact, b)) {
+		bundle_free(b);
+		return;
+	}
+	#endif // ROUTER_PEERS
+	rescheduler.reschedule_func(
+		b,
+		rescheduler.reschedule_func_context
+	);
+}
+
 void routing_table_contact_passed(
 	struct contact *contact, struct rescheduling_handle rescheduler)
 {
-	struct routed_bundle_list *tmp;
 	struct contact_list *clist = contact_list;
+	struct bundle *b;
 	bool found = false;
 
 	if (contact == NULL)
@@ -484,21 +748,23 @@ void routing_table_contact_passed(
 		return;
 
 	if (contact->node != NULL) {
-		while (contact->contact_bundles != NULL) {
-			rescheduler.reschedule_func(
-				contact->contact_bundles->data,
-				rescheduler.reschedule_func_context
-			);
-			tmp = contact->contact_bundles->next;
-			free(contact->contact_bundles);
-			contact->contact_bundles = tmp;
-		}
+		while ((b = routed_bundle_queue_pop(
+				&contact->contact_bundles)) != NULL)
+			reschedule_unqueued_bundle(contact, b, rescheduler);
 	}
 	routing_table_delete_contact(contact);
 }
 
 /* RE-SCHEDULING */
 
+static void reschedule_bundle(
+	struct contact *contact, struct bundle *b,
+	struct rescheduling_handle rescheduler)
+{
+	router_remove_bundle_from_contact(contact, b);
+	reschedule_unqueued_bundle(contact, b, rescheduler);
+}
+
 static void reschedule_bundles(
 	struct contact *contact, struct rescheduling_handle rescheduler)
 {
@@ -509,12 +775,35 @@ static void reschedule_bundles(
 		return;
 
 	/* Empty the bundle list and queue them in for re-scheduling */
-	while (contact->contact_bundles != NULL) {
-		b = contact->contact_bundles->data;
-		router_remove_bundle_from_contact(contact, b);
-		rescheduler.reschedule_func(
-			b,
-			rescheduler.reschedule_func_context
-		);
+	while ((b = routed_bundle_queue_first(
+			&contact->contact_bundles)) != NULL)
+		reschedule_bundle(contact, b, rescheduler);
+}
+
+// Re-schedules only the bundles not fitting into the contact anymore after
+// its window or data rate has been changed: those expiring before it starts
+// and, as long as its capacity is exceeded, the ones queued last, starting
+// with the lowest priority.
+static void reschedule_unfit_bundles(
+	struct contact *contact, struct rescheduling_handle rescheduler)
+{
+	struct routed_bundle_queue *const queue = &contact->contact_bundles;
+	struct routed_bundle_list *entry, *next;
+
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		for (entry = queue->head[p]; entry != NULL; entry = next) {
+			next = entry->next;
+			if (entry->expiration_ms <= contact->from_ms)
+				reschedule_bundle(contact, entry->data,
+						  rescheduler);
+		}
+	}
+	// As the capacity for p0 is reduced by bundles of all priorities, it
+	// is the lowest one.
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		while (contact->remaining_capacity_p0 < 0 &&
+		       queue->tail[p] != NULL)
+			reschedule_bundle(contact, queue->tail[p]->data,
+					  rescheduler);
 	}
 }
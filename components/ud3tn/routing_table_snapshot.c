@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/crc.h"
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/routed_bundle_queue.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/routing_table_snapshot.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t SNAPSHOT_MAGIC[4] = { 'R', 'T', 'S', 'N' };
+
+#define SNAPSHOT_HEADER_SIZE 12
+#define SNAPSHOT_TRAILER_SIZE 4
+
+/* WRITER */
+
+// If data is NULL, only the required size is determined.
+struct snapshot_writer {
+	uint8_t *data;
+	size_t pos;
+};
+
+static void write_bytes(struct snapshot_writer *w, const void *src, size_t n)
+{
+	if (w->data)
+		memcpy(&w->data[w->pos], src, n);
+	w->pos += n;
+}
+
+static void write_uint(struct snapshot_writer *w, uint64_t value, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		if (w->data)
+			w->data[w->pos] = (uint8_t)(value >> (8 * i));
+		w->pos++;
+	}
+}
+
+static void write_string(struct snapshot_writer *w, const char *str)
+{
+	const size_t length = strlen(str);
+
+	write_uint(w, length, 2);
+	write_bytes(w, str, length);
+}
+
+static void write_eids(struct snapshot_writer *w,
+		       const struct endpoint_list *eids)
+{
+	const struct endpoint_list *cur;
+	size_t count = 0;
+
+	for (cur = eids; cur != NULL; cur = cur->next)
+		count++;
+	write_uint(w, count, 2);
+	for (cur = eids; cur != NULL; cur = cur->next)
+		write_string(w, cur->eid);
+}
+
+// Returns the capacity of the contact not used by bundles sent via it,
+// i.e., including the bundles still queued.
+static int32_t unqueued_capacity(const struct contact *contact,
+				 enum bundle_routing_priority prio)
+{
+	const struct routed_bundle_queue *const q = &contact->contact_bundles;
+	const struct routed_bundle_list *entry;
+	int64_t capacity = CONTACT_CAPACITY(contact, prio);
+
+	if (contact->remaining_capacity_p0 == INT32_MAX)
+		return INT32_MAX;
+	for (int p = prio; p < BUNDLE_RPRIO_MAX; p++) {
+		for (entry = q->head[p]; entry != NULL; entry = entry->next)
+			capacity += bundle_get_serialized_size(entry->data);
+	}
+	return (int32_t)MIN(capacity, (int64_t)contact->total_capacity_bytes);
+}
+
+static void write_contact(struct snapshot_writer *w,
+			  const struct contact *contact)
+{
+	write_uint(w, contact->from_ms, 8);
+	write_uint(w, contact->to_ms, 8);
+	write_uint(w, contact->bitrate_bytes_per_s, 4);
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++)
+		write_uint(w, (uint32_t)unqueued_capacity(contact, p), 4);
+	write_eids(w, contact->contact_endpoints);
+}
+
+static void write_node(struct snapshot_writer *w, const struct node *node)
+{
+	const struct contact_list *cur;
+	size_t count = 0;
+
+	write_uint(w, node->flags, 1);
+	write_uint(w, node->cla_addr != NULL, 1);
+	write_string(w, node->eid);
+	if (node->cla_addr != NULL)
+		write_string(w, node->cla_addr);
+	write_eids(w, node->endpoints);
+	for (cur = node->contacts; cur != NULL; cur = cur->next)
+		count++;
+	write_uint(w, count, 4);
+	for (cur = node->contacts; cur != NULL; cur = cur->next)
+		write_contact(w, cur->data);
+}
+
+static void write_snapshot(struct snapshot_writer *w)
+{
+	const struct node_list *cur;
+	size_t count = 0;
+
+	for (cur = routing_table_get_node_list(); cur; cur = cur->next)
+		count++;
+	write_bytes(w, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	write_uint(w, ROUTING_TABLE_SNAPSHOT_VERSION, 2);
+	write_uint(w, 0, 2);
+	write_uint(w, count, 4);
+	for (cur = routing_table_get_node_list(); cur; cur = cur->next)
+		write_node(w, cur->node);
+}
+
+enum ud3tn_result routing_table_snapshot_create(
+	uint8_t **buffer, size_t *length)
+{
+	struct snapshot_writer w = { .data = NULL, .pos = 0 };
+
+	write_snapshot(&w);
+	w.data = malloc(w.pos + SNAPSHOT_TRAILER_SIZE);
+	if (!w.data)
+		return UD3TN_FAIL;
+	w.pos = 0;
+	write_snapshot(&w);
+	write_uint(&w, crc32(w.data, w.pos), 4);
+
+	*buffer = w.data;
+	*length = w.pos;
+	return UD3TN_OK;
+}
+
+/* READER */
+
+struct snapshot_reader {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+static bool read_uint(struct snapshot_reader *r, uint64_t *value, size_t n)
+{
+	if ((size_t)(r->end - r->pos) < n)
+		return false;
+	*value = 0;
+	for (size_t i = 0; i < n; i++)
+		*value |= (uint64_t)r->pos[i] << (8 * i);
+	r->pos += n;
+	return true;
+}
+
+static bool read_string(struct snapshot_reader *r, char **out)
+{
+	uint64_t length;
+	char *str;
+
+	if (!read_uint(r, &length, 2) || (size_t)(r->end - r->pos) < length)
+		return false;
+	// Strings containing a null character are not accepted.
+	if (length == 0 || memchr(r->pos, '\0', length) != NULL)
+		return false;
+	str = malloc(length + 1);
+	if (!str)
+		return false;
+	memcpy(str, r->pos, length);
+	str[length] = '\0';
+	r->pos += length;
+	*out = str;
+	return true;
+}
+
+static bool read_eids(struct snapshot_reader *r, struct endpoint_list **list)
+{
+	struct endpoint_list **tail = list;
+	uint64_t count;
+
+	if (!read_uint(r, &count, 2))
+		return false;
+	for (uint64_t i = 0; i < count; i++) {
+		struct endpoint_list *const entry = malloc(
+			sizeof(struct endpoint_list)
+		);
+
+		if (!entry)
+			return false;
+		entry->next = NULL;
+		if (!read_string(r, &entry->eid)) {
+			free(entry);
+			return false;
+		}
+		*tail = entry;
+		tail = &entry->next;
+	}
+	return true;
+}
+
+static bool read_contact(struct snapshot_reader *r, struct contact *contact)
+{
+	uint64_t from_ms, to_ms, bitrate, remaining[BUNDLE_RPRIO_MAX];
+
+	if (!read_uint(r, &from_ms, 8) || !read_uint(r, &to_ms, 8) ||
+	    !read_uint(r, &bitrate, 4))
+		return false;
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		if (!read_uint(r, &remaining[p], 4))
+			return false;
+	}
+	if (!read_eids(r, &contact->contact_endpoints))
+		return false;
+
+	contact->from_ms = from_ms;
+	contact->to_ms = to_ms;
+	contact->bitrate_bytes_per_s = (uint32_t)bitrate;
+	recalculate_contact_capacity(contact);
+	// This contact is of infinite capacity, nothing is accounted.
+	if (contact->remaining_capacity_p0 == INT32_MAX)
+		return true;
+	contact->remaining_capacity_p0 = MIN(
+		(int32_t)(uint32_t)remaining[0],
+		contact->remaining_capacity_p0
+	);
+	contact->remaining_capacity_p1 = MIN(
+		(int32_t)(uint32_t)remaining[1],
+		contact->remaining_capacity_p1
+	);
+	contact->remaining_capacity_p2 = MIN(
+		(int32_t)(uint32_t)remaining[2],
+		contact->remaining_capacity_p2
+	);
+	return true;
+}
+
+static bool read_contacts(struct snapshot_reader *r, struct node *node,
+			  uint64_t min_end_time_ms)
+{
+	struct contact_list **tail = &node->contacts;
+	struct contact *contact;
+	uint64_t count;
+
+	if (!read_uint(r, &count, 4))
+		return false;
+	for (uint64_t i = 0; i < count; i++) {
+		contact = contact_create(node);
+		if (!contact)
+			return false;
+		if (!read_contact(r, contact)) {
+			free_contact(contact);
+			return false;
+		}
+		// Contacts which have passed in the meantime are dropped.
+		if (contact->to_ms <= min_end_time_ms) {
+			free_contact(contact);
+			continue;
+		}
+		*tail = malloc(sizeof(struct contact_list));
+		if (!*tail) {
+			free_contact(contact);
+			return false;
+		}
+		(*tail)->data = contact;
+		(*tail)->next = NULL;
+		tail = &(*tail)->next;
+	}
+	return true;
+}
+
+static struct node *read_node(struct snapshot_reader *r,
+			      uint64_t min_end_time_ms)
+{
+	struct node *const node = node_create(NULL);
+	uint64_t flags, has_cla_addr;
+
+	if (!node)
+		return NULL;
+	if (!read_uint(r, &flags, 1) || !read_uint(r, &has_cla_addr, 1) ||
+	    !read_string(r, &node->eid) ||
+	    (has_cla_addr && !read_string(r, &node->cla_addr)) ||
+	    !read_eids(r, &node->endpoints) ||
+	    !read_contacts(r, node, min_end_time_ms)) {
+		free_node(node);
+		return NULL;
+	}
+	node->flags = (enum node_flags)flags;
+	return node;
+}
+
+static void reschedule_noop(struct bundle *bundle, const void *context)
+{
+	// The restored contacts do not have any bundles assigned yet.
+	(void)bundle;
+	(void)context;
+}
+
+enum ud3tn_result routing_table_snapshot_restore(
+	const uint8_t *buffer, size_t length, uint64_t min_end_time_ms)
+{
+	const struct rescheduling_handle rescheduler = {
+		.reschedule_func = reschedule_noop,
+		.reschedule_func_context = NULL,
+	};
+	struct snapshot_reader r;
+	struct node **nodes;
+	uint64_t version, node_count, crc;
+	size_t count = 0;
+
+	if (length < SNAPSHOT_HEADER_SIZE + SNAPSHOT_TRAILER_SIZE ||
+	    memcmp(buffer, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+		return UD3TN_FAIL;
+	r.pos = &buffer[length - SNAPSHOT_TRAILER_SIZE];
+	r.end = &buffer[length];
+	read_uint(&r, &crc, 4);
+	if (crc32(buffer, length - SNAPSHOT_TRAILER_SIZE) != crc)
+		return UD3TN_FAIL;
+
+	r.pos = &buffer[sizeof(SNAPSHOT_MAGIC)];
+	r.end = &buffer[length - SNAPSHOT_TRAILER_SIZE];
+	read_uint(&r, &version, 2);
+	r.pos += 2; // reserved
+	read_uint(&r, &node_count, 4);
+	// Every node takes more than one byte, which prevents allocating
+	// memory for bogus node counts.
+	if (version != ROUTING_TABLE_SNAPSHOT_VERSION ||
+	    node_count > (uint64_t)(r.end - r.pos))
+		return UD3TN_FAIL;
+
+	// All nodes are decoded before the routing table is modified, so that
+	// an invalid snapshot does not leave it half restored.
+	nodes = malloc(sizeof(struct node *) * (node_count ? node_count : 1));
+	if (!nodes)
+		return UD3TN_FAIL;
+	while (count < node_count) {
+		nodes[count] = read_node(&r, min_end_time_ms);
+		if (!nodes[count])
+			break;
+		count++;
+	}
+	if (count != node_count || r.pos != r.end) {
+		while (count != 0)
+			free_node(nodes[--count]);
+		free(nodes);
+		return UD3TN_FAIL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (!node_prepare_and_verify(nodes[i], 0)) {
+			free_node(nodes[i]);
+			continue;
+		}
+		routing_table_add_node(nodes[i], rescheduler);
+	}
+	free(nodes);
+	return UD3TN_OK;
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+#include "ud3tn/spray_and_wait.h"
+
+#include "cbor.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+uint32_t spray_and_wait_get_handed_copies(const struct bundle *bundle)
+{
+	const struct bundle_block *const block = bundle_block_find_first_by_type(
+		bundle->blocks,
+		BUNDLE_BLOCK_TYPE_SPRAY_AND_WAIT
+	);
+	CborParser parser;
+	CborValue it;
+	uint64_t copies;
+
+	if (block == NULL || block->data == NULL)
+		return 0;
+	if (cbor_parser_init(block->data, block->length, 0, &parser, &it) ||
+	    !cbor_value_is_unsigned_integer(&it) ||
+	    cbor_value_get_uint64(&it, &copies) != CborNoError)
+		return 0;
+	return copies > UINT32_MAX ? UINT32_MAX : (uint32_t)copies;
+}
+
+static struct bundle_block *add_block(struct bundle *bundle)
+{
+	struct bundle_block *const block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_SPRAY_AND_WAIT
+	);
+	struct bundle_block_list *entry;
+	uint8_t number = 1;
+
+	if (block == NULL)
+		return NULL;
+	entry = bundle_block_entry_create(block);
+	if (entry == NULL) {
+		bundle_block_free(block);
+		return NULL;
+	}
+
+	// Block numbers have to be unique within the bundle (BPv7)
+	for (const struct bundle_block_list *e = bundle->blocks; e != NULL;
+	     e = e->next) {
+		if (e->data->number >= number)
+			number = e->data->number + 1;
+	}
+	block->number = number;
+
+	// Prepended, as the payload block has to remain the last block
+	entry->next = bundle->blocks;
+	bundle->blocks = entry;
+	return block;
+}
+
+enum ud3tn_result spray_and_wait_set_handed_copies(struct bundle *bundle,
+						   uint32_t copies)
+{
+	struct bundle_block *block = bundle_block_find_first_by_type(
+		bundle->blocks,
+		BUNDLE_BLOCK_TYPE_SPRAY_AND_WAIT
+	);
+	CborEncoder encoder;
+
+	if (block == NULL)
+		block = add_block(bundle);
+	if (block == NULL ||
+	    bundle_block_alloc_data(block,
+				    SPRAY_AND_WAIT_BLOCK_MAX_ENCODED_SIZE) !=
+	    UD3TN_OK)
+		return UD3TN_FAIL;
+
+	cbor_encoder_init(&encoder, block->data,
+			  SPRAY_AND_WAIT_BLOCK_MAX_ENCODED_SIZE, 0);
+	cbor_encode_uint(&encoder, copies);
+	block->length = cbor_encoder_get_buffer_size(&encoder, block->data);
+	return UD3TN_OK;
+}
+
+uint32_t spray_and_wait_get_copies(const struct bundle *bundle)
+{
+	uint32_t copies;
+
+	if (bundle->spray_copies != 0)
+		return bundle->spray_copies;
+	copies = spray_and_wait_get_handed_copies(bundle);
+	return copies != 0 ? copies : SPRAY_AND_WAIT_COPIES;
+}
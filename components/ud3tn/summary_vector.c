@@ -0,0 +1,420 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/result.h"
+#include "ud3tn/summary_vector.h"
+
+#include "util/htab_hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIGEST_SET_MIN_CAPACITY 16
+#define FRAGMENT_RANGES_MIN_CAPACITY 4
+
+#define SUMMARY_VECTOR_VERSION 1
+// Version, hash count and the 32-bit number of bits
+#define SUMMARY_VECTOR_HEADER_SIZE 6
+
+static void put_u64_be(uint8_t *buffer, uint64_t value)
+{
+	for (int i = 7; i >= 0; i--) {
+		buffer[i] = value & 0xFF;
+		value >>= 8;
+	}
+}
+
+uint64_t summary_vector_digest(const struct bundle *bundle)
+{
+	const bool is_fragment = bundle_is_fragmented(bundle);
+	const size_t source_length = strlen(bundle->source);
+	uint8_t fields[32];
+
+	// Encode explicitly to obtain the same digest on every platform
+	put_u64_be(&fields[0], bundle->creation_timestamp_ms);
+	put_u64_be(&fields[8], bundle->sequence_number);
+	put_u64_be(&fields[16], is_fragment ? bundle->fragment_offset : 0);
+	put_u64_be(&fields[24], (
+		is_fragment ? bundle->payload_block->length : 0
+	));
+
+	const uint64_t digest = (
+		(uint64_t)hashlittle(fields, sizeof(fields), hashlittle(
+			bundle->source, source_length, 1
+		)) << 32 |
+		hashlittle(fields, sizeof(fields), hashlittle(
+			bundle->source, source_length, 2
+		))
+	);
+
+	return digest != 0 ? digest : 1;
+}
+
+/* DIGEST SET */
+
+static inline bool load_exceeded(size_t count, size_t capacity)
+{
+	return count * 8 > capacity * 7;
+}
+
+static size_t find_slot(const struct digest_set *set, uint64_t digest)
+{
+	const size_t mask = set->capacity - 1;
+	size_t pos = (size_t)digest & mask;
+
+	while (set->entries[pos].digest != 0 &&
+	       set->entries[pos].digest != digest)
+		pos = (pos + 1) & mask;
+	return pos;
+}
+
+static enum ud3tn_result resize(struct digest_set *set, size_t capacity)
+{
+	struct digest_set_entry *const old_entries = set->entries;
+	const size_t old_capacity = set->capacity;
+	struct digest_set_entry *const entries = calloc(
+		capacity,
+		sizeof(struct digest_set_entry)
+	);
+
+	if (entries == NULL)
+		return UD3TN_FAIL;
+	set->entries = entries;
+	set->capacity = capacity;
+	for (size_t i = 0; i < old_capacity; i++) {
+		if (old_entries[i].digest != 0)
+			set->entries[find_slot(set, old_entries[i].digest)] =
+				old_entries[i];
+	}
+	free(old_entries);
+	return UD3TN_OK;
+}
+
+void digest_set_init(struct digest_set *set)
+{
+	set->entries = NULL;
+	set->capacity = 0;
+	set->count = 0;
+}
+
+void digest_set_free(struct digest_set *set)
+{
+	free(set->entries);
+	digest_set_init(set);
+}
+
+enum ud3tn_result digest_set_add(struct digest_set *set, uint64_t digest,
+				 uint64_t expiration_ms)
+{
+	return digest_set_put(set, digest, expiration_ms, 0);
+}
+
+enum ud3tn_result digest_set_put(struct digest_set *set, uint64_t digest,
+				 uint64_t expiration_ms, uint32_t value)
+{
+	if (digest == 0)
+		digest = 1;
+	if (set->entries == NULL || load_exceeded(set->count + 1,
+						  set->capacity)) {
+		const size_t capacity = (
+			set->capacity != 0
+			? set->capacity * 2
+			: DIGEST_SET_MIN_CAPACITY
+		);
+
+		if (resize(set, capacity) != UD3TN_OK)
+			return UD3TN_FAIL;
+	}
+
+	struct digest_set_entry *const entry =
+		&set->entries[find_slot(set, digest)];
+
+	if (entry->digest == 0) {
+		entry->digest = digest;
+		set->count++;
+	}
+	entry->expiration_ms = expiration_ms;
+	entry->value = value;
+	return UD3TN_OK;
+}
+
+bool digest_set_contains(const struct digest_set *set, uint64_t digest)
+{
+	if (set->entries == NULL)
+		return false;
+	if (digest == 0)
+		digest = 1;
+	return set->entries[find_slot(set, digest)].digest != 0;
+}
+
+bool digest_set_remove(struct digest_set *set, uint64_t digest)
+{
+	return digest_set_take(set, digest, NULL);
+}
+
+bool digest_set_take(struct digest_set *set, uint64_t digest,
+		     uint32_t *value)
+{
+	if (set->entries == NULL)
+		return false;
+	if (digest == 0)
+		digest = 1;
+
+	const size_t mask = set->capacity - 1;
+	size_t pos = find_slot(set, digest);
+
+	if (set->entries[pos].digest == 0)
+		return false;
+	if (value != NULL)
+		*value = set->entries[pos].value;
+
+	// Shift back following entries that would not be found anymore
+	for (size_t next = (pos + 1) & mask;
+	     set->entries[next].digest != 0;
+	     next = (next + 1) & mask) {
+		const size_t home = (size_t)set->entries[next].digest & mask;
+
+		if (((next - home) & mask) >= ((next - pos) & mask)) {
+			set->entries[pos] = set->entries[next];
+			pos = next;
+		}
+	}
+	set->entries[pos].digest = 0;
+	set->entries[pos].expiration_ms = 0;
+	set->entries[pos].value = 0;
+	set->count--;
+	return true;
+}
+
+void digest_set_expire(struct digest_set *set, uint64_t time_ms)
+{
+	struct digest_set_entry *const old_entries = set->entries;
+	size_t remaining = 0;
+
+	for (size_t i = 0; i < set->capacity; i++) {
+		if (old_entries[i].digest != 0 &&
+		    old_entries[i].expiration_ms >= time_ms)
+			remaining++;
+	}
+	if (remaining == set->count)
+		return;
+
+	// Re-insert the remaining entries as removing them in place would
+	// require shifting back entries for every expired one.
+	set->entries = calloc(set->capacity, sizeof(struct digest_set_entry));
+	if (set->entries == NULL) {
+		// Retried by a later call
+		set->entries = old_entries;
+		return;
+	}
+	for (size_t i = 0; i < set->capacity; i++) {
+		if (old_entries[i].digest != 0 &&
+		    old_entries[i].expiration_ms >= time_ms)
+			set->entries[find_slot(set, old_entries[i].digest)] =
+				old_entries[i];
+	}
+	set->count = remaining;
+	free(old_entries);
+}
+
+/* FRAGMENT RANGES */
+
+void fragment_ranges_init(struct fragment_ranges *fr)
+{
+	fr->ranges = NULL;
+	fr->count = 0;
+	fr->capacity = 0;
+}
+
+void fragment_ranges_free(struct fragment_ranges *fr)
+{
+	free(fr->ranges);
+	fragment_ranges_init(fr);
+}
+
+enum ud3tn_result fragment_ranges_add(struct fragment_ranges *fr,
+				      uint64_t digest, uint64_t offset,
+				      uint64_t length)
+{
+	if (fr->count == fr->capacity) {
+		const size_t capacity = (
+			fr->capacity != 0
+			? fr->capacity * 2
+			: FRAGMENT_RANGES_MIN_CAPACITY
+		);
+		struct fragment_range *const ranges = realloc(
+			fr->ranges,
+			capacity * sizeof(struct fragment_range)
+		);
+
+		if (ranges == NULL)
+			return UD3TN_FAIL;
+		fr->ranges = ranges;
+		fr->capacity = capacity;
+	}
+
+	size_t pos = fr->count;
+
+	while (pos > 0 && fr->ranges[pos - 1].offset > offset) {
+		fr->ranges[pos] = fr->ranges[pos - 1];
+		pos--;
+	}
+	fr->ranges[pos] = (struct fragment_range){ digest, offset, length };
+	fr->count++;
+	return UD3TN_OK;
+}
+
+bool fragment_ranges_remove(struct fragment_ranges *fr, uint64_t digest)
+{
+	for (size_t i = 0; i < fr->count; i++) {
+		if (fr->ranges[i].digest != digest)
+			continue;
+		memmove(&fr->ranges[i], &fr->ranges[i + 1],
+			(fr->count - i - 1) * sizeof(struct fragment_range));
+		fr->count--;
+		return true;
+	}
+	return false;
+}
+
+bool fragment_ranges_next_gap(const struct fragment_ranges *fr,
+			      uint64_t position, uint64_t payload_length,
+			      uint64_t *gap_offset, uint64_t *gap_length)
+{
+	for (size_t i = 0; i < fr->count && position < payload_length; i++) {
+		const struct fragment_range *const r = &fr->ranges[i];
+
+		if (r->offset > position) {
+			*gap_offset = position;
+			*gap_length = MIN(r->offset, payload_length) - position;
+			return true;
+		}
+		position = MAX(position, r->offset + r->length);
+	}
+	if (position >= payload_length)
+		return false;
+	*gap_offset = position;
+	*gap_length = payload_length - position;
+	return true;
+}
+
+/* SUMMARY VECTOR */
+
+static inline uint32_t bit_position(uint64_t digest, uint8_t i,
+				    uint32_t bit_count)
+{
+	// Double hashing, the second hash has to be odd
+	const uint64_t h1 = digest & 0xFFFFFFFF;
+	const uint64_t h2 = (digest >> 32) | 1;
+
+	return (uint32_t)((h1 + i * h2) % bit_count);
+}
+
+enum ud3tn_result summary_vector_create(struct summary_vector *sv,
+					const struct digest_set *set)
+{
+	const uint64_t bit_count = MAX(
+		(uint64_t)set->count * SUMMARY_VECTOR_BITS_PER_BUNDLE,
+		(uint64_t)64
+	);
+
+	if (bit_count > (uint64_t)SUMMARY_VECTOR_MAX_SIZE * 8)
+		return UD3TN_FAIL;
+
+	sv->bit_count = (uint32_t)bit_count;
+	// The optimal number of hashes is ln(2) times the bits per entry
+	sv->hash_count = MAX(1, SUMMARY_VECTOR_BITS_PER_BUNDLE * 693 / 1000);
+	sv->bits = calloc((sv->bit_count + 7) / 8, 1);
+	if (sv->bits == NULL)
+		return UD3TN_FAIL;
+
+	for (size_t i = 0; i < set->capacity; i++) {
+		const uint64_t digest = set->entries[i].digest;
+
+		if (digest == 0)
+			continue;
+		for (uint8_t h = 0; h < sv->hash_count; h++) {
+			const uint32_t pos = bit_position(
+				digest,
+				h,
+				sv->bit_count
+			);
+
+			sv->bits[pos / 8] |= 1 << (pos % 8);
+		}
+	}
+	return UD3TN_OK;
+}
+
+bool summary_vector_contains(const struct summary_vector *sv,
+			     uint64_t digest)
+{
+	if (sv->bits == NULL || sv->bit_count == 0)
+		return false;
+	if (digest == 0)
+		digest = 1;
+	for (uint8_t h = 0; h < sv->hash_count; h++) {
+		const uint32_t pos = bit_position(digest, h, sv->bit_count);
+
+		if ((sv->bits[pos / 8] & (1 << (pos % 8))) == 0)
+			return false;
+	}
+	return true;
+}
+
+void summary_vector_free(struct summary_vector *sv)
+{
+	free(sv->bits);
+	sv->bits = NULL;
+	sv->bit_count = 0;
+	sv->hash_count = 0;
+}
+
+size_t summary_vector_get_serialized_size(const struct summary_vector *sv)
+{
+	return SUMMARY_VECTOR_HEADER_SIZE + (sv->bit_count + 7) / 8;
+}
+
+void summary_vector_serialize(const struct summary_vector *sv,
+			      uint8_t *buffer)
+{
+	buffer[0] = SUMMARY_VECTOR_VERSION;
+	buffer[1] = sv->hash_count;
+	buffer[2] = (sv->bit_count >> 24) & 0xFF;
+	buffer[3] = (sv->bit_count >> 16) & 0xFF;
+	buffer[4] = (sv->bit_count >> 8) & 0xFF;
+	buffer[5] = sv->bit_count & 0xFF;
+	memcpy(&buffer[SUMMARY_VECTOR_HEADER_SIZE], sv->bits,
+	       (sv->bit_count + 7) / 8);
+}
+
+enum ud3tn_result summary_vector_parse(struct summary_vector *sv,
+				       const uint8_t *data, size_t length)
+{
+	if (length < SUMMARY_VECTOR_HEADER_SIZE ||
+	    data[0] != SUMMARY_VECTOR_VERSION || data[1] == 0)
+		return UD3TN_FAIL;
+
+	const uint32_t bit_count = (
+		(uint32_t)data[2] << 24 |
+		(uint32_t)data[3] << 16 |
+		(uint32_t)data[4] << 8 |
+		(uint32_t)data[5]
+	);
+	const size_t byte_count = ((size_t)bit_count + 7) / 8;
+
+	if (bit_count == 0 || byte_count > SUMMARY_VECTOR_MAX_SIZE ||
+	    length != SUMMARY_VECTOR_HEADER_SIZE + byte_count)
+		return UD3TN_FAIL;
+
+	sv->bits = malloc(byte_count);
+	if (sv->bits == NULL)
+		return UD3TN_FAIL;
+	memcpy(sv->bits, &data[SUMMARY_VECTOR_HEADER_SIZE], byte_count);
+	sv->bit_count = bit_count;
+	sv->hash_count = data[1];
+	return UD3TN_OK;
+}
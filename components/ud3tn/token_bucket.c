@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/common.h"
+#include "ud3tn/token_bucket.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TOKENS_PER_BYTE 1000
+
+static void refill(struct token_bucket *bucket, uint64_t now_ms)
+{
+	const uint64_t max_tokens =
+		(uint64_t)bucket->capacity_bytes * TOKENS_PER_BYTE;
+	// The time may not be monotonic, e.g. if the clock is adjusted.
+	const uint64_t elapsed_ms = (
+		now_ms > bucket->last_update_ms
+		? now_ms - bucket->last_update_ms
+		: 0
+	);
+
+	bucket->last_update_ms = now_ms;
+	if (bucket->rate_bytes_per_s == 0 ||
+	    elapsed_ms > (max_tokens - bucket->tokens) /
+			  bucket->rate_bytes_per_s) {
+		bucket->tokens = max_tokens;
+		return;
+	}
+	// One byte per second adds one token per millisecond.
+	bucket->tokens += elapsed_ms * bucket->rate_bytes_per_s;
+}
+
+void token_bucket_init(struct token_bucket *bucket, uint32_t capacity_bytes,
+		       uint64_t now_ms)
+{
+	bucket->rate_bytes_per_s = 0;
+	bucket->capacity_bytes = capacity_bytes;
+	bucket->tokens = (uint64_t)capacity_bytes * TOKENS_PER_BYTE;
+	bucket->last_update_ms = now_ms;
+}
+
+void token_bucket_set_rate(struct token_bucket *bucket,
+			   uint32_t rate_bytes_per_s, uint64_t now_ms)
+{
+	refill(bucket, now_ms);
+	bucket->rate_bytes_per_s = rate_bytes_per_s;
+}
+
+uint64_t token_bucket_take(struct token_bucket *bucket, size_t bytes,
+			   uint64_t now_ms)
+{
+	uint64_t needed;
+
+	if (bucket->rate_bytes_per_s == 0)
+		return 0;
+	refill(bucket, now_ms);
+	needed = (uint64_t)MIN(bytes, (size_t)bucket->capacity_bytes) *
+		TOKENS_PER_BYTE;
+	if (bucket->tokens >= needed) {
+		bucket->tokens -= needed;
+		return 0;
+	}
+	// Rounded up, the tokens are available after the delay.
+	return (needed - bucket->tokens + bucket->rate_bytes_per_s - 1) /
+		bucket->rate_bytes_per_s;
+}
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef CONFIGPLANPARSER_H_INCLUDED
+#define CONFIGPLANPARSER_H_INCLUDED
+
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Parser for contact plans uploaded as a whole in a single config bundle,
+ * encoded in CBOR as described in doc/contacts_data_format.md.
+ *
+ * In contrast to the ASCII format, which is read byte by byte and yields one
+ * router command at a time, the plan is decoded in one pass into an array
+ * of router commands which is handed over to the router at once.
+ */
+
+struct config_plan {
+	struct router_command *commands;
+	size_t count;
+};
+
+/**
+ * Returns whether the config message contains a CBOR-encoded plan, i.e.,
+ * starts with a CBOR array instead of an ASCII command type.
+ */
+bool config_plan_is_cbor(const uint8_t *buffer, size_t length);
+
+/**
+ * Decodes the plan contained in the buffer. On success, the commands have
+ * to be released by the caller using config_plan_free() after processing.
+ * On failure, nothing has to be released.
+ */
+enum ud3tn_result config_plan_parse(struct config_plan *plan,
+				    const uint8_t *buffer, size_t length);
+
+/**
+ * Frees the commands of the plan including the nodes not consumed yet.
+ */
+void config_plan_free(struct config_plan *plan);
+
+#endif /* CONFIGPLANPARSER_H_INCLUDED */
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef EPIDEMIC_AGENT_H_
+#define EPIDEMIC_AGENT_H_
+
+#include "agents/exchange_agent.h"
+
+/*
+ * Summary vectors exchanged between epidemic routers via the exchange agent:
+ * when a link to a neighbor is established, the summary vector of the
+ * bundles known locally is sent to the agent of the neighbor. On reception,
+ * the neighbor stores it in its router and restores the persisted bundles,
+ * which are then only queued for peers that do not know them yet.
+ */
+
+// Default Agent IDs.
+#ifndef AGENT_ID_EPIDEMIC_DTN
+#define AGENT_ID_EPIDEMIC_DTN "epidemic"
+#endif // AGENT_ID_EPIDEMIC_DTN
+#ifndef AGENT_ID_EPIDEMIC_IPN
+#define AGENT_ID_EPIDEMIC_IPN "9004"
+#endif // AGENT_ID_EPIDEMIC_IPN
+
+// Lifetime of bundles containing a summary vector.
+#ifndef EPIDEMIC_SUMMARY_LIFETIME_MS
+#define EPIDEMIC_SUMMARY_LIFETIME_MS 60000
+#endif // EPIDEMIC_SUMMARY_LIFETIME_MS
+
+// Parameters of the exchange agent, defined by the router
+extern const struct exchange_agent_config epidemic_agent_config;
+
+#endif // EPIDEMIC_AGENT_H_
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef EXCHANGE_AGENT_H_
+#define EXCHANGE_AGENT_H_
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/bundle_processor.h"
+#include "ud3tn/result.h"
+
+#include "platform/hal_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Exchanges the state of the routers of neighbors: when a link to a neighbor
+ * is established, the state of the local router is sent to the agent of the
+ * neighbor. On reception, the neighbor passes it on to its router and
+ * restores the persisted bundles, which are then routed taking the state of
+ * the peer into account. What is exchanged is defined by the router, see
+ * epidemic_agent.h and prophet_agent.h.
+ */
+
+struct exchange_agent_config {
+	// Name of the exchanged state, used in log messages
+	const char *state_name;
+	const char *agent_id_dtn;
+	const char *agent_id_ipn;
+	// Lifetime of the bundles carrying the state
+	uint64_t lifetime_ms;
+
+	// Returns the serialized state of the local router, which has to be
+	// freed by the caller.
+	uint8_t *(*create_state)(size_t *length);
+	// Passes the state received from the given node on to the router.
+	enum ud3tn_result (*state_received)(
+		const char *node_eid, const uint8_t *data, size_t length);
+};
+
+int exchange_agent_setup(struct bundle_agent_interface *const bai,
+			 QueueIdentifier_t bundle_restore_queue,
+			 const uint8_t bundle_version,
+			 const struct exchange_agent_config *config);
+
+/**
+ * Creates a bundle containing the current state of the local router,
+ * addressed to the agent of the given node.
+ */
+struct bundle *exchange_agent_create_bundle(const char *node_eid);
+
+/**
+ * Returns whether the bundle is addressed to the agent, i.e., carries the
+ * state of the router of its source.
+ */
+bool exchange_agent_is_state_bundle(
+	const struct exchange_agent_config *config,
+	const struct bundle *bundle);
+
+#endif // EXCHANGE_AGENT_H_
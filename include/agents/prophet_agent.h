@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef PROPHET_AGENT_H_
+#define PROPHET_AGENT_H_
+
+#include "agents/exchange_agent.h"
+
+/*
+ * Delivery predictabilities exchanged between PRoPHET routers via the
+ * exchange agent: when a link to a neighbor is established, the
+ * predictability table of the local node is sent to the agent of the
+ * neighbor. On reception, the neighbor updates its own predictabilities and
+ * restores the persisted bundles, which are then queued for the peer if it
+ * is the better carrier.
+ */
+
+// Default Agent IDs.
+#ifndef AGENT_ID_PROPHET_DTN
+#define AGENT_ID_PROPHET_DTN "prophet"
+#endif // AGENT_ID_PROPHET_DTN
+#ifndef AGENT_ID_PROPHET_IPN
+#define AGENT_ID_PROPHET_IPN "9005"
+#endif // AGENT_ID_PROPHET_IPN
+
+// Lifetime of bundles containing a predictability table.
+#ifndef PROPHET_TABLE_LIFETIME_MS
+#define PROPHET_TABLE_LIFETIME_MS 60000
+#endif // PROPHET_TABLE_LIFETIME_MS
+
+// Parameters of the exchange agent, defined by the router
+extern const struct exchange_agent_config prophet_agent_config;
+
+#endif // PROPHET_AGENT_H_
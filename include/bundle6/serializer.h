@@ -12,4 +12,15 @@ enum ud3tn_result bundle6_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
+/*
+ * Like bundle6_serialize, but passes the block-specific data through
+ * write_data. These pointers remain valid as long as the bundle is not
+ * modified, while the ones passed to write are only valid during the call.
+ */
+enum ud3tn_result bundle6_serialize_split(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_data)(void *cla_obj, const void *, const size_t),
+	void *cla_obj);
+
 #endif /* BUNDLE6_SERIALIZER_H_INCLUDED */
@@ -88,4 +88,27 @@ enum ud3tn_result bundle7_parser_reset(struct bundle7_parser *state);
 enum ud3tn_result bundle7_parser_deinit(struct bundle7_parser *state);
 
 
+/**
+ * Parses a BPv7 bundle which is completely contained in the given buffer,
+ * starting at its first byte, in a single pass.
+ *
+ * Block data is not copied: the data pointers of all blocks of the returned
+ * bundle point into the source buffer and every block holds a reference to
+ * it, so the source stays valid until the bundle (or the last block taken
+ * from it) is freed. The caller keeps its own reference to the source.
+ *
+ * In contrast to the incremental parser, the structure of the bundle is
+ * validated strictly (protocol version, number of block fields) and a bundle
+ * is rejected if any CRC does not match.
+ *
+ * @param source Buffer containing the serialized bundle
+ * @param consumed If not NULL, receives the number of bytes of the bundle
+ *
+ * @return The parsed bundle or NULL if it is invalid or exceeds
+ *         BUNDLE_MAX_SIZE
+ */
+struct bundle *bundle7_parse_buffer(struct payload_buffer *source,
+	size_t *consumed);
+
+
 #endif /* BUNDLE_V7_PARSER_H_INCLUDED */
@@ -65,5 +65,17 @@ enum ud3tn_result bundle7_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
+/**
+ * Creates CBOR-encoded byte stream of a Bundle v7, passing the block-specific
+ * data through write_data instead of write. In contrast to the buffers passed
+ * to write, which are only valid during the call, these point directly into
+ * the bundle and remain valid as long as the bundle is not modified.
+ */
+enum ud3tn_result bundle7_serialize_split(
+	struct bundle *bundle,
+	void (*write)(void *cla_obj, const void *, const size_t),
+	void (*write_data)(void *cla_obj, const void *, const size_t),
+	void *cla_obj);
+
 
 #endif /* BUNDLE_V7_SERIALIZER_H_INCLUDED */
@@ -31,6 +31,22 @@ struct cla_config {
 	const struct bundle_agent_interface *bundle_agent_interface;
 };
 
+// Per-stage timing of the transmission via a link, see CLA_TX_PIPELINE_DEPTH.
+// The link is saturated as long as the stall time of the send stage does not
+// increase while bundles are pending.
+struct cla_tx_stats {
+	uint64_t bundles_sent;
+	uint64_t bytes_sent;
+	// Time spent preparing and serializing bundles
+	uint64_t serialize_time_us;
+	// Time spent writing serialized bundles to the link
+	uint64_t send_time_us;
+	// Time the link was idle as the next bundle was still being serialized
+	uint64_t send_stall_time_us;
+	// Time serialized bundles waited for the pipeline to accept them
+	uint64_t serialize_stall_time_us;
+};
+
 struct cla_link {
 	struct cla_config *config;
 
@@ -53,6 +69,8 @@ struct cla_link {
 	QueueIdentifier_t tx_queue_handle;
 	// Semaphore blocking the TX queue while bundles are being added
 	Semaphore_t tx_queue_sem;
+
+	struct cla_tx_stats tx_stats;
 };
 
 struct cla_tx_queue {
@@ -70,6 +88,18 @@ enum ud3tn_result cla_initialize_all(
 
 struct cla_config *cla_config_get(const char *cla_addr);
 
+/**
+ * Registers a CLA instance created outside of cla_initialize_all(), e.g. a
+ * mock CLA in tests, replacing the instance of the same name. The name
+ * returned by its vtable has to be the one of a compiled-in CLA.
+ */
+void cla_register(struct cla_config *config);
+
+/**
+ * Removes the registered instance of the CLA with the given name.
+ */
+void cla_deregister(const char *cla_name);
+
 /*
  * Private API
  */
@@ -137,6 +167,14 @@ struct cla_vtable {
 	void (*cla_send_packet_data)(struct cla_link *,
 				     const void *,
 				     const size_t);
+	/*
+	 * Optional: Sends a whole serialized bundle given as iovec list in a
+	 * single operation (e.g. writev). If provided, it is used instead of
+	 * the begin_packet / send_packet_data / end_packet sequence.
+	 */
+	void (*cla_send_packet_iov)(struct cla_link *,
+				    const struct bundle_serialized *,
+				    char *);
 
 	// RX Task API
 
@@ -9,6 +9,28 @@
 
 #include "platform/hal_queue.h"
 
+#include <stdint.h>
+
+// Number of serialized bundles which may wait to be written to a link. While
+// a bundle is written, the next ones are serialized by the TX task
+// (default: 1, i.e., double-buffered; 0 = serialize and send in turn).
+#ifndef CLA_TX_PIPELINE_DEPTH
+#define CLA_TX_PIPELINE_DEPTH 1
+#endif // CLA_TX_PIPELINE_DEPTH
+
+// Maximum number of bytes sent at once via a link after an idle period when
+// shaping the transmission to the data rate of the contact, e.g. the buffer
+// size of a radio modem (default: 0 = no shaping).
+#ifndef CLA_TX_SHAPING_BURST_SIZE
+#define CLA_TX_SHAPING_BURST_SIZE 0
+#endif // CLA_TX_SHAPING_BURST_SIZE
+
+// Size of the chunks in which serialized bundles are passed to the CLA while
+// shaping, so that large bundles are spread over time.
+#ifndef CLA_TX_SHAPING_CHUNK_SIZE
+#define CLA_TX_SHAPING_CHUNK_SIZE 512
+#endif // CLA_TX_SHAPING_CHUNK_SIZE
+
 enum cla_contact_tx_task_command_type {
 	TX_COMMAND_UNDEFINED, /* 0x00 */
 	TX_COMMAND_BUNDLES,   /* 0x01 */
@@ -19,10 +41,18 @@ struct cla_contact_tx_task_command {
 	enum cla_contact_tx_task_command_type type;
 	struct routed_bundle_list *bundles;
 	char *cla_address;
+	// Data rate of the contact the bundles are sent in, 0 = unknown
+	uint32_t bitrate_bytes_per_s;
 };
 
 enum ud3tn_result cla_launch_contact_tx_task(struct cla_link *link);
 
+/**
+ * Returns the transmission counters of the link, see struct cla_tx_stats.
+ */
+void cla_contact_tx_task_get_stats(const struct cla_link *link,
+				   struct cla_tx_stats *stats);
+
 void cla_contact_tx_task_request_exit(QueueIdentifier_t queue);
 
 #endif /* CLA_CONTACT_TX_TASK_H_INCLUDED */
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef CLA_TX_SCHEDULER_H_INCLUDED
+#define CLA_TX_SCHEDULER_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/min_heap.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Scheduler deciding the order in which the bundles handed over to a link
+ * are sent. The TX task of the link adds all bundles it has received to the
+ * scheduler before sending the next one, so that bundles handed over later
+ * (e.g. an expedited bundle) can overtake the ones still pending.
+ *
+ * The scheduler is only used by the TX task of the link and, thus, not
+ * synchronized.
+ */
+
+enum cla_tx_scheduler_policy {
+	// In the order of hand-over
+	CLA_TX_SCHEDULER_FIFO,
+	// Highest routing priority first, in the order of hand-over otherwise
+	CLA_TX_SCHEDULER_PRIORITY,
+	// Earliest expiration time first
+	CLA_TX_SCHEDULER_EDF,
+	// Deficit round robin across destination EIDs, i.e., every destination
+	// gets the same share of the link, in bytes
+	CLA_TX_SCHEDULER_DRR,
+};
+
+// Policy used by the TX tasks of all links
+#ifndef CLA_TX_SCHEDULER_POLICY
+#define CLA_TX_SCHEDULER_POLICY CLA_TX_SCHEDULER_PRIORITY
+#endif // CLA_TX_SCHEDULER_POLICY
+
+// Number of bytes a destination may send per round with CLA_TX_SCHEDULER_DRR
+#ifndef CLA_TX_SCHEDULER_DRR_QUANTUM
+#define CLA_TX_SCHEDULER_DRR_QUANTUM 4096
+#endif // CLA_TX_SCHEDULER_DRR_QUANTUM
+
+// A bundle pending for transmission via the link
+struct cla_tx_item {
+	struct bundle *bundle;
+	enum bundle_routing_priority prio;
+	uint64_t expiration_ms;
+	// Serialized size of the bundle
+	size_t size;
+	// Used by the scheduler
+	struct cla_tx_item *next;
+	// Address the bundle is sent to (see cla_begin_packet)
+	char cla_address[];
+};
+
+struct cla_tx_flow;
+
+struct cla_tx_scheduler {
+	enum cla_tx_scheduler_policy policy;
+	size_t count;
+
+	// Pending items ordered by the policy (except for DRR)
+	struct min_heap entries;
+	uint64_t sequence_number;
+
+	// DRR: flows by destination EID, and the flows with pending entries
+	// in the order they are served
+	struct hashmap flows;
+	struct cla_tx_flow *active_head;
+	struct cla_tx_flow *active_tail;
+	size_t active_count;
+	size_t quantum;
+};
+
+void cla_tx_scheduler_init(struct cla_tx_scheduler *scheduler,
+			   enum cla_tx_scheduler_policy policy,
+			   size_t drr_quantum);
+
+/**
+ * Releases the storage of the scheduler, which has to be empty.
+ */
+void cla_tx_scheduler_free(struct cla_tx_scheduler *scheduler);
+
+/**
+ * Adds the item to the scheduler, which references it until returned.
+ *
+ * @return UD3TN_FAIL if memory could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result cla_tx_scheduler_push(struct cla_tx_scheduler *scheduler,
+					struct cla_tx_item *item);
+
+/**
+ * Removes and returns the item to be sent next, NULL if empty.
+ */
+struct cla_tx_item *cla_tx_scheduler_pop(
+	struct cla_tx_scheduler *scheduler);
+
+static inline bool cla_tx_scheduler_empty(
+	const struct cla_tx_scheduler *scheduler)
+{
+	return scheduler->count == 0;
+}
+
+#endif // CLA_TX_SCHEDULER_H_INCLUDED
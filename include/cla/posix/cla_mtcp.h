@@ -39,4 +39,8 @@ void mtcp_end_packet(struct cla_link *link);
 void mtcp_send_packet_data(
 	struct cla_link *link, const void *data, const size_t length);
 
+void mtcp_send_packet_iov(struct cla_link *link,
+			  const struct bundle_serialized *serialized,
+			  char *cla_addr);
+
 #endif /* CLA_MTCP_H */
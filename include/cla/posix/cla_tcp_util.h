@@ -2,6 +2,8 @@
 #ifndef CLA_TCP_UTIL_H_INCLUDED
 #define CLA_TCP_UTIL_H_INCLUDED
 
+#include "ud3tn/bundle.h"
+
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -56,6 +58,20 @@ int cla_tcp_connect_to_cla_addr(const char *const cla_addr,
 ssize_t tcp_send_all(const int socket, const void *const buffer,
 		     const size_t length);
 
+/**
+ * Send a CLA-specific packet header followed by a serialized bundle to the
+ * given socket using as few system calls as possible (writev).
+ *
+ * @param socket The socket to be written to.
+ * @param header The header to prepend, may be NULL.
+ * @param header_length The length of the header.
+ * @param serialized The iovec list of the bundle, see bundle_serialize_iov().
+ * @return The number of bytes sent, or -1 on error (errno is set).
+ */
+ssize_t tcp_send_all_iov(const int socket,
+			 const void *const header, const size_t header_length,
+			 const struct bundle_serialized *const serialized);
+
 /**
  * Receive all data from the given socket, ignoring interruptions by signals.
  *
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * hal_payload.h
+ *
+ * Description: contains the definitions of the hardware abstraction
+ * layer interface for file-backed (spilled) payload storage
+ *
+ */
+
+#ifndef HAL_PAYLOAD_H_INCLUDED
+#define HAL_PAYLOAD_H_INCLUDED
+
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief hal_payload_spill_init Sets the directory in which spill files
+ *				 for large payloads are created.
+ * @param directory The directory to use, it is created if it does not exist.
+ *		    If NULL, a platform-specific default is used.
+ * @return Whether the directory is usable
+ */
+enum ud3tn_result hal_payload_spill_init(const char *directory);
+
+/**
+ * @brief hal_payload_spill_map Creates an anonymous spill file of the given
+ *				size and maps it into memory. Pages are backed
+ *				by the file and can be written back and evicted
+ *				by the platform, so the payload does not count
+ *				against heap memory.
+ * @param length The size of the mapping in bytes (must not be zero)
+ * @return A pointer to the writable mapping, or NULL on failure
+ */
+uint8_t *hal_payload_spill_map(size_t length);
+
+/**
+ * @brief hal_payload_map_file Maps an existing file into memory as a private
+ *			       (copy-on-write) mapping. Writes to the mapping
+ *			       are not carried through to the file.
+ * @param path The path of the file to be mapped
+ * @param length Receives the size of the mapping in bytes
+ * @return A pointer to the mapping, or NULL on failure or if the file is empty
+ */
+uint8_t *hal_payload_map_file(const char *path, size_t *length);
+
+/**
+ * @brief hal_payload_prefetch Hints that the given range of a mapping will
+ *			       be read soon, so that the platform can load it
+ *			       in the background.
+ * @param data The start of the range
+ * @param length The length of the range in bytes
+ */
+void hal_payload_prefetch(const uint8_t *data, size_t length);
+
+/**
+ * @brief hal_payload_unmap Releases a mapping obtained from
+ *			    hal_payload_spill_map or hal_payload_map_file.
+ *			    Spill files are deleted along with their mapping.
+ * @param data The pointer returned when creating the mapping
+ * @param length The length of the mapping
+ */
+void hal_payload_unmap(uint8_t *data, size_t length);
+
+#endif /* HAL_PAYLOAD_H_INCLUDED */
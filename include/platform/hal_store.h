@@ -7,6 +7,10 @@
 
 #include "ud3tn/result.h"
 #include "ud3tn/bundle.h"
+#include "ud3tn/payload.h"
+
+#include <stddef.h>
+#include <stdint.h>
 
 struct bundle_store {
     const char* identifier;
@@ -16,6 +20,28 @@ struct bundle_store_loadall {
     struct bundle_store* store;
 };
 
+/**
+ * Residency of a stored bundle, i.e. whether an instance of it is currently
+ * held in memory by the bundle processor (e.g. queued for a contact or kept
+ * for reassembly) or by a CLA for transmission. Bundles which are resident
+ * are skipped by hal_store_loadall_next, so that they are not dispatched twice.
+ */
+enum bundle_residency {
+    BUNDLE_RESIDENCY_AT_REST = 0,
+    BUNDLE_RESIDENCY_IN_MEMORY,
+    BUNDLE_RESIDENCY_IN_TX,
+};
+
+struct bundle_store_residency_stats {
+    // Number of stored bundles currently resident
+    size_t in_memory;
+    size_t in_tx;
+    // Bundles loaded by hal_store_loadall_next since initialization
+    uint64_t loads;
+    // Bundles skipped by hal_store_loadall_next as they were resident
+    uint64_t skipped_loads;
+};
+
 /**
  * @brief hal_store_init initialize persistance store
  * @return Whether store was properly initialized
@@ -36,6 +62,23 @@ enum ud3tn_result hal_store_bundle_metadata(struct bundle_store* store, struct b
 // TODO Doc
 enum ud3tn_result hal_store_bundle_delete(struct bundle_store* store, struct bundle *bundle);
 
+/**
+ * @brief hal_store_set_residency record where the stored bundle is currently held
+ * @param store Store to operate on (see hal_store_init)
+ * @param bundle Bundle (or any instance of it) to update the residency of
+ * @param residency New residency, BUNDLE_RESIDENCY_AT_REST when the bundle was released from memory
+ *
+ * hal_store_bundle marks the bundle as in memory, hal_store_bundle_delete drops its residency.
+*/
+void hal_store_set_residency(struct bundle_store* store, struct bundle *bundle, enum bundle_residency residency);
+
+/**
+ * @brief hal_store_get_residency_stats retreive the residency counters of the store
+ * @param store Store to operate on (see hal_store_init)
+ * @param stats Filled with the current counters
+*/
+void hal_store_get_residency_stats(struct bundle_store* store, struct bundle_store_residency_stats* stats);
+
 /**
  * @brief hal_store_set_uint64_value store a value identified by a key
  * @param store Store to put value in
@@ -54,10 +97,42 @@ enum ud3tn_result hal_store_set_uint64_value(struct bundle_store* store, const c
 */
 uint64_t hal_store_get_uint64_value(struct bundle_store* store, const char* key, uint64_t default_value);
 
+/**
+ * @brief hal_store_set_blob_value atomically replace a binary value identified by a key
+ * @param store Store to put value in
+ * @param key key identifying value
+ * @param data Value to store
+ * @param length Length of the value in bytes
+ * @return UD3TN_FAIL if operation failed (the previous value is kept) UD3TN_OK otherwise
+*/
+enum ud3tn_result hal_store_set_blob_value(struct bundle_store* store, const char* key, const void* data, size_t length);
+
+/**
+ * @brief hal_store_append_blob_value append data to a binary value identified by a key, creating it if missing
+ * @param store Store to put value in
+ * @param key key identifying value
+ * @param data Data to append
+ * @param length Length of the data in bytes
+ * @return UD3TN_FAIL if operation failed UD3TN_OK otherwise
+*/
+enum ud3tn_result hal_store_append_blob_value(struct bundle_store* store, const char* key, const void* data, size_t length);
+
+/**
+ * @brief hal_store_map_blob_value map a binary value identified by a key into memory
+ * @param store Store to get value from
+ * @param key Key of value to map
+ * @return A copy-on-write buffer to be released via payload_buffer_put, NULL if value is missing or empty
+*/
+struct payload_buffer* hal_store_map_blob_value(struct bundle_store* store, const char* key);
+
 // TODO Doc
 struct bundle_store_loadall* hal_store_loadall(struct bundle_store* store);
 
-// TODO Doc
+/**
+ * @brief hal_store_loadall_next load the next stored bundle which is not resident
+ * @param loader Loader returned by hal_store_loadall
+ * @return The loaded bundle, marked as in memory, or NULL if all were loaded
+*/
 struct bundle* hal_store_loadall_next(struct bundle_store_loadall* loader);
 
 // TODO Doc
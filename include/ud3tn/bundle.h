@@ -3,6 +3,7 @@
 #define BUNDLE_H_INCLUDED
 
 #include "ud3tn/common.h"
+#include "ud3tn/payload.h"
 #include "ud3tn/result.h"
 
 #include <stdbool.h>  // bool
@@ -86,6 +87,8 @@ enum bundle_block_type {
 	BUNDLE_BLOCK_TYPE_PREVIOUS_NODE     = 6,
 	BUNDLE_BLOCK_TYPE_BUNDLE_AGE        = 7,
 	BUNDLE_BLOCK_TYPE_HOP_COUNT         = 10,
+	// Private use range, see ud3tn/spray_and_wait.h
+	BUNDLE_BLOCK_TYPE_SPRAY_AND_WAIT    = 192,
 	BUNDLE_BLOCK_TYPE_MAX               = 255,
 };
 
@@ -128,6 +131,8 @@ struct bundle_block {
 
 	uint32_t length;
 	uint8_t *data;
+	/* Storage of data if not a plain heap allocation, NULL otherwise */
+	struct payload_buffer *buffer;
 
 	/* RFC 5050: EID references associated to the block */
 	struct endpoint_list *eid_refs;
@@ -179,6 +184,15 @@ struct bundle {
 
 	struct bundle_block_list *blocks;
 	struct bundle_block *payload_block;
+
+	/*
+	 * Spray-and-Wait: copies this node may still spread, zero if unset
+	 * and for the copies queued for relays by the router
+	 */
+	uint32_t spray_copies;
+
+	/* Entries of contact queues referencing this bundle */
+	struct routed_bundle_list *routed_entries;
 };
 
 struct bundle_unique_identifier {
@@ -375,6 +389,8 @@ struct bundle_adu {
 	char *destination;
 	uint8_t *payload;
 	size_t length;
+	/* Storage of payload if not a plain heap allocation, NULL otherwise */
+	struct payload_buffer *payload_buffer;
 	uint64_t bundle_creation_timestamp_ms;
 	uint64_t bundle_sequence_number;
 };
@@ -440,6 +456,29 @@ struct bundle_list *bundle_list_entry_free(struct bundle_list *entry);
 struct bundle_block *bundle_block_create(enum bundle_block_type t);
 struct bundle_block_list *bundle_block_entry_create(struct bundle_block *b);
 void bundle_block_free(struct bundle_block *b);
+
+/**
+ * Allocates storage for length bytes of block data, replacing the current
+ * data of the block. Data exceeding BUNDLE_PAYLOAD_SPILL_THRESHOLD is
+ * placed in a file-backed buffer, smaller data on the heap.
+ */
+enum ud3tn_result bundle_block_alloc_data(struct bundle_block *b,
+					  size_t length);
+
+/**
+ * Replaces the data of dst by a view of length bytes of the data of src,
+ * starting at offset. No data is copied: both blocks reference the same
+ * payload buffer, which is released when the last block referencing it is
+ * freed. If src holds a plain heap allocation, it is converted into a buffer.
+ */
+enum ud3tn_result bundle_block_share_data(struct bundle_block *dst,
+					  struct bundle_block *src,
+					  size_t offset, size_t length);
+
+/**
+ * Shortens the data of the block to the given length, keeping its backing.
+ */
+void bundle_block_truncate_data(struct bundle_block *b, size_t length);
 struct bundle_block_list *bundle_block_entry_free(struct bundle_block_list *e);
 struct bundle_block *bundle_block_dup(struct bundle_block *b);
 struct bundle_block_list *bundle_block_entry_dup(struct bundle_block_list *e);
@@ -455,6 +494,47 @@ enum ud3tn_result bundle_serialize(
 	void (*write)(void *cla_obj, const void *, const size_t),
 	void *cla_obj);
 
+/*
+ * A contiguous piece of a serialized bundle, compatible in meaning (but not
+ * necessarily in layout) with the POSIX struct iovec.
+ */
+struct bundle_iovec {
+	const void *base;
+	size_t length;
+};
+
+/*
+ * Scatter-gather representation of a serialized bundle: the encoded headers
+ * are held in a small owned buffer, block data (e.g. the payload) is
+ * referenced in place. The data references stay valid as long as the bundle
+ * is not modified or freed.
+ */
+struct bundle_serialized {
+	struct bundle_iovec *iov;
+	size_t iov_count;
+	size_t iov_capacity;
+
+	uint8_t *headers;
+	size_t headers_length;
+	size_t headers_capacity;
+
+	// Sum of the lengths of all iovec entries
+	size_t length;
+};
+
+/**
+ * Serializes a bundle into a list of iovec entries without copying the block
+ * data. The result has to be released via bundle_serialized_free().
+ */
+enum ud3tn_result bundle_serialize_iov(
+	struct bundle *bundle,
+	struct bundle_serialized *result);
+
+/**
+ * Releases the resources held by a serialized bundle.
+ */
+void bundle_serialized_free(struct bundle_serialized *serialized);
+
 struct bundle_unique_identifier bundle_get_unique_identifier(
 	const struct bundle *bundle);
 void bundle_free_unique_identifier(struct bundle_unique_identifier *id);
@@ -477,6 +557,13 @@ struct bundle_adu bundle_adu_init(const struct bundle *bundle);
  */
 struct bundle_adu bundle_to_adu(struct bundle *bundle);
 
+/**
+ * Take over the payload of the ADU as a plain heap buffer to be released via
+ * free(). A file-backed payload is copied to memory. Returns NULL on failure,
+ * in which case the ADU still owns its payload.
+ */
+uint8_t *bundle_adu_take_payload(struct bundle_adu *adu);
+
 /**
  * Free the members (including EIDs and payload) of the given ADU struct.
  */
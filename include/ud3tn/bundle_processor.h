@@ -21,6 +21,13 @@ enum failed_forwarding_policy {
 #define FAILED_FORWARD_POLICY POLICY_DROP
 #endif // FAILED_FORWARD_POLICY
 
+// Maximum number of delivered bundles remembered to detect duplicates. If it
+// is exceeded, the bundles expiring first are forgotten. This also bounds the
+// time needed to recover the list from the store after a restart.
+#ifndef KNOWN_BUNDLE_LIST_MAX_LENGTH
+#define KNOWN_BUNDLE_LIST_MAX_LENGTH 4096
+#endif // KNOWN_BUNDLE_LIST_MAX_LENGTH
+
 // Interface to the bundle agent, provided to other agents and the CLA.
 struct bundle_agent_interface {
 	char *local_eid;
@@ -107,6 +114,15 @@ enum ud3tn_result bundle_processor_bundle_dispatch(
 void bundle_processor_handle_router_command(
 	void *bp_context, struct router_command *cmd);
 
+/**
+ * @brief Process the commands of a contact plan at once - only to be executed
+ *        by the config agent. Bundles affected by the plan are re-routed
+ *        after all commands have been applied.
+ * @note Only to be used by agents from the BP task (not thread safe).
+ */
+void bundle_processor_handle_router_commands(
+	void *bp_context, struct router_command *commands, size_t count);
+
 void bundle_processor_task(void *param);
 
 #endif /* BUNDLEPROCESSOR_H_INCLUDED */
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef CGR_H_INCLUDED
+#define CGR_H_INCLUDED
+
+#include "ud3tn/node.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Contact Graph Routing (CGR)
+ *
+ * The contact graph is built from the routing table. Contacts of nodes with
+ * a CLA address are transmission opportunities from the local node to that
+ * node, the reachable EIDs of the node and of the contact are assumed to be
+ * delivered by it (as done by the legacy router). Nodes without a CLA
+ * address describe contacts between other nodes: each of their contacts is
+ * a transmission opportunity towards the node from every node listed as
+ * reachable EID of the node or the contact.
+ *
+ * Routes are determined by an earliest-arrival search over the contacts.
+ * Alternative routes are found by suppressing the first hop of the previous
+ * routes, thus, every route offers a different first-hop contact. The
+ * results are cached per destination node. When the routing table changes,
+ * only routes using a removed or modified contact are dropped, and routes
+ * that could be improved by a new contact, i.e., routes arriving after it
+ * starts.
+ */
+
+// Maximum number of routes, i.e., different first hops, per destination.
+#ifndef CGR_MAX_ROUTES
+#define CGR_MAX_ROUTES 3
+#endif // CGR_MAX_ROUTES
+
+// Maximum number of destinations for which routes are cached.
+#ifndef CGR_ROUTE_CACHE_SIZE
+#define CGR_ROUTE_CACHE_SIZE 1024
+#endif // CGR_ROUTE_CACHE_SIZE
+
+/**
+ * Returns the first-hop contacts of the routes towards the given destination
+ * that arrive before the provided time, ordered by arrival time. The list
+ * has to be freed by the caller, the contacts belong to the routing table.
+ */
+struct contact_list *cgr_lookup_first_hops(
+	const char *destination, uint64_t deadline_ms);
+
+/**
+ * Releases the contact graph and all cached routes.
+ */
+void cgr_free(void);
+
+#endif // CGR_H_INCLUDED
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef CONTACT_INDEX_H_INCLUDED
+#define CONTACT_INDEX_H_INCLUDED
+
+#include "ud3tn/node.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Ordered index over a contact_list, sorted ascending by the start or the
+ * end time of the contacts.
+ *
+ * The index is a skip list of which the lowest level is the contact_list
+ * itself, so that the list can still be traversed as before by all users.
+ * Every list entry is additionally linked into up to
+ * CONTACT_INDEX_MAX_LEVEL "express lanes" with a probability of 1/4 per
+ * level. Insertion, removal and the search for the first contact at or
+ * after a given time take O(log n) expected time instead of a linear walk.
+ *
+ * Contacts with equal times are ordered by their creation (see the
+ * sequence_number of struct contact), so that adding and removing them does
+ * not require to walk all contacts with the same time. The time of an
+ * indexed contact must not be changed; if this happens anyway, the contact
+ * is still found on removal, at the cost of a linear search.
+ */
+
+#ifndef CONTACT_INDEX_MAX_LEVEL
+#define CONTACT_INDEX_MAX_LEVEL 12
+#endif // CONTACT_INDEX_MAX_LEVEL
+
+struct contact_index_lane;
+
+struct contact_index {
+	// Head of the indexed list, i.e., the lowest level
+	struct contact_list **list;
+	struct contact_index_lane *head[CONTACT_INDEX_MAX_LEVEL];
+	uint8_t level;
+	bool order_by_from;
+};
+
+/**
+ * Initializes the index for the given (empty) list.
+ */
+void contact_index_init(struct contact_index *index,
+			struct contact_list **list, bool order_by_from);
+
+/**
+ * Releases the list entries and lanes still contained in the index, which
+ * is left empty. The contacts themselves are not freed.
+ */
+void contact_index_free(struct contact_index *index);
+
+/**
+ * Adds the contact to the list.
+ *
+ * @return false if the contact is already contained in the list with the
+ *	   same time or memory could not be allocated, true otherwise
+ */
+bool contact_index_add(struct contact_index *index, struct contact *contact);
+
+/**
+ * Removes the contact from the list.
+ *
+ * @return false if the contact is not contained in the list
+ */
+bool contact_index_remove(struct contact_index *index,
+			  struct contact *contact);
+
+/**
+ * Returns the first list entry of which the indexed time is at or after
+ * the given time, or NULL. The entries following it can be traversed via
+ * the list.
+ */
+struct contact_list *contact_index_find_first(
+	const struct contact_index *index, uint64_t time_ms);
+
+#endif // CONTACT_INDEX_H_INCLUDED
@@ -5,14 +5,30 @@
 #include "ud3tn/common.h"
 #include "ud3tn/node.h"
 
+#include "platform/hal_store.h"
 #include "platform/hal_types.h"
 
 #include <stdint.h>
 
-// Maximum number of concurrent contacts that can be handled by CM.
-#ifndef MAX_CONCURRENT_CONTACTS
-#define MAX_CONCURRENT_CONTACTS 10
-#endif // MAX_CONCURRENT_CONTACTS
+// Maximum number of bundles handed over to a CLA per TX command, 0 = all.
+// Bounding the batch size releases the routing table more often and lets
+// the contacts take turns when large numbers of bundles are queued.
+#ifndef CONTACT_BUNDLE_HANDOVER_BATCH
+#define CONTACT_BUNDLE_HANDOVER_BATCH 0
+#endif // CONTACT_BUNDLE_HANDOVER_BATCH
+
+// Time before the start of a contact at which the stored bundles are loaded
+// and routed, so that they are queued for the contact when it starts.
+// 0 = load them when the contact starts, as always with Spray-and-Wait.
+#ifndef CONTACT_PRESTAGE_LEAD_TIME_MS
+#define CONTACT_PRESTAGE_LEAD_TIME_MS 30000
+#endif // CONTACT_PRESTAGE_LEAD_TIME_MS
+
+// Whether the payloads of bundles queued for a contact starting within the
+// lead time are read ahead from the store.
+#ifndef CONTACT_PRESTAGE_READ_AHEAD
+#define CONTACT_PRESTAGE_READ_AHEAD 0
+#endif // CONTACT_PRESTAGE_READ_AHEAD
 
 struct contact_manager_params {
 	enum ud3tn_result task_creation_result;
@@ -29,10 +45,10 @@ enum contact_manager_signal {
 };
 
 struct contact_manager_params contact_manager_start(
-	QueueIdentifier_t bp_queue,
-	struct contact_list **clistptr
+	QueueIdentifier_t bp_queue
 	#ifdef ARCHIPEL_CORE
 	,QueueIdentifier_t bundle_restore_queue
+	,struct bundle_store *bundle_store
 	#endif
 );
 
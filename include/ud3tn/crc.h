@@ -14,8 +14,26 @@ enum crc_version {
 	CRC32,
 };
 
+/**
+ * Kernels used for processing larger amounts of data at once, i.e. by the
+ * one-shot functions below and by crc_feed_bytes(). The best supported
+ * implementation is selected automatically at runtime. The result is always
+ * identical to the byte-wise table lookup used by the "feed" callback.
+ */
+enum crc_implementation {
+	// One 256-entry table lookup per byte
+	CRC_IMPLEMENTATION_BYTEWISE,
+	// Eight table lookups per eight bytes ("slicing-by-8")
+	CRC_IMPLEMENTATION_SLICE_BY_8,
+	// CRC-32-C instructions (x86 SSE 4.2 / ARMv8 CRC extension), falls
+	// back to slicing-by-8 for the CRC-16 variants
+	CRC_IMPLEMENTATION_HARDWARE,
+};
+
 struct crc_stream {
 	void (*feed)(struct crc_stream *crc, uint8_t byte);
+	void (*feed_bytes)(struct crc_stream *crc, const uint8_t *data,
+			   size_t len);
 	void (*feed_eof)(struct crc_stream *crc);
 	union {
 		uint32_t checksum;
@@ -77,5 +95,23 @@ void crc_init(struct crc_stream *crc, enum crc_version version);
 
 void crc_feed_bytes(struct crc_stream *crc, const uint8_t *data, size_t len);
 
+/**
+ * @brief Returns whether the CPU provides CRC-32-C instructions
+ */
+bool crc_hardware_available(void);
+
+/**
+ * @brief Returns the implementation currently used for bulk computation
+ */
+enum crc_implementation crc_get_implementation(void);
+
+/**
+ * @brief Overrides the automatically selected implementation, e.g. for
+ *        testing or benchmarking purposes
+ *
+ * @return false if the implementation is not supported on this CPU
+ */
+bool crc_set_implementation(enum crc_implementation implementation);
+
 
 #endif /* CRC_H_INCLUDED */
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef HASHMAP_H_INCLUDED
+#define HASHMAP_H_INCLUDED
+
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Open-addressing hash table mapping strings (e.g. EIDs) to pointers.
+ *
+ * Collisions are resolved by linear probing with Robin Hood ordering, so
+ * that a lookup can stop as soon as it reaches an entry closer to its home
+ * slot than the key searched for. The full 32-bit hash is stored in every
+ * slot: probing compares hashes and only calls strcmp() on a match, without
+ * touching the key memory of other entries. Entries are deleted by shifting
+ * the following entries of the cluster back, thus, no tombstones are left
+ * behind and lookup performance does not degrade over time.
+ *
+ * The table doubles its capacity when it is 7/8 full. To avoid a latency
+ * spike, the entries are not rehashed all at once: while a resize is in
+ * progress, every insertion and removal moves a few slots of the previous
+ * table to the new one, and lookups consult both tables.
+ */
+
+struct hashmap_slot {
+	// Zero marks an empty slot, zero hashes are mapped to one
+	uint32_t hash;
+	char *key;
+	void *value;
+};
+
+struct hashmap {
+	struct hashmap_slot *slots;
+	size_t capacity;
+	size_t count;
+
+	// Previous table, non-NULL while entries are being migrated
+	struct hashmap_slot *old_slots;
+	size_t old_capacity;
+	size_t migrate_pos;
+	size_t migrate_remaining;
+};
+
+/**
+ * Initializes an empty hash map. Storage for at least the given number of
+ * entries is allocated on the first insertion.
+ */
+void hashmap_init(struct hashmap *map, size_t expected_count);
+
+/**
+ * Releases all storage of the map, the values are not freed.
+ */
+void hashmap_deinit(struct hashmap *map);
+
+/**
+ * Adds a copy of the key with the given value to the map.
+ *
+ * @return UD3TN_FAIL if the key is already present or memory could not be
+ *	   allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result hashmap_put(struct hashmap *map, const char *key,
+			      void *value);
+
+/**
+ * Returns the value for the given key, or NULL if it is not present.
+ */
+void *hashmap_get(const struct hashmap *map, const char *key);
+
+/**
+ * Removes the key from the map and returns its value, NULL if not present.
+ */
+void *hashmap_remove(struct hashmap *map, const char *key);
+
+static inline size_t hashmap_count(const struct hashmap *map)
+{
+	return map->count;
+}
+
+#endif // HASHMAP_H_INCLUDED
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef KNOWN_BUNDLE_JOURNAL_H_INCLUDED
+#define KNOWN_BUNDLE_JOURNAL_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Journal of the bundles known to the bundle processor, i.e., of the bundles
+ * already delivered and of the fragments awaiting reassembly, which allows to
+ * recognize them after a restart.
+ *
+ * The journal is a sequence of self-contained records which are appended to
+ * the value in the bundle store. All integers are stored in little-endian
+ * byte order:
+ *
+ *   record: u8 type, u8 protocol version, u16 source length, source,
+ *           u64 creation timestamp (ms), u64 sequence number,
+ *           u32 fragment offset, u32 payload length, u64 deadline (ms),
+ *           u32 CRC-32 of everything before in the record
+ *
+ * A record which is truncated or does not match its checksum, e.g. as the
+ * node was stopped while appending it, ends the journal. The journal is
+ * rewritten from time to time with only the entries not expired, see
+ * KNOWN_BUNDLE_JOURNAL_MIN_COMPACTION.
+ */
+
+// Key of the journal in the bundle store
+#define KNOWN_BUNDLE_JOURNAL_KEY "known_bundles"
+
+// Number of records which may be appended to the journal in addition to
+// the live entries before it is rewritten. The journal is rewritten as soon
+// as it contains more than twice the records left by the last rewrite plus
+// this number.
+#ifndef KNOWN_BUNDLE_JOURNAL_MIN_COMPACTION
+#define KNOWN_BUNDLE_JOURNAL_MIN_COMPACTION 256
+#endif // KNOWN_BUNDLE_JOURNAL_MIN_COMPACTION
+
+enum known_bundle_journal_type {
+	// The bundle has been delivered (or reassembled, in which case the
+	// identifier refers to the whole ADU)
+	KNOWN_BUNDLE_JOURNAL_DELIVERED = 1,
+	// The fragment is kept in the store until it can be reassembled
+	KNOWN_BUNDLE_JOURNAL_FRAGMENT = 2,
+};
+
+struct known_bundle_journal_record {
+	enum known_bundle_journal_type type;
+	struct bundle_unique_identifier id;
+	uint64_t deadline_ms;
+};
+
+/**
+ * Serializes the record into the given buffer.
+ *
+ * @param buffer The buffer to write to, or NULL to only determine the length
+ * @return the length of the serialized record in bytes
+ */
+size_t known_bundle_journal_encode(
+	const struct known_bundle_journal_record *record, uint8_t *buffer);
+
+/**
+ * Parses the first record from the given buffer. On success, the source EID
+ * of the identifier is newly allocated and has to be released via
+ * bundle_free_unique_identifier().
+ *
+ * @return the number of bytes consumed, 0 if the buffer does not start with
+ *	   a complete and valid record
+ */
+size_t known_bundle_journal_decode(
+	const uint8_t *buffer, size_t length,
+	struct known_bundle_journal_record *record);
+
+#endif // KNOWN_BUNDLE_JOURNAL_H_INCLUDED
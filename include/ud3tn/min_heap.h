@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef MIN_HEAP_H_INCLUDED
+#define MIN_HEAP_H_INCLUDED
+
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary min-heap of pointers ordered by a 64-bit key, e.g. the time of an
+ * event. Insertion, removal of arbitrary entries and changes of the key
+ * take O(log n) time.
+ *
+ * To remove or update an entry, its position in the heap has to be known.
+ * If a callback is provided, it is invoked whenever an entry is moved, so
+ * that the position can be recorded in the referenced object. Removed
+ * entries are reported with MIN_HEAP_NO_INDEX.
+ */
+
+#define MIN_HEAP_NO_INDEX SIZE_MAX
+
+typedef void (*min_heap_index_func_t)(void *data, size_t index);
+
+struct min_heap_entry {
+	uint64_t key;
+	void *data;
+};
+
+struct min_heap {
+	struct min_heap_entry *entries;
+	size_t count;
+	size_t capacity;
+	min_heap_index_func_t set_index;
+};
+
+/**
+ * Initializes an empty heap, set_index may be NULL.
+ */
+void min_heap_init(struct min_heap *heap, min_heap_index_func_t set_index);
+
+/**
+ * Releases the storage of the heap, the referenced objects are not freed.
+ */
+void min_heap_free(struct min_heap *heap);
+
+/**
+ * Adds an entry to the heap.
+ *
+ * @return UD3TN_FAIL if memory could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result min_heap_push(struct min_heap *heap, uint64_t key,
+				void *data);
+
+/**
+ * Removes the entry at the given position and returns its data.
+ */
+void *min_heap_remove(struct min_heap *heap, size_t index);
+
+/**
+ * Changes the key of the entry at the given position.
+ */
+void min_heap_update(struct min_heap *heap, size_t index, uint64_t key);
+
+typedef void (*min_heap_visit_func_t)(void *data, void *context);
+
+/**
+ * Invokes the callback for every entry with a key of at most max_key, in no
+ * particular order, taking time proportional to the number of these entries.
+ * The heap must not be modified by the callback.
+ *
+ * @return the smallest key greater than max_key, or UINT64_MAX if there is
+ *	   no such entry
+ */
+uint64_t min_heap_visit(const struct min_heap *heap, uint64_t max_key,
+			min_heap_visit_func_t func, void *context);
+
+/**
+ * Returns the entry with the smallest key, or NULL if the heap is empty.
+ */
+static inline const struct min_heap_entry *min_heap_peek(
+	const struct min_heap *heap)
+{
+	return heap->count != 0 ? &heap->entries[0] : NULL;
+}
+
+static inline void *min_heap_pop(struct min_heap *heap)
+{
+	return heap->count != 0 ? min_heap_remove(heap, 0) : NULL;
+}
+
+#endif // MIN_HEAP_H_INCLUDED
@@ -3,15 +3,12 @@
 #define NODE_H_INCLUDED
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/min_heap.h"
 #include "ud3tn/result.h"
+#include "ud3tn/routed_bundle_queue.h"
 
 #include <stdint.h>
 
-struct routed_bundle_list {
-	struct bundle *data;
-	struct routed_bundle_list *next;
-};
-
 struct contact {
 	struct node *node;
 	uint64_t from_ms;
@@ -22,8 +19,14 @@ struct contact {
 	int32_t remaining_capacity_p1;
 	int32_t remaining_capacity_p2;
 	struct endpoint_list *contact_endpoints;
-	struct routed_bundle_list *contact_bundles;
+	struct routed_bundle_queue contact_bundles;
 	int8_t active;
+	// Whether the stored bundles have been loaded ahead of the start
+	int8_t prestaged;
+	// Position in the heap of upcoming contacts of the routing table
+	size_t upcoming_index;
+	// Order of creation, orders contacts with equal times in an index
+	uint64_t sequence_number;
 };
 
 struct contact_list {
@@ -47,6 +50,7 @@ struct node {
 struct node_list {
 	struct node *node;
 	struct node_list *next;
+	struct node_list *prev;
 };
 
 #define CONTACT_CAPACITY(contact, p) ({ \
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef PAYLOAD_H_INCLUDED
+#define PAYLOAD_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BUNDLE_PAYLOAD_SPILL_THRESHOLD
+// Block data of at least this size (in bytes) is placed in a file-backed
+// spill buffer instead of the heap. Set to 0 to keep everything in memory.
+#define BUNDLE_PAYLOAD_SPILL_THRESHOLD (1024 * 1024)
+#endif // BUNDLE_PAYLOAD_SPILL_THRESHOLD
+
+enum payload_backing {
+	PAYLOAD_BACKING_MEMORY,
+	PAYLOAD_BACKING_FILE,
+	PAYLOAD_BACKING_MAPPED_FILE,
+};
+
+/*
+ * Storage backing the data of a bundle block or ADU. The data pointer is
+ * always directly addressable, independent of the backing; for file-backed
+ * buffers it points to a mapping of the spill file so that readers can
+ * stream from it without knowing where the bytes live.
+ *
+ * Buffers are reference counted: a block or ADU may borrow a view into a
+ * larger buffer (e.g. a whole serialized bundle) by holding a reference to
+ * it. The storage is released when the last reference is dropped.
+ */
+struct payload_buffer {
+	enum payload_backing backing;
+	uint8_t *data;
+	size_t length;
+	unsigned int ref_count;
+};
+
+/**
+ * Returns whether data of the given length is placed in a file-backed buffer.
+ */
+static inline bool payload_should_spill(const size_t length)
+{
+	return (
+		BUNDLE_PAYLOAD_SPILL_THRESHOLD != 0 &&
+		length >= BUNDLE_PAYLOAD_SPILL_THRESHOLD
+	);
+}
+
+/**
+ * Allocates a new payload buffer of the given length. The backing is chosen
+ * based on BUNDLE_PAYLOAD_SPILL_THRESHOLD. Returns NULL on failure.
+ */
+struct payload_buffer *payload_buffer_create(size_t length);
+
+/**
+ * Takes ownership of the given heap allocation (obtained via malloc) and
+ * wraps it into a payload buffer. On failure, the data is NOT freed.
+ */
+struct payload_buffer *payload_buffer_wrap(uint8_t *data, size_t length);
+
+/**
+ * Maps the file at the given path into a copy-on-write payload buffer.
+ * Modifications of the data are never written back to the file.
+ * Returns NULL if the file cannot be mapped (e.g. if it is empty).
+ */
+struct payload_buffer *payload_buffer_map_file(const char *path);
+
+/**
+ * Starts loading the given range of the data of a file-backed buffer into
+ * memory in the background, e.g. ahead of sending it. Has no effect for
+ * buffers held in memory.
+ */
+void payload_buffer_prefetch(const struct payload_buffer *buffer,
+			     const uint8_t *data, size_t length);
+
+/**
+ * Obtains an additional reference to the buffer and returns it.
+ */
+struct payload_buffer *payload_buffer_get(struct payload_buffer *buffer);
+
+/**
+ * Drops a reference to the buffer. The buffer and the storage backing it
+ * are released when the last reference is dropped.
+ */
+void payload_buffer_put(struct payload_buffer *buffer);
+
+#endif // PAYLOAD_H_INCLUDED
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef PROPHET_H_INCLUDED
+#define PROPHET_H_INCLUDED
+
+#include "ud3tn/hashmap.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Delivery predictabilities of the Probabilistic Routing Protocol using
+ * History of Encounters and Transitivity (PRoPHET, RFC 6693).
+ *
+ * Every node maintains the probability P(A, B) in [0, 1] that it is able to
+ * deliver a bundle to a node B. The probability is increased whenever B is
+ * encountered, decays over time (aging) and is derived transitively from the
+ * predictabilities of encountered nodes: if A frequently meets B and B
+ * frequently meets C, A is a good carrier for bundles to C.
+ *
+ * Node EIDs are mapped to small integers ("atoms") once, so that the tables
+ * are compact arrays indexed by atom instead of maps keyed by EID strings.
+ * The atoms are local to a node, serialized tables contain the EIDs. An atom
+ * is released as soon as no table has a predictability for it anymore, e.g.
+ * as it decayed to zero, and may then be assigned to another EID.
+ */
+
+// Predictability set on an encounter of a node not encountered recently.
+#ifndef PROPHET_P_ENCOUNTER
+#define PROPHET_P_ENCOUNTER 0.75f
+#endif // PROPHET_P_ENCOUNTER
+
+// Scaling of predictabilities derived via transitivity.
+#ifndef PROPHET_BETA
+#define PROPHET_BETA 0.25f
+#endif // PROPHET_BETA
+
+// Factor by which all predictabilities decay per aging time unit.
+#ifndef PROPHET_GAMMA
+#define PROPHET_GAMMA 0.98f
+#endif // PROPHET_GAMMA
+
+// Length of the aging time unit.
+#ifndef PROPHET_AGING_UNIT_MS
+#define PROPHET_AGING_UNIT_MS 30000
+#endif // PROPHET_AGING_UNIT_MS
+
+// Predictabilities below this threshold are considered zero and not sent.
+#ifndef PROPHET_P_MIN
+#define PROPHET_P_MIN 0.001f
+#endif // PROPHET_P_MIN
+
+// Minimum predictability of an EID unknown locally for being taken over from a
+// received table. By default, it could not be derived via transitivity.
+#ifndef PROPHET_P_INTERN
+#define PROPHET_P_INTERN (PROPHET_P_MIN / PROPHET_BETA)
+#endif // PROPHET_P_INTERN
+
+// Maximum size of a received predictability table, larger ones are rejected.
+#ifndef PROPHET_TABLE_MAX_SIZE
+#define PROPHET_TABLE_MAX_SIZE (1 << 20)
+#endif // PROPHET_TABLE_MAX_SIZE
+
+struct prophet_atoms {
+	/* Node EID -> atom + 1 */
+	struct hashmap map;
+	// Node EID by atom, NULL for released atoms
+	char **eids;
+	// Number of non-zero predictabilities in all tables by atom
+	uint32_t *refs;
+	// Released atoms to be assigned again
+	uint32_t *unused;
+	uint32_t unused_count;
+	uint32_t count;
+	uint32_t capacity;
+};
+
+struct prophet_table {
+	// Predictability by atom, atoms beyond the size have predictability 0
+	float *p;
+	uint32_t size;
+	// Time up to which the predictabilities have been aged
+	uint64_t aged_ms;
+	// Atoms the table refers to
+	struct prophet_atoms *atoms;
+};
+
+void prophet_atoms_init(struct prophet_atoms *atoms);
+void prophet_atoms_free(struct prophet_atoms *atoms);
+
+/**
+ * Returns the atom of the given node EID, a new atom is assigned if it has
+ * not been seen before and create is true. A new atom is kept until a table
+ * has had a predictability for it, which the caller has to ensure.
+ *
+ * @return the atom, or -1 if it is unknown or could not be allocated
+ */
+int32_t prophet_atom_get(struct prophet_atoms *atoms, const char *node_eid,
+			 bool create);
+
+void prophet_table_init(struct prophet_table *table,
+			struct prophet_atoms *atoms, uint64_t time_ms);
+void prophet_table_free(struct prophet_table *table);
+
+static inline float prophet_table_get(const struct prophet_table *table,
+				      int32_t atom)
+{
+	if (atom < 0 || (uint32_t)atom >= table->size)
+		return 0.0f;
+	return table->p[atom];
+}
+
+/**
+ * Decays all predictabilities by gamma for every aging time unit passed.
+ * Atoms whose predictabilities all dropped below PROPHET_P_MIN are released.
+ */
+void prophet_table_age(struct prophet_table *table, uint64_t time_ms);
+
+/**
+ * Updates the predictability for the encountered node:
+ * P = P_old + (1 - P_old) * P_encounter
+ */
+enum ud3tn_result prophet_table_encounter(struct prophet_table *table,
+					  int32_t atom);
+
+/**
+ * Updates the predictabilities for all nodes of the table of the encountered
+ * node: P(A, C) = max(P_old(A, C), P(A, B) * P(B, C) * beta)
+ */
+enum ud3tn_result prophet_table_transitive(
+	struct prophet_table *table, int32_t atom,
+	const struct prophet_table *peer_table);
+
+/**
+ * Returns the serialized table, which has to be freed by the caller, or NULL
+ * if memory could not be allocated.
+ */
+uint8_t *prophet_table_serialize(const struct prophet_table *table,
+				 const struct prophet_atoms *atoms,
+				 size_t *length);
+
+/**
+ * Initializes the table from its serialized form. New atoms are only
+ * assigned to unknown node EIDs with a predictability of at least
+ * PROPHET_P_INTERN, the other ones are skipped.
+ *
+ * @return UD3TN_FAIL if the data is malformed or too large, UD3TN_OK
+ *	   otherwise
+ */
+enum ud3tn_result prophet_table_parse(struct prophet_table *table,
+				      struct prophet_atoms *atoms,
+				      const uint8_t *data, size_t length,
+				      uint64_t time_ms);
+
+#endif // PROPHET_H_INCLUDED
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef ROUTED_BUNDLE_QUEUE_H_INCLUDED
+#define ROUTED_BUNDLE_QUEUE_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+// Whether bundles of the same priority are handed over in the order of their
+// expiration time (instead of the order they were routed in).
+#define CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY 0
+#endif // CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+
+struct routed_bundle_queue;
+
+/*
+ * An entry of a routed_bundle_queue. Entries are linked into the queue of a
+ * contact (via next/prev) and into the list of all entries referencing the
+ * same bundle (via next_for_bundle, starting at bundle->routed_entries). The
+ * latter allows to remove a bundle from a queue in constant time; a bundle is
+ * usually queued for a single contact, with the epidemic router for a few.
+ *
+ * Lists handed over to a CLA via routed_bundle_queue_take() are detached from
+ * their bundles and only linked via next, in which case the receiver is
+ * responsible for releasing each entry via free().
+ */
+struct routed_bundle_list {
+	struct bundle *data;
+	struct routed_bundle_list *next;
+	struct routed_bundle_list *prev;
+	struct routed_bundle_list *next_for_bundle;
+	struct routed_bundle_queue *queue;
+	uint64_t expiration_ms;
+	enum bundle_routing_priority prio;
+};
+
+/*
+ * FIFO of bundles waiting for a contact, partitioned by routing priority.
+ * Bundles of higher priority are always handed over first.
+ *
+ * The queue is not synchronized: all operations have to be performed while
+ * holding the routing table semaphore.
+ */
+struct routed_bundle_queue {
+	struct routed_bundle_list *head[BUNDLE_RPRIO_MAX];
+	struct routed_bundle_list *tail[BUNDLE_RPRIO_MAX];
+	size_t length;
+};
+
+void routed_bundle_queue_init(struct routed_bundle_queue *queue);
+
+static inline bool routed_bundle_queue_empty(
+	const struct routed_bundle_queue *queue)
+{
+	return queue->length == 0;
+}
+
+/**
+ * Appends the bundle to the queue of its priority.
+ *
+ * @return UD3TN_FAIL if the bundle is already part of the queue or memory
+ *	   could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result routed_bundle_queue_push(struct routed_bundle_queue *queue,
+					   struct bundle *bundle);
+
+/**
+ * Removes the bundle from the queue in constant time.
+ *
+ * @return UD3TN_FAIL if the bundle is not part of the queue
+ */
+enum ud3tn_result routed_bundle_queue_remove(struct routed_bundle_queue *queue,
+					     struct bundle *bundle);
+
+/**
+ * Returns the next bundle to be handed over, without removing it.
+ */
+struct bundle *routed_bundle_queue_first(
+	const struct routed_bundle_queue *queue);
+
+/**
+ * Removes and returns the next bundle to be handed over, NULL if empty.
+ */
+struct bundle *routed_bundle_queue_pop(struct routed_bundle_queue *queue);
+
+/**
+ * Detaches up to max_count bundles (all if zero) from the head of the queue,
+ * highest priority first, and returns them as a list linked via next. The
+ * caller takes ownership of the returned entries.
+ */
+struct routed_bundle_list *routed_bundle_queue_take(
+	struct routed_bundle_queue *queue, size_t max_count);
+
+/**
+ * Removes all entries from the queue, the bundles themselves are not freed.
+ */
+void routed_bundle_queue_clear(struct routed_bundle_queue *queue);
+
+#endif // ROUTED_BUNDLE_QUEUE_H_INCLUDED
@@ -15,11 +15,17 @@
 
 #ifndef ROUTING_LEGACY
 #ifndef ROUTING_EPIDEMIC
+#ifndef ROUTING_CGR
+#ifndef ROUTING_PROPHET
+#ifndef ROUTING_SPRAY_AND_WAIT
 // By default switch to legacy routing
-#warning Archipel is building with legacy routing algorithm because no explicit routing algorithm was defined. Define ROUTING_LEGACY or ROUTING_EPIDEMIC to remove this warning
+#warning Archipel is building with legacy routing algorithm because no explicit routing algorithm was defined. Define ROUTING_LEGACY, ROUTING_EPIDEMIC, ROUTING_CGR, ROUTING_PROPHET or ROUTING_SPRAY_AND_WAIT to remove this warning
 #define ROUTING_LEGACY
 #endif
 #endif
+#endif
+#endif
+#endif
 
 // Maximum number of fragments created by the router.
 #ifndef ROUTER_MAX_FRAGMENTS
@@ -41,6 +47,11 @@
 #define ROUTER_MIN_CONTACTS_HTAB 10
 #endif // ROUTER_MIN_CONTACTS_HTAB
 
+// Maximum number of destinations for which the contacts are cached.
+#ifndef ROUTER_ROUTE_CACHE_SIZE
+#define ROUTER_ROUTE_CACHE_SIZE 256
+#endif // ROUTER_ROUTE_CACHE_SIZE
+
 struct router_config {
 	size_t global_mbs;
 	uint16_t fragment_min_payload;
@@ -69,6 +80,14 @@ struct router_config router_get_config(void);
 void router_update_config(struct router_config config);
 
 struct contact_list *router_lookup_destination(char *dest);
+/**
+ * Returns the contacts via which the destination is reachable, ordered by
+ * their end time, as router_lookup_destination() does. The result is cached
+ * per destination until the routing table is modified, it is owned by the
+ * cache and must not be freed or used after modifying the routing table.
+ */
+struct contact_list *router_lookup_destination_cached(const char *dest);
+void router_route_cache_free(void);
 uint8_t router_calculate_fragment_route(
 	struct fragment_route *res, uint32_t size,
 	struct contact_list *contacts, uint32_t preprocessed_size,
@@ -110,12 +129,116 @@ enum router_result_status {
 	ROUTER_RESULT_NO_TIMELY_CONTACTS,
 	ROUTER_RESULT_NO_MEMORY,
 	ROUTER_RESULT_EXPIRED,
+	// Only copies of the bundle created by the router have been queued,
+	// the bundle itself may be released to the store.
+	ROUTER_RESULT_COPIED,
 };
 
 enum ud3tn_result router_process_command(
 	struct router_command *command,
 	struct rescheduling_handle rescheduler);
+/**
+ * Processes the commands of a contact plan as one transaction: if one of the
+ * nodes is invalid or a command would fail on the routing table, e.g. as it
+ * refers to an unknown node, the plan is rejected without modifying the
+ * routing table. Only if memory cannot be allocated, the plan may be applied
+ * partially. The nodes are taken over, only the array has to be freed.
+ */
+enum ud3tn_result router_process_commands(
+	struct router_command *commands, size_t count,
+	struct rescheduling_handle rescheduler);
 enum router_result_status router_route_bundle(
 	struct bundle *b);
 
+/**
+ * Routes a batch of bundles, e.g. the bundles queued for a contact which has
+ * ended. The bundles are grouped by destination, so that the route of a
+ * destination is determined once and reused as long as its contacts have
+ * capacity left. The result for bundles[i] is stored in results[i].
+ */
+void router_route_bundles(struct bundle **bundles, size_t count,
+			  enum router_result_status *results);
+
+#ifdef ROUTING_EPIDEMIC
+
+/* Epidemic anti-entropy, see ud3tn/summary_vector.h */
+
+struct router_epidemic_stats {
+	uint64_t summaries_received;
+	// Bundles not queued for a peer as it already knows them, counted
+	// once per bundle and peer
+	uint64_t bundles_suppressed;
+	uint64_t bytes_saved;
+	// Fragments queued for contacts too short for the whole bundle
+	uint64_t fragments_queued;
+};
+
+/**
+ * Records the bundle as known to this node, i.e., as not to be sent to this
+ * node by peers.
+ */
+void router_epidemic_record_known(const struct bundle *b);
+
+/**
+ * Returns the serialized summary vector of the known bundles, which has to
+ * be freed by the caller.
+ */
+uint8_t *router_epidemic_create_summary(size_t *length);
+
+/**
+ * Stores the summary vector received from the given node. Bundles known by
+ * the node are not routed to it anymore.
+ */
+enum ud3tn_result router_epidemic_summary_received(
+	const char *node_eid, const uint8_t *data, size_t length);
+
+struct router_epidemic_stats router_epidemic_get_stats(void);
+
+#endif // ROUTING_EPIDEMIC
+
+#ifdef ROUTING_PROPHET
+
+/* Probabilistic routing, see ud3tn/prophet.h */
+
+struct router_prophet_stats {
+	uint64_t tables_received;
+	// Bundles queued for a peer being a better carrier or the destination
+	uint64_t bundles_forwarded;
+	// Bundles not queued for a peer being a worse carrier
+	uint64_t bundles_withheld;
+};
+
+/**
+ * Returns the serialized table of the delivery predictabilities of this
+ * node, which has to be freed by the caller.
+ */
+uint8_t *router_prophet_create_table(size_t *length);
+
+/**
+ * Handles the encounter of the given node, whose delivery predictabilities
+ * have been received. Bundles are routed to the node if its predictability
+ * for their destination is higher than the local one.
+ */
+enum ud3tn_result router_prophet_table_received(
+	const char *node_eid, const uint8_t *data, size_t length);
+
+struct router_prophet_stats router_prophet_get_stats(void);
+
+#endif // ROUTING_PROPHET
+
+#ifdef ROUTING_SPRAY_AND_WAIT
+
+/* Binary Spray-and-Wait, see ud3tn/spray_and_wait.h */
+
+struct router_spray_and_wait_stats {
+	// Copies handed over to relays which have not been taken back
+	uint64_t copies_handed_over;
+	// Bundles not queued for a relay as only a single copy is left
+	uint64_t bundles_withheld;
+};
+
+struct router_spray_and_wait_stats router_spray_and_wait_get_stats(void);
+
+#endif // ROUTING_SPRAY_AND_WAIT
+
 #endif /* ROUTER_H_INCLUDED */
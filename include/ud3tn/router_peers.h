@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef ROUTER_PEERS_H_INCLUDED
+#define ROUTER_PEERS_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/node.h"
+#include "ud3tn/router.h"
+#include "ud3tn/summary_vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * State of the routers deciding per bundle and neighbor (epidemic, PRoPHET
+ * and Spray-and-Wait) about the nodes they are in contact with ("peers").
+ *
+ * For every peer, the bundles queued for it are recorded, so that they are
+ * not queued again, along with the state specific to the router. Bundles
+ * queued for a peer but not sent to it, e.g. as the contact ended before or
+ * the transmission failed, are passed back to the router, which allows to
+ * route them to the peer again.
+ *
+ * A router may queue copies of a bundle created for a single peer instead of
+ * the bundle itself (see router_peer_ops.owns). These copies are released
+ * by the caller when they have been sent or removed from the queue, without
+ * any operation on the store, which only holds the original.
+ *
+ * The state of a peer is dropped when no bundle queued for it is pending
+ * anymore and it has not been in contact for ROUTER_PEER_TIMEOUT_MS.
+ */
+
+#if defined(ROUTING_EPIDEMIC) || defined(ROUTING_PROPHET) || \
+	defined(ROUTING_SPRAY_AND_WAIT)
+#define ROUTER_PEERS
+#endif
+
+// Time after the last contact of a peer after which its state may be dropped.
+#ifndef ROUTER_PEER_TIMEOUT_MS
+#define ROUTER_PEER_TIMEOUT_MS 3600000
+#endif // ROUTER_PEER_TIMEOUT_MS
+
+struct router_peer {
+	char *node_eid;
+	// Digests of the bundles queued for the peer, see
+	// summary_vector_digest()
+	struct digest_set sent;
+	// State specific to the router, see struct router_peer_ops
+	void *state;
+	// Time at which the peer has been in contact last
+	uint64_t last_contact_ms;
+	struct router_peer *next;
+};
+
+struct router_peer_ops {
+	// Creates the state of a newly encountered peer, may be NULL.
+	void *(*create_state)(void);
+	// Releases the state of the peer, may be NULL.
+	void (*free_state)(void *state);
+	// Called for a bundle queued for the peer which has not been sent to
+	// it, possibly again for a bundle passed back already. If NULL, the
+	// bundle is only removed from the sent set.
+	void (*unsent)(struct router_peer *peer, struct bundle *bundle);
+	// Returns whether the bundle is a copy created by the router, may be
+	// NULL if the router only queues the bundles passed to it.
+	bool (*owns)(const struct bundle *bundle);
+};
+
+/**
+ * Initializes the peer state with the operations of the router. Has to be
+ * called before any of the functions below.
+ */
+void router_peers_init(const struct router_peer_ops *ops);
+
+/**
+ * Returns the state of the peer with the given node EID, which is created if
+ * it is not known yet and create is true. As the routers only create peers
+ * in contact, the time of the last contact is updated in that case.
+ */
+struct router_peer *router_peers_get(const char *node_eid, bool create);
+
+/**
+ * Reports the end of the transmission of a bundle to the peer using the
+ * given CLA address. If it failed, the bundle is passed back to the router.
+ *
+ * @return true if the bundle is a copy owned by the router, which has to be
+ *	   freed by the caller instead of being processed further
+ */
+bool router_peers_transmission_ended(struct bundle *bundle,
+				     const char *peer_cla_addr, bool success);
+
+/**
+ * Passes a bundle removed from the queue of the contact, e.g. for being
+ * re-scheduled, back to the router.
+ *
+ * @return true if the bundle is a copy owned by the router, which has to be
+ *	   freed by the caller instead of being re-scheduled
+ */
+bool router_peers_bundle_unqueued(const struct contact *contact,
+				  struct bundle *bundle);
+
+/**
+ * Passes the bundles still queued for the contact back to the router and
+ * drops the state of the peers not in contact anymore, see
+ * ROUTER_PEER_TIMEOUT_MS. Has to be called before
+ * routing_table_contact_passed().
+ */
+void router_peers_contact_over(const struct contact *contact);
+
+/**
+ * Routes the bundle only via an active contact of the node it is addressed
+ * to, e.g. for the state of the router sent to a peer.
+ */
+enum router_result_status router_peers_route_direct(struct bundle *bundle);
+
+#endif // ROUTER_PEERS_H_INCLUDED
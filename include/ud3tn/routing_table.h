@@ -3,6 +3,7 @@
 #define ROUTINGTABLE_H_INCLUDED
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/contact_index.h"
 #include "ud3tn/node.h"
 #include "ud3tn/result.h"
 
@@ -10,14 +11,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
-// Number of slots in the node hash table.
+// Number of nodes and EIDs the routing table hash maps are initially sized
+// for, they grow as needed.
 #ifndef NODE_HTAB_SLOT_COUNT
 #define NODE_HTAB_SLOT_COUNT 128
 #endif // NODE_HTAB_SLOT_COUNT
 
 struct node_table_entry {
 	uint16_t ref_count;
+	// Contacts via which the EID is reachable, ordered by end time
 	struct contact_list *contacts;
+	struct contact_index index;
 };
 
 typedef void (*reschedule_func_t)(
@@ -41,6 +45,12 @@ uint8_t routing_table_lookup_hot_node(
 
 bool routing_table_add_node(
 	struct node *new_node, struct rescheduling_handle rescheduler);
+/**
+ * Replaces the plan of an existing node. If the CLA address is retained, its
+ * contacts are updated in place: contacts overlapping with one of the new
+ * plan adopt its window, data rate and EIDs and only the bundles which do not
+ * fit anymore are re-scheduled.
+ */
 bool routing_table_replace_node(
 	struct node *node, struct rescheduling_handle rescheduler);
 bool routing_table_delete_node(
@@ -50,6 +60,25 @@ bool routing_table_delete_node_by_eid(
 
 struct contact_list **routing_table_get_raw_contact_list_ptr(void);
 struct node_list *routing_table_get_node_list(void);
+uint32_t routing_table_get_generation(void);
+
+/**
+ * Returns the inactive contact with the earliest start time, or NULL. The
+ * contact is kept until it is taken via routing_table_pop_upcoming_contact()
+ * or deleted. Contacts are added again when their node is updated.
+ */
+struct contact *routing_table_peek_upcoming_contact(void);
+struct contact *routing_table_pop_upcoming_contact(void);
+/**
+ * Invokes the callback for all inactive contacts starting until the given
+ * time, e.g. to prepare them ahead of their start.
+ *
+ * @return the start time of the next inactive contact starting later, or
+ *	   UINT64_MAX if there is none
+ */
+uint64_t routing_table_visit_upcoming_contacts(
+	uint64_t until_ms, void (*func)(struct contact *, void *),
+	void *context);
 void routing_table_delete_contact(struct contact *contact);
 void routing_table_contact_passed(
 	struct contact *contact, struct rescheduling_handle rescheduler);
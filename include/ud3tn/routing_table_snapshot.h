@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef ROUTING_TABLE_SNAPSHOT_H_INCLUDED
+#define ROUTING_TABLE_SNAPSHOT_H_INCLUDED
+
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact binary snapshot of the routing table, i.e., of all nodes with their
+ * CLA address, reachable EIDs and contacts, which allows to resume forwarding
+ * right after a restart instead of waiting for the contact plan to be
+ * uploaded again.
+ *
+ * All integers are stored in little-endian byte order, strings with a 16 bit
+ * length prefix and without terminating null character:
+ *
+ *   header:  magic "RTSN", u16 version, u16 reserved, u32 node count
+ *   node:    u8 flags, u8 has CLA address, EID, [CLA address],
+ *            u16 EID count, EIDs, u32 contact count, contacts
+ *   contact: u64 start (ms), u64 end (ms), u32 data rate (bytes/s),
+ *            3 x i32 remaining capacity (per priority),
+ *            u16 EID count, EIDs
+ *   trailer: u32 CRC-32 of everything before
+ *
+ * The remaining capacities do not include bundles still queued for a
+ * contact, as these are kept in the bundle store and routed again after
+ * restoring them.
+ */
+
+#define ROUTING_TABLE_SNAPSHOT_VERSION 1
+
+// Key of the snapshot in the bundle store
+#define ROUTING_TABLE_SNAPSHOT_KEY "routing_table"
+
+// Time without changes of the contact plan after which the routing table is
+// persisted, so that a plan applied as many commands is written only once.
+// Changes are persisted at the latest after ten times this time.
+#ifndef ROUTING_TABLE_CHECKPOINT_DELAY_MS
+#define ROUTING_TABLE_CHECKPOINT_DELAY_MS 1000
+#endif // ROUTING_TABLE_CHECKPOINT_DELAY_MS
+
+/**
+ * Serializes the routing table into a newly allocated buffer, which has to
+ * be released by the caller via free(). Has to be called while holding the
+ * routing table semaphore.
+ */
+enum ud3tn_result routing_table_snapshot_create(
+	uint8_t **buffer, size_t *length);
+
+/**
+ * Adds the nodes contained in the snapshot to the routing table. Contacts
+ * which have ended before the given time are skipped. The snapshot is fully
+ * validated before the routing table is modified.
+ *
+ * @return UD3TN_FAIL if the snapshot is invalid or memory is exhausted
+ */
+enum ud3tn_result routing_table_snapshot_restore(
+	const uint8_t *buffer, size_t length, uint64_t min_end_time_ms);
+
+#endif // ROUTING_TABLE_SNAPSHOT_H_INCLUDED
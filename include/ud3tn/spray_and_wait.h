@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef SPRAY_AND_WAIT_H_INCLUDED
+#define SPRAY_AND_WAIT_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Copy budget of Binary Spray-and-Wait routing.
+ *
+ * A bundle starts with a budget of L copies. A node carrying n > 1 copies
+ * hands floor(n / 2) of them over to a relay it encounters and keeps the
+ * rest ("spray" phase). A node carrying a single copy only forwards the
+ * bundle to its destination ("wait" phase). Thus, at most L copies of a
+ * bundle exist in the network.
+ *
+ * The budget of the local node is kept in the bundle (spray_copies), which
+ * is persisted along with its metadata. The number of copies handed over is
+ * carried by the Spray-and-Wait extension block, which contains it as a CBOR
+ * unsigned integer. Each relay is sent a copy of the bundle with its own
+ * block, the copies not sent are added to the budget again.
+ */
+
+// Copies of a bundle sprayed into the network, including the own one.
+#ifndef SPRAY_AND_WAIT_COPIES
+#define SPRAY_AND_WAIT_COPIES 8
+#endif // SPRAY_AND_WAIT_COPIES
+
+// Maximum length of the CBOR-encoded content of the extension block.
+#define SPRAY_AND_WAIT_BLOCK_MAX_ENCODED_SIZE 9
+
+/**
+ * Returns the number of copies handed over to this node as indicated by the
+ * extension block, or zero if the bundle has no (valid) block.
+ */
+uint32_t spray_and_wait_get_handed_copies(const struct bundle *bundle);
+
+/**
+ * Sets the number of copies handed over to the next node, adding the
+ * extension block to the bundle if it has none.
+ */
+enum ud3tn_result spray_and_wait_set_handed_copies(struct bundle *bundle,
+						   uint32_t copies);
+
+/**
+ * Returns the copy budget of the local node for the bundle: its persisted
+ * budget, the copies handed over by the previous node or, for bundles not
+ * carrying the extension block, SPRAY_AND_WAIT_COPIES.
+ */
+uint32_t spray_and_wait_get_copies(const struct bundle *bundle);
+
+/**
+ * Returns the number of copies to be handed over to a relay by a node
+ * carrying the given number of copies.
+ */
+static inline uint32_t spray_and_wait_split(uint32_t copies)
+{
+	return copies / 2;
+}
+
+#endif // SPRAY_AND_WAIT_H_INCLUDED
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef SUMMARY_VECTOR_H_INCLUDED
+#define SUMMARY_VECTOR_H_INCLUDED
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Summary vectors describe the bundles known to a node, so that neighbors
+ * exchanging them only have to transmit the bundles missing at the other
+ * side (anti-entropy as done by epidemic routing).
+ *
+ * Bundles are identified by a 64-bit digest of their unique identifier. A
+ * digest_set stores the digests along with the expiration time of the
+ * bundles. The summary vector sent to peers is a Bloom filter built from a
+ * digest_set: it has no false negatives, but may claim that a bundle is known
+ * by the peer although it is not. With the default of 16 bits per bundle this
+ * happens for about 0.05 % of the bundles, which are then not transmitted to
+ * that peer.
+ */
+
+// Number of Bloom filter bits per bundle in a summary vector.
+#ifndef SUMMARY_VECTOR_BITS_PER_BUNDLE
+#define SUMMARY_VECTOR_BITS_PER_BUNDLE 16
+#endif // SUMMARY_VECTOR_BITS_PER_BUNDLE
+
+// Maximum size of a received summary vector, larger ones are rejected.
+#ifndef SUMMARY_VECTOR_MAX_SIZE
+#define SUMMARY_VECTOR_MAX_SIZE (1 << 20)
+#endif // SUMMARY_VECTOR_MAX_SIZE
+
+struct digest_set_entry {
+	// Zero marks an empty slot, zero digests are mapped to one
+	uint64_t digest;
+	uint64_t expiration_ms;
+	// Defined by the user of the set, zero if added via digest_set_add()
+	uint32_t value;
+};
+
+struct digest_set {
+	struct digest_set_entry *entries;
+	size_t capacity;
+	size_t count;
+};
+
+/*
+ * Payload range of a bundle which has been sent to a peer as fragment,
+ * identified by the digest of the fragment.
+ */
+struct fragment_range {
+	uint64_t digest;
+	uint64_t offset;
+	uint64_t length;
+};
+
+/*
+ * The payload ranges of a bundle sent to a peer so far, sorted by offset.
+ * Ranges may overlap if a bundle has been fragmented differently before.
+ */
+struct fragment_ranges {
+	struct fragment_range *ranges;
+	size_t count;
+	size_t capacity;
+};
+
+struct summary_vector {
+	uint8_t *bits;
+	uint32_t bit_count;
+	uint8_t hash_count;
+};
+
+/**
+ * Returns the digest of the unique identifier of the bundle, which is the
+ * same on every node.
+ */
+uint64_t summary_vector_digest(const struct bundle *bundle);
+
+void digest_set_init(struct digest_set *set);
+void digest_set_free(struct digest_set *set);
+
+/**
+ * Adds the digest to the set, if it is already contained the expiration
+ * time is updated.
+ *
+ * @return UD3TN_FAIL if memory could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result digest_set_add(struct digest_set *set, uint64_t digest,
+				 uint64_t expiration_ms);
+
+/**
+ * Adds the digest to the set along with a value, if it is already contained
+ * the expiration time and value are updated.
+ *
+ * @return UD3TN_FAIL if memory could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result digest_set_put(struct digest_set *set, uint64_t digest,
+				 uint64_t expiration_ms, uint32_t value);
+bool digest_set_contains(const struct digest_set *set, uint64_t digest);
+bool digest_set_remove(struct digest_set *set, uint64_t digest);
+
+/**
+ * Removes the digest from the set and returns whether it was contained. If
+ * so and value is not NULL, the value stored along with it is returned there.
+ */
+bool digest_set_take(struct digest_set *set, uint64_t digest,
+		     uint32_t *value);
+
+/**
+ * Removes all digests of bundles expired at the given time.
+ */
+void digest_set_expire(struct digest_set *set, uint64_t time_ms);
+
+void fragment_ranges_init(struct fragment_ranges *fr);
+void fragment_ranges_free(struct fragment_ranges *fr);
+
+/**
+ * Adds the payload range sent as fragment with the given digest.
+ *
+ * @return UD3TN_FAIL if memory could not be allocated, UD3TN_OK otherwise
+ */
+enum ud3tn_result fragment_ranges_add(struct fragment_ranges *fr,
+				      uint64_t digest, uint64_t offset,
+				      uint64_t length);
+
+/**
+ * Removes the range of the fragment with the given digest, e.g. because its
+ * transmission failed.
+ */
+bool fragment_ranges_remove(struct fragment_ranges *fr, uint64_t digest);
+
+/**
+ * Determines the first payload range starting at or after the given position
+ * which is not covered by any of the ranges.
+ *
+ * @return false if the payload is covered up to payload_length, true
+ *	   otherwise
+ */
+bool fragment_ranges_next_gap(const struct fragment_ranges *fr,
+			      uint64_t position, uint64_t payload_length,
+			      uint64_t *gap_offset, uint64_t *gap_length);
+
+/**
+ * Creates a summary vector containing all digests of the set.
+ */
+enum ud3tn_result summary_vector_create(struct summary_vector *sv,
+					const struct digest_set *set);
+
+/**
+ * Returns whether the digest is (probably) contained in the summary vector.
+ * An empty or uninitialized summary vector contains nothing.
+ */
+bool summary_vector_contains(const struct summary_vector *sv,
+			     uint64_t digest);
+void summary_vector_free(struct summary_vector *sv);
+
+size_t summary_vector_get_serialized_size(const struct summary_vector *sv);
+
+/**
+ * Writes the summary vector to the buffer, which has to be at least
+ * summary_vector_get_serialized_size() bytes long.
+ */
+void summary_vector_serialize(const struct summary_vector *sv,
+			      uint8_t *buffer);
+
+/**
+ * Initializes the summary vector from its serialized form.
+ *
+ * @return UD3TN_FAIL if the data is malformed or too large, UD3TN_OK
+ *	   otherwise
+ */
+enum ud3tn_result summary_vector_parse(struct summary_vector *sv,
+				       const uint8_t *data, size_t length);
+
+#endif // SUMMARY_VECTOR_H_INCLUDED
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef TOKEN_BUCKET_H_INCLUDED
+#define TOKEN_BUCKET_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Token bucket limiting a byte rate, e.g. the data sent via a link to the
+ * data rate of the contact. Tokens for one byte each are added at the
+ * configured rate up to the capacity of the bucket, which is the maximum
+ * number of bytes that can be sent at once after an idle period.
+ *
+ * The current time is passed to all functions, the bucket itself does not
+ * block. Tokens are accounted in thousandths of a byte, so that no fractions
+ * are lost with millisecond time steps.
+ */
+
+struct token_bucket {
+	// Fill rate in bytes per second, 0 = unlimited
+	uint32_t rate_bytes_per_s;
+	// Maximum number of bytes which can be accumulated
+	uint32_t capacity_bytes;
+	// Available tokens in thousandths of a byte
+	uint64_t tokens;
+	// Time of the last refill
+	uint64_t last_update_ms;
+};
+
+/**
+ * Initializes a full bucket of the given capacity without rate limit.
+ */
+void token_bucket_init(struct token_bucket *bucket, uint32_t capacity_bytes,
+		       uint64_t now_ms);
+
+/**
+ * Changes the fill rate, the tokens accumulated up to now are kept.
+ */
+void token_bucket_set_rate(struct token_bucket *bucket,
+			   uint32_t rate_bytes_per_s, uint64_t now_ms);
+
+/**
+ * Takes the tokens for the given number of bytes if they are available.
+ * Requests larger than the capacity take the full bucket.
+ *
+ * @return 0 if the tokens have been taken, otherwise the time in
+ *	   milliseconds after which they will be available
+ */
+uint64_t token_bucket_take(struct token_bucket *bucket, size_t bytes,
+			   uint64_t now_ms);
+
+#endif // TOKEN_BUCKET_H_INCLUDED
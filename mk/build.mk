@@ -51,6 +51,7 @@ $(eval $(call addComponentWithRules,generated/aap2))
 $(eval $(call generateComponentRules,components/daemon))
 $(eval $(call generateComponentRules,test/unit))
 $(eval $(call generateComponentRules,test/decoder))
+$(eval $(call generateComponentRules,test/perf))
 
 build/$(PLATFORM)/libud3tn.so: LIBS = $(LIBS_libud3tn.so)
 build/$(PLATFORM)/libud3tn.so: $(LIBS_libud3tn.so) | build/$(PLATFORM)
@@ -100,6 +101,16 @@ build/$(PLATFORM)/ud3tndecode: LIBS = $(LIBS_ud3tndecode) build/$(PLATFORM)/libu
 build/$(PLATFORM)/ud3tndecode: $(LIBS_ud3tndecode) | build/$(PLATFORM)
 	$(call cmd,link)
 
+# BENCHMARK EXECUTABLE
+
+$(eval $(call addComponent,ud3tnperf,test/perf))
+
+build/$(PLATFORM)/ud3tnperf: build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnperf: LDFLAGS += $(LDFLAGS_EXECUTABLE)
+build/$(PLATFORM)/ud3tnperf: LIBS = $(LIBS_ud3tnperf) build/$(PLATFORM)/libud3tn.a
+build/$(PLATFORM)/ud3tnperf: $(LIBS_ud3tnperf) | build/$(PLATFORM)
+	$(call cmd,link)
+
 # GENERAL RULES
 
 build/$(PLATFORM): | build
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Compares the incremental BPv7 parser with the one-shot parser for bundles
+ * that are already contiguous in memory, for different payload sizes.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "bundle7/create.h"
+#include "bundle7/parser.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/payload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t payload_sizes[] = { 64, 4096, 65536, 1048576 };
+
+struct serialize_buffer {
+	uint8_t *data;
+	size_t filled;
+};
+
+static void write_to_buffer(void *param, const void *data, const size_t length)
+{
+	struct serialize_buffer *const buffer = param;
+
+	memcpy(buffer->data + buffer->filled, data, length);
+	buffer->filled += length;
+}
+
+static struct payload_buffer *create_serialized_bundle(size_t payload_length)
+{
+	uint8_t *const payload = malloc(payload_length);
+
+	if (!payload)
+		return NULL;
+	memset(payload, 0x42, payload_length);
+
+	// The payload is owned by the bundle afterwards.
+	struct bundle *const bundle = bundle7_create_local(
+		payload, payload_length,
+		"dtn://source/", "dtn://destination/",
+		658489863000, 1, 86400000, BUNDLE_FLAG_NONE
+	);
+
+	if (!bundle)
+		return NULL;
+
+	const size_t length = bundle_get_serialized_size(bundle);
+	struct serialize_buffer buffer = {
+		.data = malloc(length),
+		.filled = 0,
+	};
+	struct payload_buffer *result = NULL;
+
+	if (buffer.data &&
+	    bundle_serialize(bundle, write_to_buffer, &buffer) == UD3TN_OK &&
+	    buffer.filled == length)
+		result = payload_buffer_wrap(buffer.data, length);
+	if (!result)
+		free(buffer.data);
+	bundle_free(bundle);
+	return result;
+}
+
+static void store_bundle(struct bundle *bundle, void *param)
+{
+	*(struct bundle **)param = bundle;
+}
+
+int bench_bundle7_parser(struct perf_counter *counter, size_t iterations)
+{
+	struct bundle7_parser parser;
+	struct bundle *bundle = NULL;
+	char label[64];
+
+	if (!bundle7_parser_init(&parser, store_bundle, &bundle))
+		return -1;
+	parser.bundle_quota = BUNDLE_MAX_SIZE;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(payload_sizes); i++) {
+		struct payload_buffer *const source =
+			create_serialized_bundle(payload_sizes[i]);
+
+		if (!source) {
+			bundle7_parser_deinit(&parser);
+			return -1;
+		}
+
+		// Incremental parser, fed with the whole bundle at once: block
+		// data is copied by the internal bulk read.
+		perf_counter_reset(counter);
+		for (size_t n = 0; n < iterations; n++) {
+			bundle7_parser_reset(&parser);
+			PERF(counter, bundle7_parser_read(
+				&parser, source->data, source->length));
+			if (!bundle)
+				goto fail;
+			bundle_free(bundle);
+			bundle = NULL;
+		}
+		snprintf(label, sizeof(label), "stream, payload %zu B",
+			 payload_sizes[i]);
+		perf_counter_report(counter, label);
+
+		// One-shot parser, block data is borrowed from the source.
+		perf_counter_reset(counter);
+		for (size_t n = 0; n < iterations; n++) {
+			PERF(counter, bundle = bundle7_parse_buffer(
+				source, NULL));
+			if (!bundle)
+				goto fail;
+			bundle_free(bundle);
+			bundle = NULL;
+		}
+		snprintf(label, sizeof(label), "one-shot, payload %zu B",
+			 payload_sizes[i]);
+		perf_counter_report(counter, label);
+
+		payload_buffer_put(source);
+		continue;
+
+fail:
+		payload_buffer_put(source);
+		bundle7_parser_deinit(&parser);
+		return -1;
+	}
+
+	bundle7_parser_deinit(&parser);
+	return 0;
+}
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures Contact Graph Routing for contact plans of different sizes: the
+ * construction of the contact graph, the computation of the routes towards
+ * a destination not yet cached (which is the worst case per bundle), and
+ * the lookup of cached routes.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/cgr.h"
+#include "ud3tn/common.h"
+#include "ud3tn/node.h"
+#include "ud3tn/routing_table.h"
+
+#include "platform/hal_time.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ROUTING_CGR
+
+static const size_t contact_counts[] = { 100, 1000, 10000 };
+
+// Contacts of a node start in slots of this length
+#define CONTACT_SLOT_S 600
+// Every n-th node is a neighbor of the local node
+#define NEIGHBOR_RATIO 5
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void reschedule_noop(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static void free_list(struct contact_list *cl)
+{
+	while (cl != NULL) {
+		struct contact_list *next = cl->next;
+
+		free(cl);
+		cl = next;
+	}
+}
+
+static void node_eid(char *buf, size_t n)
+{
+	snprintf(buf, 32, "dtn://node%zu/", n);
+}
+
+// Creates a plan in which the neighbors are reachable directly and all
+// other nodes via contacts from random other nodes.
+static int create_plan(size_t contact_count, size_t node_count,
+		       uint64_t now_ms)
+{
+	const struct rescheduling_handle rescheduler = {
+		.reschedule_func = reschedule_noop,
+		.reschedule_func_context = NULL,
+	};
+	const size_t per_node = contact_count / node_count;
+	uint32_t rng = 0x12345678;
+	char eid[32];
+
+	for (size_t n = 0; n < node_count; n++) {
+		node_eid(eid, n);
+
+		struct node *node = node_create(eid);
+
+		if (!node)
+			return -1;
+		if (n % NEIGHBOR_RATIO == 0)
+			node->cla_addr = strdup("mtcp:localhost:4224");
+		for (size_t i = 0; i < per_node; i++) {
+			struct contact *c = contact_create(node);
+			struct endpoint_list *sender;
+			size_t s;
+
+			if (!c)
+				return -1;
+			c->from_ms = now_ms + (
+				i * CONTACT_SLOT_S +
+				xorshift32(&rng) % (CONTACT_SLOT_S / 2)
+			) * 1000;
+			c->to_ms = c->from_ms + (
+				60 + xorshift32(&rng) % 240
+			) * 1000;
+			c->bitrate_bytes_per_s = 10000;
+			add_contact_to_ordered_list(&node->contacts, c, 1);
+			if (node->cla_addr != NULL)
+				continue;
+
+			sender = malloc(sizeof(struct endpoint_list));
+			if (!sender)
+				return -1;
+			do {
+				s = xorshift32(&rng) % node_count;
+			} while (s == n);
+			node_eid(eid, s);
+			sender->eid = strdup(eid);
+			sender->next = NULL;
+			c->contact_endpoints = sender;
+		}
+		if (!node_prepare_and_verify(node, 0) ||
+		    !routing_table_add_node(node, rescheduler))
+			return -1;
+	}
+	return 0;
+}
+
+static int bench_plan(struct perf_counter *counter, size_t iterations,
+		      size_t contact_count)
+{
+	const size_t node_count = MAX((size_t)10, contact_count / 100);
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	// Scale the number of runs so that every size takes a similar time
+	const size_t runs = MAX(
+		(size_t)1,
+		iterations * contact_counts[0] / contact_count
+	);
+	size_t routes = 0;
+	char label[64];
+	char eid[32];
+
+	routing_table_init();
+	if (create_plan(contact_count, node_count, now_ms) != 0) {
+		routing_table_free();
+		return -1;
+	}
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		cgr_free();
+		PERF(counter, free_list(
+			cgr_lookup_first_hops("dtn://unknown/", UINT64_MAX)
+		));
+	}
+	snprintf(label, sizeof(label), "graph, %zu contacts", contact_count);
+	perf_counter_report(counter, label);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		cgr_free();
+		// Build the graph before measuring
+		free_list(cgr_lookup_first_hops("dtn://unknown/", UINT64_MAX));
+		for (size_t d = 1; d < node_count; d++) {
+			struct contact_list *cl;
+
+			node_eid(eid, d);
+			PERF(counter, cl = cgr_lookup_first_hops(
+				eid,
+				UINT64_MAX
+			));
+			routes += cl != NULL;
+			free_list(cl);
+		}
+	}
+	snprintf(label, sizeof(label), "route, %zu contacts", contact_count);
+	perf_counter_report(counter, label);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		for (size_t d = 1; d < node_count; d++) {
+			node_eid(eid, d);
+			PERF(counter, free_list(
+				cgr_lookup_first_hops(eid, UINT64_MAX)
+			));
+		}
+	}
+	snprintf(label, sizeof(label), "cached, %zu contacts", contact_count);
+	perf_counter_report(counter, label);
+
+	printf("%zu of %zu destinations reachable\n",
+	       routes / runs, node_count - 1);
+
+	cgr_free();
+	routing_table_free();
+	return 0;
+}
+
+int bench_cgr(struct perf_counter *counter, size_t iterations)
+{
+	for (size_t i = 0; i < ARRAY_LENGTH(contact_counts); i++) {
+		if (bench_plan(counter, iterations, contact_counts[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+#else // ROUTING_CGR
+
+int bench_cgr(struct perf_counter *counter, size_t iterations)
+{
+	(void)counter;
+	(void)iterations;
+	printf("Skipped, build with ROUTING=cgr to enable\n");
+	return 0;
+}
+
+#endif // ROUTING_CGR
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures the ingestion of contact plans received by the config agent, once
+ * as ASCII commands, of which each one is parsed and applied on its own, and
+ * once as a CBOR-encoded plan that is parsed in one pass and applied at once.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "agents/config_parser.h"
+#include "agents/config_plan_parser.h"
+
+#include "platform/hal_time.h"
+
+#include "ud3tn/common.h"
+#include "ud3tn/node.h"
+#include "ud3tn/router.h"
+#include "ud3tn/routing_table.h"
+
+#include "cbor.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t contact_counts[] = { 1000, 10000, 100000 };
+
+#define CONTACTS_PER_NODE 500
+// Contacts of a node start in slots of this length, i.e., one orbit
+#define CONTACT_SLOT_S 5400
+#define CONTACT_DURATION_S 300
+#define CLA_ADDR "mtcp:localhost:4224"
+
+// Upper bound for the encoded size of a contact and a command without them
+#define ENCODED_CONTACT_MAX 64
+#define ENCODED_COMMAND_MAX 128
+
+static void reschedule_noop(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static const struct rescheduling_handle rescheduler = {
+	.reschedule_func = reschedule_noop,
+	.reschedule_func_context = NULL,
+};
+
+static uint64_t contact_start_s(uint64_t base_s, size_t i)
+{
+	return base_s + i * CONTACT_SLOT_S;
+}
+
+// Returns one command per node, as sent in one bundle each.
+static char *encode_ascii(size_t n, size_t contacts_per_node, uint64_t base_s)
+{
+	const size_t size = (
+		ENCODED_COMMAND_MAX +
+		contacts_per_node * ENCODED_CONTACT_MAX
+	);
+	char *const buffer = malloc(size);
+	size_t pos = 0;
+
+	if (!buffer)
+		return NULL;
+	pos += snprintf(buffer + pos, size - pos,
+			"1(ipn:%zu.0):(" CLA_ADDR ")::[", n + 1);
+	for (size_t i = 0; i < contacts_per_node; i++) {
+		const uint64_t from_s = contact_start_s(base_s, i);
+
+		pos += snprintf(
+			buffer + pos, size - pos,
+			"%s{%llu,%llu,100000}",
+			i == 0 ? "" : ",",
+			(unsigned long long)from_s,
+			(unsigned long long)(from_s + CONTACT_DURATION_S)
+		);
+	}
+	snprintf(buffer + pos, size - pos, "];");
+	return buffer;
+}
+
+static uint8_t *encode_cbor(size_t node_count, size_t contacts_per_node,
+			    uint64_t base_s, size_t *length)
+{
+	const size_t size = node_count * (
+		ENCODED_COMMAND_MAX +
+		contacts_per_node * ENCODED_CONTACT_MAX
+	);
+	uint8_t *const buffer = malloc(size);
+	CborEncoder encoder, commands, command, list, contact, eids;
+	char eid[32];
+
+	if (!buffer)
+		return NULL;
+	cbor_encoder_init(&encoder, buffer, size, 0);
+	cbor_encoder_create_array(&encoder, &commands, node_count);
+	for (size_t n = 0; n < node_count; n++) {
+		snprintf(eid, sizeof(eid), "ipn:%zu.0", n + 1);
+		cbor_encoder_create_array(&commands, &command, 5);
+		cbor_encode_uint(&command, 1);
+		cbor_encode_text_stringz(&command, eid);
+		cbor_encode_text_stringz(&command, CLA_ADDR);
+		cbor_encoder_create_array(&command, &list, 0);
+		cbor_encoder_close_container(&command, &list);
+		cbor_encoder_create_array(&command, &list, contacts_per_node);
+		for (size_t i = 0; i < contacts_per_node; i++) {
+			const uint64_t from_s = contact_start_s(base_s, i);
+
+			cbor_encoder_create_array(&list, &contact, 4);
+			cbor_encode_uint(&contact, from_s);
+			cbor_encode_uint(&contact, from_s + CONTACT_DURATION_S);
+			cbor_encode_uint(&contact, 100000);
+			cbor_encoder_create_array(&contact, &eids, 0);
+			cbor_encoder_close_container(&contact, &eids);
+			cbor_encoder_close_container(&list, &contact);
+		}
+		cbor_encoder_close_container(&command, &list);
+		cbor_encoder_close_container(&commands, &command);
+	}
+	cbor_encoder_close_container(&encoder, &commands);
+	*length = cbor_encoder_get_buffer_size(&encoder, buffer);
+	return buffer;
+}
+
+static void process_command(void *param, struct router_command *cmd)
+{
+	size_t *const failed = param;
+
+	if (router_process_command(cmd, rescheduler) != UD3TN_OK)
+		(*failed)++;
+}
+
+static int bench_ascii(struct perf_counter *counter, size_t contact_count,
+		       uint64_t base_s)
+{
+	const size_t node_count = contact_count / CONTACTS_PER_NODE;
+	char **const commands = calloc(node_count, sizeof(char *));
+	struct config_parser parser;
+	size_t failed = 0;
+	char label[64];
+
+	if (!commands || !config_parser_init(&parser, process_command, &failed))
+		return -1;
+	for (size_t n = 0; n < node_count; n++) {
+		commands[n] = encode_ascii(n, CONTACTS_PER_NODE, base_s);
+		if (!commands[n])
+			return -1;
+	}
+	routing_table_init();
+
+	perf_counter_reset(counter);
+	perf_counter_start(counter);
+	for (size_t n = 0; n < node_count; n++) {
+		config_parser_reset(&parser);
+		config_parser_read(
+			&parser,
+			(const uint8_t *)commands[n],
+			strlen(commands[n])
+		);
+	}
+	perf_counter_stop(counter);
+	snprintf(label, sizeof(label), "ascii, %zu contacts", contact_count);
+	perf_counter_report(counter, label);
+
+	routing_table_free();
+	config_parser_reset(&parser);
+	free_node(parser.router_command->data);
+	free(parser.router_command);
+	free(parser.basedata);
+	for (size_t n = 0; n < node_count; n++)
+		free(commands[n]);
+	free(commands);
+	return failed == 0 ? 0 : -1;
+}
+
+static int bench_cbor(struct perf_counter *counter, size_t contact_count,
+		      uint64_t base_s)
+{
+	const size_t node_count = contact_count / CONTACTS_PER_NODE;
+	struct config_plan plan;
+	enum ud3tn_result result;
+	size_t length;
+	char label[64];
+	uint8_t *const buffer = encode_cbor(node_count, CONTACTS_PER_NODE,
+					    base_s, &length);
+
+	if (!buffer)
+		return -1;
+	routing_table_init();
+
+	perf_counter_reset(counter);
+	PERF(counter, result = config_plan_parse(&plan, buffer, length));
+	snprintf(label, sizeof(label), "cbor parse, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+	free(buffer);
+	if (result != UD3TN_OK)
+		return -1;
+
+	perf_counter_reset(counter);
+	PERF(counter, result = router_process_commands(
+		plan.commands,
+		plan.count,
+		rescheduler
+	));
+	snprintf(label, sizeof(label), "cbor apply, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+
+	config_plan_free(&plan);
+	routing_table_free();
+	return result == UD3TN_OK ? 0 : -1;
+}
+
+int bench_config_plan(struct perf_counter *counter, size_t iterations)
+{
+	// Contacts have to end in the future to be accepted.
+	const uint64_t base_s = hal_time_get_timestamp_s() + 3600;
+
+	(void)iterations;
+	for (size_t i = 0; i < ARRAY_LENGTH(contact_counts); i++) {
+		if (bench_ascii(counter, contact_counts[i], base_s) != 0 ||
+		    bench_cbor(counter, contact_counts[i], base_s) != 0)
+			return -1;
+	}
+	return 0;
+}
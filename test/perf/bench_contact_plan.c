@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures loading large contact plans into the routing table, e.g. 30 days
+ * of a constellation of 200 satellites, each having 500 contacts with the
+ * ground station, as well as updating single contacts of a loaded plan.
+ * The ordered contact index is compared with the sorted linked list used
+ * before for plans up to 10k contacts.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/common.h"
+#include "ud3tn/contact_index.h"
+#include "ud3tn/node.h"
+#include "ud3tn/routing_table.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t contact_counts[] = { 1000, 10000, 100000 };
+
+#define CONTACTS_PER_NODE 500
+// Contacts of a node start in slots of this length, i.e., one orbit
+#define CONTACT_SLOT_S 5400
+// Up to this size, the sorted list is measured for comparison
+#define LIST_MAX_CONTACTS 10000
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void reschedule_noop(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static const struct rescheduling_handle rescheduler = {
+	.reschedule_func = reschedule_noop,
+	.reschedule_func_context = NULL,
+};
+
+static struct contact *create_contact(struct node *node, size_t slot,
+				      uint32_t *rng)
+{
+	struct contact *c = contact_create(node);
+
+	if (!c)
+		return NULL;
+	c->from_ms = (
+		(uint64_t)slot * CONTACT_SLOT_S +
+		xorshift32(rng) % (CONTACT_SLOT_S / 2)
+	) * 1000;
+	c->to_ms = c->from_ms + (300 + xorshift32(rng) % 300) * 1000;
+	c->bitrate_bytes_per_s = 100000;
+	return c;
+}
+
+static struct node *create_node(size_t n, size_t contact_count,
+				uint32_t *rng)
+{
+	char eid[32];
+	struct node *node;
+
+	snprintf(eid, sizeof(eid), "ipn:%zu.0", n + 1);
+	node = node_create(eid);
+	if (!node)
+		return NULL;
+	node->cla_addr = strdup("mtcp:localhost:4224");
+	for (size_t i = 0; i < contact_count; i++) {
+		struct contact *c = create_contact(node, i, rng);
+
+		if (!c || !add_contact_to_ordered_list(&node->contacts, c, 1)) {
+			free(c);
+			free_node(node);
+			return NULL;
+		}
+	}
+	if (!node_prepare_and_verify(node, 0)) {
+		free_node(node);
+		return NULL;
+	}
+	return node;
+}
+
+static int bench_load(struct perf_counter *counter, size_t contact_count)
+{
+	const size_t node_count = MAX(
+		(size_t)1,
+		contact_count / CONTACTS_PER_NODE
+	);
+	uint32_t rng = 0x12345678;
+	char label[64];
+
+	routing_table_init();
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < node_count; n++) {
+		struct node *node = create_node(
+			n,
+			contact_count / node_count,
+			&rng
+		);
+		bool added;
+
+		if (!node)
+			return -1;
+		PERF(counter, added = routing_table_add_node(
+			node,
+			rescheduler
+		));
+		if (!added)
+			return -1;
+	}
+	snprintf(label, sizeof(label), "load node, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+
+	// Add a contact to every node, then delete it again
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < node_count; n++) {
+		struct node *node = create_node(n, 0, &rng);
+		struct contact *c = create_contact(
+			node,
+			CONTACTS_PER_NODE + 1,
+			&rng
+		);
+		bool added;
+
+		if (!node || !c)
+			return -1;
+		add_contact_to_ordered_list(&node->contacts, c, 1);
+		PERF(counter, added = routing_table_add_node(
+			node,
+			rescheduler
+		));
+		if (!added)
+			return -1;
+	}
+	snprintf(label, sizeof(label), "add contact, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < node_count; n++) {
+		char eid[32];
+		struct node *node;
+		struct contact_list *last;
+
+		snprintf(eid, sizeof(eid), "ipn:%zu.0", n + 1);
+		node = routing_table_lookup_node(eid);
+		if (!node || !node->contacts)
+			return -1;
+		for (last = node->contacts; last->next; last = last->next)
+			;
+		PERF(counter, routing_table_delete_contact(last->data));
+	}
+	snprintf(label, sizeof(label), "delete contact, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+
+	routing_table_free();
+	return 0;
+}
+
+static int bench_insert(struct perf_counter *counter, size_t contact_count)
+{
+	struct contact **contacts = malloc(
+		contact_count * sizeof(struct contact *)
+	);
+	struct contact_list *list = NULL;
+	struct contact_index index;
+	uint32_t rng = 0x12345678;
+	char label[64];
+
+	if (!contacts)
+		return -1;
+	for (size_t i = 0; i < contact_count; i++) {
+		contacts[i] = create_contact(
+			NULL,
+			i % CONTACTS_PER_NODE,
+			&rng
+		);
+		if (!contacts[i])
+			return -1;
+	}
+
+	perf_counter_reset(counter);
+	contact_index_init(&index, &list, true);
+	for (size_t i = 0; i < contact_count; i++)
+		PERF(counter, contact_index_add(&index, contacts[i]));
+	snprintf(label, sizeof(label), "index insert, %zu contacts",
+		 contact_count);
+	perf_counter_report(counter, label);
+	for (size_t i = 0; i < contact_count; i++)
+		contact_index_remove(&index, contacts[i]);
+
+	if (contact_count <= LIST_MAX_CONTACTS) {
+		perf_counter_reset(counter);
+		for (size_t i = 0; i < contact_count; i++)
+			PERF(counter, add_contact_to_ordered_list(
+				&list,
+				contacts[i],
+				1
+			));
+		snprintf(label, sizeof(label), "list insert, %zu contacts",
+			 contact_count);
+		perf_counter_report(counter, label);
+		for (size_t i = 0; i < contact_count; i++)
+			remove_contact_from_list(&list, contacts[i]);
+	}
+
+	for (size_t i = 0; i < contact_count; i++)
+		free_contact(contacts[i]);
+	free(contacts);
+	return 0;
+}
+
+int bench_contact_plan(struct perf_counter *counter, size_t iterations)
+{
+	(void)iterations;
+	for (size_t i = 0; i < ARRAY_LENGTH(contact_counts); i++) {
+		if (bench_insert(counter, contact_counts[i]) != 0 ||
+		    bench_load(counter, contact_counts[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
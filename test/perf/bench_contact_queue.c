@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures the cost of queuing bundles for a contact, removing them in
+ * random order (as done on re-scheduling), and handing them over to a CLA
+ * in batches, for different queue lengths.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/bundle.h"
+#include "ud3tn/common.h"
+#include "ud3tn/routed_bundle_queue.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const size_t queue_lengths[] = { 100, 10000, 50000 };
+
+#define HANDOVER_BATCH 64
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void fill_queue(struct routed_bundle_queue *queue,
+		       struct bundle **bundles, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		routed_bundle_queue_push(queue, bundles[i]);
+}
+
+static void empty_queue(struct routed_bundle_queue *queue,
+			struct bundle **bundles, const size_t *order,
+			size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		routed_bundle_queue_remove(queue, bundles[order[i]]);
+}
+
+static void hand_over(struct routed_bundle_queue *queue)
+{
+	while (!routed_bundle_queue_empty(queue)) {
+		struct routed_bundle_list *e = routed_bundle_queue_take(
+			queue,
+			HANDOVER_BATCH
+		);
+
+		while (e != NULL) {
+			struct routed_bundle_list *next = e->next;
+
+			free(e);
+			e = next;
+		}
+	}
+}
+
+static int bench_queue_length(struct perf_counter *counter,
+			      size_t iterations, size_t count)
+{
+	struct bundle **const bundles = calloc(count, sizeof(struct bundle *));
+	size_t *const order = malloc(count * sizeof(size_t));
+	struct routed_bundle_queue queue;
+	uint32_t rng = 0x12345678;
+	char label[64];
+	int rc = -1;
+
+	if (!bundles || !order)
+		goto out;
+
+	for (size_t i = 0; i < count; i++) {
+		bundles[i] = bundle_init();
+		if (!bundles[i])
+			goto out;
+		bundles[i]->protocol_version = 7;
+		bundles[i]->creation_timestamp_ms = 1;
+		bundles[i]->lifetime_ms = 1000 + xorshift32(&rng) % 100000;
+		if (i % 4 == 0)
+			bundles[i]->ret_constraints =
+				BUNDLE_RET_CONSTRAINT_FLAG_OWN;
+		order[i] = i;
+	}
+
+	// Fisher-Yates shuffle of the removal order
+	for (size_t i = count - 1; i > 0; i--) {
+		const size_t j = xorshift32(&rng) % (i + 1);
+		const size_t tmp = order[i];
+
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+
+	// Scale the number of runs so that every length takes a similar time
+	const size_t runs = MAX(
+		(size_t)1,
+		iterations * queue_lengths[0] / count
+	);
+
+	routed_bundle_queue_init(&queue);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, fill_queue(&queue, bundles, count));
+		empty_queue(&queue, bundles, order, count);
+	}
+	snprintf(label, sizeof(label), "push %zu bundles", count);
+	perf_counter_report(counter, label);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		fill_queue(&queue, bundles, count);
+		PERF(counter, empty_queue(&queue, bundles, order, count));
+	}
+	snprintf(label, sizeof(label), "remove %zu bundles (random)", count);
+	perf_counter_report(counter, label);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		fill_queue(&queue, bundles, count);
+		PERF(counter, hand_over(&queue));
+	}
+	snprintf(label, sizeof(label), "hand over %zu bundles (batch %d)",
+		 count, HANDOVER_BATCH);
+	perf_counter_report(counter, label);
+
+	rc = 0;
+
+out:
+	for (size_t i = 0; bundles && i < count; i++)
+		bundle_free(bundles[i]);
+	free(bundles);
+	free(order);
+	return rc;
+}
+
+int bench_contact_queue(struct perf_counter *counter, size_t iterations)
+{
+	for (size_t i = 0; i < ARRAY_LENGTH(queue_lengths); i++) {
+		if (bench_queue_length(counter, iterations,
+				       queue_lengths[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
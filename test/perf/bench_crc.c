@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures the throughput of the CRC implementations for typical block
+ * sizes: a small extension block, an Ethernet-sized frame, and a large
+ * payload.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/common.h"
+#include "ud3tn/crc.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const size_t block_sizes[] = { 64, 1500, 65536 };
+
+static const struct {
+	enum crc_implementation implementation;
+	const char *name;
+} implementations[] = {
+	{ CRC_IMPLEMENTATION_BYTEWISE, "bytewise" },
+	{ CRC_IMPLEMENTATION_SLICE_BY_8, "slice-by-8" },
+	{ CRC_IMPLEMENTATION_HARDWARE, "hardware" },
+};
+
+// Prevents the compiler from optimizing out the calculation
+static volatile uint32_t crc_sink;
+
+int bench_crc(struct perf_counter *counter, size_t iterations)
+{
+	const enum crc_implementation selected = crc_get_implementation();
+	const size_t max_size = block_sizes[ARRAY_LENGTH(block_sizes) - 1];
+	uint8_t *const data = malloc(max_size);
+	char label[64];
+
+	if (!data)
+		return -1;
+	for (size_t i = 0; i < max_size; i++)
+		data[i] = (uint8_t)(i * 131);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(implementations); i++) {
+		if (!crc_set_implementation(
+				implementations[i].implementation)) {
+			printf("%s: not supported on this CPU\n",
+			       implementations[i].name);
+			continue;
+		}
+
+		for (size_t s = 0; s < ARRAY_LENGTH(block_sizes); s++) {
+			const size_t size = block_sizes[s];
+
+			perf_counter_reset(counter);
+			for (size_t n = 0; n < iterations; n++)
+				PERF(counter, crc_sink = crc32(data, size));
+			snprintf(label, sizeof(label), "crc32c %s, %zu B",
+				 implementations[i].name, size);
+			perf_counter_report(counter, label);
+
+			perf_counter_reset(counter);
+			for (size_t n = 0; n < iterations; n++)
+				PERF(counter, crc_sink = crc16_x25(data, size));
+			snprintf(label, sizeof(label), "crc16-x25 %s, %zu B",
+				 implementations[i].name, size);
+			perf_counter_report(counter, label);
+		}
+	}
+
+	printf("selected by default: %s\n", implementations[selected].name);
+	crc_set_implementation(selected);
+	free(data);
+	return 0;
+}
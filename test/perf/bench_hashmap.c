@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Measures insertions, lookups (hits and misses), and removals of EID keys
+ * in the open-addressing hash map used by the routing table, compared to
+ * the chained hash table with a fixed number of slots it replaced.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/common.h"
+#include "ud3tn/hashmap.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/simplehtab.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const size_t entry_counts[] = { 100, 10000, 1000000 };
+
+// The chained table degrades linearly with the number of entries per slot,
+// do not wait for it beyond this size.
+#define SIMPLEHTAB_MAX_ENTRIES 10000
+
+// Prevents the compiler from optimizing out the lookups
+static void *volatile lookup_sink;
+
+static char **create_keys(size_t count, const char *format)
+{
+	char **const keys = calloc(count, sizeof(char *));
+
+	if (!keys)
+		return NULL;
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = malloc(32);
+		if (!keys[i])
+			return keys;
+		snprintf(keys[i], 32, format, (unsigned long)i);
+	}
+	return keys;
+}
+
+static void free_keys(char **keys, size_t count)
+{
+	for (size_t i = 0; keys && i < count; i++)
+		free(keys[i]);
+	free(keys);
+}
+
+static void report(struct perf_counter *counter, const char *table,
+		   const char *operation, size_t count)
+{
+	char label[64];
+
+	snprintf(label, sizeof(label), "%s %s %zu", table, operation, count);
+	perf_counter_report(counter, label);
+}
+
+static void bench_hashmap_count(struct perf_counter *counter, size_t runs,
+				char **keys, char **missing, size_t count)
+{
+	struct hashmap map;
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		hashmap_init(&map, 0);
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				hashmap_put(&map, keys[i], keys[i]);
+		});
+		hashmap_deinit(&map);
+	}
+	report(counter, "hashmap", "insert", count);
+
+	hashmap_init(&map, 0);
+	for (size_t i = 0; i < count; i++)
+		hashmap_put(&map, keys[i], keys[i]);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				lookup_sink = hashmap_get(&map, keys[i]);
+		});
+	}
+	report(counter, "hashmap", "lookup hit", count);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				lookup_sink = hashmap_get(&map, missing[i]);
+		});
+	}
+	report(counter, "hashmap", "lookup miss", count);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				hashmap_remove(&map, keys[i]);
+		});
+		for (size_t i = 0; i < count; i++)
+			hashmap_put(&map, keys[i], keys[i]);
+	}
+	report(counter, "hashmap", "remove", count);
+
+	hashmap_deinit(&map);
+}
+
+static void bench_simplehtab_count(struct perf_counter *counter, size_t runs,
+				   char **keys, char **missing, size_t count)
+{
+	struct htab *tab;
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		tab = htab_alloc(NODE_HTAB_SLOT_COUNT);
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				htab_add(tab, keys[i], keys[i]);
+		});
+		htab_free(tab);
+	}
+	report(counter, "simplehtab", "insert", count);
+
+	tab = htab_alloc(NODE_HTAB_SLOT_COUNT);
+	for (size_t i = 0; i < count; i++)
+		htab_add(tab, keys[i], keys[i]);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				lookup_sink = htab_get(tab, keys[i]);
+		});
+	}
+	report(counter, "simplehtab", "lookup hit", count);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				lookup_sink = htab_get(tab, missing[i]);
+		});
+	}
+	report(counter, "simplehtab", "lookup miss", count);
+
+	perf_counter_reset(counter);
+	for (size_t n = 0; n < runs; n++) {
+		PERF(counter, {
+			for (size_t i = 0; i < count; i++)
+				htab_remove(tab, keys[i]);
+		});
+		for (size_t i = 0; i < count; i++)
+			htab_add(tab, keys[i], keys[i]);
+	}
+	report(counter, "simplehtab", "remove", count);
+
+	htab_free(tab);
+}
+
+int bench_hashmap(struct perf_counter *counter, size_t iterations)
+{
+	for (size_t c = 0; c < ARRAY_LENGTH(entry_counts); c++) {
+		const size_t count = entry_counts[c];
+		// Scale the number of runs so that every size takes a
+		// similar time
+		const size_t runs = MAX(
+			(size_t)1,
+			iterations * entry_counts[0] / count
+		);
+		char **const keys = create_keys(count, "ipn:%lu.0");
+		char **const missing = create_keys(count, "dtn://node%lu/");
+		int rc = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			if (!keys || !missing || !keys[i] || !missing[i])
+				rc = -1;
+		}
+
+		if (rc == 0) {
+			bench_hashmap_count(counter, runs, keys, missing,
+					    count);
+			if (count <= SIMPLEHTAB_MAX_ENTRIES)
+				bench_simplehtab_count(counter, runs, keys,
+						       missing, count);
+		}
+
+		free_keys(keys, count);
+		free_keys(missing, count);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
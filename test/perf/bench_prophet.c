@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+/*
+ * Simulates a network of nodes moving in communities, in which nodes meet
+ * members of their own community much more often than other nodes, and
+ * compares PRoPHET with epidemic routing: the ratio of bundles delivered
+ * before their expiration and the bytes transmitted for that, including the
+ * predictability tables and summary vectors exchanged on every encounter.
+ * The exchange and update of the predictability tables (serialization,
+ * parsing, encounter and transitivity) is measured per encounter.
+ */
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "ud3tn/common.h"
+#include "ud3tn/prophet.h"
+#include "ud3tn/summary_vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NODE_COUNT 40
+#define COMMUNITY_SIZE 8
+// Percentage of encounters within the community of a node
+#define COMMUNITY_ENCOUNTER_PERCENT 85
+#define SIM_STEPS 2000
+#define STEP_MS (PROPHET_AGING_UNIT_MS / 4)
+#define ENCOUNTERS_PER_STEP 4
+// A bundle is created every n-th step
+#define BUNDLE_INTERVAL_STEPS 2
+#define BUNDLE_TTL_STEPS 500
+#define BUNDLE_SIZE 1000
+// Bundles transmitted per direction and encounter
+#define ENCOUNTER_CAPACITY 10
+#define MAX_BUNDLES (SIM_STEPS / BUNDLE_INTERVAL_STEPS)
+// Overhead of a summary vector, see summary_vector_get_serialized_size()
+#define SUMMARY_VECTOR_OVERHEAD 6
+
+enum scheme {
+	SCHEME_EPIDEMIC,
+	SCHEME_PROPHET,
+};
+
+struct sim_bundle {
+	uint16_t source;
+	uint16_t destination;
+	uint32_t created_step;
+};
+
+struct sim_result {
+	uint64_t delivered;
+	uint64_t created;
+	uint64_t transmissions;
+	uint64_t bytes;
+};
+
+struct sim {
+	enum scheme scheme;
+	struct sim_bundle bundles[MAX_BUNDLES];
+	size_t bundle_count;
+	// Whether a node has received (and still carries) a bundle
+	uint8_t known[NODE_COUNT][MAX_BUNDLES];
+	uint8_t delivered[MAX_BUNDLES];
+	char eids[NODE_COUNT][32];
+	// Every node has its own atoms, as the real routers have
+	struct prophet_atoms atoms[NODE_COUNT];
+	struct prophet_table tables[NODE_COUNT];
+	struct sim_result result;
+};
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void sim_init(struct sim *sim, enum scheme scheme)
+{
+	memset(sim, 0, sizeof(struct sim));
+	sim->scheme = scheme;
+	for (size_t n = 0; n < NODE_COUNT; n++) {
+		snprintf(sim->eids[n], sizeof(sim->eids[n]), "dtn://node%zu/", n);
+		prophet_atoms_init(&sim->atoms[n]);
+		prophet_table_init(&sim->tables[n], &sim->atoms[n], 0);
+	}
+}
+
+static void sim_free(struct sim *sim)
+{
+	for (size_t n = 0; n < NODE_COUNT; n++) {
+		prophet_table_free(&sim->tables[n]);
+		prophet_atoms_free(&sim->atoms[n]);
+	}
+}
+
+// Sends the table of node a to node b, the received table uses the atoms of b.
+static int send_table(struct sim *sim, size_t a, size_t b, uint64_t time_ms,
+		      struct prophet_table *received)
+{
+	size_t length;
+	uint8_t *const data = prophet_table_serialize(
+		&sim->tables[a],
+		&sim->atoms[a],
+		&length
+	);
+
+	if (data == NULL ||
+	    prophet_table_parse(received, &sim->atoms[b], data, length,
+				time_ms) != UD3TN_OK) {
+		free(data);
+		return -1;
+	}
+	free(data);
+	sim->result.bytes += length;
+	return 0;
+}
+
+// Updates the predictabilities of node b on the encounter of node a.
+static int update_table(struct sim *sim, size_t a, size_t b,
+			uint64_t time_ms, const struct prophet_table *received)
+{
+	const int32_t atom = prophet_atom_get(
+		&sim->atoms[b],
+		sim->eids[a],
+		true
+	);
+
+	if (atom < 0)
+		return -1;
+	prophet_table_age(&sim->tables[b], time_ms);
+	if (prophet_table_encounter(&sim->tables[b], atom) != UD3TN_OK ||
+	    prophet_table_transitive(&sim->tables[b], atom,
+				     received) != UD3TN_OK)
+		return -1;
+	return 0;
+}
+
+static bool should_forward(struct sim *sim, size_t from, size_t to,
+			   const struct sim_bundle *bundle,
+			   const struct prophet_table *to_table)
+{
+	if (bundle->destination == to || sim->scheme == SCHEME_EPIDEMIC)
+		return true;
+
+	// The table of the peer uses the atoms of the sending node
+	const int32_t atom = prophet_atom_get(
+		&sim->atoms[from],
+		sim->eids[bundle->destination],
+		false
+	);
+
+	return (
+		prophet_table_get(to_table, atom) >
+		prophet_table_get(&sim->tables[from], atom)
+	);
+}
+
+static void forward_bundles(struct sim *sim, size_t from, size_t to,
+			    uint32_t step, size_t first_live,
+			    const struct prophet_table *to_table)
+{
+	size_t sent = 0;
+
+	for (size_t i = first_live; i < sim->bundle_count; i++) {
+		const struct sim_bundle *const bundle = &sim->bundles[i];
+
+		if (sent == ENCOUNTER_CAPACITY)
+			break;
+		if (!sim->known[from][i] || sim->known[to][i] ||
+		    bundle->created_step + BUNDLE_TTL_STEPS <= step)
+			continue;
+		if (!should_forward(sim, from, to, bundle, to_table))
+			continue;
+
+		sim->known[to][i] = 1;
+		sim->result.transmissions++;
+		sim->result.bytes += BUNDLE_SIZE;
+		sent++;
+		if (bundle->destination == to && !sim->delivered[i]) {
+			sim->delivered[i] = 1;
+			sim->result.delivered++;
+		}
+	}
+}
+
+static size_t count_carried(const struct sim *sim, size_t node,
+			    size_t first_live)
+{
+	size_t count = 0;
+
+	for (size_t i = first_live; i < sim->bundle_count; i++)
+		count += sim->known[node][i];
+	return count;
+}
+
+static int encounter(struct sim *sim, size_t a, size_t b, uint32_t step,
+		     size_t first_live, struct perf_counter *counter)
+{
+	const uint64_t time_ms = (uint64_t)step * STEP_MS;
+	struct prophet_table table_a, table_b;
+	int rc = 0;
+
+	if (sim->scheme == SCHEME_EPIDEMIC) {
+		// Both nodes announce the bundles they carry
+		sim->result.bytes += 2 * SUMMARY_VECTOR_OVERHEAD + (
+			(count_carried(sim, a, first_live) +
+			 count_carried(sim, b, first_live)) *
+			SUMMARY_VECTOR_BITS_PER_BUNDLE + 7
+		) / 8;
+		forward_bundles(sim, a, b, step, first_live, NULL);
+		forward_bundles(sim, b, a, step, first_live, NULL);
+		return 0;
+	}
+
+	prophet_table_init(&table_a, &sim->atoms[b], time_ms);
+	prophet_table_init(&table_b, &sim->atoms[a], time_ms);
+	// Both tables are sent before any of them is updated
+	PERF(counter, rc = (
+		send_table(sim, a, b, time_ms, &table_a) ||
+		send_table(sim, b, a, time_ms, &table_b) ||
+		update_table(sim, a, b, time_ms, &table_a) ||
+		update_table(sim, b, a, time_ms, &table_b)
+	));
+	if (rc != 0) {
+		prophet_table_free(&table_a);
+		prophet_table_free(&table_b);
+		return -1;
+	}
+	forward_bundles(sim, a, b, step, first_live, &table_b);
+	forward_bundles(sim, b, a, step, first_live, &table_a);
+	prophet_table_free(&table_a);
+	prophet_table_free(&table_b);
+	return 0;
+}
+
+static int simulate(struct sim *sim, uint32_t seed,
+		    struct perf_counter *counter)
+{
+	uint32_t rng = seed;
+	size_t first_live = 0;
+
+	for (uint32_t step = 0; step < SIM_STEPS; step++) {
+		while (first_live < sim->bundle_count &&
+		       sim->bundles[first_live].created_step +
+		       BUNDLE_TTL_STEPS <= step)
+			first_live++;
+
+		if (step % BUNDLE_INTERVAL_STEPS == 0) {
+			struct sim_bundle *const bundle =
+				&sim->bundles[sim->bundle_count];
+
+			bundle->source = xorshift32(&rng) % NODE_COUNT;
+			do {
+				bundle->destination =
+					xorshift32(&rng) % NODE_COUNT;
+			} while (bundle->destination == bundle->source);
+			bundle->created_step = step;
+			sim->known[bundle->source][sim->bundle_count] = 1;
+			sim->bundle_count++;
+			sim->result.created++;
+		}
+
+		for (size_t e = 0; e < ENCOUNTERS_PER_STEP; e++) {
+			const size_t a = xorshift32(&rng) % NODE_COUNT;
+			size_t b;
+
+			do {
+				if (xorshift32(&rng) % 100 <
+				    COMMUNITY_ENCOUNTER_PERCENT)
+					b = (
+						a - a % COMMUNITY_SIZE +
+						xorshift32(&rng) %
+						COMMUNITY_SIZE
+					);
+				else
+					b = xorshift32(&rng) % NODE_COUNT;
+			} while (b == a);
+
+			if (encounter(sim, a, b, step, first_live,
+				      counter) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static void report(const char *name, const struct sim_result *r)
+{
+	printf(
+		"%-8s delivered %5.1f %% of %llu bundles, %llu transmissions, %llu kB transmitted (%llu B per delivered bundle)\n",
+		name,
+		r->created ? 100.0 * r->delivered / r->created : 0.0,
+		(unsigned long long)r->created,
+		(unsigned long long)r->transmissions,
+		(unsigned long long)(r->bytes / 1000),
+		(unsigned long long)(r->delivered ? r->bytes / r->delivered : 0)
+	);
+}
+
+int bench_prophet(struct perf_counter *counter, size_t iterations)
+{
+	// Every run simulates a network with a different seed
+	const size_t runs = MAX((size_t)1, iterations / 100);
+	struct sim *const sim = malloc(sizeof(struct sim));
+	struct sim_result totals[2] = { { 0 } };
+	const enum scheme schemes[] = { SCHEME_EPIDEMIC, SCHEME_PROPHET };
+
+	if (sim == NULL)
+		return -1;
+
+	perf_counter_reset(counter);
+	for (size_t s = 0; s < ARRAY_LENGTH(schemes); s++) {
+		for (size_t run = 0; run < runs; run++) {
+			sim_init(sim, schemes[s]);
+			if (simulate(sim, 0x12345678 + run, counter) != 0) {
+				sim_free(sim);
+				free(sim);
+				return -1;
+			}
+			totals[s].delivered += sim->result.delivered;
+			totals[s].created += sim->result.created;
+			totals[s].transmissions += sim->result.transmissions;
+			totals[s].bytes += sim->result.bytes;
+			sim_free(sim);
+		}
+	}
+	free(sim);
+
+	perf_counter_report(counter, "table exchange per encounter");
+	report("epidemic", &totals[0]);
+	report("prophet", &totals[1]);
+	return 0;
+}
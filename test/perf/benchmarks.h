@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef UD3TNPERF_BENCHMARKS_H_INCLUDED
+#define UD3TNPERF_BENCHMARKS_H_INCLUDED
+
+#include "perf.h"
+
+#include <stddef.h>
+
+/**
+ * A benchmark runs a fixed workload the given number of times and prints
+ * the average cost per operation. Returns zero on success.
+ */
+typedef int (*benchmark_func_t)(struct perf_counter *counter,
+				size_t iterations);
+
+int bench_bundle7_parser(struct perf_counter *counter, size_t iterations);
+int bench_cgr(struct perf_counter *counter, size_t iterations);
+int bench_config_plan(struct perf_counter *counter, size_t iterations);
+int bench_contact_plan(struct perf_counter *counter, size_t iterations);
+int bench_contact_queue(struct perf_counter *counter, size_t iterations);
+int bench_crc(struct perf_counter *counter, size_t iterations);
+int bench_hashmap(struct perf_counter *counter, size_t iterations);
+int bench_prophet(struct perf_counter *counter, size_t iterations);
+
+#endif // UD3TNPERF_BENCHMARKS_H_INCLUDED
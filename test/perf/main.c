@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "benchmarks.h"
+#include "perf.h"
+
+#include "platform/hal_platform.h"
+
+#include "ud3tn/common.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_ITERATIONS 1000
+
+static const struct {
+	const char *name;
+	const char *description;
+	benchmark_func_t func;
+} benchmarks[] = {
+	{
+		"bundle7-parser",
+		"BPv7 streaming parser vs. one-shot zero-copy parser",
+		bench_bundle7_parser,
+	},
+	{
+		"cgr",
+		"Contact Graph Routing for plans of 100, 1k and 10k contacts",
+		bench_cgr,
+	},
+	{
+		"config-plan",
+		"Ingesting contact plans of up to 100k contacts via the config agent",
+		bench_config_plan,
+	},
+	{
+		"contact-plan",
+		"Loading and updating contact plans of up to 100k contacts",
+		bench_contact_plan,
+	},
+	{
+		"contact-queue",
+		"Queuing, removal and hand-over of bundles routed via a contact",
+		bench_contact_queue,
+	},
+	{
+		"crc",
+		"CRC-32-C and CRC-16 X.25 throughput per implementation",
+		bench_crc,
+	},
+	{
+		"hashmap",
+		"EID hash map operations with 100, 10k and 1M entries",
+		bench_hashmap,
+	},
+	{
+		"prophet",
+		"Simulated delivery ratio and bytes of PRoPHET vs. epidemic",
+		bench_prophet,
+	},
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: ud3tnperf <benchmark|all> [iterations]\n\n"
+		"<benchmark> may be one of the following:\n");
+	for (size_t i = 0; i < ARRAY_LENGTH(benchmarks); i++)
+		fprintf(stderr, "    %-20s - %s\n",
+			benchmarks[i].name, benchmarks[i].description);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || argc > 3 || strcmp(argv[1], "-h") == 0) {
+		usage();
+		return argc < 2 || argc > 3;
+	}
+
+	size_t iterations = DEFAULT_ITERATIONS;
+
+	if (argc == 3) {
+		iterations = strtoul(argv[2], NULL, 10);
+		if (iterations == 0) {
+			usage();
+			return 1;
+		}
+	}
+
+	hal_platform_init(argc, argv);
+
+	struct perf_counter counter;
+	bool found = false;
+	int rc = 0;
+
+	perf_counter_init(&counter);
+	for (size_t i = 0; i < ARRAY_LENGTH(benchmarks); i++) {
+		if (strcmp(argv[1], "all") != 0 &&
+		    strcmp(argv[1], benchmarks[i].name) != 0)
+			continue;
+		found = true;
+		printf("## %s\n", benchmarks[i].name);
+		if (benchmarks[i].func(&counter, iterations) != 0) {
+			fprintf(stderr, "Benchmark %s failed\n",
+				benchmarks[i].name);
+			rc = 1;
+		}
+	}
+	perf_counter_deinit(&counter);
+
+	if (!found) {
+		usage();
+		return 1;
+	}
+
+	return rc;
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "perf.h"
+
+#include <linux/perf_event.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static long perf_event_open(struct perf_event_attr *hw_event, pid_t pid,
+			    int cpu, int group_fd, unsigned long flags)
+{
+	return syscall(__NR_perf_event_open, hw_event, pid, cpu,
+		       group_fd, flags);
+}
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void perf_counter_init(struct perf_counter *counter)
+{
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof(struct perf_event_attr));
+	pe.type = PERF_TYPE_HARDWARE;
+	pe.size = sizeof(struct perf_event_attr);
+	pe.config = PERF_COUNT_HW_CPU_CYCLES;
+	pe.disabled = 1;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+
+	counter->fd = perf_event_open(&pe, 0, -1, -1, 0);
+	if (counter->fd == -1)
+		fprintf(stderr,
+			"perf_event_open failed, falling back to wall-clock time\n");
+	perf_counter_reset(counter);
+}
+
+void perf_counter_deinit(struct perf_counter *counter)
+{
+	if (counter->fd != -1)
+		close(counter->fd);
+	counter->fd = -1;
+}
+
+bool perf_counter_is_hw(const struct perf_counter *counter)
+{
+	return counter->fd != -1;
+}
+
+const char *perf_counter_unit(const struct perf_counter *counter)
+{
+	return perf_counter_is_hw(counter) ? "cycles" : "ns";
+}
+
+void perf_counter_reset(struct perf_counter *counter)
+{
+	counter->total = 0;
+	counter->runs = 0;
+}
+
+void perf_counter_start(struct perf_counter *counter)
+{
+	if (perf_counter_is_hw(counter)) {
+		ioctl(counter->fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter->fd, PERF_EVENT_IOC_ENABLE, 0);
+	} else {
+		counter->start = monotonic_ns();
+	}
+}
+
+void perf_counter_stop(struct perf_counter *counter)
+{
+	long long count = 0;
+
+	if (perf_counter_is_hw(counter)) {
+		ioctl(counter->fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(counter->fd, &count, sizeof(long long)) !=
+				sizeof(long long))
+			count = 0;
+	} else {
+		count = (long long)(monotonic_ns() - counter->start);
+	}
+
+	counter->total += (uint64_t)count;
+	counter->runs++;
+}
+
+void perf_counter_report(const struct perf_counter *counter,
+			 const char *label)
+{
+	printf("%-40s %12" PRIu64 " %s/run (%" PRIu64 " runs)\n",
+	       label,
+	       counter->runs ? counter->total / counter->runs : 0,
+	       perf_counter_unit(counter),
+	       counter->runs);
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#ifndef UD3TNPERF_PERF_H_INCLUDED
+#define UD3TNPERF_PERF_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Measurement helpers following doc/perf_events.md
+ *
+ * CPU cycles are counted via the perf_events interface of the Linux kernel.
+ * If hardware counters are not available (e.g. in a VM or container without
+ * perf access), the monotonic clock is used instead and results are reported
+ * in nanoseconds.
+ */
+struct perf_counter {
+	int fd;
+	uint64_t start;
+	uint64_t total;
+	uint64_t runs;
+};
+
+/**
+ * Opens the CPU cycle counter for the calling thread.
+ */
+void perf_counter_init(struct perf_counter *counter);
+
+void perf_counter_deinit(struct perf_counter *counter);
+
+/**
+ * Returns whether the counter uses hardware cycles (or nanoseconds).
+ */
+bool perf_counter_is_hw(const struct perf_counter *counter);
+
+const char *perf_counter_unit(const struct perf_counter *counter);
+
+void perf_counter_reset(struct perf_counter *counter);
+
+void perf_counter_start(struct perf_counter *counter);
+
+void perf_counter_stop(struct perf_counter *counter);
+
+/**
+ * Counts the cycles spent in the given expression and adds them to the
+ * counter total.
+ */
+#define PERF(counter, expr) do { \
+	perf_counter_start(counter); \
+	expr; \
+	perf_counter_stop(counter); \
+} while (0)
+
+/**
+ * Prints the average count per run for the given label.
+ */
+void perf_counter_report(const struct perf_counter *counter,
+			 const char *label);
+
+#endif // UD3TNPERF_PERF_H_INCLUDED
@@ -4,9 +4,21 @@
 void testud3tn(void)
 {
 	RUN_TEST_GROUP(simplehtab);
+	RUN_TEST_GROUP(hashmap);
+	RUN_TEST_GROUP(min_heap);
+	RUN_TEST_GROUP(token_bucket);
 	RUN_TEST_GROUP(sdnv);
 	RUN_TEST_GROUP(node);
+	RUN_TEST_GROUP(contact_index);
 	RUN_TEST_GROUP(routingTable);
+	RUN_TEST_GROUP(routing_table_snapshot);
+	RUN_TEST_GROUP(known_bundle_journal);
+	RUN_TEST_GROUP(routedBundleQueue);
+	RUN_TEST_GROUP(router);
+	RUN_TEST_GROUP(summary_vector);
+	RUN_TEST_GROUP(prophet);
+	RUN_TEST_GROUP(spray_and_wait);
+	RUN_TEST_GROUP(cgr);
 	RUN_TEST_GROUP(eid);
 	RUN_TEST_GROUP(crc);
 	RUN_TEST_GROUP(bundle6Create);
@@ -19,12 +31,14 @@ void testud3tn(void)
 	RUN_TEST_GROUP(spp);
 	RUN_TEST_GROUP(spp_parser);
 	RUN_TEST_GROUP(spp_timecodes);
+	RUN_TEST_GROUP(cla_tx_scheduler);
 	RUN_TEST_GROUP(aap);
 	RUN_TEST_GROUP(aap_parser);
 	RUN_TEST_GROUP(aap_serializer);
 	RUN_TEST_GROUP(bibe_header_encoder);
 	RUN_TEST_GROUP(bibe_parser);
 	RUN_TEST_GROUP(bibe_validation);
+	RUN_TEST_GROUP(config_plan_parser);
 	RUN_TEST_GROUP(bundle);
 #ifdef PLATFORM_POSIX
 	RUN_TEST_GROUP(simple_queue);
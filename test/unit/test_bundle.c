@@ -891,6 +891,89 @@ TEST(bundle, bundle_to_adu)
 	bundle_adu_free_members(adu);
 }
 
+TEST(bundle, bundle_block_alloc_data)
+{
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD);
+
+	TEST_ASSERT_NOT_NULL(block);
+
+	// Small data stays on the heap
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_block_alloc_data(block, 16));
+	TEST_ASSERT_NULL(block->buffer);
+	TEST_ASSERT_NOT_NULL(block->data);
+	TEST_ASSERT_EQUAL_UINT32(16, block->length);
+
+	if (BUNDLE_PAYLOAD_SPILL_THRESHOLD == 0) {
+		bundle_block_free(block);
+		return;
+	}
+
+	// Large data is spilled to a file, replacing the heap allocation
+	const size_t length = BUNDLE_PAYLOAD_SPILL_THRESHOLD;
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_block_alloc_data(block, length));
+	TEST_ASSERT_NOT_NULL(block->buffer);
+	TEST_ASSERT_EQUAL(PAYLOAD_BACKING_FILE, block->buffer->backing);
+	TEST_ASSERT_EQUAL_PTR(block->buffer->data, block->data);
+	memset(block->data, 0x42, length);
+	block->data[length - 1] = 0x43;
+
+	struct bundle_block *dup = bundle_block_dup(block);
+
+	TEST_ASSERT_NOT_NULL(dup);
+	TEST_ASSERT_NOT_NULL(dup->buffer);
+	TEST_ASSERT_EQUAL_UINT8(0x43, dup->data[length - 1]);
+	TEST_ASSERT_EQUAL_MEMORY(block->data, dup->data, length);
+	bundle_block_free(dup);
+
+	// Truncation keeps the file-backed buffer
+	bundle_block_truncate_data(block, 8);
+	TEST_ASSERT_EQUAL_UINT32(8, block->length);
+	TEST_ASSERT_NOT_NULL(block->buffer);
+	TEST_ASSERT_EQUAL_UINT8(0x42, block->data[7]);
+
+	bundle_block_free(block);
+}
+
+TEST(bundle, bundle_adu_take_payload)
+{
+	struct bundle *bundle = bundle_init();
+
+	bundle->source = strdup("dtn://source.dtn/");
+	bundle->destination = strdup("dtn://dest.dtn/");
+	bundle->payload_block = bundle_block_create(BUNDLE_BLOCK_TYPE_PAYLOAD);
+	bundle->blocks = bundle_block_entry_create(bundle->payload_block);
+
+	const size_t length = (
+		BUNDLE_PAYLOAD_SPILL_THRESHOLD != 0
+		? BUNDLE_PAYLOAD_SPILL_THRESHOLD
+		: 32
+	);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_block_alloc_data(
+		bundle->payload_block, length));
+	memset(bundle->payload_block->data, 0x17, length);
+
+	struct bundle_adu adu = bundle_to_adu(bundle);
+
+	TEST_ASSERT_NULL(bundle->payload_block->buffer);
+	TEST_ASSERT_NULL(bundle->payload_block->data);
+	TEST_ASSERT_EQUAL(length, adu.length);
+	bundle_free(bundle);
+
+	uint8_t *payload = bundle_adu_take_payload(&adu);
+
+	TEST_ASSERT_NOT_NULL(payload);
+	TEST_ASSERT_NULL(adu.payload);
+	TEST_ASSERT_NULL(adu.payload_buffer);
+	TEST_ASSERT_EQUAL_UINT8(0x17, payload[0]);
+	TEST_ASSERT_EQUAL_UINT8(0x17, payload[length - 1]);
+	free(payload);
+
+	bundle_adu_free_members(adu);
+}
+
 
 TEST_GROUP_RUNNER(bundle)
 {
@@ -919,4 +1002,6 @@ TEST_GROUP_RUNNER(bundle)
 	RUN_TEST_CASE(bundle, bundle_is_equal);
 	RUN_TEST_CASE(bundle, bundle_adu_init);
 	RUN_TEST_CASE(bundle, bundle_to_adu);
+	RUN_TEST_CASE(bundle, bundle_block_alloc_data);
+	RUN_TEST_CASE(bundle, bundle_adu_take_payload);
 }
@@ -4,6 +4,8 @@
 #include "bundle7/fragment.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/bundle_fragmenter.h"
+#include "ud3tn/payload.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -160,7 +162,82 @@ TEST(bundle7Fragmentation, fragment_bundle)
 	TEST_ASSERT_NULL(entry->next);
 }
 
+TEST(bundle7Fragmentation, fragments_share_payload)
+{
+	const char *const payload = "Hello world, this is a fragment test!";
+	const size_t payload_length = strlen(payload);
+
+	bundle = bundle_init();
+	TEST_ASSERT_NOT_NULL(bundle);
+
+	bundle->protocol_version = 7;
+	bundle->crc_type = BUNDLE_CRC_TYPE_NONE;
+	bundle->destination = strdup("dtn://GS2/");
+	bundle->source = strdup("dtn://GS4/");
+	bundle->report_to = strdup("dtn:none");
+	bundle->lifetime_ms = 86400;
+
+	struct bundle_block *block = bundle_block_create(
+		BUNDLE_BLOCK_TYPE_PAYLOAD
+	);
+
+	TEST_ASSERT_NOT_NULL(block);
+	bundle->blocks = bundle_block_entry_create(block);
+	TEST_ASSERT_NOT_NULL(bundle->blocks);
+	bundle->payload_block = block;
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_block_alloc_data(
+		block,
+		payload_length
+	));
+	memcpy(block->data, payload, payload_length);
+
+	// Duplicating the bundle references the same payload data
+	struct bundle *first = bundlefragmenter_initialize_first_fragment(
+		bundle
+	);
+
+	TEST_ASSERT_NOT_NULL(first);
+	TEST_ASSERT_NOT_NULL(block->buffer);
+	TEST_ASSERT_EQUAL_PTR(block->buffer, first->payload_block->buffer);
+	TEST_ASSERT_EQUAL_PTR(block->data, first->payload_block->data);
+	TEST_ASSERT_EQUAL(2, block->buffer->ref_count);
+
+	const size_t first_length = 10;
+
+	fragment = bundle7_fragment_bundle(
+		first,
+		bundle_get_first_fragment_min_size(first) + first_length
+	);
+	TEST_ASSERT_NOT_NULL(fragment);
+	TEST_ASSERT_NOT_EQUAL(first, fragment);
+
+	// Both fragments are views into the payload of the original bundle
+	TEST_ASSERT_EQUAL(first_length, first->payload_block->length);
+	TEST_ASSERT_EQUAL(payload_length - first_length,
+			  fragment->payload_block->length);
+	TEST_ASSERT_EQUAL_PTR(block->buffer, fragment->payload_block->buffer);
+	TEST_ASSERT_EQUAL_PTR(block->data + first_length,
+			      fragment->payload_block->data);
+	TEST_ASSERT_EQUAL(3, block->buffer->ref_count);
+
+	// The data stays valid until the last fragment is released
+	struct payload_buffer *const buffer = block->buffer;
+
+	bundle_free(bundle);
+	bundle = NULL;
+	TEST_ASSERT_EQUAL(2, buffer->ref_count);
+	TEST_ASSERT_EQUAL_MEMORY(payload, first->payload_block->data,
+				 first_length);
+	TEST_ASSERT_EQUAL_MEMORY(payload + first_length,
+				 fragment->payload_block->data,
+				 payload_length - first_length);
+
+	bundle_free(first);
+	TEST_ASSERT_EQUAL(1, buffer->ref_count);
+}
+
 TEST_GROUP_RUNNER(bundle7Fragmentation)
 {
 	RUN_TEST_CASE(bundle7Fragmentation, fragment_bundle);
+	RUN_TEST_CASE(bundle7Fragmentation, fragments_share_payload);
 }
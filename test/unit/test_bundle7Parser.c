@@ -12,6 +12,7 @@
 #include "bundle7/bundle_age.h"
 
 #include "ud3tn/bundle.h"
+#include "ud3tn/payload.h"
 #include "ud3tn/report_manager.h"
 
 #include "testud3tn_unity.h"
@@ -406,6 +407,141 @@ TEST(bundle7Parser, invalid_crc_handling)
 	TEST_ASSERT_NULL(bundle);
 }
 
+// ----------------------------
+// One-shot parser (zero-copy)
+// ----------------------------
+
+static struct payload_buffer *copy_to_buffer(const uint8_t *data,
+	size_t length)
+{
+	uint8_t *const copy = malloc(length);
+
+	TEST_ASSERT_NOT_NULL(copy);
+	memcpy(copy, data, length);
+
+	struct payload_buffer *const buffer = payload_buffer_wrap(copy, length);
+
+	TEST_ASSERT_NOT_NULL(buffer);
+	return buffer;
+}
+
+TEST(bundle7Parser, buffer_parser)
+{
+	struct payload_buffer *source = copy_to_buffer(cbor_simple_bundle,
+		len_simple_bundle);
+	size_t consumed = 0;
+
+	bundle = bundle7_parse_buffer(source, &consumed);
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_EQUAL(len_simple_bundle, consumed);
+
+	// The source is referenced by the caller and by each of the 4 blocks
+	TEST_ASSERT_EQUAL(5, source->ref_count);
+
+	TEST_ASSERT_EQUAL(7, bundle->protocol_version);
+	TEST_ASSERT_EQUAL(658489863000, bundle->creation_timestamp_ms);
+	TEST_ASSERT_EQUAL(86400, bundle->lifetime_ms);
+	TEST_ASSERT_EQUAL_STRING("dtn:GS2", bundle->destination);
+	TEST_ASSERT_EQUAL_STRING("ipn:243.350", bundle->source);
+	TEST_ASSERT_EQUAL_STRING("dtn:none", bundle->report_to);
+	TEST_ASSERT_TRUE(bundle->proc_flags
+		& BUNDLE_FLAG_MUST_NOT_BE_FRAGMENTED);
+
+	struct bundle_block_list *block_element = bundle->blocks;
+
+	TEST_ASSERT_EQUAL(BUNDLE_BLOCK_TYPE_PREVIOUS_NODE,
+		block_element->data->type);
+	TEST_ASSERT_EQUAL(2, block_element->data->number);
+	TEST_ASSERT_EQUAL(6, block_element->data->length);
+	// Block data is a view into the source
+	TEST_ASSERT_EQUAL_PTR(source->data + 48, block_element->data->data);
+	TEST_ASSERT_EQUAL_PTR(source, block_element->data->buffer);
+
+	block_element = block_element->next->next->next;
+	TEST_ASSERT_EQUAL_PTR(block_element->data, bundle->payload_block);
+	TEST_ASSERT_NULL(block_element->next);
+	TEST_ASSERT_EQUAL(12, bundle->payload_block->length);
+	TEST_ASSERT_EQUAL_PTR(source->data + len_simple_bundle - 1 - 12,
+		bundle->payload_block->data);
+
+	// The views stay valid after the caller dropped its reference
+	payload_buffer_put(source);
+	TEST_ASSERT_EQUAL(4, source->ref_count);
+	TEST_ASSERT_EQUAL_INT8_ARRAY("Hello world!",
+		bundle->payload_block->data, 12);
+
+	TEST_ASSERT_EQUAL(len_simple_bundle,
+			  bundle_get_serialized_size(bundle));
+
+	// Trailing bytes are not consumed
+	uint8_t *padded = calloc(len_simple_bundle + 2, 1);
+
+	TEST_ASSERT_NOT_NULL(padded);
+	memcpy(padded, cbor_simple_bundle, len_simple_bundle);
+	source = payload_buffer_wrap(padded, len_simple_bundle + 2);
+	TEST_ASSERT_NOT_NULL(source);
+
+	struct bundle *other = bundle7_parse_buffer(source, &consumed);
+
+	TEST_ASSERT_NOT_NULL(other);
+	TEST_ASSERT_EQUAL(len_simple_bundle, consumed);
+	bundle_free(other);
+	TEST_ASSERT_EQUAL(1, source->ref_count);
+	payload_buffer_put(source);
+
+	// Truncated bundles are rejected
+	for (size_t length = 1; length < len_simple_bundle; length++) {
+		source = copy_to_buffer(cbor_simple_bundle, length);
+		TEST_ASSERT_NULL(bundle7_parse_buffer(source, NULL));
+		TEST_ASSERT_EQUAL(1, source->ref_count);
+		payload_buffer_put(source);
+	}
+}
+
+TEST(bundle7Parser, buffer_parser_crc)
+{
+	struct payload_buffer *source;
+
+	source = copy_to_buffer(cbor_crc16_primary_block,
+		len_crc16_primary_block);
+	bundle = bundle7_parse_buffer(source, NULL);
+	payload_buffer_put(source);
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_EQUAL(0x7123, bundle->crc.checksum);
+	bundle_free(bundle);
+
+	source = copy_to_buffer(cbor_crc16_payload_block,
+		len_crc16_payload_block);
+	bundle = bundle7_parse_buffer(source, NULL);
+	payload_buffer_put(source);
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_EQUAL(0x60d7, bundle->payload_block->crc.checksum);
+	bundle_free(bundle);
+
+	source = copy_to_buffer(cbor_crc32_primary_block,
+		len_crc32_primary_block);
+	bundle = bundle7_parse_buffer(source, NULL);
+	payload_buffer_put(source);
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_EQUAL(0x9542defd, bundle->crc.checksum);
+	bundle_free(bundle);
+
+	source = copy_to_buffer(cbor_crc32_payload_block,
+		len_crc32_payload_block);
+	bundle = bundle7_parse_buffer(source, NULL);
+	payload_buffer_put(source);
+	TEST_ASSERT_NOT_NULL(bundle);
+	TEST_ASSERT_EQUAL(0xc3aec552, bundle->payload_block->crc.checksum);
+	bundle_free(bundle);
+
+	// Bundles with an invalid CRC are rejected
+	source = copy_to_buffer(cbor_invalid_crc16, len_invalid_crc16);
+	bundle = bundle7_parse_buffer(source, NULL);
+	TEST_ASSERT_EQUAL(1, source->ref_count);
+	payload_buffer_put(source);
+	TEST_ASSERT_NULL(bundle);
+}
+
 static const uint8_t cbor_status_report[] = {
 	// [
 	//   1,                   // Record type code
@@ -531,6 +667,8 @@ TEST_GROUP_RUNNER(bundle7Parser)
 	RUN_TEST_CASE(bundle7Parser, crc16_verification);
 	RUN_TEST_CASE(bundle7Parser, crc32_verification);
 	RUN_TEST_CASE(bundle7Parser, invalid_crc_handling);
+	RUN_TEST_CASE(bundle7Parser, buffer_parser);
+	RUN_TEST_CASE(bundle7Parser, buffer_parser_crc);
 	RUN_TEST_CASE(bundle7Parser, status_report_parser);
 	RUN_TEST_CASE(bundle7Parser, hop_count);
 	RUN_TEST_CASE(bundle7Parser, bundle_age);
@@ -17,6 +17,7 @@
 
 #include "testud3tn_unity.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>  // malloc(), free()
 #include <string.h>  // memcpy()
@@ -159,6 +160,23 @@ TEST(bundle7Serializer, simple_bundle)
 	TEST_ASSERT_EQUAL(UD3TN_OK, bundle7_serialize(bundle, write, NULL));
 	TEST_ASSERT_EQUAL(len_simple_bundle, output_bytes);
 
+	// The scatter-gather variant produces the same bytes, referencing
+	// the block data in place instead of copying it.
+	struct bundle_serialized serialized;
+	bool payload_referenced = false;
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, bundle_serialize_iov(bundle, &serialized));
+	TEST_ASSERT_EQUAL(len_simple_bundle, serialized.length);
+	output_bytes = 0;
+	for (size_t i = 0; i < serialized.iov_count; i++) {
+		write(NULL, serialized.iov[i].base, serialized.iov[i].length);
+		if (serialized.iov[i].base == bundle->payload_block->data)
+			payload_referenced = true;
+	}
+	TEST_ASSERT_EQUAL(len_simple_bundle, output_bytes);
+	TEST_ASSERT_TRUE(payload_referenced);
+	bundle_serialized_free(&serialized);
+
 	bundle_free(bundle);
 }
 
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/cgr.h"
+#include "ud3tn/node.h"
+#include "ud3tn/routing_table.h"
+
+#include "platform/hal_time.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static struct rescheduling_handle rescheduler;
+static uint64_t now_ms;
+
+static void rescheduling_mock(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static void addeid(struct endpoint_list **list, const char *eid)
+{
+	struct endpoint_list *l = malloc(sizeof(struct endpoint_list));
+
+	l->eid = strdup(eid);
+	l->next = *list;
+	*list = l;
+}
+
+// Adds a contact starting and ending at the given offsets from the current
+// time, in seconds.
+static struct contact *addcontact(struct node *node,
+				  uint64_t from_s, uint64_t to_s)
+{
+	struct contact *c = contact_create(node);
+
+	c->from_ms = now_ms + from_s * 1000;
+	c->to_ms = now_ms + to_s * 1000;
+	c->bitrate_bytes_per_s = 1000;
+	add_contact_to_ordered_list(&node->contacts, c, 1);
+	return c;
+}
+
+static struct node *createnode(const char *eid, const char *cla_addr,
+			       uint64_t from_s, uint64_t to_s,
+			       struct contact **contact)
+{
+	struct node *node = node_create((char *)eid);
+	struct contact *c = addcontact(node, from_s, to_s);
+
+	if (cla_addr)
+		node->cla_addr = strdup(cla_addr);
+	if (contact)
+		*contact = c;
+	return node;
+}
+
+static void addnode(struct node *node)
+{
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node, 0));
+	TEST_ASSERT_TRUE(routing_table_add_node(node, rescheduler));
+}
+
+static size_t list_length(struct contact_list *cl)
+{
+	size_t length = 0;
+
+	for (; cl != NULL; cl = cl->next)
+		length++;
+	return length;
+}
+
+// Frees the list but not the contacts, which belong to the routing table
+static void free_list(struct contact_list *cl)
+{
+	while (cl != NULL) {
+		struct contact_list *next = cl->next;
+
+		free(cl);
+		cl = next;
+	}
+}
+
+TEST_GROUP(cgr);
+
+TEST_SETUP(cgr)
+{
+	rescheduler = (struct rescheduling_handle) {
+		.reschedule_func = rescheduling_mock,
+		.reschedule_func_context = NULL,
+	};
+	now_ms = hal_time_get_timestamp_ms();
+	routing_table_init();
+}
+
+TEST_TEAR_DOWN(cgr)
+{
+	cgr_free();
+	routing_table_free();
+}
+
+TEST(cgr, first_hops_ordered_by_arrival)
+{
+	struct node *a, *b;
+	struct contact *ca, *cb, *cc;
+	struct contact_list *cl;
+
+	a = createnode("dtn://a/", "cla:a", 100, 200, &ca);
+	addeid(&a->endpoints, "dtn://dest/");
+	b = createnode("dtn://b/", "cla:b", 50, 80, &cb);
+	addeid(&b->endpoints, "dtn://dest/");
+	addnode(a);
+	addnode(b);
+
+	TEST_ASSERT_NULL(cgr_lookup_first_hops("dtn://unknown/", UINT64_MAX));
+
+	cl = cgr_lookup_first_hops("dtn://dest/app", UINT64_MAX);
+	TEST_ASSERT_EQUAL(2, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(cb, cl->data);
+	TEST_ASSERT_EQUAL_PTR(ca, cl->next->data);
+	free_list(cl);
+
+	// Routes not arriving before the deadline are not returned
+	cl = cgr_lookup_first_hops("dtn://dest/", now_ms + 90000);
+	TEST_ASSERT_EQUAL(1, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(cb, cl->data);
+	free_list(cl);
+
+	// Cached routes are updated when the contact plan changes
+	TEST_ASSERT_TRUE(routing_table_delete_node_by_eid("dtn://b/",
+							  rescheduler));
+	cl = cgr_lookup_first_hops("dtn://dest/", UINT64_MAX);
+	TEST_ASSERT_EQUAL(1, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(ca, cl->data);
+	free_list(cl);
+
+	addnode(createnode("dtn://dest/", "cla:c", 10, 20, &cc));
+	cl = cgr_lookup_first_hops("dtn://dest/", UINT64_MAX);
+	TEST_ASSERT_EQUAL(2, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(cc, cl->data);
+	TEST_ASSERT_EQUAL_PTR(ca, cl->next->data);
+	free_list(cl);
+}
+
+#ifdef ROUTING_CGR
+
+TEST(cgr, multi_hop_routes)
+{
+	struct node *far;
+	struct contact *ca, *cb1, *cb2, *cf;
+	struct contact_list *cl;
+
+	addnode(createnode("dtn://a/", "cla:a", 100, 200, &ca));
+	addnode(createnode("dtn://b/", "cla:b", 10, 20, &cb1));
+	// b -> c ends before the contact to b starts, only a -> c is usable
+	far = createnode("dtn://c/", NULL, 0, 5, &cf);
+	addeid(&cf->contact_endpoints, "dtn://b/");
+	cf = addcontact(far, 150, 300);
+	addeid(&cf->contact_endpoints, "dtn://a/");
+	addnode(far);
+	far = createnode("dtn://d/", NULL, 400, 500, NULL);
+	addeid(&far->endpoints, "dtn://c/");
+	addnode(far);
+
+	cl = cgr_lookup_first_hops("dtn://d/", UINT64_MAX);
+	TEST_ASSERT_EQUAL(1, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(ca, cl->data);
+	free_list(cl);
+	TEST_ASSERT_NULL(cgr_lookup_first_hops("dtn://d/", now_ms + 390000));
+
+	// A new contact from b to c arrives earlier, also via a later
+	// contact to b
+	addnode(createnode("dtn://b/", "cla:b", 30, 40, &cb2));
+	far = createnode("dtn://c/", NULL, 120, 130, NULL);
+	addeid(&far->contacts->data->contact_endpoints, "dtn://b/");
+	addnode(far);
+	cl = cgr_lookup_first_hops("dtn://c/", UINT64_MAX);
+	TEST_ASSERT_EQUAL(3, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(cb1, cl->data);
+	TEST_ASSERT_EQUAL_PTR(cb2, cl->next->data);
+	TEST_ASSERT_EQUAL_PTR(ca, cl->next->next->data);
+	free_list(cl);
+	cl = cgr_lookup_first_hops("dtn://d/", now_ms + 450000);
+	TEST_ASSERT_EQUAL(3, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(cb1, cl->data);
+	free_list(cl);
+}
+
+TEST(cgr, contacts_without_senders)
+{
+	struct node *far;
+	struct contact *ca;
+	struct contact_list *cl;
+
+	addnode(createnode("dtn://a/", "cla:a", 100, 200, &ca));
+	addeid(&ca->contact_endpoints, "dtn://dest/");
+	// Contacts of a node without CLA address nor any sender do not lead
+	// to any edge, but still have to be accounted for in the graph.
+	far = createnode("dtn://c/", NULL, 10, 20, NULL);
+	addcontact(far, 30, 40);
+	addcontact(far, 50, 60);
+	addnode(far);
+
+	TEST_ASSERT_NULL(cgr_lookup_first_hops("dtn://c/", UINT64_MAX));
+	cl = cgr_lookup_first_hops("dtn://dest/", UINT64_MAX);
+	TEST_ASSERT_EQUAL(1, list_length(cl));
+	TEST_ASSERT_EQUAL_PTR(ca, cl->data);
+	free_list(cl);
+}
+
+#endif // ROUTING_CGR
+
+TEST_GROUP_RUNNER(cgr)
+{
+	RUN_TEST_CASE(cgr, first_hops_ordered_by_arrival);
+#ifdef ROUTING_CGR
+	RUN_TEST_CASE(cgr, multi_hop_routes);
+	RUN_TEST_CASE(cgr, contacts_without_senders);
+#endif // ROUTING_CGR
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "cla/cla_tx_scheduler.h"
+
+#include "ud3tn/bundle.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ITEM_COUNT 10
+
+static struct cla_tx_scheduler scheduler;
+static struct cla_tx_item *items[ITEM_COUNT];
+static size_t item_count;
+
+static struct cla_tx_item *add_item(const char *destination,
+				    enum bundle_routing_priority prio,
+				    uint64_t expiration_ms, size_t size)
+{
+	struct cla_tx_item *item = malloc(sizeof(struct cla_tx_item) + 1);
+
+	item->bundle = bundle_init();
+	item->bundle->destination = strdup(destination);
+	item->prio = prio;
+	item->expiration_ms = expiration_ms;
+	item->size = size;
+	item->cla_address[0] = '\0';
+	TEST_ASSERT_EQUAL(UD3TN_OK, cla_tx_scheduler_push(&scheduler, item));
+	items[item_count++] = item;
+	return item;
+}
+
+static void assert_order(const size_t *expected, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		TEST_ASSERT_EQUAL_PTR(items[expected[i]],
+				      cla_tx_scheduler_pop(&scheduler));
+	TEST_ASSERT_TRUE(cla_tx_scheduler_empty(&scheduler));
+	TEST_ASSERT_NULL(cla_tx_scheduler_pop(&scheduler));
+}
+
+TEST_GROUP(cla_tx_scheduler);
+
+TEST_SETUP(cla_tx_scheduler)
+{
+	item_count = 0;
+}
+
+TEST_TEAR_DOWN(cla_tx_scheduler)
+{
+	cla_tx_scheduler_free(&scheduler);
+	for (size_t i = 0; i < item_count; i++) {
+		bundle_free(items[i]->bundle);
+		free(items[i]);
+	}
+}
+
+TEST(cla_tx_scheduler, fifo)
+{
+	const size_t expected[] = { 0, 1, 2, 3 };
+
+	cla_tx_scheduler_init(&scheduler, CLA_TX_SCHEDULER_FIFO, 1000);
+	add_item("dtn://a/", BUNDLE_RPRIO_LOW, 4000, 100);
+	add_item("dtn://b/", BUNDLE_RPRIO_HIGH, 3000, 100);
+	add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 2000, 100);
+	add_item("dtn://b/", BUNDLE_RPRIO_HIGH, 1000, 100);
+	assert_order(expected, 4);
+}
+
+TEST(cla_tx_scheduler, priority)
+{
+	// A bulk bundle handed over earlier does not delay expedited ones,
+	// the order is kept within a priority.
+	const size_t expected[] = { 1, 4, 2, 3, 0 };
+
+	cla_tx_scheduler_init(&scheduler, CLA_TX_SCHEDULER_PRIORITY, 1000);
+	add_item("dtn://a/", BUNDLE_RPRIO_LOW, 1000, 1000000);
+	add_item("dtn://b/", BUNDLE_RPRIO_HIGH, 4000, 200);
+	add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 5000, 100);
+	add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 2000, 100);
+	add_item("dtn://a/", BUNDLE_RPRIO_HIGH, 3000, 200);
+	assert_order(expected, 5);
+}
+
+TEST(cla_tx_scheduler, edf)
+{
+	const size_t expected[] = { 3, 1, 2, 0 };
+
+	cla_tx_scheduler_init(&scheduler, CLA_TX_SCHEDULER_EDF, 1000);
+	add_item("dtn://a/", BUNDLE_RPRIO_HIGH, 4000, 100);
+	add_item("dtn://b/", BUNDLE_RPRIO_LOW, 2000, 100);
+	add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 3000, 100);
+	add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 1000, 100);
+	assert_order(expected, 4);
+}
+
+TEST(cla_tx_scheduler, drr)
+{
+	// Both destinations get the same share of bytes per round.
+	const size_t expected[] = { 0, 5, 1, 2, 6, 7, 3, 4, 8, 9 };
+
+	cla_tx_scheduler_init(&scheduler, CLA_TX_SCHEDULER_DRR, 1000);
+	for (int i = 0; i < 5; i++)
+		add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 1000, 600);
+	for (int i = 0; i < 5; i++)
+		add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 1000, 600);
+	assert_order(expected, 10);
+}
+
+TEST(cla_tx_scheduler, drr_large_bundle)
+{
+	// Small bundles to other destinations overtake the large one.
+	const size_t expected[] = { 1, 2, 3, 0, 4 };
+
+	cla_tx_scheduler_init(&scheduler, CLA_TX_SCHEDULER_DRR, 1000);
+	add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 1000, 100000);
+	add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 1000, 500);
+	add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 1000, 500);
+	add_item("dtn://b/", BUNDLE_RPRIO_NORMAL, 1000, 500);
+	assert_order(expected, 4);
+
+	// The destination is scheduled again after it has been served.
+	add_item("dtn://a/", BUNDLE_RPRIO_NORMAL, 1000, 100000);
+	assert_order(&expected[4], 1);
+}
+
+TEST_GROUP_RUNNER(cla_tx_scheduler)
+{
+	RUN_TEST_CASE(cla_tx_scheduler, fifo);
+	RUN_TEST_CASE(cla_tx_scheduler, priority);
+	RUN_TEST_CASE(cla_tx_scheduler, edf);
+	RUN_TEST_CASE(cla_tx_scheduler, drr);
+	RUN_TEST_CASE(cla_tx_scheduler, drr_large_bundle);
+}
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "agents/config_plan_parser.h"
+
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/router.h"
+
+#include "cbor.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+TEST_GROUP(config_plan_parser);
+
+static uint8_t buffer[512];
+static struct config_plan plan;
+
+static void encode_eids(CborEncoder *encoder, const char *const *eids,
+			size_t count)
+{
+	CborEncoder list;
+
+	cbor_encoder_create_array(encoder, &list, count);
+	for (size_t i = 0; i < count; i++)
+		cbor_encode_text_stringz(&list, eids[i]);
+	cbor_encoder_close_container(encoder, &list);
+}
+
+static void encode_contact(CborEncoder *encoder, uint64_t from_s,
+			   uint64_t to_s, uint64_t bitrate, const char *eid)
+{
+	CborEncoder contact;
+
+	cbor_encoder_create_array(encoder, &contact, 4);
+	cbor_encode_uint(&contact, from_s);
+	cbor_encode_uint(&contact, to_s);
+	cbor_encode_uint(&contact, bitrate);
+	encode_eids(&contact, &eid, eid ? 1 : 0);
+	cbor_encoder_close_container(encoder, &contact);
+}
+
+/*
+ * Encodes the plan used by most tests:
+ * 1(dtn://gs1.dtn/):(mtcp:127.0.0.1:4224):[(dtn://a.dtn/)]:
+ *	[{20,30,100,[(dtn://b.dtn/)]},{10,15,200}];
+ * 3(dtn://gs2.dtn/);
+ */
+static size_t encode_plan(uint64_t first_type)
+{
+	static const char *const eids[] = { "dtn://a.dtn/app" };
+	CborEncoder encoder, commands, command, contacts;
+
+	cbor_encoder_init(&encoder, buffer, sizeof(buffer), 0);
+	cbor_encoder_create_array(&encoder, &commands, 2);
+
+	cbor_encoder_create_array(&commands, &command, 5);
+	cbor_encode_uint(&command, first_type);
+	cbor_encode_text_stringz(&command, "dtn://gs1.dtn/");
+	cbor_encode_text_stringz(&command, "mtcp:127.0.0.1:4224");
+	encode_eids(&command, eids, 1);
+	cbor_encoder_create_array(&command, &contacts, 2);
+	encode_contact(&contacts, 20, 30, 100, "dtn://b.dtn/");
+	encode_contact(&contacts, 10, 15, 200, NULL);
+	cbor_encoder_close_container(&command, &contacts);
+	cbor_encoder_close_container(&commands, &command);
+
+	cbor_encoder_create_array(&commands, &command, 5);
+	cbor_encode_uint(&command, 3);
+	cbor_encode_text_stringz(&command, "dtn://gs2.dtn/");
+	cbor_encode_null(&command);
+	encode_eids(&command, NULL, 0);
+	encode_eids(&command, NULL, 0);
+	cbor_encoder_close_container(&commands, &command);
+
+	cbor_encoder_close_container(&encoder, &commands);
+	return cbor_encoder_get_buffer_size(&encoder, buffer);
+}
+
+TEST_SETUP(config_plan_parser)
+{
+	plan.commands = NULL;
+	plan.count = 0;
+}
+
+TEST_TEAR_DOWN(config_plan_parser)
+{
+	config_plan_free(&plan);
+}
+
+TEST(config_plan_parser, is_cbor)
+{
+	const size_t length = encode_plan(1);
+
+	TEST_ASSERT_TRUE(config_plan_is_cbor(buffer, length));
+	TEST_ASSERT_FALSE(config_plan_is_cbor(
+		(const uint8_t *)"1(dtn://gs1.dtn/);",
+		18
+	));
+	TEST_ASSERT_FALSE(config_plan_is_cbor(buffer, 0));
+}
+
+TEST(config_plan_parser, parse_plan)
+{
+	const size_t length = encode_plan(1);
+	struct node *node;
+	struct contact *contact;
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, config_plan_parse(&plan, buffer, length));
+	TEST_ASSERT_EQUAL(2, plan.count);
+
+	TEST_ASSERT_EQUAL(ROUTER_COMMAND_ADD, plan.commands[0].type);
+	node = plan.commands[0].data;
+	TEST_ASSERT_EQUAL_STRING("dtn://gs1.dtn/", node->eid);
+	TEST_ASSERT_EQUAL_STRING("mtcp:127.0.0.1:4224", node->cla_addr);
+	// EIDs are stored as node IDs, as by the ASCII parser
+	TEST_ASSERT_EQUAL_STRING("dtn://a.dtn/", node->endpoints->eid);
+	TEST_ASSERT_NULL(node->endpoints->next);
+
+	// Contacts are kept in the order of the plan, times are converted
+	contact = node->contacts->data;
+	TEST_ASSERT_EQUAL_PTR(node, contact->node);
+	TEST_ASSERT_EQUAL_UINT64(20000, contact->from_ms);
+	TEST_ASSERT_EQUAL_UINT64(30000, contact->to_ms);
+	TEST_ASSERT_EQUAL_UINT32(100, contact->bitrate_bytes_per_s);
+	TEST_ASSERT_EQUAL_STRING("dtn://b.dtn/",
+				 contact->contact_endpoints->eid);
+	contact = node->contacts->next->data;
+	TEST_ASSERT_EQUAL_UINT64(10000, contact->from_ms);
+	TEST_ASSERT_NULL(contact->contact_endpoints);
+	TEST_ASSERT_NULL(node->contacts->next->next);
+
+	TEST_ASSERT_EQUAL(ROUTER_COMMAND_DELETE, plan.commands[1].type);
+	node = plan.commands[1].data;
+	TEST_ASSERT_EQUAL_STRING("dtn://gs2.dtn/", node->eid);
+	TEST_ASSERT_NULL(node->cla_addr);
+	TEST_ASSERT_NULL(node->endpoints);
+	TEST_ASSERT_NULL(node->contacts);
+}
+
+TEST(config_plan_parser, invalid_plan)
+{
+	const size_t length = encode_plan(4);
+
+	// Querying is not supported as part of a plan
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, config_plan_parse(&plan, buffer, length));
+	TEST_ASSERT_NULL(plan.commands);
+	TEST_ASSERT_EQUAL(0, plan.count);
+
+	encode_plan(1);
+	// Truncated at every position, including within the second command
+	for (size_t i = 0; i < length; i++) {
+		TEST_ASSERT_EQUAL(UD3TN_FAIL,
+				  config_plan_parse(&plan, buffer, i));
+		TEST_ASSERT_NULL(plan.commands);
+	}
+
+	// Trailing data
+	TEST_ASSERT_EQUAL(UD3TN_FAIL,
+			  config_plan_parse(&plan, buffer, length + 1));
+	TEST_ASSERT_NULL(plan.commands);
+}
+
+TEST_GROUP_RUNNER(config_plan_parser)
+{
+	RUN_TEST_CASE(config_plan_parser, is_cbor);
+	RUN_TEST_CASE(config_plan_parser, parse_plan);
+	RUN_TEST_CASE(config_plan_parser, invalid_plan);
+}
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/contact_index.h"
+#include "ud3tn/node.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+TEST_GROUP(contact_index);
+
+#define CONTACT_COUNT 2000
+
+static struct contact_list *list;
+static struct contact_index cindex;
+static struct contact *contacts[CONTACT_COUNT];
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static size_t assert_sorted(void)
+{
+	size_t count = 0;
+
+	for (struct contact_list *cl = list; cl != NULL; cl = cl->next) {
+		if (cl->next != NULL)
+			TEST_ASSERT_TRUE(cl->data->to_ms <= cl->next->data->to_ms);
+		count++;
+	}
+	return count;
+}
+
+TEST_SETUP(contact_index)
+{
+	uint32_t rng = 0xBADC0DE;
+
+	list = NULL;
+	contact_index_init(&cindex, &list, false);
+	for (size_t i = 0; i < CONTACT_COUNT; i++) {
+		contacts[i] = contact_create(NULL);
+		// Many contacts end at the same time
+		contacts[i]->to_ms = xorshift32(&rng) % (CONTACT_COUNT / 4);
+		contacts[i]->from_ms = 0;
+	}
+}
+
+TEST_TEAR_DOWN(contact_index)
+{
+	for (size_t i = 0; i < CONTACT_COUNT; i++) {
+		contact_index_remove(&cindex, contacts[i]);
+		free_contact(contacts[i]);
+	}
+	TEST_ASSERT_NULL(list);
+	TEST_ASSERT_EQUAL(0, cindex.level);
+}
+
+TEST(contact_index, add_remove)
+{
+	size_t removed = 0;
+
+	for (size_t i = 0; i < CONTACT_COUNT; i++)
+		TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[i]));
+	TEST_ASSERT_FALSE(contact_index_add(&cindex, contacts[7]));
+	TEST_ASSERT_EQUAL(CONTACT_COUNT, assert_sorted());
+
+	for (size_t i = 0; i < CONTACT_COUNT; i += 2) {
+		TEST_ASSERT_TRUE(contact_index_remove(&cindex, contacts[i]));
+		TEST_ASSERT_FALSE(contact_index_remove(&cindex, contacts[i]));
+		removed++;
+	}
+	TEST_ASSERT_EQUAL(CONTACT_COUNT - removed, assert_sorted());
+
+	for (size_t i = 0; i < CONTACT_COUNT; i += 2)
+		TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[i]));
+	TEST_ASSERT_EQUAL(CONTACT_COUNT, assert_sorted());
+}
+
+TEST(contact_index, creation_order)
+{
+	// Added in reverse, contacts with equal times are ordered by creation
+	for (size_t i = CONTACT_COUNT; i-- > 0;) {
+		contacts[i]->to_ms = 42;
+		TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[i]));
+	}
+	TEST_ASSERT_FALSE(contact_index_add(&cindex, contacts[7]));
+	TEST_ASSERT_TRUE(contact_index_remove(&cindex, contacts[7]));
+	TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[7]));
+
+	struct contact_list *cl = list;
+
+	for (size_t i = 0; i < CONTACT_COUNT; i++, cl = cl->next)
+		TEST_ASSERT_EQUAL_PTR(contacts[i], cl->data);
+	TEST_ASSERT_NULL(cl);
+}
+
+TEST(contact_index, find_first)
+{
+	struct contact_list *cl;
+
+	for (size_t i = 0; i < CONTACT_COUNT; i++)
+		contact_index_add(&cindex, contacts[i]);
+
+	for (uint64_t t = 0; t <= CONTACT_COUNT / 4; t += 7) {
+		cl = contact_index_find_first(&cindex, t);
+		if (cl == NULL) {
+			for (size_t i = 0; i < CONTACT_COUNT; i++)
+				TEST_ASSERT_TRUE(contacts[i]->to_ms < t);
+			continue;
+		}
+		TEST_ASSERT_TRUE(cl->data->to_ms >= t);
+		// No entry before the result has a time at or after t
+		for (struct contact_list *p = list; p != cl; p = p->next)
+			TEST_ASSERT_TRUE(p->data->to_ms < t);
+	}
+	TEST_ASSERT_EQUAL_PTR(list, contact_index_find_first(&cindex, 0));
+}
+
+TEST(contact_index, changed_time)
+{
+	for (size_t i = 0; i < CONTACT_COUNT; i++)
+		contact_index_add(&cindex, contacts[i]);
+
+	// E.g. a contact merged with another one while being indexed
+	contacts[11]->to_ms = UINT64_MAX;
+	TEST_ASSERT_TRUE(contact_index_remove(&cindex, contacts[11]));
+	TEST_ASSERT_EQUAL(CONTACT_COUNT - 1, assert_sorted());
+}
+
+TEST(contact_index, free)
+{
+	for (size_t i = 0; i < CONTACT_COUNT; i++)
+		TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[i]));
+	contact_index_free(&cindex);
+	TEST_ASSERT_NULL(list);
+	TEST_ASSERT_EQUAL(0, cindex.level);
+
+	// The index can be used again
+	TEST_ASSERT_TRUE(contact_index_add(&cindex, contacts[0]));
+	TEST_ASSERT_EQUAL(1, assert_sorted());
+}
+
+TEST_GROUP_RUNNER(contact_index)
+{
+	RUN_TEST_CASE(contact_index, add_remove);
+	RUN_TEST_CASE(contact_index, creation_order);
+	RUN_TEST_CASE(contact_index, find_first);
+	RUN_TEST_CASE(contact_index, changed_time);
+	RUN_TEST_CASE(contact_index, free);
+}
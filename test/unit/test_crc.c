@@ -88,9 +88,112 @@ TEST(crc, crc32)
 	TEST_ASSERT_EQUAL_HEX32(0xee7f4af1, crc.checksum);
 }
 
+static uint32_t reference_crc(enum crc_version version,
+			      const uint8_t *data, size_t len)
+{
+	struct crc_stream crc;
+
+	crc_init(&crc, version);
+	for (size_t i = 0; i < len; i++)
+		crc.feed(&crc, data[i]);
+	crc.feed_eof(&crc);
+
+	return crc.checksum;
+}
+
+static uint32_t bulk_crc(enum crc_version version,
+			 const uint8_t *data, size_t len, size_t split)
+{
+	struct crc_stream crc;
+
+	crc_init(&crc, version);
+	crc_feed_bytes(&crc, data, split);
+	crc_feed_bytes(&crc, data + split, len - split);
+	crc.feed_eof(&crc);
+
+	return crc.checksum;
+}
+
+static void check_bit_exactness(void)
+{
+	uint8_t data[1031];
+	uint32_t state = 0x12345678;
+
+	// Deterministic pseudo-random data (xorshift32)
+	for (size_t i = 0; i < sizeof(data); i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		data[i] = (uint8_t)state;
+	}
+
+	// Check all lengths up to a few words and unaligned starts
+	for (size_t offset = 0; offset < 8; offset++) {
+		for (size_t len = 0; len < 80; len++) {
+			const uint8_t *const p = data + offset;
+
+			TEST_ASSERT_EQUAL_HEX16(
+				reference_crc(CRC16_X25, p, len),
+				crc16_x25(p, len));
+			TEST_ASSERT_EQUAL_HEX32(
+				reference_crc(CRC32, p, len),
+				crc32(p, len));
+			TEST_ASSERT_EQUAL_HEX16(
+				reference_crc(CRC16_X25, p, len),
+				bulk_crc(CRC16_X25, p, len, len / 3));
+			TEST_ASSERT_EQUAL_HEX32(
+				reference_crc(CRC32, p, len),
+				bulk_crc(CRC32, p, len, len / 3));
+			TEST_ASSERT_EQUAL_HEX16(
+				reference_crc(CRC16_CCITT_FALSE, p, len),
+				bulk_crc(CRC16_CCITT_FALSE, p, len, len / 3));
+		}
+
+		const size_t len = sizeof(data) - offset;
+
+		TEST_ASSERT_EQUAL_HEX16(
+			reference_crc(CRC16_X25, data + offset, len),
+			crc16_x25(data + offset, len));
+		TEST_ASSERT_EQUAL_HEX32(
+			reference_crc(CRC32, data + offset, len),
+			crc32(data + offset, len));
+		TEST_ASSERT_EQUAL_HEX32(
+			reference_crc(CRC32, data + offset, len),
+			bulk_crc(CRC32, data + offset, len, 13));
+	}
+
+	// Known values
+	TEST_ASSERT_EQUAL_HEX16(0xffce, crc16_x25(m4, sizeof(m4) - 1));
+	TEST_ASSERT_EQUAL_HEX32(0xee7f4af1, crc32(m4, sizeof(m4) - 1));
+}
+
+TEST(crc, implementations)
+{
+	const enum crc_implementation selected = crc_get_implementation();
+
+	TEST_ASSERT_EQUAL(crc_hardware_available() ?
+		CRC_IMPLEMENTATION_HARDWARE :
+		CRC_IMPLEMENTATION_SLICE_BY_8, selected);
+
+	TEST_ASSERT_TRUE(crc_set_implementation(CRC_IMPLEMENTATION_BYTEWISE));
+	check_bit_exactness();
+
+	TEST_ASSERT_TRUE(crc_set_implementation(
+		CRC_IMPLEMENTATION_SLICE_BY_8));
+	check_bit_exactness();
+
+	// Not all CPUs provide CRC instructions
+	TEST_ASSERT_EQUAL(crc_hardware_available(),
+		crc_set_implementation(CRC_IMPLEMENTATION_HARDWARE));
+	check_bit_exactness();
+
+	TEST_ASSERT_TRUE(crc_set_implementation(selected));
+}
+
 TEST_GROUP_RUNNER(crc)
 {
 	RUN_TEST_CASE(crc, crc16_x25);
 	RUN_TEST_CASE(crc, crc16_ccitt_false);
 	RUN_TEST_CASE(crc, crc32);
+	RUN_TEST_CASE(crc, implementations);
 }
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/hashmap.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+TEST_GROUP(hashmap);
+
+static struct hashmap map;
+
+TEST_SETUP(hashmap)
+{
+	hashmap_init(&map, 0);
+}
+
+TEST_TEAR_DOWN(hashmap)
+{
+	hashmap_deinit(&map);
+}
+
+TEST(hashmap, put_get_remove)
+{
+	int a, b;
+
+	TEST_ASSERT_NULL(hashmap_get(&map, "dtn://a/"));
+	TEST_ASSERT_NULL(hashmap_remove(&map, "dtn://a/"));
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashmap_put(&map, "dtn://a/", &a));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, hashmap_put(&map, "dtn://a/", &b));
+	TEST_ASSERT_EQUAL(UD3TN_OK, hashmap_put(&map, "dtn://b/", &b));
+	TEST_ASSERT_EQUAL(2, hashmap_count(&map));
+
+	TEST_ASSERT_EQUAL_PTR(&a, hashmap_get(&map, "dtn://a/"));
+	TEST_ASSERT_EQUAL_PTR(&b, hashmap_get(&map, "dtn://b/"));
+	TEST_ASSERT_NULL(hashmap_get(&map, "dtn://c/"));
+
+	TEST_ASSERT_EQUAL_PTR(&a, hashmap_remove(&map, "dtn://a/"));
+	TEST_ASSERT_NULL(hashmap_remove(&map, "dtn://a/"));
+	TEST_ASSERT_NULL(hashmap_get(&map, "dtn://a/"));
+	TEST_ASSERT_EQUAL_PTR(&b, hashmap_get(&map, "dtn://b/"));
+	TEST_ASSERT_EQUAL(1, hashmap_count(&map));
+}
+
+TEST(hashmap, grow_and_shrink)
+{
+	const uintptr_t count = 5000;
+	char key[32];
+
+	// Interleave insertions and removals so that removals also hit
+	// tables which are being migrated.
+	for (uintptr_t i = 1; i <= count; i++) {
+		snprintf(key, sizeof(key), "ipn:%lu.0", (unsigned long)i);
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  hashmap_put(&map, key, (void *)i));
+		if (i % 3 == 0) {
+			snprintf(key, sizeof(key), "ipn:%lu.0",
+				 (unsigned long)(i / 3));
+			TEST_ASSERT_EQUAL_PTR((void *)(i / 3),
+					      hashmap_remove(&map, key));
+		}
+	}
+	TEST_ASSERT_EQUAL(count - count / 3, hashmap_count(&map));
+	TEST_ASSERT_TRUE(map.capacity >= hashmap_count(&map));
+
+	for (uintptr_t i = 1; i <= count; i++) {
+		snprintf(key, sizeof(key), "ipn:%lu.0", (unsigned long)i);
+		TEST_ASSERT_EQUAL_PTR(i <= count / 3 ? NULL : (void *)i,
+				      hashmap_get(&map, key));
+	}
+
+	for (uintptr_t i = count / 3 + 1; i <= count; i++) {
+		snprintf(key, sizeof(key), "ipn:%lu.0", (unsigned long)i);
+		TEST_ASSERT_EQUAL_PTR((void *)i, hashmap_remove(&map, key));
+	}
+	TEST_ASSERT_EQUAL(0, hashmap_count(&map));
+	for (size_t i = 0; i < map.capacity; i++)
+		TEST_ASSERT_EQUAL(0, map.slots[i].hash);
+}
+
+TEST_GROUP_RUNNER(hashmap)
+{
+	RUN_TEST_CASE(hashmap, put_get_remove);
+	RUN_TEST_CASE(hashmap, grow_and_shrink);
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/known_bundle_journal.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(known_bundle_journal);
+
+static uint8_t journal[256];
+static size_t journal_length;
+
+static void append(enum known_bundle_journal_type type, const char *source,
+		   uint32_t fragment_offset, uint64_t deadline_ms)
+{
+	const struct known_bundle_journal_record record = {
+		.type = type,
+		.id = {
+			.protocol_version = 7,
+			.source = (char *)source,
+			.creation_timestamp_ms = 700000000000,
+			.sequence_number = 42,
+			.fragment_offset = fragment_offset,
+			.payload_length = 1000,
+		},
+		.deadline_ms = deadline_ms,
+	};
+	const size_t length = known_bundle_journal_encode(&record, NULL);
+
+	TEST_ASSERT_EQUAL(length, known_bundle_journal_encode(
+		&record,
+		&journal[journal_length]
+	));
+	journal_length += length;
+}
+
+TEST_SETUP(known_bundle_journal)
+{
+	journal_length = 0;
+	append(KNOWN_BUNDLE_JOURNAL_DELIVERED, "dtn://a.dtn/", 0, 1234);
+	append(KNOWN_BUNDLE_JOURNAL_FRAGMENT, "ipn:2.0", 500, UINT64_MAX);
+}
+
+TEST_TEAR_DOWN(known_bundle_journal)
+{
+}
+
+TEST(known_bundle_journal, decode)
+{
+	struct known_bundle_journal_record record;
+	size_t pos;
+
+	pos = known_bundle_journal_decode(journal, journal_length, &record);
+	TEST_ASSERT_NOT_EQUAL(0, pos);
+	TEST_ASSERT_EQUAL(KNOWN_BUNDLE_JOURNAL_DELIVERED, record.type);
+	TEST_ASSERT_EQUAL_UINT8(7, record.id.protocol_version);
+	TEST_ASSERT_EQUAL_STRING("dtn://a.dtn/", record.id.source);
+	TEST_ASSERT_EQUAL_UINT64(700000000000, record.id.creation_timestamp_ms);
+	TEST_ASSERT_EQUAL_UINT64(42, record.id.sequence_number);
+	TEST_ASSERT_EQUAL_UINT32(0, record.id.fragment_offset);
+	TEST_ASSERT_EQUAL_UINT32(1000, record.id.payload_length);
+	TEST_ASSERT_EQUAL_UINT64(1234, record.deadline_ms);
+	bundle_free_unique_identifier(&record.id);
+
+	pos += known_bundle_journal_decode(
+		&journal[pos],
+		journal_length - pos,
+		&record
+	);
+	TEST_ASSERT_EQUAL(journal_length, pos);
+	TEST_ASSERT_EQUAL(KNOWN_BUNDLE_JOURNAL_FRAGMENT, record.type);
+	TEST_ASSERT_EQUAL_STRING("ipn:2.0", record.id.source);
+	TEST_ASSERT_EQUAL_UINT32(500, record.id.fragment_offset);
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, record.deadline_ms);
+	bundle_free_unique_identifier(&record.id);
+}
+
+TEST(known_bundle_journal, incomplete_record)
+{
+	struct known_bundle_journal_record record;
+	const size_t first_length = known_bundle_journal_decode(
+		journal,
+		journal_length,
+		&record
+	);
+
+	bundle_free_unique_identifier(&record.id);
+
+	// The last record was interrupted while being appended
+	for (size_t i = first_length; i < journal_length; i++) {
+		TEST_ASSERT_EQUAL(0, known_bundle_journal_decode(
+			&journal[first_length],
+			i - first_length,
+			&record
+		));
+	}
+
+	// Corrupted records are detected by the checksum
+	journal[first_length + 5] ^= 0x01;
+	TEST_ASSERT_EQUAL(0, known_bundle_journal_decode(
+		&journal[first_length],
+		journal_length - first_length,
+		&record
+	));
+}
+
+TEST_GROUP_RUNNER(known_bundle_journal)
+{
+	RUN_TEST_CASE(known_bundle_journal, decode);
+	RUN_TEST_CASE(known_bundle_journal, incomplete_record);
+}
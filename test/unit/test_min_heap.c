@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/min_heap.h"
+
+#include "testud3tn_unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+TEST_GROUP(min_heap);
+
+#define ITEM_COUNT 500
+
+struct item {
+	uint64_t key;
+	size_t index;
+};
+
+static struct min_heap heap;
+static struct item items[ITEM_COUNT];
+
+static void set_index(void *data, size_t index)
+{
+	((struct item *)data)->index = index;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void assert_indices(void)
+{
+	for (size_t i = 0; i < heap.count; i++) {
+		const struct item *const item = heap.entries[i].data;
+
+		TEST_ASSERT_EQUAL(i, item->index);
+		TEST_ASSERT_EQUAL_UINT64(item->key, heap.entries[i].key);
+	}
+}
+
+static void assert_sorted_pop(size_t expected_count)
+{
+	uint64_t last = 0;
+	size_t count = 0;
+	struct item *item;
+
+	while ((item = min_heap_pop(&heap)) != NULL) {
+		TEST_ASSERT_TRUE(item->key >= last);
+		TEST_ASSERT_EQUAL(MIN_HEAP_NO_INDEX, item->index);
+		last = item->key;
+		count++;
+	}
+	TEST_ASSERT_EQUAL(expected_count, count);
+}
+
+TEST_SETUP(min_heap)
+{
+	uint32_t rng = 0xC0FFEE;
+
+	min_heap_init(&heap, set_index);
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		items[i].key = xorshift32(&rng) % 1000;
+		items[i].index = MIN_HEAP_NO_INDEX;
+	}
+}
+
+TEST_TEAR_DOWN(min_heap)
+{
+	min_heap_free(&heap);
+}
+
+TEST(min_heap, push_pop)
+{
+	TEST_ASSERT_NULL(min_heap_peek(&heap));
+	TEST_ASSERT_NULL(min_heap_pop(&heap));
+
+	for (size_t i = 0; i < ITEM_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  min_heap_push(&heap, items[i].key, &items[i]));
+	TEST_ASSERT_EQUAL(ITEM_COUNT, heap.count);
+	assert_indices();
+	assert_sorted_pop(ITEM_COUNT);
+}
+
+TEST(min_heap, remove_update)
+{
+	size_t removed = 0;
+
+	for (size_t i = 0; i < ITEM_COUNT; i++)
+		min_heap_push(&heap, items[i].key, &items[i]);
+
+	for (size_t i = 0; i < ITEM_COUNT; i += 3) {
+		TEST_ASSERT_EQUAL_PTR(&items[i],
+				      min_heap_remove(&heap, items[i].index));
+		TEST_ASSERT_EQUAL(MIN_HEAP_NO_INDEX, items[i].index);
+		removed++;
+	}
+	assert_indices();
+
+	// Move some items to the front and others to the back
+	for (size_t i = 1; i < ITEM_COUNT; i += 3) {
+		items[i].key = (i % 2) ? items[i].key / 2 : items[i].key + 1000;
+		min_heap_update(&heap, items[i].index, items[i].key);
+	}
+	assert_indices();
+	assert_sorted_pop(ITEM_COUNT - removed);
+}
+
+static void count_visited(void *data, void *context)
+{
+	const struct item *const item = data;
+	size_t *const visited = context;
+
+	TEST_ASSERT_TRUE(item->key <= 500);
+	(*visited)++;
+}
+
+TEST(min_heap, visit)
+{
+	size_t expected = 0, visited = 0;
+	uint64_t next = UINT64_MAX;
+
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, min_heap_visit(
+		&heap,
+		500,
+		count_visited,
+		&visited
+	));
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		min_heap_push(&heap, items[i].key, &items[i]);
+		if (items[i].key <= 500)
+			expected++;
+		else if (items[i].key < next)
+			next = items[i].key;
+	}
+
+	TEST_ASSERT_EQUAL_UINT64(next, min_heap_visit(
+		&heap,
+		500,
+		count_visited,
+		&visited
+	));
+	TEST_ASSERT_EQUAL(expected, visited);
+}
+
+TEST_GROUP_RUNNER(min_heap)
+{
+	RUN_TEST_CASE(min_heap, push_pop);
+	RUN_TEST_CASE(min_heap, remove_update);
+	RUN_TEST_CASE(min_heap, visit);
+}
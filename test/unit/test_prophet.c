@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/prophet.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define P_DELTA 0.0001f
+
+static struct prophet_atoms atoms;
+static struct prophet_table table;
+
+TEST_GROUP(prophet);
+
+TEST_SETUP(prophet)
+{
+	prophet_atoms_init(&atoms);
+	prophet_table_init(&table, &atoms, 0);
+}
+
+TEST_TEAR_DOWN(prophet)
+{
+	prophet_table_free(&table);
+	prophet_atoms_free(&atoms);
+}
+
+TEST(prophet, atoms)
+{
+	TEST_ASSERT_EQUAL(-1, prophet_atom_get(&atoms, "dtn://a/", false));
+	TEST_ASSERT_EQUAL(0, prophet_atom_get(&atoms, "dtn://a/", true));
+	TEST_ASSERT_EQUAL(1, prophet_atom_get(&atoms, "dtn://b/", true));
+	TEST_ASSERT_EQUAL(0, prophet_atom_get(&atoms, "dtn://a/", true));
+	TEST_ASSERT_EQUAL(1, prophet_atom_get(&atoms, "dtn://b/", false));
+	TEST_ASSERT_EQUAL(2, atoms.count);
+}
+
+TEST(prophet, encounter_and_aging)
+{
+	const int32_t b = prophet_atom_get(&atoms, "dtn://b/", true);
+
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, prophet_table_get(&table, b));
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_encounter(&table, b));
+	TEST_ASSERT_FLOAT_WITHIN(P_DELTA, PROPHET_P_ENCOUNTER,
+				 prophet_table_get(&table, b));
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_encounter(&table, b));
+	TEST_ASSERT_FLOAT_WITHIN(
+		P_DELTA,
+		PROPHET_P_ENCOUNTER +
+			(1.0f - PROPHET_P_ENCOUNTER) * PROPHET_P_ENCOUNTER,
+		prophet_table_get(&table, b)
+	);
+
+	const float p = prophet_table_get(&table, b);
+
+	// Less than one time unit does not change anything
+	prophet_table_age(&table, PROPHET_AGING_UNIT_MS - 1);
+	TEST_ASSERT_EQUAL_FLOAT(p, prophet_table_get(&table, b));
+	prophet_table_age(&table, 2 * PROPHET_AGING_UNIT_MS);
+	TEST_ASSERT_FLOAT_WITHIN(P_DELTA, p * PROPHET_GAMMA * PROPHET_GAMMA,
+				 prophet_table_get(&table, b));
+
+	// Eventually, the predictability decays to zero
+	prophet_table_age(&table, UINT32_MAX * (uint64_t)PROPHET_AGING_UNIT_MS);
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, prophet_table_get(&table, b));
+}
+
+TEST(prophet, transitivity)
+{
+	struct prophet_table peer_table;
+	const int32_t b = prophet_atom_get(&atoms, "dtn://b/", true);
+	const int32_t c = prophet_atom_get(&atoms, "dtn://c/", true);
+	const int32_t d = prophet_atom_get(&atoms, "dtn://d/", true);
+
+	prophet_table_init(&peer_table, &atoms, 0);
+	prophet_table_encounter(&peer_table, c);
+	prophet_table_encounter(&peer_table, d);
+	prophet_table_encounter(&peer_table, d);
+
+	// Only nodes encountered contribute to the predictabilities
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_transitive(
+		&table, b, &peer_table
+	));
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, prophet_table_get(&table, c));
+
+	prophet_table_encounter(&table, b);
+	prophet_table_encounter(&table, d);
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_transitive(
+		&table, b, &peer_table
+	));
+	TEST_ASSERT_FLOAT_WITHIN(
+		P_DELTA,
+		PROPHET_P_ENCOUNTER * PROPHET_P_ENCOUNTER * PROPHET_BETA,
+		prophet_table_get(&table, c)
+	);
+	// A higher direct predictability is kept
+	TEST_ASSERT_FLOAT_WITHIN(P_DELTA, PROPHET_P_ENCOUNTER,
+				 prophet_table_get(&table, d));
+	prophet_table_free(&peer_table);
+}
+
+TEST(prophet, serialize_parse)
+{
+	struct prophet_atoms peer_atoms;
+	struct prophet_table parsed;
+	size_t length;
+
+	prophet_table_encounter(&table, prophet_atom_get(
+		&atoms, "dtn://b/", true
+	));
+	// Not contained as its predictability is zero
+	prophet_atom_get(&atoms, "dtn://c/", true);
+	prophet_table_encounter(&table, prophet_atom_get(
+		&atoms, "ipn:42.0", true
+	));
+
+	uint8_t *data = prophet_table_serialize(&table, &atoms, &length);
+
+	TEST_ASSERT_NOT_NULL(data);
+
+	// The atoms of the peer differ from the local ones
+	prophet_atoms_init(&peer_atoms);
+	prophet_atom_get(&peer_atoms, "ipn:42.0", true);
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_parse(
+		&parsed, &peer_atoms, data, length, 0
+	));
+	TEST_ASSERT_EQUAL(2, peer_atoms.count);
+	TEST_ASSERT_FLOAT_WITHIN(P_DELTA, PROPHET_P_ENCOUNTER, prophet_table_get(
+		&parsed, prophet_atom_get(&peer_atoms, "dtn://b/", false)
+	));
+	TEST_ASSERT_FLOAT_WITHIN(P_DELTA, PROPHET_P_ENCOUNTER, prophet_table_get(
+		&parsed, prophet_atom_get(&peer_atoms, "ipn:42.0", false)
+	));
+	prophet_table_free(&parsed);
+
+	// Only the EIDs known or of a relevant predictability are taken over
+	prophet_atoms_free(&peer_atoms);
+	prophet_atoms_init(&peer_atoms);
+	prophet_table_age(&table, 300 * PROPHET_AGING_UNIT_MS);
+	TEST_ASSERT_TRUE(prophet_table_get(&table, prophet_atom_get(
+		&atoms, "dtn://b/", false
+	)) < PROPHET_P_INTERN);
+	free(data);
+	data = prophet_table_serialize(&table, &atoms, &length);
+	TEST_ASSERT_NOT_NULL(data);
+	prophet_atom_get(&peer_atoms, "ipn:42.0", true);
+	TEST_ASSERT_EQUAL(UD3TN_OK, prophet_table_parse(
+		&parsed, &peer_atoms, data, length, 0
+	));
+	TEST_ASSERT_EQUAL(-1, prophet_atom_get(&peer_atoms, "dtn://b/", false));
+	TEST_ASSERT_TRUE(prophet_table_get(&parsed, prophet_atom_get(
+		&peer_atoms, "ipn:42.0", false
+	)) > 0.0f);
+	prophet_table_free(&parsed);
+
+	// Malformed data is rejected
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, prophet_table_parse(
+		&parsed, &peer_atoms, data, length - 1, 0
+	));
+	data[0] = 0;
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, prophet_table_parse(
+		&parsed, &peer_atoms, data, length, 0
+	));
+
+	free(data);
+	prophet_atoms_free(&peer_atoms);
+}
+
+TEST(prophet, release_atoms)
+{
+	struct prophet_table peer_table;
+	const int32_t b = prophet_atom_get(&atoms, "dtn://b/", true);
+	const int32_t c = prophet_atom_get(&atoms, "dtn://c/", true);
+
+	prophet_table_init(&peer_table, &atoms, 0);
+	prophet_table_encounter(&table, b);
+	prophet_table_encounter(&peer_table, c);
+
+	// Kept as long as any table has a predictability for it
+	prophet_table_age(&table, UINT32_MAX * (uint64_t)PROPHET_AGING_UNIT_MS);
+	TEST_ASSERT_EQUAL(-1, prophet_atom_get(&atoms, "dtn://b/", false));
+	TEST_ASSERT_EQUAL(c, prophet_atom_get(&atoms, "dtn://c/", false));
+	prophet_table_free(&peer_table);
+	TEST_ASSERT_EQUAL(-1, prophet_atom_get(&atoms, "dtn://c/", false));
+
+	// Released atoms are assigned again
+	TEST_ASSERT_NOT_EQUAL(-1, prophet_atom_get(&atoms, "dtn://d/", true));
+	TEST_ASSERT_NOT_EQUAL(-1, prophet_atom_get(&atoms, "dtn://e/", true));
+	TEST_ASSERT_EQUAL(2, atoms.count);
+}
+
+TEST_GROUP_RUNNER(prophet)
+{
+	RUN_TEST_CASE(prophet, atoms);
+	RUN_TEST_CASE(prophet, encounter_and_aging);
+	RUN_TEST_CASE(prophet, transitivity);
+	RUN_TEST_CASE(prophet, serialize_parse);
+	RUN_TEST_CASE(prophet, release_atoms);
+}
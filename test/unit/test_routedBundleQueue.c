@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/routed_bundle_queue.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdlib.h>
+
+#define BUNDLE_COUNT 6
+
+static struct routed_bundle_queue queue, other_queue;
+static struct bundle *bundles[BUNDLE_COUNT];
+
+static struct bundle *create_bundle(enum bundle_routing_priority prio,
+				    uint64_t expiration_ms)
+{
+	struct bundle *b = bundle_init();
+
+	b->protocol_version = 7;
+	b->creation_timestamp_ms = 1;
+	b->lifetime_ms = expiration_ms - 1;
+	if (prio == BUNDLE_RPRIO_HIGH) {
+		b->ret_constraints = BUNDLE_RET_CONSTRAINT_FLAG_OWN;
+	} else if (prio == BUNDLE_RPRIO_LOW) {
+		b->protocol_version = 6;
+		b->proc_flags = BUNDLE_FLAG_NONE;
+	}
+	TEST_ASSERT_EQUAL(prio, bundle_get_routing_priority(b));
+	return b;
+}
+
+static void free_list(struct routed_bundle_list *list)
+{
+	while (list != NULL) {
+		struct routed_bundle_list *next = list->next;
+
+		free(list);
+		list = next;
+	}
+}
+
+TEST_GROUP(routedBundleQueue);
+
+TEST_SETUP(routedBundleQueue)
+{
+	routed_bundle_queue_init(&queue);
+	routed_bundle_queue_init(&other_queue);
+	bundles[0] = create_bundle(BUNDLE_RPRIO_NORMAL, 3000);
+	bundles[1] = create_bundle(BUNDLE_RPRIO_LOW, 1000);
+	bundles[2] = create_bundle(BUNDLE_RPRIO_HIGH, 4000);
+	bundles[3] = create_bundle(BUNDLE_RPRIO_NORMAL, 2000);
+	bundles[4] = create_bundle(BUNDLE_RPRIO_HIGH, 5000);
+	bundles[5] = create_bundle(BUNDLE_RPRIO_NORMAL, 1000);
+}
+
+TEST_TEAR_DOWN(routedBundleQueue)
+{
+	routed_bundle_queue_clear(&queue);
+	routed_bundle_queue_clear(&other_queue);
+	for (int i = 0; i < BUNDLE_COUNT; i++)
+		bundle_free(bundles[i]);
+}
+
+TEST(routedBundleQueue, priority_order)
+{
+	for (int i = 0; i < BUNDLE_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  routed_bundle_queue_push(&queue, bundles[i]));
+	TEST_ASSERT_EQUAL(BUNDLE_COUNT, queue.length);
+
+	// High priority first, low priority last
+	TEST_ASSERT_EQUAL_PTR(bundles[2], routed_bundle_queue_first(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[2], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[4], routed_bundle_queue_pop(&queue));
+#if CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+	TEST_ASSERT_EQUAL_PTR(bundles[5], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[3], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[0], routed_bundle_queue_pop(&queue));
+#else // CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+	TEST_ASSERT_EQUAL_PTR(bundles[0], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[3], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_EQUAL_PTR(bundles[5], routed_bundle_queue_pop(&queue));
+#endif // CONTACT_BUNDLE_QUEUE_ORDER_BY_EXPIRY
+	TEST_ASSERT_EQUAL_PTR(bundles[1], routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_NULL(routed_bundle_queue_pop(&queue));
+	TEST_ASSERT_TRUE(routed_bundle_queue_empty(&queue));
+
+	for (int i = 0; i < BUNDLE_COUNT; i++)
+		TEST_ASSERT_NULL(bundles[i]->routed_entries);
+}
+
+TEST(routedBundleQueue, remove)
+{
+	for (int i = 0; i < BUNDLE_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  routed_bundle_queue_push(&queue, bundles[i]));
+
+	// The same bundle may be queued for multiple contacts
+	TEST_ASSERT_EQUAL(UD3TN_OK,
+			  routed_bundle_queue_push(&other_queue, bundles[3]));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL,
+			  routed_bundle_queue_remove(&other_queue, bundles[0]));
+
+	TEST_ASSERT_EQUAL(UD3TN_OK,
+			  routed_bundle_queue_remove(&queue, bundles[3]));
+	TEST_ASSERT_EQUAL(UD3TN_FAIL,
+			  routed_bundle_queue_remove(&queue, bundles[3]));
+	TEST_ASSERT_EQUAL(BUNDLE_COUNT - 1, queue.length);
+	TEST_ASSERT_NOT_NULL(bundles[3]->routed_entries);
+	TEST_ASSERT_EQUAL_PTR(&other_queue, bundles[3]->routed_entries->queue);
+
+	// Removing the only entries of a partition empties it
+	TEST_ASSERT_EQUAL(UD3TN_OK,
+			  routed_bundle_queue_remove(&queue, bundles[4]));
+	TEST_ASSERT_EQUAL(UD3TN_OK,
+			  routed_bundle_queue_remove(&queue, bundles[2]));
+	TEST_ASSERT_NULL(queue.head[BUNDLE_RPRIO_HIGH]);
+	TEST_ASSERT_NULL(queue.tail[BUNDLE_RPRIO_HIGH]);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK,
+			  routed_bundle_queue_remove(&other_queue, bundles[3]));
+	TEST_ASSERT_NULL(bundles[3]->routed_entries);
+	TEST_ASSERT_TRUE(routed_bundle_queue_empty(&other_queue));
+}
+
+TEST(routedBundleQueue, take_batch)
+{
+	struct routed_bundle_list *list, *e;
+	size_t count;
+
+	for (int i = 0; i < BUNDLE_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  routed_bundle_queue_push(&queue, bundles[i]));
+
+	// The batch ends within the partition of normal priority
+	list = routed_bundle_queue_take(&queue, 3);
+	TEST_ASSERT_EQUAL_PTR(bundles[2], list->data);
+	TEST_ASSERT_EQUAL_PTR(bundles[4], list->next->data);
+	for (count = 0, e = list; e != NULL; e = e->next, count++)
+		TEST_ASSERT_NULL(e->data->routed_entries);
+	TEST_ASSERT_EQUAL(3, count);
+	TEST_ASSERT_EQUAL(BUNDLE_COUNT - 3, queue.length);
+	free_list(list);
+
+	// Queued bundles remain removable after a partition was split
+	TEST_ASSERT_NOT_NULL(routed_bundle_queue_first(&queue));
+	TEST_ASSERT_EQUAL(UD3TN_OK, routed_bundle_queue_remove(
+		&queue,
+		routed_bundle_queue_first(&queue)
+	));
+
+	list = routed_bundle_queue_take(&queue, 0);
+	for (count = 0, e = list; e != NULL; e = e->next, count++)
+		TEST_ASSERT_NULL(e->data->routed_entries);
+	TEST_ASSERT_EQUAL(BUNDLE_COUNT - 4, count);
+	TEST_ASSERT_TRUE(routed_bundle_queue_empty(&queue));
+	for (int p = 0; p < BUNDLE_RPRIO_MAX; p++) {
+		TEST_ASSERT_NULL(queue.head[p]);
+		TEST_ASSERT_NULL(queue.tail[p]);
+	}
+	free_list(list);
+
+	TEST_ASSERT_NULL(routed_bundle_queue_take(&queue, 0));
+}
+
+TEST_GROUP_RUNNER(routedBundleQueue)
+{
+	RUN_TEST_CASE(routedBundleQueue, priority_order);
+	RUN_TEST_CASE(routedBundleQueue, remove);
+	RUN_TEST_CASE(routedBundleQueue, take_batch);
+}
@@ -0,0 +1,393 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/node.h"
+#include "ud3tn/router.h"
+#include "ud3tn/routing_table.h"
+
+#include "bundle7/create.h"
+
+#include "cla/cla.h"
+
+#include "platform/hal_time.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_SIZE 9
+
+static struct rescheduling_handle rescheduler;
+
+static void rescheduling_mock(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static const char *mock_cla_name_get(void)
+{
+	return "mtcp";
+}
+
+static size_t mock_cla_mbs_get(struct cla_config *config)
+{
+	(void)config;
+	return SIZE_MAX;
+}
+
+static const struct cla_vtable mock_cla_vtable = {
+	.cla_name_get = mock_cla_name_get,
+	.cla_mbs_get = mock_cla_mbs_get,
+};
+
+// Registered for the nodes with a CLA address starting with "mtcp:"
+static struct cla_config mock_cla = {
+	.vtable = &mock_cla_vtable,
+};
+
+static void addeid(struct endpoint_list **list, const char *eid)
+{
+	struct endpoint_list *l = malloc(sizeof(struct endpoint_list));
+
+	l->eid = strdup(eid);
+	l->next = *list;
+	*list = l;
+}
+
+static struct contact *addcontact(struct node *node, uint64_t from_ms,
+				  uint64_t to_ms)
+{
+	struct contact *c = contact_create(node);
+
+	c->from_ms = from_ms;
+	c->to_ms = to_ms;
+	c->bitrate_bytes_per_s = 1000;
+	add_contact_to_ordered_list(&node->contacts, c, 1);
+	return c;
+}
+
+static void addnode(struct node *node)
+{
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node, 0));
+	TEST_ASSERT_TRUE(routing_table_add_node(node, rescheduler));
+}
+
+static bool is_queued(const struct contact *contact,
+		      const struct bundle *bundle)
+{
+	for (int prio = 0; prio < BUNDLE_RPRIO_MAX; prio++) {
+		const struct routed_bundle_list *e =
+			contact->contact_bundles.head[prio];
+
+		for (; e != NULL; e = e->next) {
+			if (e->data == bundle)
+				return true;
+		}
+	}
+	return false;
+}
+
+static struct bundle *create_bundle(const char *destination,
+				    uint64_t creation_time_ms,
+				    uint64_t sequence_number)
+{
+	struct bundle *b = bundle7_create_local(
+		malloc(400), 400, "dtn://src/app", destination,
+		creation_time_ms, sequence_number, 3600000, 0
+	);
+
+	TEST_ASSERT_NOT_NULL(b);
+	return b;
+}
+
+TEST_GROUP(router);
+
+TEST_SETUP(router)
+{
+	rescheduler = (struct rescheduling_handle) {
+		.reschedule_func = rescheduling_mock,
+		.reschedule_func_context = NULL,
+	};
+	routing_table_init();
+	cla_register(&mock_cla);
+}
+
+TEST_TEAR_DOWN(router)
+{
+	cla_deregister(mock_cla_name_get());
+	router_route_cache_free();
+	routing_table_free();
+}
+
+TEST(router, lookup_destination_cached)
+{
+	struct node *a = node_create("dtn://a/");
+	struct node *b = node_create("dtn://b/");
+	struct contact *a1, *a2, *b1;
+	struct contact_list *cl;
+
+	a->cla_addr = strdup("cla:a");
+	a1 = addcontact(a, 100000, 200000);
+	a2 = addcontact(a, 300000, 400000);
+	addeid(&a->endpoints, "dtn://dest/");
+	b->cla_addr = strdup("cla:b");
+	b1 = addcontact(b, 150000, 250000);
+	addeid(&b->endpoints, "dtn://dest/");
+	addnode(a);
+	addnode(b);
+
+	TEST_ASSERT_NULL(router_lookup_destination_cached("dtn://unknown/"));
+
+	// Ordered by end time, the same list is returned until modified
+	cl = router_lookup_destination_cached("dtn://dest/app");
+	TEST_ASSERT_NOT_NULL(cl);
+	TEST_ASSERT_EQUAL_PTR(a1, cl->data);
+	TEST_ASSERT_EQUAL_PTR(b1, cl->next->data);
+	TEST_ASSERT_EQUAL_PTR(a2, cl->next->next->data);
+	TEST_ASSERT_NULL(cl->next->next->next);
+	TEST_ASSERT_EQUAL_PTR(cl, router_lookup_destination_cached(
+		"dtn://dest/app"
+	));
+
+	// Dropped when the routing table changes
+	TEST_ASSERT_TRUE(routing_table_delete_node_by_eid("dtn://b/",
+							  rescheduler));
+	cl = router_lookup_destination_cached("dtn://dest/app");
+	TEST_ASSERT_NOT_NULL(cl);
+	TEST_ASSERT_EQUAL_PTR(a1, cl->data);
+	TEST_ASSERT_EQUAL_PTR(a2, cl->next->data);
+	TEST_ASSERT_NULL(cl->next->next);
+
+	// Negative results are updated as well
+	b = node_create("dtn://unknown/");
+	b->cla_addr = strdup("cla:b");
+	b1 = addcontact(b, 150000, 250000);
+	addnode(b);
+	cl = router_lookup_destination_cached("dtn://unknown/");
+	TEST_ASSERT_NOT_NULL(cl);
+	TEST_ASSERT_EQUAL_PTR(b1, cl->data);
+}
+
+TEST(router, route_bundles)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	struct node *a = node_create("dtn://a/");
+	struct bundle *bundles[BATCH_SIZE];
+	enum router_result_status results[BATCH_SIZE];
+	static const char *const destinations[] = {
+		"dtn://b/app", "dtn://a/app", "dtn://c/app"
+	};
+	size_t i;
+
+	a->cla_addr = strdup("cla:a");
+	addcontact(a, now_ms, now_ms + 100000);
+	addnode(a);
+
+	// The batch is reordered by destination and expiration time, the
+	// results have to be reported in the original order nonetheless.
+	for (i = 0; i < BATCH_SIZE; i++) {
+		bundles[i] = bundle7_create_local(
+			malloc(100), 100, "dtn://src/app",
+			destinations[i % 3],
+			// Every second bundle has expired already
+			i % 2 ? now_ms - 7200000 : now_ms,
+			i, 3600000, 0
+		);
+		TEST_ASSERT_NOT_NULL(bundles[i]);
+	}
+	router_route_bundles(bundles, BATCH_SIZE, results);
+
+	for (i = 0; i < BATCH_SIZE; i++) {
+		// No CLA is registered for "cla:", thus, there is no route
+		if (i % 2) {
+			TEST_ASSERT_EQUAL(ROUTER_RESULT_EXPIRED, results[i]);
+		} else {
+			TEST_ASSERT_NOT_EQUAL(ROUTER_RESULT_OK, results[i]);
+			TEST_ASSERT_NOT_EQUAL(ROUTER_RESULT_EXPIRED,
+					      results[i]);
+		}
+		bundle_free(bundles[i]);
+	}
+}
+
+TEST(router, route_bundles_reuse)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	struct node *a = node_create("dtn://a/");
+	struct node *b = node_create("dtn://b/");
+	struct contact *a1, *a2, *b1;
+	struct contact *expected[6];
+	struct bundle *bundles[6];
+	enum router_result_status results[6];
+	size_t i;
+
+	// 1000 bytes, i.e., two of the bundles fit into the first contact
+	a->cla_addr = strdup("mtcp:a");
+	a1 = addcontact(a, now_ms + 10000, now_ms + 11000);
+	a2 = addcontact(a, now_ms + 20000, now_ms + 120000);
+	addnode(a);
+	b->cla_addr = strdup("mtcp:b");
+	b1 = addcontact(b, now_ms + 30000, now_ms + 130000);
+	addnode(b);
+	expected[0] = expected[1] = a1;
+	expected[2] = expected[3] = a2;
+	expected[4] = expected[5] = b1;
+
+	// Routed to "dtn://a/" first and in the order of creation, the route
+	// of the previous bundle is reused as long as it has capacity.
+	for (i = 0; i < 4; i++)
+		bundles[i] = create_bundle("dtn://a/app", now_ms, i);
+	// Reusing the route of the bundles to "dtn://a/" would queue them
+	// for the wrong node, which a1 and a2 have capacity for.
+	for (; i < 6; i++)
+		bundles[i] = create_bundle("dtn://b/app", now_ms, i);
+	router_route_bundles(bundles, 6, results);
+
+	for (i = 0; i < 6; i++) {
+		TEST_ASSERT_EQUAL(ROUTER_RESULT_OK, results[i]);
+		TEST_ASSERT_TRUE(is_queued(expected[i], bundles[i]));
+		router_remove_bundle_from_contact(expected[i], bundles[i]);
+		bundle_free(bundles[i]);
+	}
+}
+
+TEST(router, route_bundles_reuse_outliving_contact)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	struct node *a = node_create("dtn://a/");
+	struct contact *a1, *a2;
+	struct bundle *bundles[2];
+	enum router_result_status results[2];
+
+	// The second contact ends after the bundles have expired
+	a->cla_addr = strdup("mtcp:a");
+	a1 = addcontact(a, now_ms + 10000, now_ms + 11000);
+	a2 = addcontact(a, now_ms + 20000, now_ms + 120000);
+	addnode(a);
+
+	// The first bundle does not fit into a1. The second one would, thus,
+	// it is only queued for a2 if the route of the first one is reused.
+	bundles[0] = bundle7_create_local(
+		malloc(1500), 1500, "dtn://src/app", "dtn://a/app",
+		now_ms, 0, 60000, BUNDLE_FLAG_MUST_NOT_BE_FRAGMENTED
+	);
+	bundles[1] = bundle7_create_local(
+		malloc(100), 100, "dtn://src/app", "dtn://a/app",
+		now_ms, 1, 60000, BUNDLE_FLAG_MUST_NOT_BE_FRAGMENTED
+	);
+	TEST_ASSERT_NOT_NULL(bundles[0]);
+	TEST_ASSERT_NOT_NULL(bundles[1]);
+	router_route_bundles(bundles, 2, results);
+
+	TEST_ASSERT_EQUAL(ROUTER_RESULT_OK, results[0]);
+	TEST_ASSERT_EQUAL(ROUTER_RESULT_OK, results[1]);
+	TEST_ASSERT_TRUE(is_queued(a2, bundles[0]));
+	TEST_ASSERT_TRUE(is_queued(a2, bundles[1]));
+	TEST_ASSERT_FALSE(is_queued(a1, bundles[1]));
+
+	router_remove_bundle_from_contact(a2, bundles[0]);
+	router_remove_bundle_from_contact(a2, bundles[1]);
+	bundle_free(bundles[0]);
+	bundle_free(bundles[1]);
+}
+
+TEST(router, route_bundles_table_modified)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	struct node *a = node_create("dtn://a/");
+	struct node *c = node_create("dtn://c/");
+	struct contact *a1, *c1;
+	struct bundle *bundles[2];
+	enum router_result_status result;
+
+	a->cla_addr = strdup("mtcp:a");
+	a1 = addcontact(a, now_ms + 20000, now_ms + 120000);
+	addnode(a);
+
+	bundles[0] = create_bundle("dtn://a/app", now_ms, 0);
+	router_route_bundles(&bundles[0], 1, &result);
+	TEST_ASSERT_EQUAL(ROUTER_RESULT_OK, result);
+	TEST_ASSERT_TRUE(is_queued(a1, bundles[0]));
+
+	// The contacts to "dtn://a/" looked up for the previous batch are
+	// outdated by the new node, which delivers the bundle earlier.
+	c->cla_addr = strdup("mtcp:c");
+	c1 = addcontact(c, now_ms + 10000, now_ms + 60000);
+	addeid(&c->endpoints, "dtn://a/");
+	addnode(c);
+
+	bundles[1] = create_bundle("dtn://a/app", now_ms, 1);
+	router_route_bundles(&bundles[1], 1, &result);
+	TEST_ASSERT_EQUAL(ROUTER_RESULT_OK, result);
+	TEST_ASSERT_TRUE(is_queued(c1, bundles[1]));
+
+	router_remove_bundle_from_contact(a1, bundles[0]);
+	router_remove_bundle_from_contact(c1, bundles[1]);
+	bundle_free(bundles[0]);
+	bundle_free(bundles[1]);
+}
+
+static struct node *plannode(char *eid, uint64_t now_ms)
+{
+	struct node *node = node_create(eid);
+
+	node->cla_addr = strdup("mtcp:x");
+	addcontact(node, now_ms + 10000, now_ms + 20000);
+	return node;
+}
+
+TEST(router, process_commands_transaction)
+{
+	const uint64_t now_ms = hal_time_get_timestamp_ms();
+	struct router_command commands[3];
+
+	// Replacing a node deleted by a preceding command fails, thus, the
+	// node added first is not added either.
+	commands[0] = (struct router_command) {
+		ROUTER_COMMAND_ADD, plannode("dtn://x/", now_ms)
+	};
+	commands[1] = (struct router_command) {
+		ROUTER_COMMAND_DELETE, node_create("dtn://x/")
+	};
+	commands[2] = (struct router_command) {
+		ROUTER_COMMAND_UPDATE, plannode("dtn://x/", now_ms)
+	};
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, router_process_commands(
+		commands, 3, rescheduler
+	));
+	TEST_ASSERT_NULL(routing_table_lookup_node("dtn://x/"));
+
+	commands[0] = (struct router_command) {
+		ROUTER_COMMAND_ADD, plannode("dtn://x/", now_ms)
+	};
+	commands[1] = (struct router_command) {
+		ROUTER_COMMAND_DELETE, node_create("dtn://y/")
+	};
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, router_process_commands(
+		commands, 2, rescheduler
+	));
+	TEST_ASSERT_NULL(routing_table_lookup_node("dtn://x/"));
+
+	commands[0] = (struct router_command) {
+		ROUTER_COMMAND_ADD, plannode("dtn://x/", now_ms)
+	};
+	commands[1] = (struct router_command) {
+		ROUTER_COMMAND_UPDATE, plannode("dtn://x/", now_ms)
+	};
+	TEST_ASSERT_EQUAL(UD3TN_OK, router_process_commands(
+		commands, 2, rescheduler
+	));
+	TEST_ASSERT_NOT_NULL(routing_table_lookup_node("dtn://x/"));
+}
+
+TEST_GROUP_RUNNER(router)
+{
+	RUN_TEST_CASE(router, lookup_destination_cached);
+	RUN_TEST_CASE(router, route_bundles);
+	RUN_TEST_CASE(router, route_bundles_reuse);
+	RUN_TEST_CASE(router, route_bundles_reuse_outliving_contact);
+	RUN_TEST_CASE(router, route_bundles_table_modified);
+	RUN_TEST_CASE(router, process_commands_transaction);
+}
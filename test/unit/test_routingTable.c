@@ -1,8 +1,12 @@
 // SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
 #include "ud3tn/bundle_processor.h"
+#include "ud3tn/common.h"
 #include "ud3tn/node.h"
+#include "ud3tn/router.h"
 #include "ud3tn/routing_table.h"
 
+#include "bundle7/create.h"
+
 #include "util/llsort.h"
 
 #include "testud3tn_unity.h"
@@ -40,11 +44,29 @@ static struct contact *c1, *c2, *c3, *c5, *c6, *c7,
 	*c8, *c9, *c10, *c11, *c12, *c13, *c14, *c15;
 
 static struct rescheduling_handle rescheduler;
+static struct bundle *rescheduled[4];
+static size_t rescheduled_count;
 
 static void rescheduling_mock(struct bundle *b, const void *ctx)
 {
-	(void)b;
 	(void)ctx;
+	if (rescheduled_count < ARRAY_LENGTH(rescheduled))
+		rescheduled[rescheduled_count] = b;
+	rescheduled_count++;
+}
+
+static struct bundle *createbundle(uint64_t lifetime_ms)
+{
+	return bundle7_create_local(
+		malloc(10), 10, "dtn://a/app", "dtn://b/app",
+		1000, 1, lifetime_ms, 0
+	);
+}
+
+static void freebundle(struct contact *c, struct bundle *b)
+{
+	router_remove_bundle_from_contact(c, b);
+	bundle_free(b);
 }
 
 TEST_SETUP(routingTable)
@@ -112,6 +134,7 @@ TEST_SETUP(routingTable)
 	/* node4 */
 	node4 = node_create("node4");
 	/* rescheduling handle */
+	rescheduled_count = 0;
 	rescheduler = (struct rescheduling_handle) {
 		.reschedule_func = rescheduling_mock,
 		.reschedule_func_context = NULL,
@@ -273,8 +296,173 @@ TEST(routingTable, routing_table_replace)
 	free_node(node3);
 }
 
+TEST(routingTable, routing_table_upcoming)
+{
+	struct node *node15 = node_create("node1");
+	struct contact *c16;
+
+	node15->cla_addr = strdup("cla:addr1");
+	c16 = createct(node15, 3, 5, 100);
+	add_contact_to_ordered_list(&node15->contacts, c16, 1);
+
+	// This is normally done by `router_task`
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node11, 0));
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node2, 0));
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node15, 0));
+
+	TEST_ASSERT_NULL(routing_table_peek_upcoming_contact());
+	TEST_ASSERT_TRUE(routing_table_add_node(node2, rescheduler));
+	TEST_ASSERT_TRUE(routing_table_add_node(node11, rescheduler));
+	TEST_ASSERT_EQUAL_PTR(c1, routing_table_peek_upcoming_contact());
+	TEST_ASSERT_EQUAL_PTR(c1, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_EQUAL(MIN_HEAP_NO_INDEX, c1->upcoming_index);
+	// This is normally done by the contact manager
+	c1->active = 1;
+
+	// Active contacts are not added again, merged ones are updated
+	TEST_ASSERT_TRUE(routing_table_add_node(node15, rescheduler));
+	TEST_ASSERT_EQUAL_UINT64(3, c3->from_ms);
+	routing_table_delete_contact(c8);
+
+	TEST_ASSERT_EQUAL_PTR(c2, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_EQUAL_PTR(c3, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_EQUAL_PTR(c7, routing_table_peek_upcoming_contact());
+	TEST_ASSERT_EQUAL_PTR(c7, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_NULL(routing_table_pop_upcoming_contact());
+
+	c1->active = 0;
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node1"), rescheduler));
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node2"), rescheduler));
+}
+
+// Replaces the plan of "node7" by the given contact and the one following it
+static void replacenode7(uint64_t from, uint64_t to, uint16_t bitrate)
+{
+	struct node *update = node_create("node7");
+
+	update->cla_addr = strdup("cla:addr7");
+	add_contact_to_ordered_list(&update->contacts,
+				    createct(update, from, to, bitrate), 1);
+	add_contact_to_ordered_list(&update->contacts,
+				    createct(update, 20000, 21000, 1000), 1);
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(update, 0));
+	TEST_ASSERT_TRUE(routing_table_replace_node(update, rescheduler));
+}
+
+TEST(routingTable, routing_table_replace_unfit)
+{
+	struct node *node = node_create("node7");
+	struct contact *c, *c_next;
+	struct bundle *b[3];
+	int32_t size;
+
+	node->cla_addr = strdup("cla:addr7");
+	c = createct(node, 1000, 11000, 1000);
+	c_next = createct(node, 20000, 21000, 1000);
+	add_contact_to_ordered_list(&node->contacts, c, 1);
+	add_contact_to_ordered_list(&node->contacts, c_next, 1);
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node, 0));
+	TEST_ASSERT_TRUE(routing_table_add_node(node, rescheduler));
+
+	// The first bundle expires at 3 s, the others at 61 s
+	b[0] = createbundle(2000);
+	b[1] = createbundle(60000);
+	b[2] = createbundle(60000);
+	size = bundle_get_serialized_size(b[1]);
+	for (int i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL(UD3TN_OK,
+				  router_add_bundle_to_contact(c, b[i]));
+	}
+
+	// Only the bundle queued last does not fit anymore
+	replacenode7(1000, 2000, 2 * size);
+	TEST_ASSERT_EQUAL_PTR(c, node->contacts->data);
+	TEST_ASSERT_EQUAL(1, rescheduled_count);
+	TEST_ASSERT_EQUAL_PTR(b[2], rescheduled[0]);
+	TEST_ASSERT_EQUAL(2, c->contact_bundles.length);
+	TEST_ASSERT_EQUAL_INT32(2 * size, c->total_capacity_bytes);
+	TEST_ASSERT_EQUAL_INT32(0, c->remaining_capacity_p0);
+	bundle_free(b[2]);
+
+	// Bundles expiring before the new start are re-scheduled
+	replacenode7(1000, 5000, 2 * size);
+	TEST_ASSERT_EQUAL(1, rescheduled_count);
+	replacenode7(4000, 5000, 2 * size);
+	TEST_ASSERT_EQUAL_PTR(c, node->contacts->data);
+	TEST_ASSERT_EQUAL(2, rescheduled_count);
+	TEST_ASSERT_EQUAL_PTR(b[0], rescheduled[1]);
+	TEST_ASSERT_EQUAL(1, c->contact_bundles.length);
+	TEST_ASSERT_EQUAL_INT32(size, c->remaining_capacity_p0);
+	TEST_ASSERT_EQUAL_PTR(c, routing_table_peek_upcoming_contact());
+	bundle_free(b[0]);
+
+	freebundle(c, b[1]);
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node7"), rescheduler));
+}
+
+TEST(routingTable, routing_table_replace_delta)
+{
+	struct node *node = node_create("node7");
+	struct node *update = node_create("node7");
+	struct contact *c, *c_dropped, *c_update, *c_new;
+	struct bundle *b[2];
+	struct node_table_entry *nti;
+
+	node->cla_addr = strdup("cla:addr7");
+	addnode(&node->endpoints, "node8");
+	c = createct(node, 1000, 11000, 1000);
+	c_dropped = createct(node, 20000, 21000, 1000);
+	add_contact_to_ordered_list(&node->contacts, c, 1);
+	add_contact_to_ordered_list(&node->contacts, c_dropped, 1);
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node, 0));
+	TEST_ASSERT_TRUE(routing_table_add_node(node, rescheduler));
+	b[0] = createbundle(3600000);
+	b[1] = createbundle(3600000);
+	router_add_bundle_to_contact(c, b[0]);
+	router_add_bundle_to_contact(c_dropped, b[1]);
+
+	// Same CLA address and endpoints, first contact extended
+	update->cla_addr = strdup("cla:addr7");
+	addnode(&update->endpoints, "node8");
+	c_update = createct(update, 1000, 12000, 1000);
+	c_new = createct(update, 40000, 41000, 1000);
+	add_contact_to_ordered_list(&update->contacts, c_update, 1);
+	add_contact_to_ordered_list(&update->contacts, c_new, 1);
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(update, 0));
+	TEST_ASSERT_TRUE(routing_table_replace_node(update, rescheduler));
+
+	// The node and the overlapping contact are kept including its bundle
+	TEST_ASSERT_EQUAL_PTR(node, routing_table_lookup_node("node7"));
+	TEST_ASSERT_EQUAL_PTR(c, node->contacts->data);
+	TEST_ASSERT_EQUAL_UINT64(12000, c->to_ms);
+	TEST_ASSERT_EQUAL(1, c->contact_bundles.length);
+	TEST_ASSERT_EQUAL_PTR(c_new, node->contacts->next->data);
+	TEST_ASSERT_EQUAL_PTR(node, c_new->node);
+	TEST_ASSERT_NULL(node->contacts->next->next);
+	// Only the bundle of the dropped contact is re-scheduled
+	TEST_ASSERT_EQUAL(1, rescheduled_count);
+	TEST_ASSERT_EQUAL_PTR(b[1], rescheduled[0]);
+	nti = routing_table_lookup_eid("node8");
+	TEST_ASSERT_NOT_NULL(nti);
+	TEST_ASSERT_EQUAL_UINT16(2, nti->ref_count);
+	TEST_ASSERT_EQUAL_PTR(c, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_EQUAL_PTR(c_new, routing_table_pop_upcoming_contact());
+	TEST_ASSERT_NULL(routing_table_pop_upcoming_contact());
+
+	freebundle(c, b[0]);
+	bundle_free(b[1]);
+	TEST_ASSERT_TRUE(routing_table_delete_node(
+		node_create("node7"), rescheduler));
+}
+
 TEST_GROUP_RUNNER(routingTable)
 {
 	RUN_TEST_CASE(routingTable, routing_table_add_delete);
 	RUN_TEST_CASE(routingTable, routing_table_replace);
+	RUN_TEST_CASE(routingTable, routing_table_upcoming);
+	RUN_TEST_CASE(routingTable, routing_table_replace_unfit);
+	RUN_TEST_CASE(routingTable, routing_table_replace_delta);
 }
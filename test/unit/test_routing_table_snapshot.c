@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/node.h"
+#include "ud3tn/result.h"
+#include "ud3tn/routing_table.h"
+#include "ud3tn/routing_table_snapshot.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(routing_table_snapshot);
+
+static struct rescheduling_handle rescheduler;
+static uint8_t *snapshot;
+static size_t snapshot_length;
+
+static void rescheduling_mock(struct bundle *b, const void *ctx)
+{
+	(void)b;
+	(void)ctx;
+}
+
+static void add_eid(struct endpoint_list **list, const char *eid)
+{
+	struct endpoint_list *l = malloc(sizeof(struct endpoint_list));
+
+	l->eid = strdup(eid);
+	l->next = *list;
+	*list = l;
+}
+
+static struct contact *add_contact(struct node *node, uint64_t from_ms,
+				   uint64_t to_ms, uint32_t bitrate)
+{
+	struct contact *c = contact_create(node);
+
+	c->from_ms = from_ms;
+	c->to_ms = to_ms;
+	c->bitrate_bytes_per_s = bitrate;
+	add_contact_to_ordered_list(&node->contacts, c, 1);
+	return c;
+}
+
+/*
+ * Creates the snapshot of the following routing table:
+ * 1(dtn://gs1.dtn/):(mtcp:127.0.0.1:4224):[(dtn://a.dtn/)]:
+ *	[{1,5,100},{10,20,100,[(dtn://b.dtn/)]}];
+ * with 300 bytes of the second contact already used for all priorities.
+ */
+static void create_snapshot(void)
+{
+	struct node *node = node_create("dtn://gs1.dtn/");
+	struct contact *c;
+
+	node->cla_addr = strdup("mtcp:127.0.0.1:4224");
+	add_eid(&node->endpoints, "dtn://a.dtn/");
+	add_contact(node, 1000, 5000, 100);
+	c = add_contact(node, 10000, 20000, 100);
+	add_eid(&c->contact_endpoints, "dtn://b.dtn/");
+	TEST_ASSERT_EQUAL(1, node_prepare_and_verify(node, 0));
+	TEST_ASSERT_TRUE(routing_table_add_node(node, rescheduler));
+	c->remaining_capacity_p0 -= 300;
+	c->remaining_capacity_p1 -= 300;
+	c->remaining_capacity_p2 -= 300;
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, routing_table_snapshot_create(
+		&snapshot,
+		&snapshot_length
+	));
+	routing_table_free();
+	routing_table_init();
+	TEST_ASSERT_NULL(routing_table_lookup_node("dtn://gs1.dtn/"));
+}
+
+TEST_SETUP(routing_table_snapshot)
+{
+	rescheduler = (struct rescheduling_handle) {
+		.reschedule_func = rescheduling_mock,
+		.reschedule_func_context = NULL,
+	};
+	snapshot = NULL;
+	routing_table_init();
+}
+
+TEST_TEAR_DOWN(routing_table_snapshot)
+{
+	free(snapshot);
+	routing_table_free();
+}
+
+TEST(routing_table_snapshot, restore)
+{
+	struct node *node;
+	struct contact *c;
+
+	create_snapshot();
+	// The first contact has passed in the meantime
+	TEST_ASSERT_EQUAL(UD3TN_OK, routing_table_snapshot_restore(
+		snapshot,
+		snapshot_length,
+		6000
+	));
+
+	node = routing_table_lookup_node("dtn://gs1.dtn/");
+	TEST_ASSERT_NOT_NULL(node);
+	TEST_ASSERT_EQUAL_STRING("mtcp:127.0.0.1:4224", node->cla_addr);
+	TEST_ASSERT_EQUAL_STRING("dtn://a.dtn/", node->endpoints->eid);
+	TEST_ASSERT_NULL(node->endpoints->next);
+	TEST_ASSERT_NOT_NULL(node->contacts);
+	TEST_ASSERT_NULL(node->contacts->next);
+
+	c = node->contacts->data;
+	TEST_ASSERT_EQUAL_UINT64(10000, c->from_ms);
+	TEST_ASSERT_EQUAL_UINT64(20000, c->to_ms);
+	TEST_ASSERT_EQUAL_UINT32(100, c->bitrate_bytes_per_s);
+	TEST_ASSERT_EQUAL_UINT32(1000, c->total_capacity_bytes);
+	TEST_ASSERT_EQUAL_INT32(700, c->remaining_capacity_p0);
+	TEST_ASSERT_EQUAL_INT32(700, c->remaining_capacity_p2);
+	TEST_ASSERT_EQUAL_STRING("dtn://b.dtn/", c->contact_endpoints->eid);
+
+	// The contact is indexed as if added via the config agent
+	TEST_ASSERT_NOT_NULL(routing_table_lookup_eid("dtn://b.dtn/"));
+	TEST_ASSERT_EQUAL_PTR(c, routing_table_peek_upcoming_contact());
+}
+
+TEST(routing_table_snapshot, invalid)
+{
+	create_snapshot();
+
+	// Truncated at every position
+	for (size_t i = 0; i < snapshot_length; i++) {
+		TEST_ASSERT_EQUAL(UD3TN_FAIL, routing_table_snapshot_restore(
+			snapshot,
+			i,
+			0
+		));
+	}
+
+	// Corrupted data is detected by the checksum
+	snapshot[snapshot_length / 2] ^= 0x01;
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, routing_table_snapshot_restore(
+		snapshot,
+		snapshot_length,
+		0
+	));
+	TEST_ASSERT_NULL(routing_table_lookup_node("dtn://gs1.dtn/"));
+}
+
+TEST_GROUP_RUNNER(routing_table_snapshot)
+{
+	RUN_TEST_CASE(routing_table_snapshot, restore);
+	RUN_TEST_CASE(routing_table_snapshot, invalid);
+}
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/spray_and_wait.h"
+
+#include "bundle7/create.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static struct bundle *bundle;
+
+TEST_GROUP(spray_and_wait);
+
+TEST_SETUP(spray_and_wait)
+{
+	bundle = bundle7_create_local(
+		malloc(10), 10, "dtn://a/app", "dtn://b/app",
+		1000, 1, 3600000, 0
+	);
+	TEST_ASSERT_NOT_NULL(bundle);
+}
+
+TEST_TEAR_DOWN(spray_and_wait)
+{
+	bundle_free(bundle);
+}
+
+TEST(spray_and_wait, split)
+{
+	TEST_ASSERT_EQUAL_UINT32(4, spray_and_wait_split(8));
+	TEST_ASSERT_EQUAL_UINT32(2, spray_and_wait_split(5));
+	TEST_ASSERT_EQUAL_UINT32(0, spray_and_wait_split(1));
+}
+
+TEST(spray_and_wait, handed_copies_block)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, spray_and_wait_get_handed_copies(bundle));
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, spray_and_wait_set_handed_copies(
+		bundle,
+		4
+	));
+	TEST_ASSERT_EQUAL_UINT32(4, spray_and_wait_get_handed_copies(bundle));
+
+	// The block is added in front of the payload block, with a new number
+	TEST_ASSERT_EQUAL(BUNDLE_BLOCK_TYPE_SPRAY_AND_WAIT,
+			  bundle->blocks->data->type);
+	TEST_ASSERT_EQUAL(2, bundle->blocks->data->number);
+	TEST_ASSERT_EQUAL_PTR(bundle->payload_block,
+			      bundle->blocks->next->data);
+
+	// Updating the number of copies does not add another block
+	TEST_ASSERT_EQUAL(UD3TN_OK, spray_and_wait_set_handed_copies(
+		bundle,
+		100000
+	));
+	TEST_ASSERT_EQUAL_UINT32(100000,
+				 spray_and_wait_get_handed_copies(bundle));
+	TEST_ASSERT_EQUAL_PTR(bundle->payload_block,
+			      bundle->blocks->next->data);
+	TEST_ASSERT_NULL(bundle->blocks->next->next);
+}
+
+TEST(spray_and_wait, copies)
+{
+	// New bundles start with the configured budget
+	TEST_ASSERT_EQUAL_UINT32(SPRAY_AND_WAIT_COPIES,
+				 spray_and_wait_get_copies(bundle));
+
+	// Received bundles start with the copies handed over
+	spray_and_wait_set_handed_copies(bundle, 3);
+	TEST_ASSERT_EQUAL_UINT32(3, spray_and_wait_get_copies(bundle));
+
+	// The persisted budget takes precedence
+	bundle->spray_copies = 1;
+	TEST_ASSERT_EQUAL_UINT32(1, spray_and_wait_get_copies(bundle));
+}
+
+TEST_GROUP_RUNNER(spray_and_wait)
+{
+	RUN_TEST_CASE(spray_and_wait, split);
+	RUN_TEST_CASE(spray_and_wait, handed_copies_block);
+	RUN_TEST_CASE(spray_and_wait, copies);
+}
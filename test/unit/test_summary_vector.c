@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/bundle.h"
+#include "ud3tn/summary_vector.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIGEST_COUNT 1000
+
+static struct digest_set set;
+
+TEST_GROUP(summary_vector);
+
+TEST_SETUP(summary_vector)
+{
+	digest_set_init(&set);
+}
+
+TEST_TEAR_DOWN(summary_vector)
+{
+	digest_set_free(&set);
+}
+
+static uint64_t test_digest(uint64_t i)
+{
+	// Spread the values over the table, but with colliding home slots
+	return (i * 0x9E3779B97F4A7C15ULL) | 1;
+}
+
+TEST(summary_vector, bundle_digest)
+{
+	struct bundle b = {
+		.source = "dtn://a/app",
+		.creation_timestamp_ms = 1000,
+		.sequence_number = 1,
+	};
+	const uint64_t d1 = summary_vector_digest(&b);
+
+	TEST_ASSERT_NOT_EQUAL(0, d1);
+	TEST_ASSERT_EQUAL_UINT64(d1, summary_vector_digest(&b));
+	b.sequence_number = 2;
+	TEST_ASSERT_NOT_EQUAL(d1, summary_vector_digest(&b));
+	b.sequence_number = 1;
+	b.source = "dtn://b/app";
+	TEST_ASSERT_NOT_EQUAL(d1, summary_vector_digest(&b));
+}
+
+TEST(summary_vector, digest_set_add_remove)
+{
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK, digest_set_add(
+			&set, test_digest(i), i
+		));
+	// Adding again only updates the expiration time
+	TEST_ASSERT_EQUAL(UD3TN_OK, digest_set_add(&set, test_digest(0), 5));
+	TEST_ASSERT_EQUAL(DIGEST_COUNT, set.count);
+
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		TEST_ASSERT_TRUE(digest_set_contains(&set, test_digest(i)));
+	TEST_ASSERT_FALSE(digest_set_contains(&set, 2));
+
+	// Remove every second digest, the others have to remain reachable
+	for (uint64_t i = 0; i < DIGEST_COUNT; i += 2)
+		TEST_ASSERT_TRUE(digest_set_remove(&set, test_digest(i)));
+	TEST_ASSERT_FALSE(digest_set_remove(&set, test_digest(0)));
+	TEST_ASSERT_EQUAL(DIGEST_COUNT / 2, set.count);
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		TEST_ASSERT_EQUAL(i % 2 == 1, digest_set_contains(
+			&set, test_digest(i)
+		));
+}
+
+TEST(summary_vector, digest_set_put_take)
+{
+	uint32_t value = 0;
+
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		TEST_ASSERT_EQUAL(UD3TN_OK, digest_set_put(
+			&set, test_digest(i), i, (uint32_t)i + 1
+		));
+	TEST_ASSERT_EQUAL(UD3TN_OK, digest_set_put(&set, test_digest(0), 5, 7));
+	TEST_ASSERT_EQUAL(DIGEST_COUNT, set.count);
+
+	// Values have to move along with the entries shifted back
+	for (uint64_t i = 0; i < DIGEST_COUNT; i += 2)
+		TEST_ASSERT_TRUE(digest_set_remove(&set, test_digest(i)));
+	for (uint64_t i = 1; i < DIGEST_COUNT; i += 2) {
+		TEST_ASSERT_TRUE(digest_set_take(&set, test_digest(i), &value));
+		TEST_ASSERT_EQUAL_UINT32(i + 1, value);
+	}
+	TEST_ASSERT_FALSE(digest_set_take(&set, test_digest(1), &value));
+	TEST_ASSERT_EQUAL(0, set.count);
+}
+
+TEST(summary_vector, digest_set_expire)
+{
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		digest_set_add(&set, test_digest(i), i);
+
+	digest_set_expire(&set, DIGEST_COUNT / 2);
+	TEST_ASSERT_EQUAL(DIGEST_COUNT / 2, set.count);
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		TEST_ASSERT_EQUAL(i >= DIGEST_COUNT / 2, digest_set_contains(
+			&set, test_digest(i)
+		));
+}
+
+TEST(summary_vector, create_serialize_parse)
+{
+	struct summary_vector sv, parsed;
+	const size_t probes = 10 * DIGEST_COUNT;
+	size_t false_positives = 0;
+
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++)
+		digest_set_add(&set, test_digest(i), UINT64_MAX);
+	TEST_ASSERT_EQUAL(UD3TN_OK, summary_vector_create(&sv, &set));
+
+	const size_t size = summary_vector_get_serialized_size(&sv);
+	uint8_t *const buffer = malloc(size);
+
+	summary_vector_serialize(&sv, buffer);
+	TEST_ASSERT_EQUAL(UD3TN_OK, summary_vector_parse(
+		&parsed, buffer, size
+	));
+	for (uint64_t i = 0; i < DIGEST_COUNT; i++) {
+		TEST_ASSERT_TRUE(summary_vector_contains(&sv, test_digest(i)));
+		TEST_ASSERT_TRUE(summary_vector_contains(
+			&parsed,
+			test_digest(i)
+		));
+	}
+	for (uint64_t i = DIGEST_COUNT; i < DIGEST_COUNT + probes; i++)
+		false_positives += summary_vector_contains(
+			&parsed,
+			test_digest(i)
+		);
+	// About 0.05 % expected with the default configuration, an order of
+	// magnitude more points to a broken filter
+	TEST_ASSERT_TRUE(false_positives < probes / 200);
+
+	// Malformed data is rejected
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, summary_vector_parse(
+		&sv, buffer, size - 1
+	));
+	buffer[0] = 0;
+	TEST_ASSERT_EQUAL(UD3TN_FAIL, summary_vector_parse(
+		&sv, buffer, size
+	));
+
+	free(buffer);
+	summary_vector_free(&sv);
+	summary_vector_free(&parsed);
+
+	// An empty summary vector does not contain anything
+	TEST_ASSERT_FALSE(summary_vector_contains(&sv, test_digest(0)));
+}
+
+TEST(summary_vector, fragment_ranges)
+{
+	struct fragment_ranges fr;
+	uint64_t offset, length;
+
+	fragment_ranges_init(&fr);
+	TEST_ASSERT_TRUE(fragment_ranges_next_gap(&fr, 0, 100, &offset,
+						  &length));
+	TEST_ASSERT_EQUAL_UINT64(0, offset);
+	TEST_ASSERT_EQUAL_UINT64(100, length);
+
+	// Ranges are added out of order and overlap
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 3, 60, 20));
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 1, 0, 30));
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 2, 20, 20));
+	TEST_ASSERT_TRUE(fragment_ranges_next_gap(&fr, 0, 100, &offset,
+						  &length));
+	TEST_ASSERT_EQUAL_UINT64(40, offset);
+	TEST_ASSERT_EQUAL_UINT64(20, length);
+	TEST_ASSERT_TRUE(fragment_ranges_next_gap(&fr, 60, 100, &offset,
+						  &length));
+	TEST_ASSERT_EQUAL_UINT64(80, offset);
+	TEST_ASSERT_EQUAL_UINT64(20, length);
+	TEST_ASSERT_FALSE(fragment_ranges_next_gap(&fr, 0, 30, &offset,
+						   &length));
+
+	// A failed fragment has to be sent again
+	TEST_ASSERT_TRUE(fragment_ranges_remove(&fr, 1));
+	TEST_ASSERT_FALSE(fragment_ranges_remove(&fr, 1));
+	TEST_ASSERT_TRUE(fragment_ranges_next_gap(&fr, 0, 100, &offset,
+						  &length));
+	TEST_ASSERT_EQUAL_UINT64(0, offset);
+	TEST_ASSERT_EQUAL_UINT64(20, length);
+
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 4, 0, 20));
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 5, 40, 20));
+	TEST_ASSERT_EQUAL(UD3TN_OK, fragment_ranges_add(&fr, 6, 80, 20));
+	TEST_ASSERT_FALSE(fragment_ranges_next_gap(&fr, 0, 100, &offset,
+						   &length));
+	fragment_ranges_free(&fr);
+}
+
+TEST_GROUP_RUNNER(summary_vector)
+{
+	RUN_TEST_CASE(summary_vector, bundle_digest);
+	RUN_TEST_CASE(summary_vector, digest_set_add_remove);
+	RUN_TEST_CASE(summary_vector, digest_set_put_take);
+	RUN_TEST_CASE(summary_vector, digest_set_expire);
+	RUN_TEST_CASE(summary_vector, create_serialize_parse);
+	RUN_TEST_CASE(summary_vector, fragment_ranges);
+}
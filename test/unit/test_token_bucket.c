@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: BSD-3-Clause OR Apache-2.0
+#include "ud3tn/token_bucket.h"
+
+#include "testud3tn_unity.h"
+
+#include <stdint.h>
+
+TEST_GROUP(token_bucket);
+
+static struct token_bucket bucket;
+
+TEST_SETUP(token_bucket)
+{
+	token_bucket_init(&bucket, 1000, 10000);
+}
+
+TEST_TEAR_DOWN(token_bucket)
+{
+}
+
+TEST(token_bucket, unlimited)
+{
+	for (int i = 0; i < 100; i++)
+		TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 1000,
+							      10000));
+}
+
+TEST(token_bucket, rate)
+{
+	token_bucket_set_rate(&bucket, 100, 10000);
+
+	// The full bucket can be sent at once
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 600, 10000));
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 400, 10000));
+	// 100 bytes take one second, 1 byte ten milliseconds
+	TEST_ASSERT_EQUAL_UINT64(1000, token_bucket_take(&bucket, 100, 10000));
+	TEST_ASSERT_EQUAL_UINT64(5, token_bucket_take(&bucket, 100, 10995));
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 100, 11000));
+	TEST_ASSERT_EQUAL_UINT64(10, token_bucket_take(&bucket, 1, 11000));
+	// Fractions of bytes are not lost
+	TEST_ASSERT_EQUAL_UINT64(5, token_bucket_take(&bucket, 1, 11005));
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 1, 11010));
+
+	// Refilled up to the capacity only, larger requests take all
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 5000, 100000));
+	TEST_ASSERT_EQUAL_UINT64(10000, token_bucket_take(&bucket, 5000,
+							  100000));
+}
+
+TEST(token_bucket, change_rate)
+{
+	token_bucket_set_rate(&bucket, 1000, 10000);
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 1000, 10000));
+
+	// Tokens accumulated at the previous rate are kept
+	token_bucket_set_rate(&bucket, 100, 10500);
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 500, 10500));
+	TEST_ASSERT_EQUAL_UINT64(1000, token_bucket_take(&bucket, 100, 10500));
+
+	// Removing the limit allows to send immediately
+	token_bucket_set_rate(&bucket, 0, 10500);
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, 1000, 10500));
+}
+
+TEST(token_bucket, overflow)
+{
+	token_bucket_init(&bucket, UINT32_MAX, 0);
+	token_bucket_set_rate(&bucket, UINT32_MAX, 0);
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, UINT32_MAX,
+						      0));
+	TEST_ASSERT_EQUAL_UINT64(0, token_bucket_take(&bucket, UINT32_MAX,
+						      UINT64_MAX));
+	TEST_ASSERT_EQUAL_UINT64(1000, token_bucket_take(&bucket, UINT32_MAX,
+							 UINT64_MAX));
+}
+
+TEST_GROUP_RUNNER(token_bucket)
+{
+	RUN_TEST_CASE(token_bucket, unlimited);
+	RUN_TEST_CASE(token_bucket, rate);
+	RUN_TEST_CASE(token_bucket, change_rate);
+	RUN_TEST_CASE(token_bucket, overflow);
+}